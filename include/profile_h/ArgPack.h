@@ -6,6 +6,9 @@ typedef struct {
 	std::string workDir;
 	std::string outWorkDir;
 	std::string configFileName;
+	std::string batchFileName;
+	unsigned batchThreads;
+	std::string dseFileName;
 	std::vector<std::string> kernelNames;
 
 	int mode;
@@ -38,11 +41,18 @@ typedef struct {
 
 	bool verbose;
 	bool compressed;
+	bool binaryTrace;
+	unsigned binaryTraceCompression;
+	unsigned traceThreads;
+	bool convertTrace;
 #ifdef PROGRESSIVE_TRACE_CURSOR
 	bool progressive;
 #endif
 #ifdef FUTURE_CACHE
 	bool futureCache;
+#endif
+#ifdef DDDG_CACHE
+	bool dddgCache;
 #endif
 	double frequency;
 	double uncertainty;
@@ -54,8 +64,10 @@ typedef struct {
 	bool showPostOptDDDG;
 	bool showScheduling;
 	bool fNPLA;
+	bool fParNPLA;
 	bool fNoTCS;
 	bool fNoMMA;
+	bool fRecIIUnroll;
 	bool fBurstAggr;
 	bool fBurstMix;
 	bool fVec;
@@ -7,6 +7,7 @@
 #include <iostream>
 #include <list>
 #include <map>
+#include <memory>
 #include <unordered_map>
 #include <unordered_set>
 #include <set>
@@ -14,9 +15,12 @@
 
 #include "profile_h/auxiliary.h"
 #include "profile_h/ContextManager.h"
+#include "profile_h/CSRGraph.h"
 #include "profile_h/DDDGBuilder.h"
+#include "profile_h/DDDGCache.h"
 #include "profile_h/HardwareProfile.h"
 #include "profile_h/MemoryModel.h"
+#include "profile_h/ScheduledDatapathState.h"
 
 #include "profile_h/boostincls.h"
 
@@ -40,10 +44,8 @@ public:
 
 	class TCScheduler {
 		const std::vector<int> &microops;
-		const Graph &graph;
+		const CSRGraph &csr;
 		unsigned numOfTotalNodes;
-		const std::unordered_map<unsigned, Vertex> &nameToVertex;
-		const VertexNameMap &vertexToName;
 		HardwareProfile &profile;
 
 		double effectivePeriod;
@@ -53,8 +55,7 @@ public:
 	public:
 		TCScheduler(
 			const std::vector<int> &microops,
-			const Graph &graph, unsigned numOfTotalNodes,
-			const std::unordered_map<unsigned, Vertex> &nameToVertex, const VertexNameMap &vertexToName,
+			const CSRGraph &csr, unsigned numOfTotalNodes,
 			HardwareProfile &profile
 		);
 
@@ -72,16 +73,18 @@ public:
 		typedef std::vector<unsigned> executedListTy;
 
 		const std::vector<int> &microops;
-		const std::unordered_map<int, unsigned> &resultSizeList;
-		const Graph &graph;
+		const resultSizeColumnTy &resultSizeList;
+		const CSRGraph &csr;
 		unsigned numOfTotalNodes;
-		const std::unordered_map<unsigned, Vertex> &nameToVertex;
-		const VertexNameMap &vertexToName;
 		HardwareProfile &profile;
 		const std::unordered_map<int, std::pair<std::string, int64_t>> &baseAddress;
+		// Partition ID of each load/store node (see HardwareProfile::arrayGetPartitionID())
+		std::vector<unsigned> partitionIDs;
 		const std::vector<uint64_t> &asap;
 		const std::vector<uint64_t> &alap;
 		std::vector<uint64_t> &rc;
+		// If not null, resource allocations and releases are logged here (see ScheduledDatapathState)
+		std::vector<allocationEventTy> *allocationLog;
 
 		std::vector<unsigned> numParents;
 		std::vector<bool> finalIsolated;
@@ -93,6 +96,8 @@ public:
 		bool readyChanged;
 		uint64_t alapShift;
 		bool criticalPathAllocated;
+		// Set when any allocation was rejected by the hardware profile
+		bool resourceConstrained;
 
 		TCScheduler tcSched;
 
@@ -146,25 +151,29 @@ public:
 		std::ofstream dumpFile;
 
 		bool dummyAllocate() { return true; }
+		void logAllocation(uint8_t type, unsigned nodeID) { if(allocationLog) allocationLog->push_back({type, nodeID}); }
 		static bool prioritiseSmallerALAP(const std::pair<unsigned, uint64_t> &first, const std::pair<unsigned, uint64_t> &second) { return first.second < second.second; }
+		// Insert keeping the list sorted by ALAP (same position that a stable sort would give to a node pushed at the back)
+		static void insertByALAP(nodeTickTy &ready, unsigned nodeID, uint64_t tick);
 
 		void assignReadyStartingNodes();
 		void select();
 		void execute();
 		void release();
+		void skipQuietCycles();
 
 		void pushReady(unsigned nodeID, uint64_t tick);
 		void trySelect(nodeTickTy &ready, selectedListTy &selected, bool (HardwareProfile::*tryAllocate)(bool));
 		void trySelect(nodeTickTy &ready, selectedListTy &selected, bool (HardwareProfile::*tryAllocateOp)(int, bool));
-		void trySelect(nodeTickTy &ready, selectedListTy &selected, bool (HardwareProfile::*tryAllocateMem)(std::string, bool));
+		void trySelect(nodeTickTy &ready, selectedListTy &selected, bool (HardwareProfile::*tryAllocateMem)(unsigned, bool));
 		void trySelect(nodeTickTy &ready, selectedListTy &selected, bool (HardwareProfile::*tryAllocateDDRMem)(unsigned, int, bool));
 		void enqueueExecute(unsigned opcode, selectedListTy &selected, executingMapTy &executing, void (HardwareProfile::*release)());
 		void enqueueExecute(selectedListTy &selected, executingMapTy &executing, void (HardwareProfile::*releaseOp)(int));
-		void enqueueExecute(unsigned opcde, selectedListTy &selected, executingMapTy &executing, void (HardwareProfile::*releaseMem)(std::string));
+		void enqueueExecute(unsigned opcde, selectedListTy &selected, executingMapTy &executing, void (HardwareProfile::*releaseMem)(unsigned));
 		void enqueueExecute(selectedListTy &selected, executingMapTy &executing, void (HardwareProfile::*releaseDDRMem)(unsigned, int));
 		void tryRelease(unsigned opcode, executingMapTy &executing, executedListTy &executed, void (HardwareProfile::*release)());
 		void tryRelease(executingMapTy &executing, executedListTy &executed, void (HardwareProfile::*releaseOp)(int));
-		void tryRelease(unsigned opcode, executingMapTy &executing, executedListTy &executed, void (HardwareProfile::*releaseMem)(std::string));
+		void tryRelease(unsigned opcode, executingMapTy &executing, executedListTy &executed, void (HardwareProfile::*releaseMem)(unsigned));
 		void tryRelease(executingMapTy &executing, executedListTy &executed, void (HardwareProfile::*releaseDDRMem)(unsigned, int));
 		void setScheduledAndAssignReadyChildren(unsigned nodeID);
 		void filterOutDeadOps();
@@ -172,16 +181,17 @@ public:
 	public:
 		RCScheduler(
 			const std::string loopName, const unsigned loopLevel, const unsigned datapathType,
-			const std::vector<int> &microops, const std::unordered_map<int, unsigned> &resultSizeList,
-			const Graph &graph, unsigned numOfTotalNodes,
-			const std::unordered_map<unsigned, Vertex> &nameToVertex, const VertexNameMap &vertexToName,
+			const std::vector<int> &microops, const resultSizeColumnTy &resultSizeList,
+			const CSRGraph &csr, unsigned numOfTotalNodes,
 			HardwareProfile &profile, const std::unordered_map<int, std::pair<std::string, int64_t>> &baseAddress,
-			const std::vector<uint64_t> &asap, const std::vector<uint64_t> &alap, std::vector<uint64_t> &rc
+			const std::vector<uint64_t> &asap, const std::vector<uint64_t> &alap, std::vector<uint64_t> &rc,
+			std::vector<allocationEventTy> *allocationLog = nullptr
 		);
 
 		~RCScheduler();
 
 		std::pair<uint64_t, double> schedule();
+		bool isResourceConstrained() { return resourceConstrained; }
 	};
 	
 	class ColorWriter {
@@ -226,18 +236,18 @@ private:
 
 	HardwareProfile *profile;
 
-	void findMinimumRankPair(std::pair<unsigned, unsigned> &pair, std::map<unsigned, unsigned> rankMap);
+	unsigned findMinimumRankPair(std::pair<unsigned, unsigned> &pair, std::vector<std::pair<unsigned, unsigned>> &rankHeap);
 	static bool prioritiseLargerResIIMem(const std::pair<std::string, double> &first, const std::pair<std::string, double> &second) { return first.second < second.second; }
 
 public:
 	BaseDatapath(
-		std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
+		std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ostream *summaryFile,
 		std::string loopName, unsigned loopLevel, uint64_t loopUnrollFactor,
 		bool enablePipelining, uint64_t asapII
 	);
 
 	BaseDatapath(
-		std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
+		std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ostream *summaryFile,
 		std::string loopName, unsigned loopLevel, uint64_t loopUnrollFactor, unsigned datapathType
 	);
 
@@ -246,10 +256,12 @@ public:
 	std::string getTargetLoopName() const;
 	unsigned getTargetLoopLevel() const;
 	uint64_t getTargetLoopUnrollFactor() const;
+	bool tracksLoopIterations() const;
 	unsigned getNumNodes() const;
 	unsigned getNumEdges() const;
 	uint64_t getMaxII() const;
 	uint64_t getRCIL() const;
+	const estimatedResourcesTy &getEstimatedResources() const;
 	Pack &getPack();
 	const std::vector<MemoryModel::nodeExportTy> &getExportedNodesToBeforeDDDG();
 	const std::vector<MemoryModel::nodeExportTy> &getExportedNodesToAfterDDDG();
@@ -257,18 +269,22 @@ public:
 	void importNodes(std::vector<MemoryModel::nodeExportTy> nodesToImport);
 	void postDDDGBuild();
 	void refreshDDDG();
+	void releaseDDDGEdges();
 	void setForDDDGImport();
 	void insertMicroop(int microop);
 	void insertDDDGEdge(unsigned from, unsigned to, uint8_t paramID);
+	void insertNodeIteration(unsigned iteration);
+	void insertCarriedEdge(unsigned from, unsigned to, unsigned distance);
 	bool edgeExists(unsigned from, unsigned to);
 	void updateRemoveDDDGEdges(std::set<Edge> &edgesToRemove);
+	void updateRemoveDDDGEdges(std::vector<Edge> &edgesToRemove);
 	void updateAddDDDGEdges(std::vector<edgeTy> &edgesToAdd);
 	void updateRemoveDDDGNodes(std::vector<unsigned> &nodesToRemove);
 	artificialNodeTy createArtificialNode(artificialNodeTy &aNode, int opcode);
 	artificialNodeTy createArtificialNode(unsigned baseNode, int opcode);
 	unsigned createDummySink();
 
-	std::string constructUniqueID(std::string funcID, std::string instID, std::string bbID);
+	std::string constructUniqueID(uint32_t funcID, uint32_t instID, uint32_t bbID);
 
 	// Interface for non-subclasses (e.g. MemoryModel)
 	unsigned getDatapathType();
@@ -278,6 +294,7 @@ public:
 	VertexNameMap &getVertexToName();
 	EdgeWeightMap &getEdgeToWeight();
 	std::unordered_map<unsigned, Vertex> &getNameToVertex();
+	const CSRGraph &getCSR();
 	std::vector<int> &getMicroops();
 	std::unordered_map<int, std::pair<std::string, int64_t>> &getBaseAddress();
 
@@ -300,6 +317,9 @@ protected:
 
 	// A map from node ID to its microop
 	std::vector<int> microops;
+	// Loop iteration of each node and dependencies into the iteration after the DDDG (normal loops only)
+	std::vector<unsigned> nodeIterations;
+	std::vector<carriedEdgeTy> carriedEdges;
 	// The DDDG
 	Graph graph;
 	// Number of nodes in the graph
@@ -310,6 +330,11 @@ protected:
 	VertexNameMap vertexToName;
 	// A map from edge internal ID to its weight (parameter ID before estimation, node latency after estimation)
 	EdgeWeightMap edgeToWeight;
+	// Compressed snapshot of the DDDG used by the scheduling phases. Rebuilt by getCSR() when the DDDG has changed
+	CSRGraph csr;
+	bool csrOutdated;
+	// After the DDDG optimisations the boost edges are released and the snapshot is the only copy of the edges
+	bool dddgEdgesReleased;
 	// Set containing all called functions
 	std::unordered_set<std::string> functionNames;
 	// The name says it all
@@ -337,6 +362,8 @@ protected:
 	uint64_t maxII;
 	// Final latency of the loop, without performing the nest calculations
 	uint64_t rcIL;
+	// Resources written to the summary file (see dumpSummary())
+	estimatedResourcesTy estimatedResources;
 
 	// Optimisation counters
 	uint64_t sharedLoadsRemoved;
@@ -351,10 +378,19 @@ protected:
 	std::unordered_map<unsigned, std::set<unsigned>> loadDepMap;
 	std::unordered_map<unsigned, std::set<unsigned>> storeDepMap;
 
+	// Key of the scheduled state of this datapath, empty if states are not reused (see ScheduledDatapathState)
+	std::string scheduledStateKey;
+	// State recovered from a previous design point, or being captured for the next ones
+	std::shared_ptr<ScheduledDatapathState> scheduledState;
+	bool scheduledStateRestored;
+
 	void initBaseAddress();
 
 	uint64_t fpgaEstimationOneMoreSubtraceForRecIICalculation();
 	uint64_t fpgaEstimation();
+	bool analyseDDDG(std::tuple<uint64_t, uint64_t> &asapResult);
+	std::tuple<uint64_t, uint64_t> restoreScheduledState();
+	void captureScheduledState(std::tuple<uint64_t, uint64_t> asapResult);
 
 	void removeInductionDependencies();
 	void removePhiNodes();
@@ -374,6 +410,7 @@ protected:
 	std::tuple<std::string, uint64_t> calculateResIIMemPort();
 	std::tuple<std::string, uint64_t> calculateResIIMemRec();
 	uint64_t calculateRecII(uint64_t currAsapII);
+	uint64_t calculateRecIIFromCycleRatio(uint64_t currAsapII);
 	uint64_t getLoopTotalLatency(uint64_t maxII);
 
 	void inheritLoadDepMap(unsigned targetID, unsigned sourceID);
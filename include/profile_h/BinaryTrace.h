@@ -0,0 +1,180 @@
+#ifndef __BINARYTRACE_H__
+#define __BINARYTRACE_H__
+
+#include <assert.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <zlib.h>
+
+#define BINARY_TRACE_MAGIC_STRING "!Bt"
+#define BINARY_TRACE_VERSION 1
+// Number of records per block. Each block is compressed independently, so that any record
+// can be reached by decompressing a single block (i.e. 2 MB of raw records)
+#define BINARY_TRACE_BLOCK_RECORDS 65536
+// Label ID used for operands that carry no label (i.e. the "noreg" trace logger variants)
+#define BINARY_TRACE_NO_LABEL 0xFFFFFFFF
+// Number of block buffers per background thread in the writer ring (see BinaryTraceWriter)
+#define BINARY_TRACE_RING_SLOTS_PER_THREAD 2
+
+// Binary dynamic trace format
+// ---------------------------
+// The binary trace holds the same information as the textual dynamic_trace.gz, but each line
+// is stored as a fixed-width 32-byte record. Function, basic block, instruction and label strings
+// are interned and only their 32-bit IDs are stored in the records. File layout:
+//
+//	HEADER: magic (3 bytes), version (1 byte), record size (uint32), records per block (uint32), compression (uint32)
+//	BLOCK 0: stored size (uint32), raw size (uint32), payload
+//	...
+//	BLOCK N-1
+//	FOOTER: no. of strings (uint64), for each string: length (uint32), chars
+//	        no. of blocks (uint64), for each block: file offset (uint64), first record (uint64)
+//	        no. of records (uint64)
+//	TRAILER: footer offset (uint64)
+//
+// Positions inside a binary trace (e.g. progressive trace cursor, future cache) are record
+// indexes instead of byte offsets.
+struct binaryTraceRecordTy {
+	enum {
+		TYPE_INST = 0,
+		TYPE_RESULT = 1,
+		TYPE_FORWARD = 2,
+		TYPE_PARAM = 3
+	};
+	enum {
+		FLAG_ISREG = 0x1,
+		FLAG_DOUBLE = 0x2,
+		FLAG_LABEL = 0x4
+	};
+
+	uint8_t type;
+	uint8_t flags;
+	// Opcode (instruction records)
+	uint16_t opcode;
+	// Source line (instruction records) or parameter number (parameter records)
+	int32_t lineNo;
+	// Operand size (operand records)
+	uint32_t size;
+	// Function ID (instruction records) or label ID (operand records)
+	uint32_t funcID;
+	uint32_t bbID;
+	uint32_t instID;
+	// Dynamic instruction count (instruction records) or operand value (operand records)
+	union {
+		int64_t i;
+		double d;
+		uint64_t u;
+	} value;
+};
+
+class BinaryTraceWriter {
+public:
+	enum {
+		COMPRESSION_NONE = 0,
+		COMPRESSION_ZLIB = 1
+	};
+
+private:
+	enum {
+		SLOT_FREE = 0,
+		SLOT_FILLED = 1,
+		SLOT_DONE = 2
+	};
+
+	typedef struct {
+		std::vector<binaryTraceRecordTy> records;
+		std::vector<Bytef> compressed;
+		size_t numRecords;
+		uint64_t firstRecord;
+		uint32_t storedSize;
+		int state;
+	} slotTy;
+
+	FILE *file;
+	unsigned compression;
+
+	// Ring of block buffers. Records are appended to the current slot without any locking, and the lock is only taken
+	// once per block. With background threads, full slots are compressed in parallel while the traced kernel keeps
+	// running, and they are written in order by whichever thread finishes the oldest one. The traced kernel only
+	// waits when all slots are full. Without background threads there is a single slot, compressed and written by the
+	// caller as before
+	std::vector<slotTy> ring;
+	unsigned currSlot;
+	unsigned nextWriteSlot;
+	std::deque<unsigned> filledSlots;
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable slotFilled;
+	std::condition_variable slotFreed;
+	bool finishing;
+
+	std::vector<std::pair<uint64_t, uint64_t>> blockIndex;
+	uint64_t numRecords;
+
+	std::vector<std::string> strings;
+	std::unordered_map<std::string, uint32_t> stringIDs;
+	std::unordered_map<const char *, uint32_t> pointerIDs;
+
+	void flushBlock();
+	void compressSlot(slotTy &slot);
+	void writeDoneSlots();
+	void worker();
+
+public:
+	BinaryTraceWriter(std::string fileName, unsigned compression, unsigned numThreads = 0);
+	~BinaryTraceWriter();
+
+	uint32_t intern(const std::string &str);
+	// XXX: This variant caches IDs by pointer. Only use it with strings whose contents never change
+	// (e.g. the constant globals created by the instrumentation pass)
+	uint32_t intern(const char *str);
+
+	void appendInstruction(int lineNo, uint32_t funcID, uint32_t bbID, uint32_t instID, int opcode, uint64_t count);
+	void appendIntOperand(uint8_t type, int param, int size, int64_t value, int isReg, uint32_t labelID = BINARY_TRACE_NO_LABEL);
+	void appendDoubleOperand(uint8_t type, int param, int size, double value, int isReg, uint32_t labelID = BINARY_TRACE_NO_LABEL);
+	void append(binaryTraceRecordTy &record);
+
+	void close();
+};
+
+class BinaryTraceReader {
+	FILE *file;
+	uint32_t blockRecords;
+	unsigned compression;
+
+	std::vector<std::string> strings;
+	std::vector<std::pair<uint64_t, uint64_t>> blockIndex;
+	uint64_t numRecords;
+
+	std::vector<binaryTraceRecordTy> block;
+	std::vector<Bytef> compressedBlock;
+	int64_t loadedBlock;
+	uint64_t cursor;
+
+	void loadBlock(uint64_t blockNo);
+
+public:
+	BinaryTraceReader(std::string fileName);
+	~BinaryTraceReader();
+
+	// Returns nullptr when end of trace is reached. The returned record is only valid until the next read
+	const binaryTraceRecordTy *read();
+	uint64_t tell() { return cursor; }
+	void seek(uint64_t record) { cursor = record; }
+	void rewind() { cursor = 0; }
+	bool eof() { return cursor >= numRecords; }
+
+	uint64_t getNumRecords() { return numRecords; }
+	const std::string &getString(uint32_t ID) { return strings.at(ID); }
+	uint32_t getNumStrings() { return strings.size(); }
+};
+
+void convertTextTraceToBinary(std::string textFileName, std::string binFileName, unsigned compression);
+
+#endif
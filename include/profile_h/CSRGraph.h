@@ -0,0 +1,60 @@
+#ifndef __CSRGRAPH_H__
+#define __CSRGRAPH_H__
+
+#include <stdint.h>
+#include <vector>
+
+#include "profile_h/auxiliary.h"
+
+#include "profile_h/boostincls.h"
+
+// Compressed DDDG
+// ---------------
+// The DDDG is built and transformed as a boost adjacency list, where every edge is a separate heap node. Once the
+// transforms are applied, the scheduling phases (ASAP, ALAP, resource- and time-constrained scheduling) only traverse
+// the graph, many times and in every direction. This is an immutable snapshot of the DDDG for these phases, with the
+// out-edges of all nodes stored contiguously (CSR) and the in-edges stored likewise (CSC), both indexed by node ID.
+// Edges of a node keep the same order as in the boost graph, so all traversals visit nodes in the same order.
+//
+// The snapshot is not updated when the DDDG changes. Edits to the DDDG are still performed in batches through the
+// BaseDatapath::update*() functions, which mark the snapshot as outdated (see BaseDatapath::getCSR()). Once the DDDG
+// optimisations are done, the boost edges are released and the snapshot is the only copy of the DDDG edges (see
+// BaseDatapath::releaseDDDGEdges()).
+class CSRGraph {
+public:
+	typedef struct {
+		unsigned node;
+		uint8_t weight;
+	} edgeRefTy;
+
+private:
+	unsigned numNodes;
+	std::vector<unsigned> outOffsets;
+	std::vector<edgeRefTy> outEdges;
+	std::vector<unsigned> inOffsets;
+	std::vector<edgeRefTy> inEdges;
+	// Node IDs sorted topologically (parents before their children)
+	std::vector<unsigned> topologicalOrder;
+
+public:
+	CSRGraph() : numNodes(0) { }
+
+	void build(const Graph &graph, const VertexNameMap &vertexToName);
+	void clear();
+
+	unsigned getNumNodes() const { return numNodes; }
+	unsigned getNumEdges() const { return outEdges.size(); }
+	const std::vector<unsigned> &getTopologicalOrder() const { return topologicalOrder; }
+
+	unsigned outDegree(unsigned nodeID) const { return outOffsets[nodeID + 1] - outOffsets[nodeID]; }
+	unsigned inDegree(unsigned nodeID) const { return inOffsets[nodeID + 1] - inOffsets[nodeID]; }
+	unsigned degree(unsigned nodeID) const { return outDegree(nodeID) + inDegree(nodeID); }
+
+	// Edges are iterated as [begin, end) ranges. For out-edges, "node" is the child; for in-edges, the parent
+	const edgeRefTy *outBegin(unsigned nodeID) const { return outEdges.data() + outOffsets[nodeID]; }
+	const edgeRefTy *outEnd(unsigned nodeID) const { return outEdges.data() + outOffsets[nodeID + 1]; }
+	const edgeRefTy *inBegin(unsigned nodeID) const { return inEdges.data() + inOffsets[nodeID]; }
+	const edgeRefTy *inEnd(unsigned nodeID) const { return inEdges.data() + inOffsets[nodeID + 1]; }
+};
+
+#endif
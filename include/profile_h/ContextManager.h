@@ -2,12 +2,19 @@
 #define __CONTEXTMANAGER_H__
 
 #include <boost/functional/hash.hpp>
+#include <map>
+#include <tuple>
 
 #include "profile_h/auxiliary.h"
 #include "profile_h/DDDGBuilder.h"
 
 #define FILE_CONTEXT_MANAGER "context.dat"
-#define FILE_CONTEXT_MANAGER_MAGIC_STRING "!Bc"
+// The magic string identifies the layout of all records. It must be changed whenever the layout of any record changes
+#define FILE_CONTEXT_MANAGER_MAGIC_STRING "!Bf"
+// Prefix shared by the magic strings of all versions. Files with another magic string of the same prefix were written
+// with other record layouts (e.g. parsed trace containers saved as symbol dumps, DDDGs without carried edges, no TOC)
+// and are not read
+#define FILE_CONTEXT_MANAGER_MAGIC_PREFIX "!B"
 
 class BaseDatapath;
 struct ddrInfoTy;
@@ -15,6 +22,18 @@ struct globalOutBurstsInfoTy;
 struct packInfoTy;
 struct outBurstInfoTy;
 
+// Context file
+// ------------
+// The context file is a sequence of records, each starting with its type (1 byte). Records with variable length are
+// followed by their length (size_t), and may be identified by a name and a code (e.g. DDDGs of each loop). When the
+// file is closed after writing, a table of contents record is appended as a footer:
+//
+//	TOC: type (1 byte), length (size_t), no. of entries (uint64), for each entry: record type (1 byte),
+//	     identifier length (size_t), identifier, code (uint64), record offset (uint64), record size (uint64),
+//	     and finally the offset of the TOC record itself (uint64), which are the last 8 bytes of the file
+//
+// The file is memory-mapped for reading and records are found straight from the TOC, instead of scanning the whole
+// file at each request. Files that were not closed properly have no TOC and are scanned instead.
 class ContextManager {
 	enum {
 		TYPE_EOF = 0,
@@ -25,6 +44,8 @@ class ContextManager {
 		TYPE_GLOBAL_OUTBURSTS_INFO = 5,
 		TYPE_GLOBAL_DDR_MAP = 6,
 		TYPE_GLOBAL_PACK_INFO = 7,
+		TYPE_CACHE_KEY = 8,
+		TYPE_TOC = 9,
 	};
 
 	struct cfd_t {
@@ -35,12 +56,25 @@ class ContextManager {
 	// XXX: You can find the definitions at lib/Build_DDDG/ContextManager.cpp
 	static const std::unordered_map<int, cfd_t> typeMap;
 
+	// (record type, identifier, code) to (record offset, record size)
+	typedef std::tuple<char, std::string, uint64_t> tocKeyTy;
+	typedef std::map<tocKeyTy, std::pair<uint64_t, uint64_t>> tocTy;
+
 	std::string fileName;
 	std::fstream contextFile;
 	bool readOnly;
+	tocTy toc;
+	bool hasTOC;
+	const char *mapping;
+	size_t mappingSize;
+	const char *readCursor;
 
 	bool seekTo(int type);
 	bool seekToIdentified(int type, std::string ID, uint64_t optID2 = 0);
+	void writeTOC();
+	bool readTOC();
+	void readBytes(char *buffer, size_t size);
+	void skipBytes(size_t size);
 	void realign();
 	template<typename T> size_t writeElement(std::stringstream &ss, T &elem);
 	template<typename E> size_t writeElement(std::stringstream &ss, std::vector<E> &elem);
@@ -51,20 +85,21 @@ class ContextManager {
 	template<typename K, typename L, typename E> size_t writeElement(std::stringstream &ss, std::unordered_map<std::pair<K, L>, std::vector<E>, boost::hash<std::pair<K, L>>> &elem);
 	template<typename K, typename E, typename F> size_t writeElement(std::stringstream &ss, std::unordered_map<K, std::pair<E, F>> &elem);
 	template<typename K, typename E> size_t writeElement(std::stringstream &ss, std::unordered_multimap<K, E> &elem);
-	template<typename T> void readElement(std::fstream &fs, T &elem);
-	template<typename E> void readElement(std::fstream &fs, std::vector<E> &elem);
-	template<typename E> void readElement(std::fstream &fs, std::set<E> &elem);
-	template<typename K, typename E> void readElement(std::fstream &fs, std::map<K, E> &elem);
-	template<typename K, typename E> void readElement(std::fstream &fs, std::unordered_map<K, E> &elem);
-	template<typename K, typename E> void readElement(std::fstream &fs, std::unordered_map<K, std::vector<E>> &elem);
-	template<typename K, typename L, typename E> void readElement(std::fstream &fs, std::unordered_map<std::pair<K, L>, std::vector<E>, boost::hash<std::pair<K, L>>> &elem);
-	template<typename K, typename E, typename F> void readElement(std::fstream &fs, std::unordered_map<K, std::pair<E, F>> &elem);
-	template<typename T> void skipElement(std::fstream &fs);
+	template<typename T> void readElement(T &elem);
+	template<typename E> void readElement(std::vector<E> &elem);
+	template<typename E> void readElement(std::set<E> &elem);
+	template<typename K, typename E> void readElement(std::map<K, E> &elem);
+	template<typename K, typename E> void readElement(std::unordered_map<K, E> &elem);
+	template<typename K, typename E> void readElement(std::unordered_map<K, std::vector<E>> &elem);
+	template<typename K, typename L, typename E> void readElement(std::unordered_map<std::pair<K, L>, std::vector<E>, boost::hash<std::pair<K, L>>> &elem);
+	template<typename K, typename E, typename F> void readElement(std::unordered_map<K, std::pair<E, F>> &elem);
+	template<typename T> void skipElement();
 	void commit(char elemType, std::stringstream &ss, size_t totalFieldSize, std::string optID = "", uint64_t optID2 = 0);
 	void commit(char elemType, std::stringstream &ss);
 
 public:
 	ContextManager();
+	ContextManager(std::string fileName);
 	~ContextManager();
 
 	void openForWrite();
@@ -86,6 +121,8 @@ public:
 	void getGlobalDDRMap(std::unordered_map<std::string, std::vector<ddrInfoTy>> *globalDDRMap);
 	void saveGlobalPackInfo(std::unordered_map<arrayPackSzPairTy, std::vector<packInfoTy>, boost::hash<arrayPackSzPairTy>> &globalPackInfo);
 	void getGlobalPackInfo(std::unordered_map<arrayPackSzPairTy, std::vector<packInfoTy>, boost::hash<arrayPackSzPairTy>> *globalPackInfo);
+	void saveCacheKey(std::string &key);
+	void getCacheKey(std::string *key);
 
 #ifdef DBG_PRINT_ALL
 	void printDatabase();
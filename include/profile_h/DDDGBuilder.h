@@ -1,6 +1,8 @@
 #ifndef __DDDGBUILDER_H__
 #define __DDDGBUILDER_H__
 
+#include <algorithm>
+#include <assert.h>
 #include <fstream>
 #include <map>
 #include <set>
@@ -9,13 +11,18 @@
 #include <stdlib.h>
 #include <string>
 #include <unordered_map>
+#include <vector>
 #include <zlib.h>
 
 #include "profile_h/auxiliary.h"
 #include "profile_h/opcodes.h"
+#include "profile_h/SymbolTable.h"
+#include "profile_h/TraceReader.h"
 
 #ifdef FUTURE_CACHE
 #define FILE_FUTURE_CACHE "futurecache.db"
+// Cursors from binary and textual traces are not interchangeable, so they are cached separately
+#define FILE_FUTURE_CACHE_BIN "futurecache_bin.db"
 #define FILE_FUTURE_CACHE_MAGIC_STRING "!BU"
 
 class FutureCache {
@@ -80,7 +87,7 @@ extern lpNameLevelPair2headBBnameMapTy lpNameLevelPair2headBBnameMap;
 extern lpNameLevelPair2headBBnameMapTy lpNameLevelPair2exitingBBnameMap;
 
 typedef std::map<std::string, std::vector<unsigned> > loopName2levelUnrollVecMapTy;
-extern loopName2levelUnrollVecMapTy loopName2levelUnrollVecMap;
+extern thread_local loopName2levelUnrollVecMapTy loopName2levelUnrollVecMap;
 
 typedef std::map<std::pair<std::string, std::string>, unsigned> funcBBNmPair2numInstInBBMapTy;
 extern funcBBNmPair2numInstInBBMapTy funcBBNmPair2numInstInBBMap;
@@ -101,8 +108,21 @@ struct edgeNodeInfo {
 
 typedef std::unordered_multimap<unsigned, edgeNodeInfo> u2eMMap;
 
+// Dependency from a DDDG node to a node of the iteration after the last one of the DDDG (see
+// DDDGBuilder::parseTraceFile()). The sink is the DDDG node that executes the same instruction in the last iteration,
+// and distance is the number of iterations between the source and the actual sink
+struct carriedEdgeTy {
+	unsigned source;
+	unsigned sink;
+	unsigned distance;
+};
+
 typedef std::unordered_map<int64_t, unsigned> i642uMap;
 
+typedef std::unordered_map<uint64_t, unsigned> u642uMap;
+
+typedef std::unordered_map<uint32_t, unsigned> u322uMap;
+
 // TODO: The typedef is here but variable is declared at InstrumentForDDDGPass
 // But the idea is to bring the generation of this map here, to the getTraceLineFromTo
 // To save gzip processing twice (memory trace and DDDG generation)
@@ -111,114 +131,201 @@ typedef std::map<std::pair<std::string, std::string>, std::vector<uint64_t>> mem
 
 class BaseDatapath;
 
+// Column of the parsed trace container holding values only for some nodes (e.g. memory operations). Elements are
+// (node ID, value) pairs sorted by node ID, nodes are appended in order thus insertion is usually a push_back()
+template<typename T> class SparseColumn {
+	std::vector<std::pair<int, T>> elems;
+
+public:
+	typedef typename std::vector<std::pair<int, T>>::const_iterator const_iterator;
+
+	// Same semantics as unordered_map::insert(): an existing key is not overwritten
+	void insert(int key, const T &value) {
+		if(elems.empty() || elems.back().first < key) {
+			elems.push_back(std::make_pair(key, value));
+			return;
+		}
+
+		typename std::vector<std::pair<int, T>>::iterator it = std::lower_bound(elems.begin(), elems.end(), key,
+			[](const std::pair<int, T> &elem, int key) { return elem.first < key; }
+		);
+		if(it == elems.end() || it->first != key)
+			elems.insert(it, std::make_pair(key, value));
+	}
+
+	const_iterator find(int key) const {
+		const_iterator it = std::lower_bound(elems.begin(), elems.end(), key,
+			[](const std::pair<int, T> &elem, int key) { return elem.first < key; }
+		);
+
+		return (it != elems.end() && it->first == key)? it : elems.end();
+	}
+
+	const T &at(int key) const {
+		const_iterator it = find(key);
+		assert(it != elems.end() && "Node not found in parsed trace column");
+		return it->second;
+	}
+
+	const_iterator begin() const { return elems.begin(); }
+	const_iterator end() const { return elems.end(); }
+	size_t size() const { return elems.size(); }
+	void clear() { std::vector<std::pair<int, T>>().swap(elems); }
+};
+
+// (Node ID -> (address, size in bits)) of load/store operations
+typedef SparseColumn<std::pair<int64_t, unsigned>> memoryTraceColumnTy;
+// (Node ID -> (array name, address)) of getelementptr operations. Array names are IDs from symbolTable
+typedef SparseColumn<std::pair<uint32_t, int64_t>> getElementPtrColumnTy;
+// (Node ID -> result size in bits)
+typedef SparseColumn<unsigned> resultSizeColumnTy;
+
+// Parsed dynamic trace of a datapath, stored as columns. Columns indexed by node ID are dense vectors, the others
+// are sparse columns. Function, instruction and basic block names are IDs from symbolTable.
+//
+// In compressed mode (i.e. "--compressed"), pack() deflates each column in memory separately. A column is inflated back
+// when it is requested by a getter or appended to, and it stays inflated after it was handed out by a getter
 class ParsedTraceContainer {
+	enum {
+		COLUMN_FUNC,
+		COLUMN_INSTID,
+		COLUMN_LINENO,
+		COLUMN_MEMORYTRACE,
+		COLUMN_GETELEMENTPTR,
+		COLUMN_PREVBB,
+		COLUMN_CURRBB,
+		COLUMN_RESULTSIZE,
+		NUM_COLUMNS
+	};
+
+	typedef struct {
+		// Deflated column (empty if not packed)
+		std::vector<Bytef> data;
+		size_t rawSize;
+		// Handed out by a getter, thus not packed anymore
+		bool exposed;
+	} packedColumnTy;
+
 	std::string kernelName;
 
-	std::string funcFileName;
-	std::string instIDFileName;
-	std::string lineNoFileName;
-	std::string memoryTraceFileName;
-	std::string getElementPtrFileName;
-	std::string prevBasicBlockFileName;
-	std::string currBasicBlockFileName;
-	std::string resultSizeFileName;
-
-	gzFile funcFile;
-	gzFile instIDFile;
-	gzFile lineNoFile;
-	gzFile memoryTraceFile;
-	gzFile getElementPtrFile;
-	gzFile prevBasicBlockFile;
-	gzFile currBasicBlockFile;
-	gzFile resultSizeFile;
-
-	std::vector<std::string> funcList;
-	std::vector<std::string> instIDList;
+	std::vector<uint32_t> funcList;
+	std::vector<uint32_t> instIDList;
 	std::vector<int> lineNoList;
-	std::unordered_map<int, std::pair<int64_t, unsigned>> memoryTraceList;
-	std::unordered_map<int, std::pair<std::string, int64_t>> getElementPtrList;
-	std::vector<std::string> prevBasicBlockList;
-	std::vector<std::string> currBasicBlockList;
-	std::unordered_map<int, unsigned> resultSizeList;
+	memoryTraceColumnTy memoryTraceList;
+	getElementPtrColumnTy getElementPtrList;
+	std::vector<uint32_t> prevBasicBlockList;
+	std::vector<uint32_t> currBasicBlockList;
+	resultSizeColumnTy resultSizeList;
 
+	packedColumnTy packedColumns[NUM_COLUMNS];
 	bool compressed;
-	bool keepAliveRead;
-	bool keepAliveWrite;
 	bool locked;
 
+	template<typename C> void packColumn(unsigned column, C &elems);
+	template<typename C> C &unpackColumn(unsigned column, C &elems);
+	template<typename C> C &exposeColumn(unsigned column, C &elems);
+
 public:
 	ParsedTraceContainer(std::string kernelName);
-	~ParsedTraceContainer();
 
-	void openAndClearAllFiles();
-	void openAllFilesForWrite();
-	void openAllFilesForRead();
-	void closeAllFiles();
+	// Remove all elements
+	void clear();
+	// Deflate the columns that were not handed out by a getter (compressed mode only)
+	void pack();
 	void lock();
 	void unlock();
 	std::string getKernelName() { return kernelName; }
 
-	void appendToFuncList(std::string elem);
-	void appendToInstIDList(std::string elem);
+	// Serialise all columns into a buffer and back (see ContextManager). Symbol IDs are only valid within one
+	// execution, thus names are stored instead
+	void serialise(std::string &buffer);
+	void deserialise(const char *buffer, size_t size);
+
+	void appendToFuncList(uint32_t elem);
+	void appendToInstIDList(uint32_t elem);
 	void appendToLineNoList(int elem);
 	void appendToMemoryTraceList(int key, int64_t elem, unsigned elem2);
 	void appendToGetElementPtrList(int key, std::string elem, int64_t elem2);
-	void appendToPrevBBList(std::string elem);
-	void appendToCurrBBList(std::string elem);
+	void appendToPrevBBList(uint32_t elem);
+	void appendToCurrBBList(uint32_t elem);
 	void appendToResultSizeList(int key, unsigned elem);
 
-	const std::vector<std::string> &getFuncList();
-	const std::vector<std::string> &getInstIDList();
+	const std::vector<uint32_t> &getFuncList();
+	const std::vector<uint32_t> &getInstIDList();
 	const std::vector<int> &getLineNoList();
-	const std::unordered_map<int, std::pair<int64_t, unsigned>> &getMemoryTraceList();
-	const std::unordered_map<int, std::pair<std::string, int64_t>> &getGetElementPtrList();
-	const std::vector<std::string> &getPrevBBList();
-	const std::vector<std::string> &getCurrBBList();
-	const std::unordered_map<int, unsigned> &getResultSizeList();
+	const memoryTraceColumnTy &getMemoryTraceList();
+	const getElementPtrColumnTy &getGetElementPtrList();
+	const std::vector<uint32_t> &getPrevBBList();
+	const std::vector<uint32_t> &getCurrBBList();
+	const resultSizeColumnTy &getResultSizeList();
 };
 
 class DDDGBuilder {
 	BaseDatapath *datapath;
 	ParsedTraceContainer &PC;
 
-	std::string rest;
 	uint8_t prevMicroop, currMicroop;
-	std::string currInstID;
-	std::string currDynamicFunction;
-	std::string calleeFunction;
-	std::stack<std::pair<std::string, int>> activeMethod;
-	s2uMap functionCounter;
-	std::string prevBB, currBB;
+	// Names are handled as IDs from symbolTable
+	uint32_t currInstID;
+	uint32_t currDynamicFunction;
+	uint32_t calleeFunction;
+	std::stack<std::pair<uint32_t, int>> activeMethod;
+	u322uMap functionCounter;
+	// Dynamic function IDs indexed by (static function ID, counter)
+	std::unordered_map<uint64_t, uint32_t> dynamicFunctionIDs;
+	uint32_t prevBB, currBB;
 	int numOfInstructions;
 	bool lastParameter;
 	std::vector<int64_t> parameterValuePerInst;
 	std::vector<unsigned> parameterSizePerInst;
 	std::vector<std::string> parameterLabelPerInst;
-	s2uMap registerLastWritten;
-	std::string calleeDynamicFunction;
+	// Indexed by (dynamic function ID, register ID)
+	u642uMap registerLastWritten;
+	uint32_t calleeDynamicFunction;
 	int lastCallSource;
 	u2eMMap registerEdgeTable;
 	u2eMMap memoryEdgeTable;
 	unsigned numOfRegDeps, numOfMemDeps;
 	i642uMap addressLastWritten;
 
-	intervalTy getTraceLineFromTo(gzFile &traceFile);
-	void parseTraceFile(gzFile &traceFile, intervalTy interval);
-	void parseInstructionLine();
-	void parseResult();
-	void parseForward();
-	void parseParameter(int param);
-
-	bool lookaheadIsSameLoopLevel(gzFile &traceFile, unsigned loopLevel);
+	// Loop iteration tracking, only for normal loops whose datapath uses it (iterationEndInst is NO_SYMBOL otherwise). An
+	// iteration ends with the last instruction of the exiting BB
+	uint32_t loopFunction, loopHeaderBB, iterationEndInst;
+	unsigned currIteration;
+	std::vector<unsigned> nodeIterations;
+	// Occurrences of each instruction ID in the current iteration
+	u322uMap occurrencesInIteration;
+	// Node of the latest iteration indexed by (instruction ID, occurrence)
+	std::unordered_map<uint64_t, unsigned> identity2Node;
+	// Shadow iteration (the iteration after the last one) is parsed only to find loop-carried dependencies
+	bool shadowIteration;
+	unsigned numOfDDDGNodes;
+	int shadowCounterpart;
+	// Loop-carried sources of shadow PHI and bitcast nodes, forwarded to their readers as removePhiNodes() does
+	std::unordered_map<unsigned, std::vector<unsigned>> shadowForwards;
+	std::vector<carriedEdgeTy> carriedEdges;
+
+	uint32_t getDynamicFunctionID(uint32_t staticFunction, unsigned counter);
+	static uint64_t getUniqueRegID(uint32_t dynamicFunction, uint32_t reg) { return (((uint64_t) dynamicFunction) << 32) | reg; }
+
+	intervalTy getTraceLineFromTo(TraceReader &traceFile);
+	void parseTraceFile(TraceReader &traceFile, intervalTy interval);
+	void parseInstructionLine(const traceLineTy &line);
+	void parseResult(const traceLineTy &line);
+	void parseForward(const traceLineTy &line);
+	void parseParameter(const traceLineTy &line);
+	void insertCarriedEdge(unsigned source);
+
+	bool lookaheadIsSameLoopLevel(TraceReader &traceFile, unsigned loopLevel);
 
 	void writeDDDG();
 
 public:
 	DDDGBuilder(BaseDatapath *datapath, ParsedTraceContainer &PC);
 
-	intervalTy getTraceLineFromToBeforeNestedLoop(gzFile &traceFile);
-	intervalTy getTraceLineFromToAfterNestedLoop(gzFile &traceFile);
-	intervalTy getTraceLineFromToBetweenAfterAndBefore(gzFile &traceFile);
+	intervalTy getTraceLineFromToBeforeNestedLoop(TraceReader &traceFile);
+	intervalTy getTraceLineFromToAfterNestedLoop(TraceReader &traceFile);
+	intervalTy getTraceLineFromToBetweenAfterAndBefore(TraceReader &traceFile);
 
 	void buildInitialDDDG();
 	void buildInitialDDDG(intervalTy interval);
@@ -226,6 +333,8 @@ public:
 	unsigned getNumOfRegisterDependencies();
 	unsigned getNumOfMemoryDependencies();
 	std::pair<const u2eMMap, const u2eMMap> getEdgeTables();
+	const std::vector<unsigned> &getNodeIterations();
+	const std::vector<carriedEdgeTy> &getCarriedEdges();
 };
 
 #endif
@@ -0,0 +1,49 @@
+#ifndef __DDDGCACHE_H__
+#define __DDDGCACHE_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "profile_h/auxiliary.h"
+#include "profile_h/ContextManager.h"
+
+#define FOLDER_DDDG_CACHE "dddgcache/"
+#define FILE_DDDG_CACHE_SUFFIX ".dat"
+// Part of the key, increment when the format of the entries changes so that old entries are not used
+#define DDDG_CACHE_VERSION 2
+
+class BaseDatapath;
+
+// Persistent DDDG cache
+// ---------------------
+// The initial DDDG of a datapath (microops, edges, loop-carried dependencies and parsed trace container) only depends on the dynamic trace and on
+// the state of the trace analysis when it is built: target loop, loop level, datapath type, unroll factor, progressive
+// trace cursor and loop bounds (and whether loop iterations are tracked). Design points that only differ in e.g. array
+// partitioning or frequency build exactly the same DDDGs, thus these are saved in the input working directory and reused
+// by later executions.
+//
+// Each entry is a context file (see ContextManager) named after a hash of its key, containing: the key itself (to
+// detect hash collisions), the parsed trace container, the DDDG and the side-effects of the DDDG construction on the
+// trace analysis state (progressive trace cursor and runtime-calculated loop bounds), which are restored on a hit.
+class DDDGCache {
+	std::string wholeLoopName;
+	unsigned datapathType;
+	uint64_t unrollFactor;
+	std::string key;
+	std::string fileName;
+
+public:
+	// The key is constructed from the current trace analysis state, thus this must be called before building the DDDG.
+	// DDDGs built with and without loop iteration tracking (see BaseDatapath::tracksLoopIterations()) are different entries
+	DDDGCache(std::string wholeLoopName, unsigned datapathType, uint64_t unrollFactor, bool loopIterations);
+	// Key identifying the DDDG that would be built now (also used by ScheduledDatapathState)
+	static std::string constructKey(std::string wholeLoopName, unsigned datapathType, uint64_t unrollFactor);
+
+	// Recover DDDG and parsed trace container from cache. Returns false if there is no entry for this key
+	bool load(BaseDatapath *datapath, ParsedTraceContainer *PC);
+	// Save a freshly built DDDG. Must be called right after the DDDG construction
+	void save(DDDGBuilder &builder, ParsedTraceContainer &PC, std::vector<int> &microops);
+};
+
+#endif
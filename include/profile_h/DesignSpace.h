@@ -0,0 +1,103 @@
+#ifndef __DESIGNSPACE_H__
+#define __DESIGNSPACE_H__
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#define FILE_DSE_RESULTS "dse_results.csv"
+#define FILE_DSE_CFG_PREFIX "dse_"
+
+// Design space for "--dse"
+// ------------------------
+// The space file has shared directives (any configuration line) and options ("option,DIMENSION,DIRECTIVES", where
+// DIRECTIVES are configuration lines separated by ";", or "none"). Each design point takes one option of each
+// dimension, and the space is the cartesian product of all dimensions.
+//
+// Dimensions whose options only partition arrays are partitioning dimensions. Points that take the same options on all
+// other dimensions (i.e. same DDDGs and latencies) form a group. Within a group, a point is at least as partitioned as
+// another if every array has at least as many partitions of the same type (complete partitioning is above all others).
+// Assuming that more partitions never increase the cycle count, the cycles of a more partitioned point in the same
+// group are a lower bound for the less partitioned ones. Memory resources are exact for each point, and the functional
+// units floor (see estimatedResourcesTy) is the same for a whole group.
+class DesignSpace {
+public:
+	struct objectivesTy {
+		uint64_t cycles;
+		uint64_t dsp;
+		uint64_t ff;
+		uint64_t lut;
+		uint64_t bram18k;
+
+		objectivesTy() : cycles(0), dsp(0), ff(0), lut(0), bram18k(0) { }
+		// True if no objective of this is larger than the same objective of other
+		bool isCovering(const objectivesTy &other) const;
+	};
+
+	struct pointTy {
+		enum {
+			POINT_PENDING,
+			POINT_EVALUATED,
+			POINT_PRUNED
+		};
+
+		std::string name;
+		std::string cfgFileName;
+		// Option taken on each dimension
+		std::vector<unsigned> options;
+		unsigned status;
+		// Estimated objectives when evaluated, lower bounds when pruned
+		objectivesTy objectives;
+	};
+
+private:
+	// Array name to partitioning type and factor (see ConfigurationManager::partitionCfgTy)
+	typedef std::map<std::string, std::pair<unsigned, uint64_t>> partitioningTy;
+
+	std::vector<std::string> sharedDirectives;
+	std::vector<std::string> dimensions;
+	std::vector<std::vector<std::vector<std::string>>> options;
+	// Partitioning of each option, empty for dimensions that are not partitioning dimensions
+	std::vector<std::vector<partitioningTy>> partitionings;
+
+	std::vector<pointTy> points;
+	std::vector<unsigned> pointGroup;
+	std::vector<uint64_t> pointRank;
+	std::vector<objectivesTy> pointMemory;
+	std::map<std::string, unsigned> groupKeyToID;
+	std::vector<objectivesTy> groupFloor;
+	std::vector<unsigned> front;
+
+	static bool parsePartitioning(const std::string &directive, partitioningTy &partitioning);
+	static bool isPartitionedLessOrEqual(const partitioningTy &first, const partitioningTy &second);
+	bool isPartitionedLessOrEqual(unsigned first, unsigned second) const;
+
+public:
+	DesignSpace(std::string spaceFileName);
+
+	// Write the configuration file of each point, named after prefix and the point name
+	void writeConfigurationFiles(std::string prefix);
+	unsigned size() const { return points.size(); }
+	const pointTy &getPoint(unsigned pointID) const { return points.at(pointID); }
+
+	// Information known from the configuration alone, must be set for all points before getEvaluationOrder().
+	// Points are only compared to points with the same key suffix (e.g. settings changed by the configuration parser)
+	void setPointInfo(unsigned pointID, std::string groupKeySuffix, uint64_t memBRAM18k, uint64_t memFF, uint64_t memLUT);
+	// First point of each group (the most partitioned), followed by the remaining points of each group from the
+	// most to the least partitioned. Thus all points that may bound a point are handled before it
+	std::vector<unsigned> getEvaluationOrder() const;
+
+	objectivesTy getLowerBound(unsigned pointID) const;
+	// True if a point in the Pareto front is not worse than objectives on any objective
+	bool isDominated(const objectivesTy &objectives) const;
+	void setPruned(unsigned pointID, const objectivesTy &bound);
+	// The floor only uses DSP, FF and LUT (see estimatedResourcesTy), memory logic is not included
+	void setEvaluated(unsigned pointID, const objectivesTy &objectives, const objectivesTy &floor);
+	const std::vector<unsigned> &getFront() const { return front; }
+
+	void dumpResults(std::string fileName) const;
+};
+
+#endif
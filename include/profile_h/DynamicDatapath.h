@@ -1,6 +1,7 @@
 #ifndef DYNAMIC_DATAPATH_H
 #define DYNAMIC_DATAPATH_H
 
+#include <functional>
 #include <string>
 #include "profile_h/lin-profile.h"
 #include "profile_h/BaseDatapath.h"
@@ -9,34 +10,36 @@ using namespace llvm;
 
 class DynamicDatapath : public BaseDatapath {
 	void _DynamicDatapath(
-		std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
+		std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ostream *summaryFile,
 		std::string loopName, unsigned loopLevel, uint64_t loopUnrollFactor,
 		std::vector<MemoryModel::nodeExportTy> *nodesToImport,
-		unsigned datapathType
+		unsigned datapathType, std::function<void()> *traceStateReady
 	);
 
 public:
 	DynamicDatapath(
-		std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
+		std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ostream *summaryFile,
 		std::string loopName, unsigned loopLevel, uint64_t loopUnrollFactor
 	);
 
 	DynamicDatapath(
-		std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
+		std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ostream *summaryFile,
 		std::string loopName, unsigned loopLevel, uint64_t loopUnrollFactor,
 		bool enablePipelining, uint64_t asapII
 	);
 
+	// Constructors for non-perfect loop nests. If traceStateReady is provided, it is called as soon as this datapath has
+	// finished updating the trace analysis state (progressive trace cursor and runtime loop bounds)
 	DynamicDatapath(
-		std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
+		std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ostream *summaryFile,
 		std::string loopName, unsigned loopLevel, uint64_t loopUnrollFactor,
-		unsigned datapathType
+		unsigned datapathType, std::function<void()> *traceStateReady = nullptr
 	);
 
 	DynamicDatapath(
-		std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
+		std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ostream *summaryFile,
 		std::string loopName, unsigned loopLevel, uint64_t loopUnrollFactor,
-		std::vector<MemoryModel::nodeExportTy> &nodesToImport, unsigned datapathType
+		std::vector<MemoryModel::nodeExportTy> &nodesToImport, unsigned datapathType, std::function<void()> *traceStateReady = nullptr
 	);
 
 	~DynamicDatapath();
@@ -21,10 +21,13 @@ protected:
 	std::map<std::string, std::tuple<uint64_t, uint64_t, size_t, unsigned>> arrayNameToConfig;
 	std::map<std::string, unsigned> arrayNameToNumOfPartitions;
 	std::map<std::string, float> arrayNameToEfficiency;
-	std::map<std::string, unsigned> arrayPartitionToReadPorts;
-	std::map<std::string, unsigned> arrayPartitionToReadPortsInUse;
-	std::map<std::string, unsigned> arrayPartitionToWritePorts;
-	std::map<std::string, unsigned> arrayPartitionToWritePortsInUse;
+	// Each array partition receives a dense ID when memory usage is set (see addPartition()). Port counters are
+	// indexed by this ID, the partition name is only used to find it
+	std::map<std::string, unsigned> arrayPartitionToID;
+	std::vector<unsigned> partitionReadPorts;
+	std::vector<unsigned> partitionReadPortsInUse;
+	std::vector<unsigned> partitionWritePorts;
+	std::vector<unsigned> partitionWritePortsInUse;
 	unsigned fAddCount, fSubCount, fMulCount, fDivCount;
 #ifdef CONSTRAIN_INT_OP
 	fuCountTy intOpCount;
@@ -52,6 +55,9 @@ protected:
 
 	MemoryModel *memmodel;
 
+	// If the partition already exists, its ports are kept
+	void addPartition(std::string partitionName, unsigned readPorts, unsigned writePorts);
+
 public:
 #ifdef CONSTRAIN_INT_OP
 	// XXX: You can find the definition at lib/Build_DDDG/HardwareProfileParams.cpp
@@ -71,6 +77,8 @@ public:
 	HardwareProfile();
 	virtual ~HardwareProfile() { }
 	static HardwareProfile *createInstance();
+	// Copy of this profile in its current state (memory model is shared)
+	virtual HardwareProfile *clone() = 0;
 	void setMemoryModel(MemoryModel *memmodel);
 	virtual void clear();
 
@@ -111,12 +119,15 @@ public:
 #endif
 
 	unsigned arrayGetNumOfPartitions(std::string arrayName);
+	unsigned arrayGetPartitionID(std::string partitionName);
 	unsigned arrayGetPartitionReadPorts(std::string partitionName);
 	unsigned arrayGetPartitionWritePorts(std::string partitionName);
 	const std::map<std::string, std::tuple<uint64_t, uint64_t, size_t, unsigned>> &arrayGetConfig() { return arrayNameToConfig; }
 	const std::map<std::string, unsigned> &arrayGetNumOfPartitions() { return arrayNameToNumOfPartitions; }
 	const std::map<std::string, float> &arrayGetEfficiency() { return arrayNameToEfficiency; }
 	virtual unsigned arrayGetMaximumWritePortsPerPartition() = 0;
+	// BRAM18k, FFs and LUTs used by the on-chip arrays, as set by setMemoryCurrentUsage()
+	virtual std::tuple<unsigned, unsigned, unsigned> resourcesGetMemory() = 0;
 	unsigned fAddGetAmount() { return fAddCount; }
 	unsigned fSubGetAmount() { return fSubCount; }
 	unsigned fMulGetAmount() { return fMulCount; }
@@ -130,8 +141,8 @@ public:
 	bool fMulTryAllocate(bool commit = true);
 	bool fDivTryAllocate(bool commit = true);
 	bool fCmpTryAllocate(bool commit = true);
-	bool loadTryAllocate(std::string arrayPartitionName, bool commit = true);
-	bool storeTryAllocate(std::string arrayPartitionName, bool commit = true);
+	bool loadTryAllocate(unsigned partitionID, bool commit = true);
+	bool storeTryAllocate(unsigned partitionID, bool commit = true);
 	bool intOpTryAllocate(int opcode, bool commit = true);
 	bool callTryAllocate(bool commit = true);
 	bool ddrOpTryAllocate(unsigned node, int opcode, bool commit = true);
@@ -142,8 +153,8 @@ public:
 	void fMulRelease();
 	void fDivRelease();
 	void fCmpRelease();
-	void loadRelease(std::string arrayPartitionName);
-	void storeRelease(std::string arrayPartitionName);
+	void loadRelease(unsigned partitionID);
+	void storeRelease(unsigned partitionID);
 	void intOpRelease(int opcode);
 	void callRelease();
 	void ddrOpRelease(unsigned node, int opcode);
@@ -270,6 +281,7 @@ public:
 	unsigned resourcesGetFFs() { return usedFF; }
 	unsigned resourcesGetLUTs() { return usedLUT; }
 	unsigned resourcesGetBRAM18k() { return usedBRAM18k; }
+	std::tuple<unsigned, unsigned, unsigned> resourcesGetMemory() { return std::make_tuple(usedBRAM18k, memLogicFF, memLogicLUT); }
 };
 
 class XilinxVC707HardwareProfile : public XilinxHardwareProfile {
@@ -281,6 +293,7 @@ class XilinxVC707HardwareProfile : public XilinxHardwareProfile {
 	};
 
 public:
+	HardwareProfile *clone() { return new XilinxVC707HardwareProfile(*this); }
 	void setResourceLimits();
 };
 
@@ -293,6 +306,7 @@ class XilinxZC702HardwareProfile : public XilinxHardwareProfile {
 	};
 
 public:
+	HardwareProfile *clone() { return new XilinxZC702HardwareProfile(*this); }
 	void setResourceLimits();
 };
 
@@ -324,6 +338,7 @@ class XilinxZCU102HardwareProfile : public XilinxZCUHardwareProfile {
 
 public:
 	XilinxZCU102HardwareProfile() { }
+	HardwareProfile *clone() { return new XilinxZCU102HardwareProfile(*this); }
 	void setResourceLimits();
 };
 
@@ -338,6 +353,7 @@ class XilinxZCU104HardwareProfile : public XilinxZCUHardwareProfile {
 
 public:
 	XilinxZCU104HardwareProfile() { }
+	HardwareProfile *clone() { return new XilinxZCU104HardwareProfile(*this); }
 	void setResourceLimits();
 };
 
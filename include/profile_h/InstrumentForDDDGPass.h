@@ -35,14 +35,40 @@
 #include "profile_h/Passes.h"
 #include "profile_h/SlotTracker.h"
 #include "profile_h/TraceFunctions.h"
+#include "profile_h/TraceIntervalPlan.h"
 #include "profile_h/auxiliary.h"
 
 #define RESULT_LINE 19134
 #define FORWARD_LINE 24601
 
-extern std::unordered_map<std::string, std::vector<ddrInfoTy>> globalDDRMap;
-extern std::unordered_map<std::string, std::vector<globalOutBurstsInfoTy>> globalOutBurstsInfo;
-extern std::unordered_map<arrayPackSzPairTy, std::vector<packInfoTy>, boost::hash<arrayPackSzPairTy>> globalPackInfo;
+extern thread_local std::unordered_map<std::string, std::vector<ddrInfoTy>> globalDDRMap;
+extern thread_local std::unordered_map<std::string, std::vector<globalOutBurstsInfoTy>> globalOutBurstsInfo;
+extern thread_local std::unordered_map<arrayPackSzPairTy, std::vector<packInfoTy>, boost::hash<arrayPackSzPairTy>> globalPackInfo;
+
+// State of one cycle estimation (i.e. one design point)
+// Everything that is modified during an estimation is either here or in thread_local globals, which are
+// (re)initialised by install(). The static analysis databases, the memory trace and the dynamic trace are
+// only read, thus several RunContexts can be estimated in parallel as long as each has its own thread
+class RunContext {
+	ArgPack initialArgs;
+	wholeloopName2loopBoundMapTy initialLoopBoundMap;
+
+public:
+	// Name of the design point being estimated when running with "--batch" or "--dse" (empty otherwise)
+	std::string pointName;
+	std::string contextFileName;
+	std::vector<std::string> pipelineLoopLevelVec;
+	std::ofstream summaryFile;
+	// Estimated cycles for each target loop, filled by loopBasedTraceAnalysis()
+	std::vector<std::pair<std::string, uint64_t>> estimatedCycles;
+	// Estimated resources for each target loop, in the same order as estimatedCycles
+	std::vector<std::pair<std::string, estimatedResourcesTy>> estimatedResources;
+
+	RunContext(const ArgPack &args, const wholeloopName2loopBoundMapTy &loopBounds, std::string pointName = "");
+
+	// Initialise the per-run globals of the calling thread with this context
+	void install();
+};
 
 namespace llvm {
 
@@ -87,9 +113,6 @@ class InstrumentForDDDG : public ModulePass {
 #endif
 	};
 
-	std::vector<std::string> pipelineLoopLevelVec;
-	std::ofstream summaryFile;
-
 	int shouldTrace(std::string call);
 
 #ifdef DBG_PRINT_ALL
@@ -112,10 +135,12 @@ public:
 
 	void updateUnrollingDatabase(const std::vector<ConfigurationManager::unrollingCfgTy> &unrollingCfg);
 
-	void loopBasedTraceAnalysis();
+	void loopBasedTraceAnalysis(RunContext &ctx);
+	void batchTraceAnalysis();
+	void dseTraceAnalysis();
 
-	void openSummaryFile(std::string kernelName);
-	void closeSummaryFile();
+	void openSummaryFile(RunContext &ctx, std::string kernelName);
+	void closeSummaryFile(RunContext &ctx);
 };
 
 // Embedded Profiler Engine
@@ -0,0 +1,95 @@
+#ifndef __LOOPTRIPCOUNTS_H__
+#define __LOOPTRIPCOUNTS_H__
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// Loop trip counts
+// ----------------
+// While the dynamic trace is generated, every execution of the last instruction of a loop header (the same instructions
+// counted by the runtime loop bound calculation, see DDDGBuilder::getTraceLineFromTo()) is accounted to its loop. A
+// header execution starts a new dynamic entry of the loop if the previous branch executed in the same function was
+// outside of this loop, otherwise it is one more trip of the current entry. Loops are identified by name and level.
+//
+// The counts are saved in a sidecar file (loop_trip_counts.txt) when tracing finishes, so that runtime loop bounds
+// can be read from it instead of scanning the whole trace for header executions. Each line has:
+//
+//	WHOLELOOPNAME,HEADER EXECUTIONS,ENTRIES,MIN,MAX,HISTOGRAM
+//
+// where MIN and MAX are the smallest and largest trip counts of a dynamic entry and HISTOGRAM is a ";"-separated list
+// of TRIPCOUNT:ENTRIES. Trip counts are given in header executions, as in the runtime loop bound calculation
+class LoopTripCounts {
+public:
+	typedef struct {
+		uint64_t headerExecutions;
+		uint64_t entries;
+		uint64_t min;
+		uint64_t max;
+		std::map<uint64_t, uint64_t> histogram;
+	} loopTy;
+
+private:
+	std::map<std::string, loopTy> loops;
+
+public:
+	void addLoop(std::string wholeLoopName, const loopTy &loop) { loops[wholeLoopName] = loop; }
+	const std::map<std::string, loopTy> &getLoops() { return loops; }
+
+	bool load(std::string fileName);
+	void save(std::string fileName);
+};
+
+// Counts loop trip counts while the trace is generated, see LoopTripCounts
+class LoopTripCounter {
+	typedef struct {
+		unsigned funcID;
+		// Innermost loop of this BB (-1 if none) and its level
+		int loopID;
+		unsigned loopLevel;
+		// Slot of the loop if this is the last instruction of its header, -1 otherwise
+		int headerSlot;
+	} siteTy;
+
+	typedef struct {
+		std::string wholeLoopName;
+		int loopID;
+		unsigned loopLevel;
+		// Header executions of the dynamic entry being counted
+		uint64_t currentTrips;
+		LoopTripCounts::loopTy counts;
+	} slotTy;
+
+	const std::map<std::pair<std::string, std::string>, std::pair<std::string, unsigned>> &bbLoops;
+	std::unordered_map<std::string, int> lastInst2Slot;
+	std::unordered_map<std::string, unsigned> funcName2ID;
+	std::unordered_map<std::string, int> loopName2ID;
+	std::unordered_map<const char *, siteTy> pointer2Site;
+	std::vector<slotTy> slots;
+	// Last branch site executed in each function
+	std::vector<const siteTy *> lastBranch;
+
+	const siteTy &getSite(const char *funcName, const char *bbName, const char *instName);
+	int getLoopID(std::string loopName);
+	void closeEntry(slotTy &slot);
+
+public:
+	// headerBBs maps each loop (name, level) to its header BB, headerLastInsts maps each loop header (BB name, function
+	// name) to the ID of its last instruction and bbLoops maps each BB (BB name, function name) to its innermost loop
+	LoopTripCounter(
+		const std::map<std::pair<std::string, std::string>, std::string> &headerBBs,
+		const std::map<std::pair<std::string, std::string>, std::string> &headerLastInsts,
+		const std::map<std::pair<std::string, std::string>, std::pair<std::string, unsigned>> &bbLoops
+	);
+
+	// Account for one execution of a branch instruction (any terminator that transfers control inside the function)
+	// XXX: Sites are cached by pointer. Only use it with the constant globals created by the instrumentation pass
+	void hitBranch(const char *funcName, const char *bbName, const char *instName);
+
+	void close(std::string fileName);
+};
+
+#endif
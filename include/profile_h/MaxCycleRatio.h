@@ -0,0 +1,43 @@
+#ifndef __MAXCYCLERATIO_H__
+#define __MAXCYCLERATIO_H__
+
+#include <stdint.h>
+#include <vector>
+
+// Maximum cycle ratio solver (Howard's policy iteration)
+// ------------------------------------------------------
+// Each edge has a weight (i.e. latency of its source) and a distance (i.e. number of loop iterations that it crosses).
+// The ratio of a cycle is its total weight divided by its total distance, and the maximum ratio among all cycles is the
+// recurrence-constrained latency of one loop iteration (see BaseDatapath::calculateRecIIFromCycleRatio()).
+//
+// Each node follows one out-edge (the policy). The policy graph is evaluated (ratio of the cycle that each node reaches
+// and its value relative to that cycle), then the policy is improved by switching to edges that reach larger ratios or
+// larger values. When no edge improves, the largest ratio of the policy graph is the maximum cycle ratio
+class MaxCycleRatio {
+	typedef struct {
+		unsigned source;
+		unsigned target;
+		uint64_t weight;
+		uint64_t distance;
+	} edgeTy;
+
+	unsigned numOfNodes;
+	std::vector<edgeTy> edges;
+
+public:
+	enum {
+		NO_CYCLE = 0,
+		CYCLE_FOUND = 1,
+		// The graph has a cycle with no distance, thus its ratio is unbounded
+		ZERO_DISTANCE_CYCLE = 2
+	};
+
+	MaxCycleRatio(unsigned numOfNodes) : numOfNodes(numOfNodes) { }
+
+	void addEdge(unsigned source, unsigned target, uint64_t weight, uint64_t distance);
+
+	// Solve the graph. When a cycle is found, its total weight and distance are returned
+	int solve(uint64_t &weight, uint64_t &distance);
+};
+
+#endif
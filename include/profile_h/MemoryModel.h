@@ -5,6 +5,7 @@
 #include "profile_h/boostincls.h"
 #include "profile_h/ContextManager.h"
 #include "profile_h/DDDGBuilder.h"
+#include "profile_h/MemoryTrace.h"
 
 #define FILE_MEM_ANALYSIS_RPT_SUFFIX "_memanalysis.rpt"
 
@@ -62,8 +63,8 @@ class BaseDatapath;
 
 class Reporter {
 	static const std::string warnReasonMap[];
-	static std::ofstream rptFile;
-	static std::string loopName;
+	static thread_local std::ofstream rptFile;
+	static thread_local std::string loopName;
 	unsigned loopLevel;
 	unsigned datapathType;
 	ParsedTraceContainer *PC;
@@ -160,10 +161,10 @@ struct packInfoTy {
 
 class MemoryModel {
 protected:
-	static std::string preprocessedLoopName;
-	static bool shouldRpt;
-	static std::ofstream rptFile;
-	static Reporter reporter;
+	static thread_local std::string preprocessedLoopName;
+	static thread_local bool shouldRpt;
+	static thread_local std::ofstream rptFile;
+	static thread_local Reporter reporter;
 	BaseDatapath *datapath;
 	std::vector<int> &microops;
 	Graph &graph;
@@ -173,7 +174,7 @@ protected:
 	std::unordered_map<int, std::pair<std::string, int64_t>> &baseAddress;
 	ConfigurationManager &CM;
 	ParsedTraceContainer &PC;
-	const std::unordered_map<int, std::pair<int64_t, unsigned>> &memoryTraceList;
+	const memoryTraceColumnTy &memoryTraceList;
 	std::string wholeLoopName;
 	std::vector<ddrInfoTy> filteredDDRMap;
 
@@ -220,10 +221,37 @@ public:
 #endif
 	};
 
+	// Address ranges of the active DDR transactions of one array. Each transaction is identified by its root load/store
+	// node and covers a closed address range. Overlap queries do not depend on the number of active transactions
+	class activeTransactionsTy {
+		// Root node to its address range and whether it is bursted
+		std::unordered_map<unsigned, std::tuple<uint64_t, uint64_t, bool>> ranges;
+		unsigned burstedCount;
+		// Number of active transactions covering each address. Each key starts a segment that ends at the next key,
+		// addresses before the first key are not covered and consecutive segments never have the same count
+		std::map<uint64_t, unsigned> coverage;
+
+		std::map<uint64_t, unsigned>::iterator splitCoverage(uint64_t address);
+		void mergeCoverage(std::map<uint64_t, unsigned>::iterator it);
+		void updateCoverage(uint64_t base, uint64_t end, bool increment);
+
+	public:
+		activeTransactionsTy() : burstedCount(0) { }
+
+		// Inserting an active transaction or erasing an inactive one does nothing
+		void insert(unsigned rootID, uint64_t base, uint64_t end, bool bursted);
+		void erase(unsigned rootID);
+		bool overlaps(uint64_t base, uint64_t end);
+		bool hasBursted() { return burstedCount; }
+		bool empty() { return ranges.empty(); }
+	};
+
 	MemoryModel(BaseDatapath *datapath);
 	virtual ~MemoryModel() { }
 	static MemoryModel *createInstance(BaseDatapath *datapath);
 	static bool preprocess(std::string loopName);
+	// Forget all per-run state (preprocessed loop nest, open report), so that a new design point can be estimated
+	static void reset();
 	static bool canOutBurstsOverlap(std::vector<MemoryModel::nodeExportTy> toBefore, std::vector<MemoryModel::nodeExportTy> toAfter);
 	void enableReport();
 	void finishReport();
@@ -254,10 +282,10 @@ public:
 };
 
 class XilinxZCUMemoryModel : public MemoryModel {
-	static std::vector<ddrInfoTy> filteredDDRMap;
-	static std::unordered_map<std::string, std::vector<globalOutBurstsInfoTy>>::iterator filteredOutBurstsInfo;
-	static bool ddrBanking;
-	static std::unordered_map<std::string, unsigned> packSizes;
+	static thread_local std::vector<ddrInfoTy> filteredDDRMap;
+	static thread_local std::unordered_map<std::string, std::vector<globalOutBurstsInfoTy>>::iterator filteredOutBurstsInfo;
+	static thread_local bool ddrBanking;
+	static thread_local std::unordered_map<std::string, unsigned> packSizes;
 	static void preprocess(std::string loopName, ConfigurationManager &CM);
 	static void blockInvalidOutBursts(
 		unsigned loopLevel, unsigned datapathType,
@@ -279,8 +307,10 @@ class XilinxZCUMemoryModel : public MemoryModel {
 	// This map relates DDR nodes (e.g. ReadReq, WriteReq, WriteResp) to the node ID used in burstedLoad/burstedStores
 	std::unordered_map<unsigned, unsigned> ddrNodesToRootLS;
 	std::unordered_map<std::string, bool> readActive, writeActive;
-	std::unordered_map<std::string, std::set<unsigned>> activeReads;
-	std::unordered_map<std::string, std::set<unsigned>> activeWrites;
+	std::unordered_map<std::string, activeTransactionsTy> activeReads;
+	std::unordered_map<std::string, activeTransactionsTy> activeWrites;
+	// Bursted loads indexed by their last participant, which closes the burst when read (see tryAllocate())
+	std::unordered_map<unsigned, std::vector<unsigned>> burstedLoadsByLastLoad;
 	std::set<unsigned> importedReadReqs, importedWriteReqs, importedWriteResps;
 	std::unordered_map<unsigned, burstInfoTy> importedLoads;
 	std::unordered_map<unsigned, burstInfoTy> importedStores;
@@ -304,7 +334,7 @@ class XilinxZCUMemoryModel : public MemoryModel {
 	std::unordered_map<std::string, outBurstInfoTy> findOutBursts(
 		std::unordered_map<unsigned, burstInfoTy> &burstedNodes,
 		std::unordered_map<unsigned, std::pair<std::string, uint64_t>> &foundNodes,
-		const std::vector<std::string> &instIDList,
+		const std::vector<uint32_t> &instIDList,
 		bool (XilinxZCUMemoryModel::*analyseOutBurstFeasability)(unsigned, std::string)
 	);
 	void packBursts(
@@ -320,6 +350,9 @@ public:
 
 	XilinxZCUMemoryModel(BaseDatapath *datapath);
 
+	// Construct the memory trace map from "mem_trace.txt" or "mem_trace_short.bin" (if not constructed yet)
+	static void loadMemoryTrace();
+
 	void analyseAndTransform();
 
 	bool tryAllocate(unsigned node, int opcode, bool commit = true);
@@ -0,0 +1,94 @@
+#ifndef __MEMORYTRACE_H__
+#define __MEMORYTRACE_H__
+
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+
+#include "profile_h/DDDGBuilder.h"
+
+#define MEMORY_TRACE_MAGIC_STRING "!Bm"
+// Version 1 is the original unversioned layout (sequence of key/address vector pairs), which is still read
+// into memoryTraceMap when found
+#define MEMORY_TRACE_VERSION 2
+
+// Mappable short memory trace
+// ---------------------------
+// mem_trace_short.bin holds the addresses accessed by each load/store instruction, per loop level. It is memory-mapped
+// during estimation instead of being copied into memoryTraceMap, thus lookups return spans pointing straight into the
+// mapping and concurrent Lina executions share the same page cache. File layout:
+//
+//	HEADER: magic (3 bytes), version (1 byte), reserved (uint32), no. of keys (uint64),
+//	        string pool offset (uint64), string pool size (uint64)
+//	DIRECTORY: for each key, sorted by (whole loop name, instruction name): whole loop name offset (uint32),
+//	           whole loop name length (uint32), instruction name offset (uint32), instruction name length (uint32),
+//	           address array offset (uint64), no. of addresses (uint64)
+//	STRINGS: string pool (names are not null-terminated, offsets are relative to the pool)
+//	ADDRESSES: address arrays (uint64 each), 8-byte aligned
+class MappedMemoryTrace {
+public:
+	// Read-only view of the addresses of one key, either from the mapping or from memoryTraceMap
+	class addressSpanTy {
+		const uint64_t *addresses;
+		size_t numAddresses;
+
+	public:
+		addressSpanTy() : addresses(nullptr), numAddresses(0) { }
+		addressSpanTy(const uint64_t *addresses, size_t numAddresses) : addresses(addresses), numAddresses(numAddresses) { }
+
+		size_t size() const { return numAddresses; }
+		bool empty() const { return !numAddresses; }
+		uint64_t operator[](size_t i) const { return addresses[i]; }
+		const uint64_t *begin() const { return addresses; }
+		const uint64_t *end() const { return addresses + numAddresses; }
+	};
+
+private:
+	typedef struct {
+		char magic[3];
+		uint8_t version;
+		uint32_t reserved;
+		uint64_t numKeys;
+		uint64_t stringsOffset;
+		uint64_t stringsSize;
+	} headerTy;
+
+	typedef struct {
+		uint32_t loopNameOffset;
+		uint32_t loopNameLength;
+		uint32_t instNameOffset;
+		uint32_t instNameLength;
+		uint64_t addressesOffset;
+		uint64_t numAddresses;
+	} keyTy;
+
+	const char *mapping;
+	size_t mappingSize;
+	const keyTy *keys;
+	uint64_t numKeys;
+	const char *strings;
+
+	int compare(const keyTy &key, const std::string &wholeLoopName, const std::string &instName) const;
+
+public:
+	MappedMemoryTrace() : mapping(nullptr), mappingSize(0), keys(nullptr), numKeys(0), strings(nullptr) { }
+	~MappedMemoryTrace() { close(); }
+
+	// Write the memory trace map in this format
+	static void write(FILE *file, const memoryTraceMapTy &memoryTraceMap);
+
+	// Map the file. Returns false if it does not exist or is not in this format (e.g. version 1 files)
+	bool open(std::string fileName);
+	void close();
+	bool isOpen() const { return mapping != nullptr; }
+
+	bool find(const std::string &wholeLoopName, const std::string &instName, addressSpanTy &span) const;
+	uint64_t getNumKeys() const { return numKeys; }
+	void getKey(uint64_t i, std::string &wholeLoopName, std::string &instName, addressSpanTy &span) const;
+};
+
+// XXX: This is read-only after loaded, thus it is shared among threads when running "--batch-threads"
+extern MappedMemoryTrace mappedMemoryTrace;
+
+#endif
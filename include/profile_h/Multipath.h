@@ -1,12 +1,35 @@
 #ifndef MULTIPATH_H
 #define MULTIPATH_H
 
+#include <functional>
+
 #include "profile_h/lin-profile.h"
 
 using namespace llvm;
 
+class DynamicDatapath;
+
 typedef std::unordered_map<unsigned, std::tuple<std::vector<MemoryModel::nodeExportTy>, std::vector<MemoryModel::nodeExportTy>, bool>> exportedNodesMapTy;
 
+// Copy of the per-thread trace analysis state (see RunContext). When "--f-parnpla" is set, the datapaths of a non-perfect
+// loop level are built in separate threads, and this state is handed from each datapath to the next one in the same order
+// as in a serial execution
+class TraceAnalysisState {
+	ArgPack savedArgs;
+	wholeloopName2loopBoundMapTy loopBounds;
+	loopName2levelUnrollVecMapTy levelUnrollVec;
+#ifdef PROGRESSIVE_TRACE_CURSOR
+	long int cursor;
+	uint64_t instCount;
+#endif
+
+public:
+	// Copy the state of the calling thread
+	void save();
+	// Overwrite the state of the calling thread
+	void restore() const;
+};
+
 class Multipath {
 	uint64_t numCycles;
 	std::string kernelName;
@@ -23,12 +46,21 @@ class Multipath {
 
 	std::vector<std::tuple<unsigned, unsigned, uint64_t, uint64_t>> latencies;
 	Pack P;
+	estimatedResourcesTy estimatedResources;
 
 	exportedNodesMapTy exportedNodes;
 
 	void _Multipath();
 
 	void recursiveLookup(unsigned currLoopLevel, unsigned finalLoopLevel);
+	DynamicDatapath *buildNonPerfectDatapath(
+		unsigned currLoopLevel, unsigned targetUnrollFactor, std::vector<MemoryModel::nodeExportTy> &nodesToImport,
+		unsigned datapathType, std::ostream *summary, std::function<void()> *traceStateReady = nullptr
+	);
+	void buildNonPerfectDatapathsInParallel(
+		unsigned currLoopLevel, unsigned targetUnrollFactor, std::vector<std::vector<MemoryModel::nodeExportTy> *> &nodesToImport,
+		std::vector<unsigned> &datapathTypes, std::vector<DynamicDatapath *> &datapaths
+	);
 	void dumpSummary();
 
 public:
@@ -47,6 +79,7 @@ public:
 	~Multipath();
 
 	uint64_t getCycles() const;
+	const estimatedResourcesTy &getEstimatedResources() const;
 
 	void dumpSummary(uint64_t numCycles);
 
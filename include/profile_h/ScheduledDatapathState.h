@@ -0,0 +1,101 @@
+#ifndef __SCHEDULEDDATAPATHSTATE_H__
+#define __SCHEDULEDDATAPATHSTATE_H__
+
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdint.h>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+#include "profile_h/auxiliary.h"
+#include "profile_h/CSRGraph.h"
+#include "profile_h/HardwareProfile.h"
+
+#include "profile_h/boostincls.h"
+
+// Maximum number of states kept in memory. When full, the oldest state is dropped
+#define SCHEDULED_STATE_STORE_SIZE 64
+
+// One resource operation performed by the resource-constrained scheduler (see BaseDatapath::RCScheduler)
+typedef struct {
+	enum {
+		EVENT_ALLOCATE,
+		EVENT_RELEASE,
+		// End of a cycle (i.e. release of pipelined units)
+		EVENT_TICK
+	};
+
+	uint8_t type;
+	unsigned nodeID;
+} allocationEventTy;
+
+// Scheduled datapath state
+// ------------------------
+// Everything that a datapath computes before resource-constrained scheduling (DDDG transforms, latencies, ASAP, ALAP,
+// critical paths and DDDG optimisations) only depends on the DDDG, the latencies of the target and on the optimisation
+// flags. Design points of a batch that only change resource constraints (e.g. array partitioning) recover this state
+// instead of recomputing it, and only the resource-constrained scheduling runs against the new hardware configuration.
+//
+// When a resource-constrained schedule never had an allocation rejected, it is also kept as a free schedule together
+// with the allocations and releases it performed. If these same allocations all fit in the new hardware configuration,
+// the new constraints do not bind and a fresh scheduling would give exactly the same schedule, thus it is skipped.
+class ScheduledDatapathState {
+public:
+	typedef struct {
+		std::vector<uint64_t> rcScheduledTime;
+		uint64_t rcIL;
+		double achievedPeriod;
+		std::vector<allocationEventTy> allocationLog;
+	} freeScheduleTy;
+
+	// Microops at ALAP scheduling and nodes per ALAP time, used to calculate the required resources
+	std::vector<int> alapMicroops;
+	std::map<uint64_t, std::set<unsigned>> alapTimesNodesMap;
+	// Optimised DDDG (CSR snapshot) with latencies as edge weights, and its microops
+	CSRGraph csr;
+	std::vector<int> microops;
+	std::tuple<uint64_t, uint64_t> asapResult;
+	std::vector<uint64_t> asapScheduledTime;
+	std::vector<uint64_t> alapScheduledTime;
+	std::vector<unsigned> cPathNodes;
+	std::unordered_map<unsigned, std::set<unsigned>> loadDepMap;
+	std::unordered_map<unsigned, std::set<unsigned>> storeDepMap;
+	uint64_t sharedLoadsRemoved;
+	uint64_t repeatedStoresRemoved;
+
+private:
+	std::shared_ptr<const freeScheduleTy> freeSchedule;
+
+	// States are shared by the design points of a batch, which may run in parallel
+	static std::mutex storeMutex;
+	static std::map<std::string, std::shared_ptr<ScheduledDatapathState>> store;
+	static std::list<std::string> storeOrder;
+
+public:
+	// States are only reused between design points of a batch or design space. Memory model analysis changes the DDDG according to
+	// the off-chip configuration, thus it must be disabled. Recovered states only have the CSR snapshot of the optimised DDDG,
+	// which cannot be dumped with "--show-post-dddg"
+	static bool isEnabled();
+	// The key is constructed from the current trace analysis state, thus this must be called before building the DDDG
+	static std::string constructKey(std::string wholeLoopName, std::string loopName, unsigned datapathType, uint64_t unrollFactor, ConfigurationManager &CM);
+	// Returns nullptr if there is no state for this key
+	static std::shared_ptr<ScheduledDatapathState> find(std::string key);
+	static void insert(std::string key, std::shared_ptr<ScheduledDatapathState> state);
+
+	std::shared_ptr<const freeScheduleTy> getFreeSchedule();
+	void setFreeSchedule(std::shared_ptr<const freeScheduleTy> schedule);
+
+	// Perform the allocations of a free schedule on a constrained profile. Returns false if any allocation is rejected,
+	// in which case the profile is left in an intermediate state and should be discarded
+	static bool replay(
+		const freeScheduleTy &schedule, HardwareProfile &profile,
+		const std::vector<int> &microops, const std::unordered_map<int, std::pair<std::string, int64_t>> &baseAddress
+	);
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef __SYMBOLTABLE_H__
+#define __SYMBOLTABLE_H__
+
+#include <atomic>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+#include "profile_h/auxiliary.h"
+
+// Interning table for trace names
+// -------------------------------
+// Dynamic function names (e.g. "foo-3"), register names, instruction IDs and basic block names are handled as 32-bit
+// IDs during DDDG construction, so that the parsed trace container and register lookups do not allocate and hash one
+// string per node. The table is pre-populated once from the static information (see populate()) and lazily extended
+// with names found in the trace. Names are never removed, thus an ID is valid for the whole execution.
+//
+// XXX: This table is shared among threads when running "--batch-threads". Interning is serialised by a mutex (with a
+// per-thread cache in front of it) while resolving an ID to its name is lock-free
+class SymbolTable {
+	// Names are stored in fixed-size chunks that are never moved, so that resolving does not race with interning
+	static const unsigned CHUNK_BITS = 16;
+	static const uint32_t CHUNK_SIZE = 1 << CHUNK_BITS;
+	static const uint32_t MAX_CHUNKS = 1 << 16;
+
+	std::mutex mutex;
+	std::unordered_map<std::string, uint32_t> name2IDMap;
+	std::atomic<std::string *> chunks[MAX_CHUNKS];
+	std::atomic<uint32_t> numOfSymbols;
+
+public:
+	static const uint32_t NO_SYMBOL = 0xFFFFFFFF;
+
+	SymbolTable();
+	~SymbolTable();
+
+	// Intern the names known from the static passes (functions, basic blocks and instructions)
+	void populate();
+
+	// Get the ID of a name, interning it if not yet present
+	uint32_t getID(const std::string &name);
+	// Get the name of an interned ID
+	const std::string &getName(uint32_t ID) const {
+		assert(ID < numOfSymbols.load(std::memory_order_acquire) && "Symbol ID not found in symbol table");
+		return chunks[ID >> CHUNK_BITS].load(std::memory_order_acquire)[ID & (CHUNK_SIZE - 1)];
+	}
+	uint32_t size() const { return numOfSymbols.load(std::memory_order_acquire); }
+};
+
+extern SymbolTable symbolTable;
+
+#endif
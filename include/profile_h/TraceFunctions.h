@@ -9,6 +9,10 @@
 #include <string.h>
 #include <zlib.h>
 
+#include "profile_h/BinaryTrace.h"
+#include "profile_h/LoopTripCounts.h"
+#include "profile_h/MemoryTrace.h"
+#include "profile_h/TraceIndex.h"
 #include "profile_h/lin-profile.h"
 
 #if !defined(RESULT_LINE) && !defined(FORWARD_LINE)
@@ -0,0 +1,159 @@
+#ifndef __TRACEINDEX_H__
+#define __TRACEINDEX_H__
+
+#include <assert.h>
+#include <map>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <zlib.h>
+
+#define TRACE_INDEX_MAGIC_STRING "!Bi"
+#define TRACE_INDEX_VERSION 1
+// Amount of uncompressed trace (in bytes) between two checkpoints. Smaller values give finer random
+// access at the cost of a slightly worse compression ratio (the deflate dictionary is reset at each checkpoint)
+#define TRACE_INDEX_CHECKPOINT_SPACING (8 * 1024 * 1024)
+// Size of the decompression window kept by the reader. Seeks that land inside this window are free
+#define TRACE_INDEX_WINDOW_SIZE (1024 * 1024)
+
+// Seekable dynamic trace
+// ----------------------
+// The textual dynamic_trace.gz is written in-process with zlib. Every TRACE_INDEX_CHECKPOINT_SPACING
+// bytes (always at an instruction line boundary) the deflate stream is fully flushed: the compressed
+// stream becomes byte-aligned and no longer depends on previous data, so decompression can restart at
+// that point with a raw inflate. The file is still a plain single-member gzip file.
+//
+// Each checkpoint is saved in a sidecar index (dynamic_trace.gz.idx) together with the dynamic
+// instruction count at that point and how many times each loop header was executed so far. With this,
+// seeks restart from the nearest checkpoint instead of from the beginning of the trace, and the search
+// for the first execution of a loop can jump straight to the checkpoint preceding it. File layout:
+//
+//	HEADER: magic (3 bytes), version (1 byte), size of dynamic_trace.gz (uint64)
+//	HEADERS: no. of loop headers (uint64), for each: BB name length (uint32), chars, function name length (uint32), chars
+//	CHECKPOINTS: no. of checkpoints (uint64), for each: compressed offset (uint64), uncompressed offset (uint64),
+//	             instruction count (uint64), header hits (uint64 for each loop header)
+class TraceIndex {
+public:
+	typedef struct {
+		uint64_t compressedOffset;
+		uint64_t uncompressedOffset;
+		uint64_t instCount;
+		std::vector<uint64_t> headerHits;
+	} checkpointTy;
+
+private:
+	std::vector<std::pair<std::string, std::string>> headers;
+	std::map<std::pair<std::string, std::string>, unsigned> header2Slot;
+	std::vector<checkpointTy> checkpoints;
+	uint64_t traceSize;
+
+public:
+	TraceIndex() : traceSize(0) { }
+
+	void setHeaders(const std::vector<std::pair<std::string, std::string>> &headers);
+	unsigned getNumHeaders() { return headers.size(); }
+	// Returns -1 if this (BB, function) pair is not a known loop header
+	int getHeaderSlot(std::string bbName, std::string funcName);
+
+	void addCheckpoint(const checkpointTy &checkpoint) { checkpoints.push_back(checkpoint); }
+	bool empty() { return checkpoints.empty(); }
+
+	// Size of the indexed dynamic_trace.gz, used to detect stale indexes
+	void setTraceSize(uint64_t traceSize) { this->traceSize = traceSize; }
+	uint64_t getTraceSize() { return traceSize; }
+
+	bool load(std::string fileName);
+	void save(std::string fileName);
+
+	// Last checkpoint at or before the given uncompressed offset. Returns nullptr if none
+	const checkpointTy *findCheckpoint(uint64_t uncompressedOffset);
+	// Last checkpoint at or after "from" that is guaranteed to precede the first execution of the
+	// given loop header after "from". Returns nullptr if no such checkpoint could be found
+	const checkpointTy *findCheckpointBeforeHeader(std::string bbName, std::string funcName, uint64_t from);
+};
+
+// Writes dynamic_trace.gz with checkpoints, see TraceIndex
+class IndexedGzWriter {
+	FILE *file;
+	z_stream strm;
+	std::vector<char> inBuffer;
+	size_t inLen;
+	std::vector<Bytef> outBuffer;
+
+	uint64_t compressedOffset;
+	uint64_t uncompressedOffset;
+	uint64_t nextCheckpoint;
+
+	TraceIndex index;
+	std::string indexFileName;
+	std::vector<uint64_t> headerHits;
+	std::unordered_map<std::string, int> lastInst2Slot;
+	std::unordered_map<const char *, int> pointer2Slot;
+
+	void deflateBuffer(int flush);
+
+public:
+	// headerLastInsts maps each loop header (BB name, function name) to the ID of its last instruction
+	IndexedGzWriter(std::string fileName, std::string indexFileName, const std::map<std::pair<std::string, std::string>, std::string> &headerLastInsts);
+	~IndexedGzWriter();
+
+	void printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+	// Create a checkpoint here if enough data was written since the last one. Must be called at line boundaries
+	void checkpoint(uint64_t instCount);
+	// Account for one execution of a branch instruction. Only the last instructions of loop headers are counted
+	// XXX: Slots are cached by pointer. Only use it with the constant globals created by the instrumentation pass
+	void hitHeader(const char *instName);
+
+	void close();
+};
+
+// Reads dynamic_trace.gz, using the checkpoints from the index (if available) for random access
+class IndexedGzReader {
+	FILE *file;
+	z_stream strm;
+	bool rawMode;
+	bool inputEnded;
+	std::vector<Bytef> inBuffer;
+
+	std::vector<char> window;
+	uint64_t windowStart;
+	size_t windowLen;
+	size_t windowPos;
+	// Data from this position on is kept in the window when it slides (see pin())
+	bool pinned;
+	uint64_t pinnedPos;
+
+	TraceIndex index;
+	bool hasIndex;
+
+	bool readInput();
+	void skipInput(size_t len);
+	void restart(const TraceIndex::checkpointTy *checkpoint);
+	bool fill();
+
+public:
+	IndexedGzReader(std::string fileName, std::string indexFileName);
+	~IndexedGzReader();
+
+	// Same semantics as gzgets()
+	char *gets(char *buffer, int len);
+	// Copy up to len bytes, regardless of line boundaries. Returns the number of bytes copied (0 at end of trace)
+	size_t read(char *buffer, size_t len);
+	uint64_t tell() { return windowStart + windowPos; }
+	void seek(uint64_t pos);
+	void rewind() { seek(0); }
+
+	// Keep all data from pos (which must be inside the window) on in the window, growing it if needed, so that
+	// seeking back to pos never restarts decompression
+	void pin(uint64_t pos);
+	void unpin() { pinned = false; }
+
+	bool indexed() { return hasIndex; }
+	// Seek forward to a checkpoint right before the next execution of the given loop header. If
+	// successful, instCount is updated with the dynamic instruction count at the new position
+	bool seekNearHeader(std::string bbName, std::string funcName, uint64_t &instCount);
+};
+
+#endif
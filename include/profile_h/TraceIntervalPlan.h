@@ -0,0 +1,63 @@
+#ifndef __TRACEINTERVALPLAN_H__
+#define __TRACEINTERVALPLAN_H__
+
+#include <map>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "profile_h/auxiliary.h"
+#include "profile_h/DDDGBuilder.h"
+
+// Single-pass trace interval plan
+// -------------------------------
+// Every normal-loop datapath searches the dynamic trace for its interval (first execution of the loop header and the
+// last instruction of the n-th execution of the exiting BB, see DDDGBuilder::getTraceLineFromTo()). Without a plan,
+// each datapath scans the trace again. The plan gathers all loops (and levels) that the current run will analyse and
+// finds all their intervals in one streaming pass, which starts where the first datapath would start its own search.
+// If any of the loops has an unknown static bound, the same pass also counts the runtime loop bounds.
+//
+// A planned interval is only used when it is guaranteed to be identical to what a dedicated search would find
+// from the current trace cursor, otherwise the datapath falls back to its own search. In particular, loops requested
+// out of trace order (i.e. whose header was found before the current progressive trace cursor) are searched again.
+class TraceIntervalPlan {
+	typedef struct {
+		std::string lastInstHeaderBB;
+		std::string lastInstExitingBB;
+		unsigned numInstInHeaderBB;
+		// Number of exiting BB executions to record
+		uint64_t maxExits;
+
+		bool headerFound;
+		uint64_t byteFrom;
+		uint64_t headerPos;
+		uint64_t instCount;
+		uint64_t firstExitPos;
+		std::vector<uint64_t> exits;
+	} entryTy;
+
+	std::map<std::string, entryTy> entries;
+	bool scanned;
+	bool complete;
+	uint64_t scanStart;
+	bool countsLoopBounds;
+	std::map<std::string, uint64_t> loopBoundCounts;
+
+	void scan(uint64_t cursor, uint64_t instCount);
+
+public:
+	TraceIntervalPlan() : scanned(false), complete(false), scanStart(0), countsLoopBounds(false) { }
+
+	// Request the intervals of a loop for all unroll factors up to maxUnrollFactor. Must be called before the first get()
+	void request(std::string loopName, unsigned loopLevel, uint64_t maxUnrollFactor);
+	void clear();
+
+	// Get the interval for this loop that a search starting from the given cursor would find. The trace is scanned
+	// on the first call. If runtimeLoopBound is set, the runtime loop bound counts are also added to
+	// wholeloopName2loopBoundMap (the caller must still post-process them). Returns false if the plan cannot be used
+	bool get(std::string loopName, unsigned loopLevel, uint64_t unrollFactor, uint64_t cursor, uint64_t instCount, bool runtimeLoopBound, intervalTy &interval);
+};
+
+extern thread_local TraceIntervalPlan traceIntervalPlan;
+
+#endif
@@ -0,0 +1,126 @@
+#ifndef __TRACEPIPELINE_H__
+#define __TRACEPIPELINE_H__
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+#include "profile_h/TraceIndex.h"
+#include "profile_h/TraceReader.h"
+
+// Size of the decompressed chunks passed from the inflate stage to the tokenise stage
+#define TRACE_PIPELINE_CHUNK_SIZE (1024 * 1024)
+// Number of chunks in flight between the inflate and tokenise stages
+#define TRACE_PIPELINE_NUM_CHUNKS 4
+// Number of parsed lines per batch passed from the tokenise stage to the consumer
+#define TRACE_PIPELINE_BATCH_SIZE 4096
+// Number of batches in flight between the tokenise stage and the consumer
+#define TRACE_PIPELINE_NUM_BATCHES 8
+// Number of times a stage yields on a full/empty queue before blocking until the other side signals
+#define TRACE_PIPELINE_SPIN_COUNT 64
+
+// Bounded single-producer single-consumer queue. Producer only writes tail, consumer only writes head
+template<class T> class SPSCQueue {
+	std::vector<T> slots;
+	std::atomic<size_t> head;
+	std::atomic<size_t> tail;
+
+public:
+	SPSCQueue(size_t capacity) : slots(capacity + 1), head(0), tail(0) { }
+
+	bool push(T elem) {
+		size_t currTail = tail.load(std::memory_order_relaxed);
+		size_t nextTail = (currTail + 1) % slots.size();
+		if(nextTail == head.load(std::memory_order_acquire))
+			return false;
+
+		slots[currTail] = elem;
+		tail.store(nextTail, std::memory_order_release);
+		return true;
+	}
+
+	bool pop(T &elem) {
+		size_t currHead = head.load(std::memory_order_relaxed);
+		if(currHead == tail.load(std::memory_order_acquire))
+			return false;
+
+		elem = slots[currHead];
+		head.store((currHead + 1) % slots.size(), std::memory_order_release);
+		return true;
+	}
+};
+
+// Three-stage pipeline for reading the textual dynamic trace sequentially
+// -----------------------------------------------------------------------
+// The inflate thread decompresses large chunks of dynamic_trace.gz, the tokenise thread splits them into lines and
+// parses them into batches of traceLineTy, and the consumer (i.e. DDDGBuilder::parseTraceFile()) takes lines from the
+// batches. Chunks and batches are recycled through a second queue in the opposite direction, thus the strings of
+// traceLineTy keep their capacity and nothing is allocated once the pipeline is warm. Lines are delivered in trace
+// order and with the same positions as TraceReader::next(), only earlier.
+//
+// The reader is owned by the inflate thread while the pipeline runs. Destroying the pipeline stops both threads, even
+// if the trace was not consumed until the end
+class TracePipeline {
+	typedef struct {
+		// Position of the first byte of this chunk in the trace
+		uint64_t pos;
+		std::vector<char> data;
+		size_t len;
+	} chunkTy;
+
+	typedef struct {
+		std::vector<traceLineTy> lines;
+		size_t numLines;
+	} batchTy;
+
+	IndexedGzReader *reader;
+	bool parseOperands;
+
+	std::vector<chunkTy> chunks;
+	SPSCQueue<chunkTy *> freeChunks;
+	SPSCQueue<chunkTy *> filledChunks;
+	std::vector<batchTy> batches;
+	SPSCQueue<batchTy *> freeBatches;
+	SPSCQueue<batchTy *> filledBatches;
+
+	// Set by the consumer to stop the threads
+	std::atomic<bool> stopping;
+
+	// Stages that gave up spinning block here. Every successful push/pop wakes them if there is any
+	std::mutex waitMutex;
+	std::condition_variable waitCond;
+	std::atomic<unsigned> waiters;
+
+	// Batch being consumed. An empty batch marks the end of the trace
+	batchTy *current;
+	size_t currentLine;
+	bool ended;
+
+	std::thread inflateThread;
+	std::thread tokeniseThread;
+
+	// Wait until elem is pushed/popped. Returns false if the pipeline is stopping
+	template<class T> bool push(SPSCQueue<T> &queue, T elem);
+	template<class T> bool pop(SPSCQueue<T> &queue, T &elem);
+	// Block until ready() returns true. Returns false if the pipeline is stopping
+	template<class F> bool wait(F ready);
+	void signal();
+
+	void inflateStage();
+	void tokeniseStage();
+	// Append a parsed line to the batch, passing it to the consumer when full. Returns false if stopping
+	bool emit(batchTy *&batch, const char *lineStart, uint64_t pos);
+
+public:
+	TracePipeline(IndexedGzReader *reader, bool parseOperands);
+	~TracePipeline();
+
+	// Same semantics as TraceReader::next(). Line content is swapped, not copied, thus fields that do not belong
+	// to the line type hold unrelated values
+	bool next(traceLineTy &line);
+};
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef __TRACEREADER_H__
+#define __TRACEREADER_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include <zlib.h>
+
+#include "profile_h/auxiliary.h"
+#include "profile_h/BinaryTrace.h"
+#include "profile_h/TraceIndex.h"
+
+// A dynamic trace line, already parsed. This is filled either from the textual or from the binary trace
+struct traceLineTy {
+	enum {
+		TYPE_INST = 0,
+		TYPE_RESULT = 1,
+		TYPE_FORWARD = 2,
+		TYPE_PARAM = 3
+	};
+
+	int type;
+	// Position of this line in the trace (byte offset for textual traces, record index for binary traces)
+	uint64_t pos;
+
+	// Instruction lines
+	int lineNo;
+	std::string funcName;
+	std::string bbName;
+	std::string instName;
+	int opcode;
+	uint64_t count;
+
+	// Result, forward and parameter lines
+	int param;
+	int size;
+	double value;
+	int isReg;
+	std::string label;
+	// Symbol ID of the label, resolved by the reader so that the DDDG builder does not intern one string per operand
+	uint32_t labelID;
+};
+
+class TracePipeline;
+
+// Reads the dynamic trace line by line, regardless of its format (textual dynamic_trace.gz or
+// binary dynamic_trace.bin, according to "--binary-trace")
+//
+// Lookaheads should use mark()/reset() instead of tell()/seek(). While a mark is set, the textual reader keeps all
+// decompressed data from the mark on in its sliding window, thus going back to the mark is only a pointer move, even
+// if the lookahead crossed the end of the window (a plain backward seek would restart decompression from a checkpoint)
+//
+// Long sequential reads of the textual trace can be pipelined with startPipeline(), so that decompression and parsing
+// run on separate threads (see TracePipeline.h)
+class TraceReader {
+	bool binary;
+	IndexedGzReader *textFile;
+	BinaryTraceReader *binFile;
+	char buffer[BUFF_STR_SZ];
+
+	TracePipeline *pipeline;
+
+	// Symbol IDs of the strings of the binary trace, indexed by string ID (NO_SYMBOL if not resolved yet)
+	std::vector<uint32_t> binaryLabelIDs;
+	uint32_t emptyLabelID;
+
+	bool marked;
+	uint64_t markPos;
+
+	// Positions of the last instruction lines read (ring buffer), see trackInstructions()
+	std::vector<uint64_t> instHistory;
+	size_t instHistoryHead;
+	size_t instHistoryCount;
+
+	bool nextText(traceLineTy &line, bool parseOperands);
+	bool nextBinary(traceLineTy &line, bool parseOperands);
+	uint32_t getBinaryLabelID(uint32_t stringID);
+
+public:
+	TraceReader();
+	~TraceReader();
+
+	// Parse a textual trace line (null or newline-terminated). Returns false for empty lines. Position is not filled
+	static bool parseText(const char *buffer, traceLineTy &line, bool parseOperands);
+
+	// Read next line. If parseOperands is false, only the type of non-instruction lines is filled. Operand labels are
+	// interned in the symbol table by the reader: textual labels through the per-thread cache of the symbol table (on the
+	// tokenise thread when pipelined), binary labels once per string of the binary trace
+	bool next(traceLineTy &line, bool parseOperands = true);
+	// Not available while pipelined
+	uint64_t tell();
+	void seek(uint64_t pos);
+	void rewind();
+	// Jump forward close to the next execution of the given loop header using the trace index (textual
+	// traces only). Returns true and updates instCount if the jump was performed
+	bool seekNearHeader(std::string bbName, std::string funcName, uint64_t &instCount);
+
+	// Read the rest of the trace from the current position through the pipeline, until the next seek/rewind.
+	// parseOperands is fixed for all lines read meanwhile. Binary traces are read as usual
+	void startPipeline(bool parseOperands = true);
+	void stopPipeline();
+
+	// Set a mark at the current line. Lines read while marked are not tracked by trackInstructions()
+	void mark();
+	// Go back to the mark and release it
+	void reset();
+
+	// Keep the positions of the last n + 1 instruction lines read from now on
+	void trackInstructions(size_t n);
+	// Position of the n-th instruction line read before the last one (0 is the last one itself). Returns 0 (i.e.
+	// beginning of trace) if fewer lines were read
+	uint64_t getInstructionPos(size_t n);
+};
+
+#endif
@@ -40,9 +40,42 @@ extern std::ofstream debugFile;
 // You can see it working in DDDGBuilder.cpp
 #define FUTURE_CACHE
 
+// Going further than the future cache, the DDDGs themselves are the same for design points that only differ in
+// e.g. array partitioning or pipelining. If enabled, DDDGs can be saved and reused in later executions of Lina.
+// You can see it working in DDDGCache.cpp
+#define DDDG_CACHE
+
+// Instead of searching the dynamic trace once per datapath, the intervals of all loops analysed in a run are found
+// in a single pass over the trace, which is performed when the first interval is needed.
+// You can see it working in TraceIntervalPlan.cpp
+#define TRACE_INTERVAL_PLAN
+
+// Long sequential reads of the textual dynamic trace (i.e. DDDG construction and the interval plan scan) are pipelined:
+// decompression and line parsing run on two extra threads while the calling thread tracks dependencies.
+// You can see it working in TracePipeline.cpp
+#define PIPELINED_TRACE_READ
+
+// Loop trip counts are recorded while the dynamic trace is generated and saved in a sidecar file. Runtime loop bounds are
+// then read from this file instead of counting loop header executions over the whole trace.
+// You can see it working in LoopTripCounts.cpp
+#define LOOP_TRIP_COUNTS
+
+// Design points of a batch that only differ in resource constraints (e.g. array partitioning) share everything computed
+// before resource-constrained scheduling. If enabled, this state is kept in memory and only the scheduling is redone,
+// or even skipped when the new constraints do not bind. You can see it working in ScheduledDatapathState.cpp
+#define INCREMENTAL_RESCHEDULING
+
 // If enabled, sanity checks are performed in the multipath vector
 //#define CHECK_MULTIPATH_STATE
 
+// If enabled, every overlap query on the active DDR transactions of the memory model is checked against a linear scan
+// of all active transactions (i.e. the checks used before the coverage map)
+//#define CHECK_ACTIVE_TRANSACTIONS
+
+// If enabled, every textual trace line parsed by the tokenizer is parsed again with the sscanf() formats that it
+// replaced, and both results are compared (see TraceReader::parseText())
+//#define CHECK_TRACE_TOKENIZER
+
 // Enable resource contraints for int operations
 #define CONSTRAIN_INT_OP
 
@@ -67,9 +100,14 @@ extern std::ofstream debugFile;
 
 #define FILE_TRACE_SUFFIX "_trace.bc"
 #define FILE_DYNAMIC_TRACE "dynamic_trace.gz"
+#define FILE_DYNAMIC_TRACE_BIN "dynamic_trace.bin"
+#define FILE_DYNAMIC_TRACE_INDEX "dynamic_trace.gz.idx"
+#define FILE_LOOP_TRIP_COUNTS "loop_trip_counts.txt"
 #define FILE_MEM_TRACE "mem_trace.txt"
 #define FILE_MEM_TRACE_SHORT "mem_trace_short.bin"
 #define FILE_SUMMARY_SUFFIX "_summary.log"
+#define FILE_BATCH_RESULTS "batch_results.csv"
+#define FILE_BATCH_CFG_PREFIX "batch_"
 
 // XXX: For now, I'm using the old separators as defined in the original lin-analyzer to simplify correctness comparison and also portability
 #define LEGACY_SEPARATOR
@@ -77,10 +115,14 @@ extern std::ofstream debugFile;
 
 #define CHECK_VISITED_NODES
 
-extern ArgPack args;
+// XXX: Globals modified during cycle estimation are thread_local, so that several design points can be
+// estimated in parallel (see RunContext in InstrumentForDDDGPass.h)
+extern thread_local ArgPack args;
+// Suffix counter for the names of artificial nodes (see generateInstID())
+extern thread_local uint64_t artificialInstIDCounter;
 #ifdef PROGRESSIVE_TRACE_CURSOR
-extern long int progressiveTraceCursor;
-extern uint64_t progressiveTraceInstCount;
+extern thread_local long int progressiveTraceCursor;
+extern thread_local uint64_t progressiveTraceInstCount;
 #endif
 
 extern const std::string functionNameMapperMDKindName;
@@ -99,7 +141,7 @@ std::string mangleFunctionName(std::string functionName);
 std::string demangleFunctionName(std::string mangledName);
 std::string mangleArrayName(std::string arrayName);
 std::string demangleArrayName(std::string mangledName);
-std::string generateInstID(unsigned opcode, std::vector<std::string> instIDList);
+uint32_t generateInstID(unsigned opcode, const std::vector<uint32_t> &instIDList);
 
 unsigned nextPowerOf2(unsigned x);
 uint64_t nextPowerOf2(uint64_t x);
@@ -119,7 +161,7 @@ extern std::map<std::string, std::string> mangledName2ArrayNameMap;
 	} while(false)
 
 typedef std::map<std::string, uint64_t> wholeloopName2loopBoundMapTy;
-extern wholeloopName2loopBoundMapTy wholeloopName2loopBoundMap;
+extern thread_local wholeloopName2loopBoundMapTy wholeloopName2loopBoundMap;
 
 typedef std::pair<std::string, unsigned> arrayPackSzPairTy;
 
@@ -152,11 +194,12 @@ struct artificialNodeTy {
 	// Non-silent latency
 	// (e.g. if the opcode is of type LLVM_IR_DDRSilentReadReq, the latency here will be from LLVM_IR_DDRReadReq)
 	unsigned nonSilentLatency;
-	std::string currDynamicFunction;
-	std::string currInstID;
+	// Names are IDs from symbolTable
+	uint32_t currDynamicFunction;
+	uint32_t currInstID;
 	int lineNo;
-	std::string prevBB;
-	std::string currBB;
+	uint32_t prevBB;
+	uint32_t currBB;
 };
 
 struct DatapathType {
@@ -283,19 +326,6 @@ public:
 	T getGlobalCfg(unsigned name);
 };
 
-class LimitedQueue {
-	size_t size;
-	std::queue<unsigned> history;
-
-public:
-	LimitedQueue(size_t size);
-
-	void push(unsigned elem);
-	unsigned front();
-	unsigned back();
-	size_t getSize();
-};
-
 class Pack {
 public:
 	struct resourceNodeTy {
@@ -311,13 +341,20 @@ public:
 		resourceNodeTy(unsigned fus, unsigned dsps, unsigned ffs, unsigned luts) : loopLevel(0), datapathType(0), fus(fus), dsps(dsps), ffs(ffs), luts(luts) { }
 	};
 
+	typedef std::tuple<std::string, unsigned, unsigned> descriptorTy;
+
 private:
-	std::vector<std::tuple<std::string, unsigned, unsigned>> structure;
-	std::unordered_map<std::string, std::vector<uint64_t>> unsignedContent;
-	std::unordered_map<std::string, std::vector<int64_t>> signedContent;
-	std::unordered_map<std::string, std::vector<float>> floatContent;
-	std::unordered_map<std::string, std::vector<std::string>> stringContent;
-	std::unordered_map<std::string, std::vector<resourceNodeTy>> resourceTreeContent;
+	// Each descriptor is identified by its position in the structure (field ID). Elements are kept in typed columns
+	// indexed by field ID, so that merges and lookups by ID never touch the descriptor names
+	std::vector<descriptorTy> structure;
+	std::unordered_map<std::string, unsigned> nameToFieldID;
+	std::vector<std::vector<uint64_t>> unsignedContent;
+	std::vector<std::vector<int64_t>> signedContent;
+	std::vector<std::vector<float>> floatContent;
+	std::vector<std::vector<std::string>> stringContent;
+	std::vector<std::vector<resourceNodeTy>> resourceTreeContent;
+
+	template<typename T> std::vector<std::vector<T>> &getColumns();
 
 public:
 	enum {
@@ -339,20 +376,48 @@ public:
 		TYPE_RESOURCENET
 	};
 
-	void addDescriptor(std::string name, unsigned mergeMode, unsigned type);
+	// Returns the field ID of the new descriptor, which can be used in place of its name
+	unsigned addDescriptor(std::string name, unsigned mergeMode, unsigned type);
+	// Returns the field ID of a descriptor, asserts if not found
+	unsigned getFieldID(const std::string &name) const;
 
-	template<typename T> void addElement(std::string name, T value);
+	template<typename T> void addElement(unsigned fieldID, T value);
+	template<typename T> void addElement(const std::string &name, T value) { addElement<T>(getFieldID(name), value); }
 
-	std::vector<std::tuple<std::string, unsigned, unsigned>> getStructure();
-	template<typename T> std::vector<T> getElements(std::string name);
+	const std::vector<descriptorTy> &getStructure() const { return structure; }
+	template<typename T> const std::vector<T> &getElements(unsigned fieldID);
+	template<typename T> const std::vector<T> &getElements(const std::string &name) { return getElements<T>(getFieldID(name)); }
 
-	template<typename T> std::string mergeElements(std::string name);
+	// Numeric merge (MERGE_MAX, MERGE_MIN, MERGE_SUM, MERGE_MULSUM) without formatting the result
+	template<typename T> T aggregate(unsigned fieldID);
+	template<typename T> T aggregate(const std::string &name) { return aggregate<T>(getFieldID(name)); }
+	// Resource merge (MERGE_RESOURCETREEMAX, MERGE_RESOURCELISTMAX) without formatting the result
+	resourceNodeTy aggregateResources(unsigned fieldID);
+	resourceNodeTy aggregateResources(const std::string &name) { return aggregateResources(getFieldID(name)); }
+
+	template<typename T> std::string mergeElements(unsigned fieldID);
+	template<typename T> std::string mergeElements(const std::string &name) { return mergeElements<T>(getFieldID(name)); }
 
 	bool hasSameStructure(Pack &P);
 	void merge(Pack &P);
 	void clear();
 };
 
+// Resources estimated for a loop, as written to the summary file. The floor is the part of this estimation that does
+// not depend on the memory configuration nor on the schedule: one unit of each functional unit type in use, plus the
+// loop control logic (memory logic is not included)
+struct estimatedResourcesTy {
+	uint64_t dsp;
+	uint64_t ff;
+	uint64_t lut;
+	uint64_t bram18k;
+	uint64_t floorDSP;
+	uint64_t floorFF;
+	uint64_t floorLUT;
+
+	estimatedResourcesTy() : dsp(0), ff(0), lut(0), bram18k(0), floorDSP(0), floorFF(0), floorLUT(0) { }
+};
+
 }
 
 #endif // End of AUXILIARY_H
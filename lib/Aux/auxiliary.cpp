@@ -3,6 +3,7 @@
 #include "llvm/IR/Verifier.h"
 
 #include "profile_h/opcodes.h"
+#include "profile_h/SymbolTable.h"
 
 #include <iomanip>
 #include <sstream>
@@ -118,21 +119,25 @@ std::string demangleArrayName(std::string mangledName) {
 	return (mangledName2ArrayNameMap.end() == arrayFound)? mangledName : arrayFound->second;
 }
 
-std::string generateInstID(unsigned opcode, std::vector<std::string> instIDList) {
-	static uint64_t idCtr = 0;
+// Reset for each design point (see RunContext::install()), so that the names of artificial nodes (and the symbol
+// table entries created for them) are reused instead of growing along a batch
+thread_local uint64_t artificialInstIDCounter = 0;
 
+uint32_t generateInstID(unsigned opcode, const std::vector<uint32_t> &instIDList) {
 	// XXX: I don't think this is a performance bottleneck, but if it is, then we should re-think this logic to avoid name collision
 	// Create an instID, checking if the name does not exist already
 	std::string instID;
+	uint32_t instIDSymbol;
 	do {
 #ifdef LEGACY_SEPARATOR
-		instID = reverseOpcodeMap.at(opcode) + "-" + std::to_string(idCtr++);
+		instID = reverseOpcodeMap.at(opcode) + "-" + std::to_string(artificialInstIDCounter++);
 #else
-		instID = reverseOpcodeMap.at(opcode) + GLOBAL_SEPARATOR + std::to_string(idCtr++);
+		instID = reverseOpcodeMap.at(opcode) + GLOBAL_SEPARATOR + std::to_string(artificialInstIDCounter++);
 #endif
-	} while(std::find(instIDList.begin(), instIDList.end(), instID) != instIDList.end());
+		instIDSymbol = symbolTable.getID(instID);
+	} while(std::find(instIDList.begin(), instIDList.end(), instIDSymbol) != instIDList.end());
 
-	return instID;
+	return instIDSymbol;
 }
 
 unsigned nextPowerOf2(unsigned x) {
@@ -657,460 +662,106 @@ bool ConfigurationManager::getGlobalCfg<bool>(unsigned name) {
 	return (found != globalCfgMap.end())? found->second.asBool : false;
 }
 
-LimitedQueue::LimitedQueue(size_t size) : size(size) { }
+template<> std::vector<std::vector<uint64_t>> &Pack::getColumns<uint64_t>() { return unsignedContent; }
+template<> std::vector<std::vector<int64_t>> &Pack::getColumns<int64_t>() { return signedContent; }
+template<> std::vector<std::vector<float>> &Pack::getColumns<float>() { return floatContent; }
+template<> std::vector<std::vector<std::string>> &Pack::getColumns<std::string>() { return stringContent; }
+template<> std::vector<std::vector<Pack::resourceNodeTy>> &Pack::getColumns<Pack::resourceNodeTy>() { return resourceTreeContent; }
 
-void LimitedQueue::push(unsigned elem) {
-	history.push(elem);
+unsigned Pack::addDescriptor(std::string name, unsigned mergeMode, unsigned type) {
+	unsigned fieldID = structure.size();
 
-	if(history.size() > size)
-		history.pop();
-}
-
-unsigned LimitedQueue::front() {
-	return (history.size() < size)? 0 : history.front();
-}
-
-unsigned LimitedQueue::back() {
-	return history.back();
-}
-
-size_t LimitedQueue::getSize() {
-	return size;
-}
-
-void Pack::addDescriptor(std::string name, unsigned mergeMode, unsigned type) {
+	bool inserted = nameToFieldID.insert(std::make_pair(name, fieldID)).second;
+	assert(inserted && "Descriptor was already added to this pack");
 	structure.push_back(std::make_tuple(name, mergeMode, type));
-}
 
-template<> void Pack::addElement<uint64_t>(std::string name, uint64_t value) {
-	std::unordered_map<std::string, std::vector<uint64_t>>::iterator found = unsignedContent.find(name);
+	// One (possibly empty) column per type, so that all columns stay indexed by field ID
+	unsignedContent.emplace_back();
+	signedContent.emplace_back();
+	floatContent.emplace_back();
+	stringContent.emplace_back();
+	resourceTreeContent.emplace_back();
 
-	if(unsignedContent.end() == found) {
-		std::vector<uint64_t> vec;
-		vec.push_back(value);
-		unsignedContent[name] = vec;
-	}
-	else {
-		found->second.push_back(value);
-	}
+	return fieldID;
 }
 
-template<> void Pack::addElement<int64_t>(std::string name, int64_t value) {
-	std::unordered_map<std::string, std::vector<int64_t>>::iterator found = signedContent.find(name);
-
-	if(signedContent.end() == found) {
-		std::vector<int64_t> vec;
-		vec.push_back(value);
-		signedContent[name] = vec;
-	}
-	else {
-		found->second.push_back(value);
-	}
+unsigned Pack::getFieldID(const std::string &name) const {
+	std::unordered_map<std::string, unsigned>::const_iterator found = nameToFieldID.find(name);
+	assert(found != nameToFieldID.end() && "Element was not found");
+	return found->second;
 }
 
-template<> void Pack::addElement<float>(std::string name, float value) {
-	std::unordered_map<std::string, std::vector<float>>::iterator found = floatContent.find(name);
-
-	if(floatContent.end() == found) {
-		std::vector<float> vec;
-		vec.push_back(value);
-		floatContent[name] = vec;
-	}
-	else {
-		found->second.push_back(value);
-	}
+template<typename T> void Pack::addElement(unsigned fieldID, T value) {
+	assert(fieldID < structure.size() && "Element was not found");
+	getColumns<T>()[fieldID].push_back(value);
 }
 
-template<> void Pack::addElement<std::string>(std::string name, std::string value) {
-	std::unordered_map<std::string, std::vector<std::string>>::iterator found = stringContent.find(name);
-
-	if(stringContent.end() == found) {
-		std::vector<std::string> vec;
-		vec.push_back(value);
-		stringContent[name] = vec;
-	}
-	else {
-		found->second.push_back(value);
-	}
+template<typename T> const std::vector<T> &Pack::getElements(unsigned fieldID) {
+	assert(fieldID < structure.size() && "Element was not found");
+	return getColumns<T>()[fieldID];
 }
 
-template<> void Pack::addElement<Pack::resourceNodeTy>(std::string name, resourceNodeTy value) {
-	std::unordered_map<std::string, std::vector<resourceNodeTy>>::iterator found = resourceTreeContent.find(name);
-
-	if(resourceTreeContent.end() == found) {
-		std::vector<resourceNodeTy> vec;
-		vec.push_back(value);
-		resourceTreeContent[name] = vec;
-	}
-	else {
-		found->second.push_back(value);
-	}
-}
-
-std::vector<std::tuple<std::string, unsigned, unsigned>> Pack::getStructure() {
-	return structure;
-}
-
-template<> std::vector<uint64_t> Pack::getElements<uint64_t>(std::string name) {
-	return unsignedContent[name];
-}
+template<typename T> T Pack::aggregate(unsigned fieldID) {
+	assert(fieldID < structure.size() && "Element was not found");
+	const std::vector<T> &column = getColumns<T>()[fieldID];
+	T aggrElem;
 
-template<> std::vector<int64_t> Pack::getElements<int64_t>(std::string name) {
-	return signedContent[name];
-}
-
-template<> std::vector<float> Pack::getElements<float>(std::string name) {
-	return floatContent[name];
-}
-
-template<> std::vector<std::string> Pack::getElements<std::string>(std::string name) {
-	return stringContent[name];
-}
-
-template<> std::vector<Pack::resourceNodeTy> Pack::getElements<Pack::resourceNodeTy>(std::string name) {
-	return resourceTreeContent[name];
-}
-
-template<> std::string Pack::mergeElements<uint64_t>(std::string name) {
-	uint64_t aggrElem;
-	std::string aggrString;
-	bool isEqual = true;
-	bool firstElem = true;
-	std::set<uint64_t> set;
-
-	std::tuple<std::string, unsigned, unsigned> elem;
-	bool found = false;
-	for(auto &it : structure) {
-		if(!(std::get<0>(it).compare(name))) {
-			elem = it;
-			found = true;
-		}
-	}
-	assert(found && "Element was not found");
-
-	switch(std::get<1>(elem)) {
+	switch(std::get<1>(structure[fieldID])) {
 		case MERGE_MAX:
-			aggrElem = std::numeric_limits<uint64_t>::min();
+			aggrElem = std::numeric_limits<T>::min();
 
-			for(auto &it : unsignedContent[name]) {
+			for(auto &it : column) {
 				if(it > aggrElem)
 					aggrElem = it;
 			}
 
-			return std::to_string(aggrElem);
+			return aggrElem;
 		case MERGE_MIN:
-			aggrElem = std::numeric_limits<uint64_t>::max();
+			aggrElem = std::numeric_limits<T>::max();
 
-			for(auto &it : unsignedContent[name]) {
+			for(auto &it : column) {
 				if(it < aggrElem)
 					aggrElem = it;
 			}
 
-			return std::to_string(aggrElem);
+			return aggrElem;
 		case MERGE_SUM:
 			aggrElem = 0;
 
-			for(auto &it : unsignedContent[name])
+			for(auto &it : column)
 				aggrElem += it;
 
-			return std::to_string(aggrElem);
+			return aggrElem;
 		case MERGE_MULSUM:
 			aggrElem = 0;
 
-			for(unsigned i = 0; i < unsignedContent[name].size(); i += 2)
-				aggrElem += unsignedContent[name][i] * unsignedContent[name][i + 1];
-
-			return std::to_string(aggrElem);
-		case MERGE_EQUAL:
-			aggrElem = unsignedContent[name][0];
-
-			for(auto &it : unsignedContent[name]) {
-				if(aggrElem != it)
-					isEqual = false;
-			}
-
-			return isEqual? "true" : "false";
-		case MERGE_SET:
-			for(auto &it : unsignedContent[name])
-				set.insert(it);
-
-			for(auto &it : set) {
-				if(firstElem) {
-					aggrString = std::to_string(it);
-					firstElem = false;
-				}
-				else {
-					aggrString += std::to_string(it);
-				}
-			}
+			for(unsigned i = 0; i < column.size(); i += 2)
+				aggrElem += column[i] * column[i + 1];
 
-			return aggrString;
-		case MERGE_RESOURCETREEMAX:
-			assert(false && "Cannot merge, invalid aggregation type for unsigned (MERGE_RESOURCETREEMAX)");
-		case MERGE_RESOURCELISTMAX:
-			assert(false && "Cannot merge, invalid aggregation type for unsigned (MERGE_RESOURCELISTMAX)");
+			return aggrElem;
 		default:
-			assert(false && "Cannot merge, aggregation type is MERGE_NONE");
+			assert(false && "Cannot aggregate, merge type is not numeric");
+			return 0;
 	}
 }
 
-template<> std::string Pack::mergeElements<int64_t>(std::string name) {
-	int64_t aggrElem;
-	std::string aggrString;
-	bool isEqual = true;
-	bool firstElem = true;
-	std::set<int64_t> set;
-
-	std::tuple<std::string, unsigned, unsigned> elem;
-	bool found = false;
-	for(auto &it : structure) {
-		if(!(std::get<0>(it).compare(name))) {
-			elem = it;
-			found = true;
-		}
-	}
-	assert(found && "Element was not found");
-
-	switch(std::get<1>(elem)) {
-		case MERGE_MAX:
-			aggrElem = std::numeric_limits<int64_t>::min();
-
-			for(auto &it : signedContent[name]) {
-				if(it > aggrElem)
-					aggrElem = it;
-			}
-
-			return std::to_string(aggrElem);
-		case MERGE_MIN:
-			aggrElem = std::numeric_limits<int64_t>::max();
-
-			for(auto &it : signedContent[name]) {
-				if(it < aggrElem)
-					aggrElem = it;
-			}
-
-			return std::to_string(aggrElem);
-		case MERGE_SUM:
-			aggrElem = 0;
-
-			for(auto &it : signedContent[name])
-				aggrElem += it;
-
-			return std::to_string(aggrElem);
-		case MERGE_MULSUM:
-			aggrElem = 0;
-
-			for(unsigned i = 0; i < signedContent[name].size(); i += 2)
-				aggrElem += signedContent[name][i] * signedContent[name][i + 1];
-
-			return std::to_string(aggrElem);
-		case MERGE_EQUAL:
-			aggrElem = signedContent[name][0];
-
-			for(auto &it : signedContent[name]) {
-				if(aggrElem != it)
-					isEqual = false;
-			}
-
-			return isEqual? "true" : "false";
-		case MERGE_SET:
-			for(auto &it : signedContent[name])
-				set.insert(it);
-
-			for(auto &it : set) {
-				if(firstElem) {
-					aggrString = std::to_string(it);
-					firstElem = false;
-				}
-				else {
-					aggrString += std::to_string(it);
-				}
-			}
-
-			return aggrString;
-		case MERGE_RESOURCETREEMAX:
-			assert(false && "Cannot merge, invalid aggregation type for integer (MERGE_RESOURCETREEMAX)");
-		case MERGE_RESOURCELISTMAX:
-			assert(false && "Cannot merge, invalid aggregation type for unsigned (MERGE_RESOURCELISTMAX)");
-		default:
-			assert(false && "Cannot merge, aggregation type is MERGE_NONE");
-	}
-}
-
-template<> std::string Pack::mergeElements<float>(std::string name) {
-	float aggrElem;
-	std::string aggrString;
-	bool isEqual = true;
-
-	std::tuple<std::string, unsigned, unsigned> elem;
-	bool found = false;
-	for(auto &it : structure) {
-		if(!(std::get<0>(it).compare(name))) {
-			elem = it;
-			found = true;
-		}
-	}
-	assert(found && "Element was not found");
-
-	switch(std::get<1>(elem)) {
-		case MERGE_MAX:
-			aggrElem = std::numeric_limits<float>::min();
-
-			for(auto &it : floatContent[name]) {
-				if(it > aggrElem)
-					aggrElem = it;
-			}
-
-			return std::to_string(aggrElem);
-		case MERGE_MIN:
-			aggrElem = std::numeric_limits<float>::max();
-
-			for(auto &it : floatContent[name]) {
-				if(it < aggrElem)
-					aggrElem = it;
-			}
-
-			return std::to_string(aggrElem);
-		case MERGE_SUM:
-			aggrElem = 0;
-
-			for(auto &it : floatContent[name])
-				aggrElem += it;
-
-			return std::to_string(aggrElem);
-		case MERGE_MULSUM:
-			aggrElem = 0;
-
-			for(unsigned i = 0; i < floatContent[name].size(); i += 2)
-				aggrElem += floatContent[name][i] * floatContent[name][i + 1];
-
-			return std::to_string(aggrElem);
-		case MERGE_EQUAL:
-			aggrElem = floatContent[name][0];
-
-			for(auto &it : floatContent[name]) {
-				if(fabs(aggrElem - it) > 0.0001)
-					isEqual = false;
-			}
-
-			return isEqual? "true" : "false";
-		case MERGE_SET:
-			assert(false && "Cannot merge, invalid aggregation type for float (MERGE_SET)");
-		case MERGE_RESOURCETREEMAX:
-			assert(false && "Cannot merge, invalid aggregation type for float (MERGE_RESOURCETREEMAX)");
-		case MERGE_RESOURCELISTMAX:
-			assert(false && "Cannot merge, invalid aggregation type for unsigned (MERGE_RESOURCELISTMAX)");
-		default:
-			assert(false && "Cannot merge, aggregation type is MERGE_NONE");
-	}
-}
-
-template<> std::string Pack::mergeElements<std::string>(std::string name) {
-	std::string aggrString;
-	bool isEqual = true;
-	bool firstElem = true;
-	std::set<std::string> set;
-
-	std::tuple<std::string, unsigned, unsigned> elem;
-	bool found = false;
-	for(auto &it : structure) {
-		if(!(std::get<0>(it).compare(name))) {
-			elem = it;
-			found = true;
-		}
-	}
-	assert(found && "Element was not found");
-
-	switch(std::get<1>(elem)) {
-		case MERGE_MAX:
-			assert(false && "Cannot merge, invalid aggregation type for string (MERGE_MAX)");
-		case MERGE_MIN:
-			assert(false && "Cannot merge, invalid aggregation type for string (MERGE_MIN)");
-		case MERGE_SUM:
-			assert(false && "Cannot merge, invalid aggregation type for string (MERGE_SUM)");
-		case MERGE_MULSUM:
-			assert(false && "Cannot merge, invalid aggregation type for string (MERGE_MULSUM)");
-		case MERGE_EQUAL:
-			aggrString = stringContent[name][0];
-
-			for(auto &it : stringContent[name]) {
-				if(aggrString.compare(it))
-					isEqual = false;
-			}
-
-			return isEqual? "true" : "false";
-		case MERGE_SET:
-			for(auto &it : stringContent[name])
-				set.insert(it);
-
-			for(auto &it : set) {
-				if(firstElem) {
-					aggrString = it;
-					firstElem = false;
-				}
-				else {
-					aggrString += it;
-				}
-			}
-
-			return aggrString;
-		case MERGE_RESOURCETREEMAX:
-			assert(false && "Cannot merge, invalid aggregation type for string (MERGE_RESOURCETREEMAX)");
-		case MERGE_RESOURCELISTMAX:
-			assert(false && "Cannot merge, invalid aggregation type for unsigned (MERGE_RESOURCELISTMAX)");
-		default:
-			assert(false && "Cannot merge, merge type is MERGE_NONE");
-	}
-}
-
-template<> std::string Pack::mergeElements<Pack::resourceNodeTy>(std::string name) {
-	unsigned aggrElemFU;
-	unsigned aggrElemDSP;
-	unsigned aggrElemFF;
-	unsigned aggrElemLUT;
-	std::vector<resourceNodeTy>::iterator it;
-	std::vector<resourceNodeTy>::iterator itEnd;
-	std::string stringFU;
-	std::string stringDSP;
-	std::string stringFF;
-	std::string stringLUT;
-
-	std::tuple<std::string, unsigned, unsigned> elem;
-	bool found = false;
-	for(auto &it : structure) {
-		if(!(std::get<0>(it).compare(name))) {
-			elem = it;
-			found = true;
-		}
-	}
-	assert(found && "Element was not found");
-
-	switch(std::get<1>(elem)) {
-		case MERGE_MAX:
-			assert(false && "Cannot merge, invalid aggregation type for resource tree (MERGE_MAX)");
-		case MERGE_MIN:
-			assert(false && "Cannot merge, invalid aggregation type for resource tree (MERGE_MIN)");
-		case MERGE_SUM:
-			assert(false && "Cannot merge, invalid aggregation type for resource tree (MERGE_SUM)");
-		case MERGE_MULSUM:
-			assert(false && "Cannot merge, invalid aggregation type for resource tree (MERGE_MULSUM)");
-		case MERGE_EQUAL:
-			assert(false && "Cannot merge, invalid aggregation type for resource tree (MERGE_EQUAL)");
-		case MERGE_SET:
-			assert(false && "Cannot merge, invalid aggregation type for resource tree (MERGE_SET)");
+Pack::resourceNodeTy Pack::aggregateResources(unsigned fieldID) {
+	assert(fieldID < structure.size() && "Element was not found");
+	const std::vector<resourceNodeTy> &column = resourceTreeContent[fieldID];
+	unsigned aggrElemFU = 0;
+	unsigned aggrElemDSP = 0;
+	unsigned aggrElemFF = 0;
+	unsigned aggrElemLUT = 0;
+	std::vector<resourceNodeTy>::const_iterator it = column.begin();
+	std::vector<resourceNodeTy>::const_iterator itEnd = column.end();
+
+	switch(std::get<1>(structure[fieldID])) {
 		/* Resource Tree Max: Sum the values for one instance of each DDDG in the code */
 		/* Used for integer FUs */
 		case MERGE_RESOURCETREEMAX:
-			aggrElemFU = 0;
-			aggrElemDSP = 0;
-			aggrElemFF = 0;
-			aggrElemLUT = 0;
-			it = resourceTreeContent[name].begin();
-			itEnd = resourceTreeContent[name].end();
-
 			// If this resource tree has only one node (i.e. mergeElements was called by BaseDatapath for a single DDDG)
 			// we simply return the resources of the single node.
-			if(1 == resourceTreeContent[name].size()) {
+			if(1 == column.size()) {
 				aggrElemFU = it->fus;
 				aggrElemDSP = it->dsps;
 				aggrElemFF = it->ffs;
@@ -1227,31 +878,11 @@ template<> std::string Pack::mergeElements<Pack::resourceNodeTy>(std::string nam
 				}
 			}
 
-			stringFU = std::to_string(aggrElemFU);
-			stringDSP = std::to_string(aggrElemDSP);
-			stringFF = std::to_string(aggrElemFF);
-			stringLUT = std::to_string(aggrElemLUT);
-
-			// Since we will pack these values on a single stream, we assume 10 characters for each number
-			// If any exceeds, abort
-			assert(stringFU.size() <= 10 && stringDSP.size() <= 10 && stringFF.size() <= 10 && stringLUT.size() <= 10 && "Cannot merge, aggregated values exceeds 10 characters");
-
-			stringFU.insert(0, 10 - stringFU.size(), '0');
-			stringDSP.insert(0, 10 - stringDSP.size(), '0');
-			stringFF.insert(0, 10 - stringFF.size(), '0');
-			stringLUT.insert(0, 10 - stringLUT.size(), '0');
-
-			// Pack'em all!
-			return stringFU + stringDSP + stringFF + stringLUT;
+			return resourceNodeTy(aggrElemFU, aggrElemDSP, aggrElemFF, aggrElemLUT);
 		/* Resource List Max: Find the maximum value considering one instance of each DDDG in the code */
 		/* Used for float FUs */
 		case MERGE_RESOURCELISTMAX:
-			aggrElemFU = 0;
-			aggrElemDSP = 0;
-			aggrElemFF = 0;
-			aggrElemLUT = 0;
-
-			for(auto &it : resourceTreeContent[name]) {
+			for(auto &it : column) {
 				if(it.fus > aggrElemFU) {
 					aggrElemFU = it.fus;
 					aggrElemDSP = it.dsps;
@@ -1259,49 +890,190 @@ template<> std::string Pack::mergeElements<Pack::resourceNodeTy>(std::string nam
 					aggrElemLUT = it.luts;
 				}
 			}
-			stringFU = std::to_string(aggrElemFU);
-			stringDSP = std::to_string(aggrElemDSP);
-			stringFF = std::to_string(aggrElemFF);
-			stringLUT = std::to_string(aggrElemLUT);
-
-			// Since we will pack these values on a single stream, we assume 10 characters for each number
-			// If any exceeds, abort
-			assert(stringFU.size() <= 10 && stringDSP.size() <= 10 && stringFF.size() <= 10 && stringLUT.size() <= 10 && "Cannot merge, aggregated values exceeds 10 characters");
-
-			stringFU.insert(0, 10 - stringFU.size(), '0');
-			stringDSP.insert(0, 10 - stringDSP.size(), '0');
-			stringFF.insert(0, 10 - stringFF.size(), '0');
-			stringLUT.insert(0, 10 - stringLUT.size(), '0');
-
-			// Pack'em all!
-			return stringFU + stringDSP + stringFF + stringLUT;
+
+			return resourceNodeTy(aggrElemFU, aggrElemDSP, aggrElemFF, aggrElemLUT);
 		default:
-			assert(false && "Cannot merge, merge type is MERGE_NONE");
+			assert(false && "Cannot aggregate, merge type is not a resource merge");
+			return resourceNodeTy(0, 0, 0, 0);
 	}
 }
 
-bool Pack::hasSameStructure(Pack &P) {
-	std::vector<std::tuple<std::string, unsigned, unsigned>> otherStructure = P.getStructure();
+template<typename T> std::string Pack::mergeElements(unsigned fieldID) {
+	assert(fieldID < structure.size() && "Element was not found");
+	const std::vector<T> &column = getColumns<T>()[fieldID];
+	std::string aggrString;
+	bool isEqual = true;
+	bool firstElem = true;
+	std::set<T> set;
 
-	if(structure.size() != otherStructure.size())
-		return false;
+	switch(std::get<1>(structure[fieldID])) {
+		case MERGE_MAX:
+		case MERGE_MIN:
+		case MERGE_SUM:
+		case MERGE_MULSUM:
+			return std::to_string(aggregate<T>(fieldID));
+		case MERGE_EQUAL:
+			for(auto &it : column) {
+				if(column[0] != it)
+					isEqual = false;
+			}
 
-	for(unsigned i = 0; i < structure.size(); i++) {
-		if(std::get<0>(structure[i]).compare(std::get<0>(otherStructure[i])))
-			return false;
-		if(std::get<1>(structure[i]) != std::get<1>(otherStructure[i]))
-			return false;
-		if(std::get<2>(structure[i]) != std::get<2>(otherStructure[i]))
-			return false;
+			return isEqual? "true" : "false";
+		case MERGE_SET:
+			for(auto &it : column)
+				set.insert(it);
+
+			for(auto &it : set) {
+				if(firstElem) {
+					aggrString = std::to_string(it);
+					firstElem = false;
+				}
+				else {
+					aggrString += std::to_string(it);
+				}
+			}
+
+			return aggrString;
+		case MERGE_RESOURCETREEMAX:
+			assert(false && "Cannot merge, invalid aggregation type for integer (MERGE_RESOURCETREEMAX)");
+		case MERGE_RESOURCELISTMAX:
+			assert(false && "Cannot merge, invalid aggregation type for integer (MERGE_RESOURCELISTMAX)");
+		default:
+			assert(false && "Cannot merge, aggregation type is MERGE_NONE");
 	}
 
-	return true;
+	return aggrString;
+}
+
+template<> std::string Pack::mergeElements<float>(unsigned fieldID) {
+	assert(fieldID < structure.size() && "Element was not found");
+	const std::vector<float> &column = floatContent[fieldID];
+	bool isEqual = true;
+
+	switch(std::get<1>(structure[fieldID])) {
+		case MERGE_MAX:
+		case MERGE_MIN:
+		case MERGE_SUM:
+		case MERGE_MULSUM:
+			return std::to_string(aggregate<float>(fieldID));
+		case MERGE_EQUAL:
+			for(auto &it : column) {
+				if(fabs(column[0] - it) > 0.0001)
+					isEqual = false;
+			}
+
+			return isEqual? "true" : "false";
+		case MERGE_SET:
+			assert(false && "Cannot merge, invalid aggregation type for float (MERGE_SET)");
+		case MERGE_RESOURCETREEMAX:
+			assert(false && "Cannot merge, invalid aggregation type for float (MERGE_RESOURCETREEMAX)");
+		case MERGE_RESOURCELISTMAX:
+			assert(false && "Cannot merge, invalid aggregation type for float (MERGE_RESOURCELISTMAX)");
+		default:
+			assert(false && "Cannot merge, aggregation type is MERGE_NONE");
+	}
+
+	return "";
+}
+
+template<> std::string Pack::mergeElements<std::string>(unsigned fieldID) {
+	assert(fieldID < structure.size() && "Element was not found");
+	const std::vector<std::string> &column = stringContent[fieldID];
+	std::string aggrString;
+	bool isEqual = true;
+	bool firstElem = true;
+	std::set<std::string> set;
+
+	switch(std::get<1>(structure[fieldID])) {
+		case MERGE_MAX:
+			assert(false && "Cannot merge, invalid aggregation type for string (MERGE_MAX)");
+		case MERGE_MIN:
+			assert(false && "Cannot merge, invalid aggregation type for string (MERGE_MIN)");
+		case MERGE_SUM:
+			assert(false && "Cannot merge, invalid aggregation type for string (MERGE_SUM)");
+		case MERGE_MULSUM:
+			assert(false && "Cannot merge, invalid aggregation type for string (MERGE_MULSUM)");
+		case MERGE_EQUAL:
+			for(auto &it : column) {
+				if(column[0].compare(it))
+					isEqual = false;
+			}
+
+			return isEqual? "true" : "false";
+		case MERGE_SET:
+			for(auto &it : column)
+				set.insert(it);
+
+			for(auto &it : set) {
+				if(firstElem) {
+					aggrString = it;
+					firstElem = false;
+				}
+				else {
+					aggrString += it;
+				}
+			}
+
+			return aggrString;
+		case MERGE_RESOURCETREEMAX:
+			assert(false && "Cannot merge, invalid aggregation type for string (MERGE_RESOURCETREEMAX)");
+		case MERGE_RESOURCELISTMAX:
+			assert(false && "Cannot merge, invalid aggregation type for string (MERGE_RESOURCELISTMAX)");
+		default:
+			assert(false && "Cannot merge, merge type is MERGE_NONE");
+	}
+
+	return aggrString;
+}
+
+template<> std::string Pack::mergeElements<Pack::resourceNodeTy>(unsigned fieldID) {
+	assert(fieldID < structure.size() && "Element was not found");
+	unsigned mergeMode = std::get<1>(structure[fieldID]);
+	assert((MERGE_RESOURCETREEMAX == mergeMode || MERGE_RESOURCELISTMAX == mergeMode) && "Cannot merge, invalid aggregation type for resource tree");
+
+	resourceNodeTy aggrElem = aggregateResources(fieldID);
+	std::string stringFU = std::to_string(aggrElem.fus);
+	std::string stringDSP = std::to_string(aggrElem.dsps);
+	std::string stringFF = std::to_string(aggrElem.ffs);
+	std::string stringLUT = std::to_string(aggrElem.luts);
+
+	// Since we will pack these values on a single stream, we assume 10 characters for each number
+	// If any exceeds, abort
+	assert(stringFU.size() <= 10 && stringDSP.size() <= 10 && stringFF.size() <= 10 && stringLUT.size() <= 10 && "Cannot merge, aggregated values exceeds 10 characters");
+
+	stringFU.insert(0, 10 - stringFU.size(), '0');
+	stringDSP.insert(0, 10 - stringDSP.size(), '0');
+	stringFF.insert(0, 10 - stringFF.size(), '0');
+	stringLUT.insert(0, 10 - stringLUT.size(), '0');
+
+	// Pack'em all!
+	return stringFU + stringDSP + stringFF + stringLUT;
+}
+
+template void Pack::addElement<uint64_t>(unsigned fieldID, uint64_t value);
+template void Pack::addElement<int64_t>(unsigned fieldID, int64_t value);
+template void Pack::addElement<float>(unsigned fieldID, float value);
+template void Pack::addElement<std::string>(unsigned fieldID, std::string value);
+template void Pack::addElement<Pack::resourceNodeTy>(unsigned fieldID, resourceNodeTy value);
+template const std::vector<uint64_t> &Pack::getElements<uint64_t>(unsigned fieldID);
+template const std::vector<int64_t> &Pack::getElements<int64_t>(unsigned fieldID);
+template const std::vector<float> &Pack::getElements<float>(unsigned fieldID);
+template const std::vector<std::string> &Pack::getElements<std::string>(unsigned fieldID);
+template const std::vector<Pack::resourceNodeTy> &Pack::getElements<Pack::resourceNodeTy>(unsigned fieldID);
+template uint64_t Pack::aggregate<uint64_t>(unsigned fieldID);
+template int64_t Pack::aggregate<int64_t>(unsigned fieldID);
+template float Pack::aggregate<float>(unsigned fieldID);
+template std::string Pack::mergeElements<uint64_t>(unsigned fieldID);
+template std::string Pack::mergeElements<int64_t>(unsigned fieldID);
+
+bool Pack::hasSameStructure(Pack &P) {
+	return structure == P.getStructure();
 }
 
 void Pack::merge(Pack &P) {
 	if(!(structure.size())) {
 		for(auto &it : P.getStructure())
-			structure.push_back(it);
+			addDescriptor(std::get<0>(it), std::get<1>(it), std::get<2>(it));
 	}
 
 	if(!(P.getStructure().size()))
@@ -1309,38 +1081,23 @@ void Pack::merge(Pack &P) {
 
 	assert(hasSameStructure(P) && "Attempt to merge a pack with different structure");
 
-	std::vector<uint64_t> otherUnsignedStuff;
-	std::vector<int64_t> otherSignedStuff;
-	std::vector<float> otherFloatStuff;
-	std::vector<std::string> otherStringStuff;
-	std::vector<resourceNodeTy> otherResourceTreeStuff;
-
-	for(auto &it : structure) {
-		switch(std::get<2>(it)) {
+	// Same structure means same field IDs, thus whole columns are appended
+	for(unsigned i = 0; i < structure.size(); i++) {
+		switch(std::get<2>(structure[i])) {
 			case TYPE_UNSIGNED:
-				otherUnsignedStuff = P.getElements<uint64_t>(std::get<0>(it));
-				for(auto &it2 : otherUnsignedStuff)
-					addElement<uint64_t>(std::get<0>(it), it2);
+				unsignedContent[i].insert(unsignedContent[i].end(), P.unsignedContent[i].begin(), P.unsignedContent[i].end());
 				break;
 			case TYPE_SIGNED:
-				otherSignedStuff = P.getElements<int64_t>(std::get<0>(it));
-				for(auto &it2 : otherSignedStuff)
-					addElement<int64_t>(std::get<0>(it), it2);
+				signedContent[i].insert(signedContent[i].end(), P.signedContent[i].begin(), P.signedContent[i].end());
 				break;
 			case TYPE_FLOAT:
-				otherFloatStuff = P.getElements<float>(std::get<0>(it));
-				for(auto &it2 : otherFloatStuff)
-					addElement<float>(std::get<0>(it), it2);
+				floatContent[i].insert(floatContent[i].end(), P.floatContent[i].begin(), P.floatContent[i].end());
 				break;
 			case TYPE_STRING:
-				otherStringStuff = P.getElements<std::string>(std::get<0>(it));
-				for(auto &it2 : otherStringStuff)
-					addElement<std::string>(std::get<0>(it), it2);
+				stringContent[i].insert(stringContent[i].end(), P.stringContent[i].begin(), P.stringContent[i].end());
 				break;
 			case TYPE_RESOURCENET:
-				otherResourceTreeStuff = P.getElements<resourceNodeTy>(std::get<0>(it));
-				for(auto &it2 : otherResourceTreeStuff)
-					addElement<resourceNodeTy>(std::get<0>(it), it2);
+				resourceTreeContent[i].insert(resourceTreeContent[i].end(), P.resourceTreeContent[i].begin(), P.resourceTreeContent[i].end());
 				break;
 			default:
 				assert(false && "Invalid type of element");
@@ -1350,11 +1107,11 @@ void Pack::merge(Pack &P) {
 }
 
 void Pack::clear() {
-	std::vector<std::tuple<std::string, unsigned, unsigned>>().swap(structure);
-	// XXX: Double-check to see if there is no memory leak due to inner vectors
-	std::unordered_map<std::string, std::vector<uint64_t>>().swap(unsignedContent);
-	std::unordered_map<std::string, std::vector<int64_t>>().swap(signedContent);
-	std::unordered_map<std::string, std::vector<float>>().swap(floatContent);
-	std::unordered_map<std::string, std::vector<std::string>>().swap(stringContent);
-	std::unordered_map<std::string, std::vector<resourceNodeTy>>().swap(resourceTreeContent);
+	std::vector<descriptorTy>().swap(structure);
+	std::unordered_map<std::string, unsigned>().swap(nameToFieldID);
+	std::vector<std::vector<uint64_t>>().swap(unsignedContent);
+	std::vector<std::vector<int64_t>>().swap(signedContent);
+	std::vector<std::vector<float>>().swap(floatContent);
+	std::vector<std::vector<std::string>>().swap(stringContent);
+	std::vector<std::vector<resourceNodeTy>>().swap(resourceTreeContent);
 }
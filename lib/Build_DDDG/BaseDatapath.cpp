@@ -5,32 +5,32 @@
 
 #include "llvm/Support/GraphWriter.h"
 #include "profile_h/colors.h"
+#include "profile_h/MaxCycleRatio.h"
 #include "profile_h/opcodes.h"
 
-void BaseDatapath::findMinimumRankPair(std::pair<unsigned, unsigned> &pair, std::map<unsigned, unsigned> rankMap) {
-	unsigned minRank = numOfTotalNodes;
+// Pop the two nodes with minimum rank from the heap of (rank, node ID), ties broken by the lower node ID. When these
+// are the last two nodes, they are paired by node ID. Returns the highest rank of the pair
+unsigned BaseDatapath::findMinimumRankPair(std::pair<unsigned, unsigned> &pair, std::vector<std::pair<unsigned, unsigned>> &rankHeap) {
+	assert(rankHeap.size() >= 2 && "Associative chain has less than two operands left");
 
-	for(auto &it : rankMap) {
-		unsigned nodeRank = it.second;
-		if(nodeRank < minRank) {
-			pair.first = it.first;
-			minRank = nodeRank;
-		}
-	}
+	std::pop_heap(rankHeap.begin(), rankHeap.end(), std::greater<std::pair<unsigned, unsigned>>());
+	std::pair<unsigned, unsigned> first = rankHeap.back();
+	rankHeap.pop_back();
+	std::pop_heap(rankHeap.begin(), rankHeap.end(), std::greater<std::pair<unsigned, unsigned>>());
+	std::pair<unsigned, unsigned> second = rankHeap.back();
+	rankHeap.pop_back();
 
-	minRank = numOfTotalNodes;
+	if(rankHeap.empty() && second.second < first.second)
+		std::swap(first, second);
 
-	for(auto &it : rankMap) {
-		unsigned nodeRank = it.second;
-		if(it.first != pair.first && nodeRank < minRank) {
-			pair.second = it.first;
-			minRank = nodeRank;
-		}
-	}
+	pair.first = first.second;
+	pair.second = second.second;
+
+	return second.first;
 }
 
 BaseDatapath::BaseDatapath(
-	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
+	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ostream *summaryFile,
 	std::string loopName, unsigned loopLevel, uint64_t loopUnrollFactor,
 	bool enablePipelining, uint64_t asapII
 ) :
@@ -49,7 +49,25 @@ BaseDatapath::BaseDatapath(
 	memmodel = MemoryModel::createInstance(this);
 	profile->setMemoryModel(memmodel);
 
-	if(args.fNoMMA || args.mmaMode != ArgPack::MMA_MODE_USE) {
+	scheduledStateRestored = false;
+#ifdef INCREMENTAL_RESCHEDULING
+	// As with the DDDG cache, the key depends on the trace analysis state before the DDDG is built
+	if(ScheduledDatapathState::isEnabled())
+		scheduledStateKey = ScheduledDatapathState::constructKey(appendDepthToLoopName(loopName, loopLevel), loopName, datapathType, loopUnrollFactor, CM);
+#endif
+
+	bool recoveredFromCache = false;
+#ifdef DDDG_CACHE
+	DDDGCache dddgCache(appendDepthToLoopName(loopName, loopLevel), datapathType, loopUnrollFactor, tracksLoopIterations());
+	// When generating a context the DDDG builder is needed, thus the cache is only written
+	if(args.dddgCache && ArgPack::MMA_MODE_GEN != args.mmaMode && (args.fNoMMA || args.mmaMode != ArgPack::MMA_MODE_USE))
+		recoveredFromCache = dddgCache.load(this, &PC);
+#endif
+
+	if(recoveredFromCache) {
+		VERBOSE_PRINT(errs() << "\tInitial DDDG recovered from DDDG cache\n");
+	}
+	else if(args.fNoMMA || args.mmaMode != ArgPack::MMA_MODE_USE) {
 		VERBOSE_PRINT(errs() << "\tBuild initial DDDG\n");
 
 		builder = new DDDGBuilder(this, PC);
@@ -62,6 +80,13 @@ BaseDatapath::BaseDatapath(
 			CtxM.saveDDDG(wholeLoopName, datapathType, loopUnrollFactor, *builder, microops);
 		}
 
+#ifdef DDDG_CACHE
+		if(args.dddgCache) {
+			VERBOSE_PRINT(errs() << "\tSaving initial DDDG to DDDG cache\n");
+			dddgCache.save(*builder, PC, microops);
+		}
+#endif
+
 		delete builder;
 		builder = nullptr;
 	}
@@ -92,12 +117,14 @@ BaseDatapath::BaseDatapath(
 	repeatedStoresRemoved = 0;
 
 	dummySinkCreated = false;
+	csrOutdated = true;
+	dddgEdgesReleased = false;
 }
 
 // This constructor does not perform DDDG generation. It should be generated externally via
 // child classes (e.g. DynamicDatapath)
 BaseDatapath::BaseDatapath(
-	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
+	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ostream *summaryFile,
 	std::string loopName, unsigned loopLevel, uint64_t loopUnrollFactor, unsigned datapathType
 ) :
 	kernelName(kernelName), CM(CM), CtxM(CtxM), summaryFile(summaryFile),
@@ -115,6 +142,13 @@ BaseDatapath::BaseDatapath(
 	memmodel = MemoryModel::createInstance(this);
 	profile->setMemoryModel(memmodel);
 
+	scheduledStateRestored = false;
+#ifdef INCREMENTAL_RESCHEDULING
+	// The DDDG is built by the child class, thus the trace analysis state is still untouched here
+	if(ScheduledDatapathState::isEnabled())
+		scheduledStateKey = ScheduledDatapathState::constructKey(appendDepthToLoopName(loopName, loopLevel), loopName, datapathType, loopUnrollFactor, CM);
+#endif
+
 	numCycles = 0;
 	rcIL = 0;
 
@@ -131,6 +165,8 @@ BaseDatapath::BaseDatapath(
 	repeatedStoresRemoved = 0;
 
 	dummySinkCreated = false;
+	csrOutdated = true;
+	dddgEdgesReleased = false;
 }
 
 BaseDatapath::~BaseDatapath() {
@@ -154,6 +190,12 @@ uint64_t BaseDatapath::getTargetLoopUnrollFactor() const {
 	return loopUnrollFactor;
 }
 
+// Loop iterations and loop-carried dependencies are only used by the recurrence-constrained II via maximum cycle ratio.
+// A generated context may be used later by design points with pipelining, thus it always has them
+bool BaseDatapath::tracksLoopIterations() const {
+	return (enablePipelining && !(args.fRecIIUnroll)) || ArgPack::MMA_MODE_GEN == args.mmaMode;
+}
+
 unsigned BaseDatapath::getNumNodes() const {
 	return boost::num_vertices(graph);
 }
@@ -170,6 +212,10 @@ uint64_t BaseDatapath::getRCIL() const {
 	return rcIL;
 }
 
+const estimatedResourcesTy &BaseDatapath::getEstimatedResources() const {
+	return estimatedResources;
+}
+
 Pack &BaseDatapath::getPack() {
 	return P;
 }
@@ -196,13 +242,16 @@ void BaseDatapath::importNodes(std::vector<MemoryModel::nodeExportTy> nodesToImp
 void BaseDatapath::postDDDGBuild() {
 	refreshDDDG();
 
-	for(auto &it : PC.getFuncList()) {
+	// Names are resolved once per dynamic function
+	std::unordered_set<uint32_t> dynamicFunctions(PC.getFuncList().begin(), PC.getFuncList().end());
+	for(auto &it : dynamicFunctions) {
+		const std::string &dynamicFunction = symbolTable.getName(it);
 #ifdef LEGACY_SEPARATOR
-		size_t tagPos = it.find("-");
+		size_t tagPos = dynamicFunction.find("-");
 #else
-		size_t tagPos = it.find(GLOBAL_SEPARATOR);
+		size_t tagPos = dynamicFunction.find(GLOBAL_SEPARATOR);
 #endif
-		std::string functionName = it.substr(0, tagPos);
+		std::string functionName = dynamicFunction.substr(0, tagPos);
 
 		functionNames.insert(functionName);
 	}
@@ -235,11 +284,17 @@ void BaseDatapath::refreshDDDG() {
 	vertexToName = boost::get(boost::vertex_index, graph);
 
 	edgeToWeight = boost::get(boost::edge_weight, graph);
+	csrOutdated = true;
 }
 
 void BaseDatapath::setForDDDGImport() {
 	graph.clear();
 	microops.clear();
+	nodeIterations.clear();
+	carriedEdges.clear();
+	csr.clear();
+	csrOutdated = true;
+	dddgEdgesReleased = false;
 }
 
 void BaseDatapath::insertMicroop(int microop) {
@@ -249,6 +304,20 @@ void BaseDatapath::insertMicroop(int microop) {
 void BaseDatapath::insertDDDGEdge(unsigned from, unsigned to, uint8_t paramID) {
 	if(from != to)
 		boost::add_edge(from, to, EdgeProperty(paramID), graph);
+
+	csrOutdated = true;
+}
+
+void BaseDatapath::insertNodeIteration(unsigned iteration) {
+	nodeIterations.push_back(iteration);
+}
+
+void BaseDatapath::insertCarriedEdge(unsigned from, unsigned to, unsigned distance) {
+	carriedEdgeTy edge;
+	edge.source = from;
+	edge.sink = to;
+	edge.distance = distance;
+	carriedEdges.push_back(edge);
 }
 
 bool BaseDatapath::edgeExists(unsigned from, unsigned to) {
@@ -258,6 +327,19 @@ bool BaseDatapath::edgeExists(unsigned from, unsigned to) {
 void BaseDatapath::updateRemoveDDDGEdges(std::set<Edge> &edgesToRemove) {
 	for(auto &it : edgesToRemove)
 		boost::remove_edge(it, graph);
+
+	csrOutdated = true;
+}
+
+void BaseDatapath::updateRemoveDDDGEdges(std::vector<Edge> &edgesToRemove) {
+	// Same order as with std::set<Edge>
+	std::sort(edgesToRemove.begin(), edgesToRemove.end());
+	edgesToRemove.erase(std::unique(edgesToRemove.begin(), edgesToRemove.end()), edgesToRemove.end());
+
+	for(auto &it : edgesToRemove)
+		boost::remove_edge(it, graph);
+
+	csrOutdated = true;
 }
 
 void BaseDatapath::updateAddDDDGEdges(std::vector<edgeTy> &edgesToAdd) {
@@ -265,11 +347,15 @@ void BaseDatapath::updateAddDDDGEdges(std::vector<edgeTy> &edgesToAdd) {
 		if(it.from != it.to && !edgeExists(it.from, it.to))
 			boost::get(boost::edge_weight, graph)[boost::add_edge(it.from, it.to, graph).first] = it.paramID;
 	}
+
+	csrOutdated = true;
 }
 
 void BaseDatapath::updateRemoveDDDGNodes(std::vector<unsigned> &nodesToRemove) {
 	for(auto &it : nodesToRemove)
 		boost::clear_vertex(nameToVertex[it], graph);
+
+	csrOutdated = true;
 }
 
 artificialNodeTy BaseDatapath::createArtificialNode(artificialNodeTy &aNode, int opcode) {
@@ -280,7 +366,6 @@ artificialNodeTy BaseDatapath::createArtificialNode(artificialNodeTy &aNode, int
 	insertMicroop(opcode);
 
 	PC.unlock();
-	PC.openAllFilesForWrite();
 	// Update ParsedTraceContainer containers with the new node.
 	// XXX: We use the values from the first store
 	PC.appendToFuncList(aNode.currDynamicFunction);
@@ -289,7 +374,7 @@ artificialNodeTy BaseDatapath::createArtificialNode(artificialNodeTy &aNode, int
 	PC.appendToPrevBBList(aNode.prevBB);
 	PC.appendToCurrBBList(aNode.currBB);
 	// Finished
-	PC.closeAllFiles();
+	PC.pack();
 	PC.lock();
 
 	return aNode;
@@ -371,6 +456,29 @@ std::unordered_map<unsigned, Vertex> &BaseDatapath::getNameToVertex() {
 	return nameToVertex;
 }
 
+const CSRGraph &BaseDatapath::getCSR() {
+	if(csrOutdated) {
+		assert(!dddgEdgesReleased && "DDDG was changed after its edges were released (see releaseDDDGEdges())");
+		csr.build(graph, vertexToName);
+		csrOutdated = false;
+	}
+
+	return csr;
+}
+
+// The resource-constrained scheduling and the II calculations only traverse the CSR snapshot, thus the boost edge lists are
+// released after the DDDG optimisations. Nodes are kept (and so are their IDs), as some phases still iterate through them
+void BaseDatapath::releaseDDDGEdges() {
+	if(dddgEdgesReleased)
+		return;
+
+	getCSR();
+
+	Graph edgeless(boost::num_vertices(graph));
+	graph.swap(edgeless);
+	dddgEdgesReleased = true;
+}
+
 std::vector<int> &BaseDatapath::getMicroops() {
 	return microops;
 }
@@ -382,7 +490,12 @@ std::unordered_map<int, std::pair<std::string, int64_t>> &BaseDatapath::getBaseA
 void BaseDatapath::initBaseAddress() {
 	const ConfigurationManager::partitionCfgMapTy &partitionMap = CM.getPartitionCfgMap();
 	const ConfigurationManager::partitionCfgMapTy &completePartitionMap = CM.getCompletePartitionCfgMap();
-	const std::unordered_map<int, std::pair<std::string, int64_t>> &getElementPtrMap = PC.getGetElementPtrList();
+	const getElementPtrColumnTy &getElementPtrMap = PC.getGetElementPtrList();
+	// Array names are stored as symbol IDs
+	auto getElementPtr = [&getElementPtrMap](unsigned nodeID) {
+		const std::pair<uint32_t, int64_t> &elem = getElementPtrMap.at(nodeID);
+		return std::make_pair(symbolTable.getName(elem.first), elem.second);
+	};
 
 	VertexIterator vi, viEnd;
 	for(std::tie(vi, viEnd) = vertices(graph); vi != viEnd; vi++) {
@@ -410,7 +523,7 @@ void BaseDatapath::initBaseAddress() {
 				unsigned parentID = vertexToName[boost::source(*inEdgei, graph)];
 				int parentMicroop = microops.at(parentID);
 				if(LLVM_IR_GetElementPtr == parentMicroop || isLoadOp(parentMicroop)) {
-					baseAddress[nodeID] = getElementPtrMap.at(parentID);
+					baseAddress[nodeID] = getElementPtr(parentID);
 					currNode = boost::source(*inEdgei, graph);
 					nodeMicroop = parentMicroop;
 					foundParent = true;
@@ -418,7 +531,7 @@ void BaseDatapath::initBaseAddress() {
 					break;
 				}
 				else if(LLVM_IR_Alloca == parentMicroop) {
-					baseAddress[nodeID] = getElementPtrMap.at(parentID);
+					baseAddress[nodeID] = getElementPtr(parentID);
 					modified = true;
 					break;
 				}
@@ -429,7 +542,7 @@ void BaseDatapath::initBaseAddress() {
 		}
 
 		if(!modified)
-			baseAddress[nodeID] = getElementPtrMap.at(nodeID);
+			baseAddress[nodeID] = getElementPtr(nodeID);
 
 		// Check if base address is inside a partition request. If not, add to a no-partition vector
 		// XXX: A partition sanity check was implemented in the original version.
@@ -493,6 +606,7 @@ uint64_t BaseDatapath::fpgaEstimationOneMoreSubtraceForRecIICalculation() {
 				nonNullFound = true;
 		}
 	}
+	csrOutdated = true;
 
 	if(!nonNullFound) {
 		VERBOSE_PRINT(errs() << "\tThis DDDG has no latency\n");
@@ -508,75 +622,33 @@ uint64_t BaseDatapath::fpgaEstimationOneMoreSubtraceForRecIICalculation() {
 uint64_t BaseDatapath::fpgaEstimation() {
 	VERBOSE_PRINT(errs() << "\tStarting IL and II calculation\n");
 
-	VERBOSE_PRINT(errs() << "\tRemoving induction dependencies\n");
-	removeInductionDependencies();
-	VERBOSE_PRINT(errs() << "\tRemoving PHI nodes\n");
-	removePhiNodes();
+	std::tuple<uint64_t, uint64_t> asapResult;
+	if(!(scheduledStateKey.empty()))
+		scheduledState = ScheduledDatapathState::find(scheduledStateKey);
 
-	if(args.fSBOpt) {
-		VERBOSE_PRINT(errs() << "\tOptimising store buffers\n");
-		enableStoreBufferOptimisation();
+	if(scheduledState) {
+		VERBOSE_PRINT(errs() << "\tRecovering optimised DDDG, ASAP, ALAP and critical paths from a previous design point\n");
+		scheduledStateRestored = true;
+		asapResult = restoreScheduledState();
 	}
+	else {
+		// Filled along the estimation and published after resource-constrained scheduling
+		if(!(scheduledStateKey.empty()))
+			scheduledState = std::make_shared<ScheduledDatapathState>();
 
-	if(!(args.fNoMMA)) {
-		memmodel->enableReport();
-
-		if(ArgPack::MMA_MODE_USE == args.mmaMode) {
-			VERBOSE_PRINT(errs() <<"\t\"--mma-mode\" is set to \"use\", setting up memory model\n");
-			memmodel->setUp(CtxM);
-		}
-
-		VERBOSE_PRINT(errs() << "\tPerforming DDDG memory model-based analysis and transform\n");
-		profile->performMemoryModelAnalysis();
-
-		if(ArgPack::MMA_MODE_GEN == args.mmaMode) {
-			memmodel->save(CtxM);
-			VERBOSE_PRINT(errs() <<"\t\"--mma-mode\" is set to \"gen\", halting now\n");
+		if(!analyseDDDG(asapResult))
 			return 0;
-		}
 	}
 
-	// Put the node latency using selected architecture as edge weights in the graph
-	VERBOSE_PRINT(errs() << "\tUpdating DDDG edges with operation latencies according to selected hardware\n");
-	bool nonNullFound = false;
-	EdgeIterator edgei, edgeEnd;
-	for(std::tie(edgei, edgeEnd) = boost::edges(graph); edgei != edgeEnd; edgei++) {
-		uint8_t weight = edgeToWeight[*edgei];
-
-		// XXX: Up to this point no control edges were added so far, I think
-		if(EDGE_CONTROL == weight) {
-			boost::put(boost::edge_weight, graph, *edgei, 0);
-		}
-		else {
-			unsigned nodeID = vertexToName[boost::source(*edgei, graph)];
-			unsigned opcode = microops.at(nodeID);
-			unsigned latency = profile->getLatency(opcode);
-			boost::put(boost::edge_weight, graph, *edgei, latency);
-
-			if(latency)
-				nonNullFound = true;
-		}
-	}
-
-	if(!nonNullFound) {
-		VERBOSE_PRINT(errs() << "\tThis DDDG has no latency\n");
-		return 0;
-	}
-
-	VERBOSE_PRINT(errs() << "\tStarting ASAP scheduling\n");
-	std::tuple<uint64_t, uint64_t> asapResult = asapScheduling();
-
-	VERBOSE_PRINT(errs() << "\tStarting ALAP scheduling\n");
-	alapScheduling(asapResult);
-
-	VERBOSE_PRINT(errs() << "\tIdentifying critical paths\n");
-	identifyCriticalPaths();
-
 	VERBOSE_PRINT(errs() << "\tStarting resource-constrained scheduling\n");
 	std::pair<uint64_t, double> rcPair = rcScheduling();
 	rcIL = rcPair.first;
 	double achievedPeriod = rcPair.second;
 
+	// Captured before calculateResIIMem() changes the dependency maps
+	if(scheduledState && !scheduledStateRestored)
+		captureScheduledState(asapResult);
+
 	VERBOSE_PRINT(errs() << "\tGetting memory-constrained II\n");
 	std::tuple<std::string, uint64_t> resIIMem = calculateResIIMem();
 
@@ -591,8 +663,9 @@ uint64_t BaseDatapath::fpgaEstimation() {
 
 	P.clear();
 	profile->fillPack(P, loopLevel, datapathType, enablePipelining? maxII : 0);
-	for(auto &it : P.getStructure()) {
-		std::string name = std::get<0>(it);
+	const std::vector<Pack::descriptorTy> &structure = P.getStructure();
+	for(unsigned fieldID = 0; fieldID < structure.size(); fieldID++) {
+		const std::string &name = std::get<0>(structure[fieldID]);
 
 		// Names starting with "_" are not printed (used for internal calculations)
 		if('_' == name[0])
@@ -600,18 +673,18 @@ uint64_t BaseDatapath::fpgaEstimation() {
 
 		VERBOSE_PRINT(errs() << "\t" << name << ": ");
 
-		switch(std::get<2>(it)) {
+		switch(std::get<2>(structure[fieldID])) {
 			case Pack::TYPE_UNSIGNED:
-				VERBOSE_PRINT(errs() << std::to_string(P.getElements<uint64_t>(name)[0]) << "\n");
+				VERBOSE_PRINT(errs() << std::to_string(P.getElements<uint64_t>(fieldID)[0]) << "\n");
 				break;
 			case Pack::TYPE_SIGNED:
-				VERBOSE_PRINT(errs() << std::to_string(P.getElements<int64_t>(name)[0]) << "\n");
+				VERBOSE_PRINT(errs() << std::to_string(P.getElements<int64_t>(fieldID)[0]) << "\n");
 				break;
 			case Pack::TYPE_FLOAT:
-				VERBOSE_PRINT(errs() << std::to_string(P.getElements<float>(name)[0]) << "\n");
+				VERBOSE_PRINT(errs() << std::to_string(P.getElements<float>(fieldID)[0]) << "\n");
 				break;
 			case Pack::TYPE_STRING:
-				VERBOSE_PRINT(errs() << P.getElements<std::string>(name)[0] << "\n");
+				VERBOSE_PRINT(errs() << P.getElements<std::string>(fieldID)[0] << "\n");
 				break;
 		}
 	}
@@ -670,25 +743,25 @@ uint64_t BaseDatapath::fpgaEstimation() {
 	P.addDescriptor("Number of repeated stores detected", Pack::MERGE_SUM, Pack::TYPE_UNSIGNED);
 	P.addElement<uint64_t>("Number of repeated stores detected", repeatedStoresRemoved);
 	if(!(args.fNoFPUThresOpt)) {
-		P.addDescriptor("Units limited by DSP usage", Pack::MERGE_SET, Pack::TYPE_STRING);
+		unsigned fieldID = P.addDescriptor("Units limited by DSP usage", Pack::MERGE_SET, Pack::TYPE_STRING);
 		for(auto &i : profile->getConstrainedUnits()) {
-			P.addElement<uint64_t>("Units limited by DSP usage", i);
+			P.addElement<uint64_t>(fieldID, i);
 			switch(i) {
 				case HardwareProfile::LIMITED_BY_FADD:
-					P.addElement<std::string>("Units limited by DSP usage", "fadd");
+					P.addElement<std::string>(fieldID, "fadd");
 					break;
 				case HardwareProfile::LIMITED_BY_FSUB:
-					P.addElement<std::string>("Units limited by DSP usage", "fsub");
+					P.addElement<std::string>(fieldID, "fsub");
 					break;
 				case HardwareProfile::LIMITED_BY_FMUL:
-					P.addElement<std::string>("Units limited by DSP usage", "fmul");
+					P.addElement<std::string>(fieldID, "fmul");
 					break;
 				case HardwareProfile::LIMITED_BY_FDIV:
-					P.addElement<std::string>("Units limited by DSP usage", "fdiv");
+					P.addElement<std::string>(fieldID, "fdiv");
 					break;
 #ifdef CONSTRAIN_INT_OP
 				case HardwareProfile::LIMITED_BY_INTOP:
-					P.addElement<std::string>("Units limited by DSP usage", "int op");
+					P.addElement<std::string>(fieldID, "int op");
 					break;
 #endif
 			}
@@ -701,8 +774,119 @@ uint64_t BaseDatapath::fpgaEstimation() {
 	return numCycles;
 }
 
+// DDDG transforms and scheduling that do not depend on resource constraints. Returns false if the estimation should stop
+bool BaseDatapath::analyseDDDG(std::tuple<uint64_t, uint64_t> &asapResult) {
+	VERBOSE_PRINT(errs() << "\tRemoving induction dependencies\n");
+	removeInductionDependencies();
+	VERBOSE_PRINT(errs() << "\tRemoving PHI nodes\n");
+	removePhiNodes();
+
+	if(args.fSBOpt) {
+		VERBOSE_PRINT(errs() << "\tOptimising store buffers\n");
+		enableStoreBufferOptimisation();
+	}
+
+	if(!(args.fNoMMA)) {
+		memmodel->enableReport();
+
+		if(ArgPack::MMA_MODE_USE == args.mmaMode) {
+			VERBOSE_PRINT(errs() <<"\t\"--mma-mode\" is set to \"use\", setting up memory model\n");
+			memmodel->setUp(CtxM);
+		}
+
+		VERBOSE_PRINT(errs() << "\tPerforming DDDG memory model-based analysis and transform\n");
+		profile->performMemoryModelAnalysis();
+
+		if(ArgPack::MMA_MODE_GEN == args.mmaMode) {
+			memmodel->save(CtxM);
+			VERBOSE_PRINT(errs() <<"\t\"--mma-mode\" is set to \"gen\", halting now\n");
+			return false;
+		}
+	}
+
+	// Put the node latency using selected architecture as edge weights in the graph
+	VERBOSE_PRINT(errs() << "\tUpdating DDDG edges with operation latencies according to selected hardware\n");
+	bool nonNullFound = false;
+	EdgeIterator edgei, edgeEnd;
+	for(std::tie(edgei, edgeEnd) = boost::edges(graph); edgei != edgeEnd; edgei++) {
+		uint8_t weight = edgeToWeight[*edgei];
+
+		// XXX: Up to this point no control edges were added so far, I think
+		if(EDGE_CONTROL == weight) {
+			boost::put(boost::edge_weight, graph, *edgei, 0);
+		}
+		else {
+			unsigned nodeID = vertexToName[boost::source(*edgei, graph)];
+			unsigned opcode = microops.at(nodeID);
+			unsigned latency = profile->getLatency(opcode);
+			boost::put(boost::edge_weight, graph, *edgei, latency);
+
+			if(latency)
+				nonNullFound = true;
+		}
+	}
+	csrOutdated = true;
+
+	if(!nonNullFound) {
+		VERBOSE_PRINT(errs() << "\tThis DDDG has no latency\n");
+		return false;
+	}
+
+	VERBOSE_PRINT(errs() << "\tStarting ASAP scheduling\n");
+	asapResult = asapScheduling();
+
+	VERBOSE_PRINT(errs() << "\tStarting ALAP scheduling\n");
+	alapScheduling(asapResult);
+
+	VERBOSE_PRINT(errs() << "\tIdentifying critical paths\n");
+	identifyCriticalPaths();
+
+	return true;
+}
+
+std::tuple<uint64_t, uint64_t> BaseDatapath::restoreScheduledState() {
+	// Required resources are calculated from the ALAP schedule, before the DDDG optimisations (see alapScheduling())
+	std::map<uint64_t, std::set<unsigned>> alapTimesNodesMap(scheduledState->alapTimesNodesMap);
+	microops = scheduledState->alapMicroops;
+	profile->calculateRequiredResources(microops, CM.getArrayInfoCfgMap(), baseAddress, alapTimesNodesMap);
+
+	// Only the CSR snapshot of the optimised DDDG is kept in the state (see releaseDDDGEdges())
+	microops = scheduledState->microops;
+	Graph edgeless(scheduledState->csr.getNumNodes());
+	graph.swap(edgeless);
+	refreshDDDG();
+	csr = scheduledState->csr;
+	csrOutdated = false;
+	dddgEdgesReleased = true;
+
+	asapScheduledTime = scheduledState->asapScheduledTime;
+	alapScheduledTime = scheduledState->alapScheduledTime;
+	cPathNodes = scheduledState->cPathNodes;
+	loadDepMap = scheduledState->loadDepMap;
+	storeDepMap = scheduledState->storeDepMap;
+	sharedLoadsRemoved = scheduledState->sharedLoadsRemoved;
+	repeatedStoresRemoved = scheduledState->repeatedStoresRemoved;
+
+	return scheduledState->asapResult;
+}
+
+void BaseDatapath::captureScheduledState(std::tuple<uint64_t, uint64_t> asapResult) {
+	scheduledState->csr = csr;
+	scheduledState->microops = microops;
+	scheduledState->asapResult = asapResult;
+	scheduledState->asapScheduledTime = asapScheduledTime;
+	scheduledState->alapScheduledTime = alapScheduledTime;
+	scheduledState->cPathNodes = cPathNodes;
+	scheduledState->loadDepMap = loadDepMap;
+	scheduledState->storeDepMap = storeDepMap;
+	scheduledState->sharedLoadsRemoved = sharedLoadsRemoved;
+	scheduledState->repeatedStoresRemoved = repeatedStoresRemoved;
+
+	ScheduledDatapathState::insert(scheduledStateKey, scheduledState);
+}
+
 void BaseDatapath::removeInductionDependencies() {
-	const std::vector<std::string> &instID = PC.getInstIDList();
+	const std::vector<uint32_t> &instID = PC.getInstIDList();
 
 	std::vector<Vertex> topologicalSortedNodes;
 	boost::topological_sort(graph, std::back_inserter(topologicalSortedNodes));
@@ -710,7 +894,7 @@ void BaseDatapath::removeInductionDependencies() {
 	// Nodes with no incoming edges first
 	for(auto vi = topologicalSortedNodes.rbegin(); vi != topologicalSortedNodes.rend(); vi++) {
 		unsigned nodeID = vertexToName[*vi];
-		std::string nodeInstID = instID.at(nodeID);
+		const std::string &nodeInstID = symbolTable.getName(instID.at(nodeID));
 
 		if(nodeInstID.find("indvars") != std::string::npos) {
 #ifndef BYTE_OPS
@@ -729,7 +913,7 @@ void BaseDatapath::removeInductionDependencies() {
 			InEdgeIterator inEdgei, inEdgeEnd;
 			for(std::tie(inEdgei, inEdgeEnd) = boost::in_edges(*vi, graph); inEdgei != inEdgeEnd; inEdgei++) {
 				unsigned parentID = vertexToName[boost::source(*inEdgei, graph)];
-				std::string parentInstID = instID.at(parentID);
+				const std::string &parentInstID = symbolTable.getName(instID.at(parentID));
 
 				if(std::string::npos == parentInstID.find("indvars") && !isIndexOp(microops.at(parentID)))
 					continue;
@@ -795,9 +979,9 @@ void BaseDatapath::removePhiNodes() {
 }
 
 void BaseDatapath::enableStoreBufferOptimisation() {
-	const std::vector<std::string> &instID = PC.getInstIDList();
-	const std::vector<std::string> &dynamicMethodID = PC.getFuncList();
-	const std::vector<std::string> &prevBB = PC.getPrevBBList();
+	const std::vector<uint32_t> &instID = PC.getInstIDList();
+	const std::vector<uint32_t> &dynamicMethodID = PC.getFuncList();
+	const std::vector<uint32_t> &prevBB = PC.getPrevBBList();
 
 	std::vector<edgeTy> edgesToAdd;
 	std::vector<unsigned> nodesToRemove;
@@ -872,7 +1056,7 @@ void BaseDatapath::enableStoreBufferOptimisation() {
 
 void BaseDatapath::initScratchpadPartitions() {
 	const ConfigurationManager::partitionCfgMapTy &partitionMap = CM.getPartitionCfgMap();
-	const std::unordered_map<int, std::pair<int64_t, unsigned>> &memoryTraceList = PC.getMemoryTraceList();
+	const memoryTraceColumnTy &memoryTraceList = PC.getMemoryTraceList();
 
 	for(unsigned nodeID = 0; nodeID < numOfTotalNodes; nodeID++) {
 		if(!isMemoryOp(microops.at(nodeID)) || baseAddress.end() == baseAddress.find(nodeID))
@@ -952,9 +1136,9 @@ void BaseDatapath::performMemoryDisambiguation() {
 
 	std::unordered_multimap<std::string, std::string> loadStorePairs;
 	std::unordered_set<std::string> pairedStore;
-	const std::vector<std::string> &dynamicMethodID = PC.getFuncList();
-	const std::vector<std::string> &instID = PC.getInstIDList();
-	const std::vector<std::string> &prevBB = PC.getPrevBBList();
+	const std::vector<uint32_t> &dynamicMethodID = PC.getFuncList();
+	const std::vector<uint32_t> &instID = PC.getInstIDList();
+	const std::vector<uint32_t> &prevBB = PC.getPrevBBList();
 
 	std::vector<Vertex> topologicalSortedNodes;
 	boost::topological_sort(graph, std::back_inserter(topologicalSortedNodes));
@@ -977,11 +1161,11 @@ void BaseDatapath::performMemoryDisambiguation() {
 			if(!isLoadOp(childMicroop))
 				continue;
 
-			std::string nodeDynamicMethodID = dynamicMethodID.at(nodeID);
-			std::string childDynamicMethodID = dynamicMethodID.at(childID);
+			uint32_t nodeDynamicMethodID = dynamicMethodID.at(nodeID);
+			uint32_t childDynamicMethodID = dynamicMethodID.at(childID);
 
 			// Ignore if dynamic function names are different (either functions are different or different executions)
-			if(nodeDynamicMethodID.compare(childDynamicMethodID))
+			if(nodeDynamicMethodID != childDynamicMethodID)
 				continue;
 
 			std::string storeUniqueID = constructUniqueID(nodeDynamicMethodID, instID.at(nodeID), prevBB.at(nodeID));
@@ -1050,8 +1234,8 @@ void BaseDatapath::performMemoryDisambiguation() {
 					edgesToAdd.push_back({prevStoreID, nodeID, 255});
 					// XXX: This seems quite odd and I have not tested
 					// it->[first|second] is already a unique ID and we are appending one more element to it
-					dynamicMemoryOps.insert(it->second + "-" + prevBB.at(prevStoreID));
-					dynamicMemoryOps.insert(it->first + "-" + prevBB.at(nodeID));
+					dynamicMemoryOps.insert(it->second + "-" + symbolTable.getName(prevBB.at(prevStoreID)));
+					dynamicMemoryOps.insert(it->first + "-" + symbolTable.getName(prevBB.at(nodeID)));
 				}
 			}
 		}
@@ -1060,7 +1244,7 @@ void BaseDatapath::performMemoryDisambiguation() {
 }
 
 void BaseDatapath::removeSharedLoads() {
-	const std::unordered_map<int, std::pair<int64_t, unsigned>> &memoryTraceList = PC.getMemoryTraceList();
+	const memoryTraceColumnTy &memoryTraceList = PC.getMemoryTraceList();
 	std::set<Edge> edgesToRemove;
 	std::vector<edgeTy> edgesToAdd;
 	std::unordered_map<int64_t, unsigned> loadedAddresses;
@@ -1080,7 +1264,7 @@ void BaseDatapath::removeSharedLoads() {
 		// From this point only active store and loads are considered
 		// XXX: offchip not being considered
 
-		std::unordered_map<int, std::pair<int64_t, unsigned>>::const_iterator found = memoryTraceList.find(nodeID);
+		memoryTraceColumnTy::const_iterator found = memoryTraceList.find(nodeID);
 		assert(found != memoryTraceList.end() && "Storage operation found with no memory trace element");
 		std::unordered_map<int64_t, unsigned>::iterator found2 = loadedAddresses.find(found->second.first);
 
@@ -1120,10 +1304,10 @@ void BaseDatapath::removeSharedLoads() {
 }
 
 void BaseDatapath::removeRepeatedStores() {
-	const std::unordered_map<int, std::pair<int64_t, unsigned>> &memoryTraceList = PC.getMemoryTraceList();
-	const std::vector<std::string> &dynamicMethodID = PC.getFuncList();
-	const std::vector<std::string> &instID = PC.getInstIDList();
-	const std::vector<std::string> &prevBB = PC.getPrevBBList();
+	const memoryTraceColumnTy &memoryTraceList = PC.getMemoryTraceList();
+	const std::vector<uint32_t> &dynamicMethodID = PC.getFuncList();
+	const std::vector<uint32_t> &instID = PC.getInstIDList();
+	const std::vector<uint32_t> &prevBB = PC.getPrevBBList();
 	std::unordered_map<int64_t, unsigned> addressStoreMap;
 	repeatedStoresRemoved = 0;
 
@@ -1161,9 +1345,15 @@ void BaseDatapath::removeRepeatedStores() {
 
 void BaseDatapath::reduceTreeHeight(bool (&isAssociativeFunc)(unsigned)) {
 	std::vector<bool> visited(numOfTotalNodes, false);
-	std::set<Edge> edgesToRemove;
+	std::vector<Edge> edgesToRemove;
 	std::vector<edgeTy> edgesToAdd;
 
+	// Reused by all associative chains
+	std::vector<unsigned> nodes;
+	std::vector<unsigned> leaves;
+	std::vector<unsigned> associativeChain;
+	std::vector<std::pair<unsigned, unsigned>> rankHeap;
+
 	for(unsigned int nodeID = numOfTotalNodes - 1; nodeID + 1; nodeID--) {
 		if(nameToVertex.end() == nameToVertex.find(nodeID) || !boost::degree(nameToVertex[nodeID], graph))
 			continue;
@@ -1173,10 +1363,10 @@ void BaseDatapath::reduceTreeHeight(bool (&isAssociativeFunc)(unsigned)) {
 
 		visited.at(nodeID) = true;
 
-		std::list<unsigned> nodes;
-		std::vector<Edge> edgesToRemoveTmp;
-		std::vector<std::pair<unsigned, bool>> leaves;
-		std::vector<unsigned> associativeChain;
+		size_t numOfEdgesToRemove = edgesToRemove.size();
+		nodes.clear();
+		leaves.clear();
+		associativeChain.clear();
 
 		associativeChain.push_back(nodeID);
 		for(unsigned i = 0; i < associativeChain.size(); i++) {
@@ -1198,7 +1388,7 @@ void BaseDatapath::reduceTreeHeight(bool (&isAssociativeFunc)(unsigned)) {
 				}
 
 				if(2 == numOfChainParents) {
-					nodes.push_front(chainNodeID);
+					nodes.push_back(chainNodeID);
 
 					for(std::tie(inEdgei, inEdgeEnd) = boost::in_edges(nameToVertex[chainNodeID], graph); inEdgei != inEdgeEnd; inEdgei++) {
 						Vertex parentNode = boost::source(*inEdgei, graph);
@@ -1210,12 +1400,12 @@ void BaseDatapath::reduceTreeHeight(bool (&isAssociativeFunc)(unsigned)) {
 						if(isBranchOp(parentMicroop))
 							continue;
 
-						edgesToRemoveTmp.push_back(*inEdgei);
+						edgesToRemove.push_back(*inEdgei);
 
 						visited.at(parentID) = true;
 
 						if(!isAssociativeFunc(parentMicroop)) {
-							leaves.push_back(std::make_pair(parentID, false));
+							leaves.push_back(parentID);
 						}
 						else {
 							int numOfChildren = 0;
@@ -1228,50 +1418,44 @@ void BaseDatapath::reduceTreeHeight(bool (&isAssociativeFunc)(unsigned)) {
 							if(1 == numOfChildren)
 								associativeChain.push_back(parentID);
 							else
-								leaves.push_back(std::make_pair(parentID, false));
+								leaves.push_back(parentID);
 						}
 					}
 				}
 				else {
-					leaves.push_back(std::make_pair(chainNodeID, false));
+					leaves.push_back(chainNodeID);
 				}
 			}
 			else {
-				leaves.push_back(std::make_pair(chainNodeID, false));
+				leaves.push_back(chainNodeID);
 			}
 		}
 
-		if(nodes.size() < 3)
+		if(nodes.size() < 3) {
+			edgesToRemove.resize(numOfEdgesToRemove);
 			continue;
+		}
 
-		for(auto &it : edgesToRemoveTmp)
-			edgesToRemove.insert(it);
-
-		std::map<unsigned, unsigned> rankMap;
+		// A leaf may feed more than one input of the chain
+		std::sort(leaves.begin(), leaves.end());
+		leaves.erase(std::unique(leaves.begin(), leaves.end()), leaves.end());
 
+		rankHeap.clear();
 		for(auto &it : leaves)
-			rankMap[it.first] = (it.second)? numOfTotalNodes : 0;
+			rankHeap.push_back(std::make_pair(0, it));
+		std::make_heap(rankHeap.begin(), rankHeap.end(), std::greater<std::pair<unsigned, unsigned>>());
 
-		for(auto &it : nodes) {
+		// Chain nodes are paired from the closest to the chain root
+		for(std::vector<unsigned>::reverse_iterator it = nodes.rbegin(); it != nodes.rend(); it++) {
 			std::pair<unsigned, unsigned> nodePair;
-
-			if(2 == rankMap.size()) {
-				nodePair.first = rankMap.begin()->first;
-				nodePair.second = (++(rankMap.begin()))->first;
-			}
-			else {
-				findMinimumRankPair(nodePair, rankMap);
-			}
-
-			assert(nodePair.first != numOfTotalNodes && nodePair.second != numOfTotalNodes);
+			unsigned maxRank = findMinimumRankPair(nodePair, rankHeap);
 
 			// TODO: maybe a meaningful weight here?
-			edgesToAdd.push_back({nodePair.first, it, 1});
-			edgesToAdd.push_back({nodePair.second, it, 1});
+			edgesToAdd.push_back({nodePair.first, *it, 1});
+			edgesToAdd.push_back({nodePair.second, *it, 1});
 
-			rankMap[it] = std::max(rankMap[nodePair.first], rankMap[nodePair.second]) + 1;
-			rankMap.erase(nodePair.first);
-			rankMap.erase(nodePair.second);
+			rankHeap.push_back(std::make_pair(maxRank + 1, *it));
+			std::push_heap(rankHeap.begin(), rankHeap.end(), std::greater<std::pair<unsigned, unsigned>>());
 		}
 	}
 
@@ -1279,11 +1463,11 @@ void BaseDatapath::reduceTreeHeight(bool (&isAssociativeFunc)(unsigned)) {
 	updateAddDDDGEdges(edgesToAdd);
 }
 
-std::string BaseDatapath::constructUniqueID(std::string funcID, std::string instID, std::string bbID) {
+std::string BaseDatapath::constructUniqueID(uint32_t funcID, uint32_t instID, uint32_t bbID) {
 #ifdef LEGACY_SEPARATOR
-	return funcID + "-" + instID + "-" + bbID;
+	return symbolTable.getName(funcID) + "-" + symbolTable.getName(instID) + "-" + symbolTable.getName(bbID);
 #else
-	return funcID + GLOBAL_SEPARATOR + instID + GLOBAL_SEPARATOR + bbID;
+	return symbolTable.getName(funcID) + GLOBAL_SEPARATOR + symbolTable.getName(instID) + GLOBAL_SEPARATOR + symbolTable.getName(bbID);
 #endif
 }
 
@@ -1299,8 +1483,7 @@ std::tuple<uint64_t, uint64_t> BaseDatapath::asapScheduling() {
 	std::set<unsigned> visitedNodes;
 #endif
 
-	std::vector<Vertex> topologicalSortedNodes;
-	boost::topological_sort(graph, std::back_inserter(topologicalSortedNodes));
+	const CSRGraph &csr = getCSR();
 
 	// TODO: this loop was iterated with a node index only and it worked
 	// since the "virgin" DDDG is naturally topologically sorted.
@@ -1308,13 +1491,10 @@ std::tuple<uint64_t, uint64_t> BaseDatapath::asapScheduling() {
 	// To avoid that, another approach would maintain the DDDG unchanged in terms of nodes.
 	// This is possible by creating composite nodes, such as DDRWriteReq+DDRWrite and DDRWrite+DDRWriteResp
 	// for example.
-	for(auto vi = topologicalSortedNodes.rbegin(); vi != topologicalSortedNodes.rend(); vi++) {
-		Vertex currNode = *vi;
-		unsigned nodeID = vertexToName[currNode];
-
+	for(auto &nodeID : csr.getTopologicalOrder()) {
 		// Set scheduled time to 0 to root nodes
-		if(!boost::in_degree(currNode, graph)) {
-			asapScheduledTime[currNode] = 0;
+		if(!csr.inDegree(nodeID)) {
+			asapScheduledTime[nodeID] = 0;
 #ifdef CHECK_VISITED_NODES
 			visitedNodes.insert(nodeID);
 #endif
@@ -1322,10 +1502,9 @@ std::tuple<uint64_t, uint64_t> BaseDatapath::asapScheduling() {
 		}
 
 		unsigned maxCurrStartTime = 0;
-		InEdgeIterator inEdgei, inEdgeEnd;
 		// Evaluate all incoming edges. Save the largest incoming time considering scheduled time of parents + the edge weight
-		for(std::tie(inEdgei, inEdgeEnd) = boost::in_edges(currNode, graph); inEdgei != inEdgeEnd; inEdgei++) {
-			unsigned parentNodeID = vertexToName[boost::source(*inEdgei, graph)];
+		for(const CSRGraph::edgeRefTy *inEdge = csr.inBegin(nodeID); inEdge != csr.inEnd(nodeID); inEdge++) {
+			unsigned parentNodeID = inEdge->node;
 			unsigned parentOpcode = microops.at(parentNodeID);
 #ifdef CHECK_VISITED_NODES
 			assert(visitedNodes.find(parentNodeID) != visitedNodes.end() && "Node was not yet visited!");
@@ -1345,7 +1524,7 @@ std::tuple<uint64_t, uint64_t> BaseDatapath::asapScheduling() {
 			if(LLVM_IR_DDRReadReq == parentOpcode) memmodel->addToLoadDepMap(nodeID, parentNodeID);
 			if(LLVM_IR_DDRWriteReq == parentOpcode) memmodel->addToStoreDepMap(nodeID, parentNodeID);
 
-			unsigned currNodeStartTime = asapScheduledTime[parentNodeID] + edgeToWeight[*inEdgei];
+			unsigned currNodeStartTime = asapScheduledTime[parentNodeID] + inEdge->weight;
 			if(currNodeStartTime > maxCurrStartTime)
 				maxCurrStartTime = currNodeStartTime;
 		}
@@ -1392,16 +1571,15 @@ void BaseDatapath::alapScheduling(std::tuple<uint64_t, uint64_t> asapResult) {
 	std::set<unsigned> visitedNodes;
 #endif
 
-	std::vector<Vertex> topologicalSortedNodes;
-	boost::topological_sort(graph, std::back_inserter(topologicalSortedNodes));
+	const CSRGraph &csr = getCSR();
+	const std::vector<unsigned> &topologicalOrder = csr.getTopologicalOrder();
 
 	// TODO: See the same loop from asap for more info
-	for(auto vi = topologicalSortedNodes.begin(); vi != topologicalSortedNodes.end(); vi++) {
-		Vertex currNode = *vi;
-		unsigned nodeID = vertexToName[currNode];
+	for(auto vi = topologicalOrder.rbegin(); vi != topologicalOrder.rend(); vi++) {
+		unsigned nodeID = *vi;
 
 		// Set scheduled time to maximum time from ASAP to leaf nodes
-		if(!boost::out_degree(currNode, graph)) {
+		if(!csr.outDegree(nodeID)) {
 			alapScheduledTime[nodeID] = std::get<1>(asapResult);
 
 #ifdef CHECK_VISITED_NODES
@@ -1412,14 +1590,13 @@ void BaseDatapath::alapScheduling(std::tuple<uint64_t, uint64_t> asapResult) {
 
 		// Initialise minimum time with the result of ASAP
 		unsigned minCurrStartTime = std::get<1>(asapResult);
-		OutEdgeIterator outEdgei, outEdgeEnd;
 		// Evaluate all outcoming edges. Save the smallest outcoming time considering scheduled time of childs - the edge weight
-		for(std::tie(outEdgei, outEdgeEnd) = boost::out_edges(currNode, graph); outEdgei != outEdgeEnd; outEdgei++) {
-			unsigned childNodeID = vertexToName[boost::target(*outEdgei, graph)];
+		for(const CSRGraph::edgeRefTy *outEdge = csr.outBegin(nodeID); outEdge != csr.outEnd(nodeID); outEdge++) {
+			unsigned childNodeID = outEdge->node;
 #ifdef CHECK_VISITED_NODES
 			assert(visitedNodes.find(childNodeID) != visitedNodes.end() && "Node was not yet visited!");
 #endif
-			unsigned currNodeStartTime = alapScheduledTime[childNodeID] - edgeToWeight[*outEdgei];
+			unsigned currNodeStartTime = alapScheduledTime[childNodeID] - outEdge->weight;
 			if(currNodeStartTime < minCurrStartTime)
 				minCurrStartTime = currNodeStartTime;
 		}
@@ -1438,9 +1615,8 @@ void BaseDatapath::alapScheduling(std::tuple<uint64_t, uint64_t> asapResult) {
 		// if it doesn't violate ASAP. 0-latency nodes can always be executed within a cycle regardless of timing budget,
 		// which means they will be allocated to the same cycle as the dummy cycle (as late as possible). Since the dummy
 		// cycle does not actually exist, it makes no sense to leave the 0-latency nodes with it. So we bring it back.
-		InEdgeIterator inEdgei, inEdgeEnd;
-		for(std::tie(inEdgei, inEdgeEnd) = boost::in_edges(dummySink, graph); inEdgei != inEdgeEnd; inEdgei++) {
-			unsigned parentNodeID = vertexToName[boost::source(*inEdgei, graph)];
+		for(const CSRGraph::edgeRefTy *inEdge = csr.inBegin(dummySink); inEdge != csr.inEnd(dummySink); inEdge++) {
+			unsigned parentNodeID = inEdge->node;
 
 			if(!(profile->getLatency(microops.at(parentNodeID)))) {
 				unsigned minCurrStartTime = alapScheduledTime[parentNodeID];
@@ -1457,12 +1633,19 @@ void BaseDatapath::alapScheduling(std::tuple<uint64_t, uint64_t> asapResult) {
 	const ConfigurationManager::arrayInfoCfgMapTy &arrayInfoCfgMap = CM.getArrayInfoCfgMap();
 	profile->calculateRequiredResources(microops, arrayInfoCfgMap, baseAddress, minTimesNodesMap);
 
+	// Later design points recover the required resources from these (see restoreScheduledState())
+	if(scheduledState) {
+		scheduledState->alapMicroops = microops;
+		scheduledState->alapTimesNodesMap.swap(minTimesNodesMap);
+	}
+
 	std::map<uint64_t, std::set<unsigned>>().swap(minTimesNodesMap);
 
 	P.clear();
 	profile->fillPack(P, loopLevel, datapathType, 0);
-	for(auto &it : P.getStructure()) {
-		std::string name = std::get<0>(it);
+	const std::vector<Pack::descriptorTy> &structure = P.getStructure();
+	for(unsigned fieldID = 0; fieldID < structure.size(); fieldID++) {
+		const std::string &name = std::get<0>(structure[fieldID]);
 
 		// Names starting with "_" are not printed (used for other purposes)
 		if('_' == name[0])
@@ -1470,18 +1653,18 @@ void BaseDatapath::alapScheduling(std::tuple<uint64_t, uint64_t> asapResult) {
 
 		VERBOSE_PRINT(errs() << "\t\t" << name << ": ");
 
-		switch(std::get<2>(it)) {
+		switch(std::get<2>(structure[fieldID])) {
 			case Pack::TYPE_UNSIGNED:
-				VERBOSE_PRINT(errs() << std::to_string(P.getElements<uint64_t>(name)[0]) << "\n");
+				VERBOSE_PRINT(errs() << std::to_string(P.getElements<uint64_t>(fieldID)[0]) << "\n");
 				break;
 			case Pack::TYPE_SIGNED:
-				VERBOSE_PRINT(errs() << std::to_string(P.getElements<int64_t>(name)[0]) << "\n");
+				VERBOSE_PRINT(errs() << std::to_string(P.getElements<int64_t>(fieldID)[0]) << "\n");
 				break;
 			case Pack::TYPE_FLOAT:
-				VERBOSE_PRINT(errs() << std::to_string(P.getElements<float>(name)[0]) << "\n");
+				VERBOSE_PRINT(errs() << std::to_string(P.getElements<float>(fieldID)[0]) << "\n");
 				break;
 			case Pack::TYPE_STRING:
-				VERBOSE_PRINT(errs() << P.getElements<std::string>(name)[0] << "\n");
+				VERBOSE_PRINT(errs() << P.getElements<std::string>(fieldID)[0] << "\n");
 				break;
 		}
 	}
@@ -1499,8 +1682,9 @@ void BaseDatapath::identifyCriticalPaths() {
 
 	// After calculating ASAP and ALAP, the critical path is defined by the nodes that have the same scheduled time on both
 	// (i.e. no operation mobility / slack)
+	const CSRGraph &csr = getCSR();
 	for(unsigned nodeID = 0; nodeID < numOfTotalNodes; nodeID++) {
-		if(!boost::degree(nameToVertex[nodeID], graph))
+		if(!csr.degree(nodeID))
 			continue;
 
 		if(asapScheduledTime[nodeID] == alapScheduledTime[nodeID])
@@ -1516,23 +1700,60 @@ std::pair<uint64_t, double> BaseDatapath::rcScheduling() {
 	// initScratchpadPartitions() generated more stuff that we do not use in Lina. Thus it was reduced to process only what we need
 	VERBOSE_PRINT(errs() << "\t\tUpdating base address database\n");
 	initScratchpadPartitions();
-	VERBOSE_PRINT(errs() << "\t\tOptimising DDDG\n");
-	optimiseDDDG();
+	// A recovered DDDG is already optimised
+	if(!scheduledStateRestored) {
+		VERBOSE_PRINT(errs() << "\t\tOptimising DDDG\n");
+		optimiseDDDG();
+	}
 
 	if(args.showPostOptDDDG)
 		dumpGraph(true);
 
+	// No more DDDG transforms from this point on
+	releaseDDDGEdges();
+
 	rcScheduledTime.assign(numOfTotalNodes, 0);
 
 	profile->constrainHardware(CM.getArrayInfoCfgMap(), CM.getPartitionCfgMap(), CM.getCompletePartitionCfgMap());
 
+	std::shared_ptr<const ScheduledDatapathState::freeScheduleTy> freeSchedule = scheduledState? scheduledState->getFreeSchedule() : nullptr;
+	if(freeSchedule) {
+		// The replay is performed on a copy, so that a rejected allocation leaves the constrained profile untouched
+		HardwareProfile *replayProfile = profile->clone();
+
+		if(ScheduledDatapathState::replay(*freeSchedule, *replayProfile, microops, baseAddress)) {
+			VERBOSE_PRINT(errs() << "\t\tResource constraints do not bind, recovering schedule from a previous design point\n");
+
+			delete profile;
+			profile = replayProfile;
+			rcScheduledTime = freeSchedule->rcScheduledTime;
+
+			VERBOSE_PRINT(errs() << "\t\tResource-constrained scheduling finished\n");
+			return std::make_pair(freeSchedule->rcIL, freeSchedule->achievedPeriod);
+		}
+
+		delete replayProfile;
+	}
+
+	std::vector<allocationEventTy> allocationLog;
 	RCScheduler rcSched(
 		loopName, loopLevel, datapathType,
-		microops, PC.getResultSizeList(), graph, numOfTotalNodes, nameToVertex, vertexToName,
-		*profile, baseAddress, asapScheduledTime, alapScheduledTime, rcScheduledTime
+		microops, PC.getResultSizeList(), getCSR(), numOfTotalNodes,
+		*profile, baseAddress, asapScheduledTime, alapScheduledTime, rcScheduledTime,
+		scheduledState? &allocationLog : nullptr
 	);
 	std::pair<uint64_t, double> rcPair = rcSched.schedule();
 
+	// A schedule that was never limited by resources is the same for any constraints that fit its allocations
+	if(scheduledState && !freeSchedule && !(rcSched.isResourceConstrained())) {
+		std::shared_ptr<ScheduledDatapathState::freeScheduleTy> newFreeSchedule = std::make_shared<ScheduledDatapathState::freeScheduleTy>();
+		newFreeSchedule->rcScheduledTime = rcScheduledTime;
+		newFreeSchedule->rcIL = rcPair.first;
+		newFreeSchedule->achievedPeriod = rcPair.second;
+		newFreeSchedule->allocationLog.swap(allocationLog);
+		scheduledState->setFreeSchedule(newFreeSchedule);
+	}
+
 	VERBOSE_PRINT(errs() << "\t\tResource-constrained scheduling finished\n");
 	return rcPair;
 }
@@ -1590,8 +1811,9 @@ std::tuple<std::string, uint64_t> BaseDatapath::calculateResIIMemPort() {
 	}
 
 	std::map<uint64_t, std::vector<unsigned>> rcToNodes;
+	const CSRGraph &csr = getCSR();
 	for(unsigned nodeID = 0; nodeID < numOfTotalNodes; nodeID++) {
-		if(!boost::degree(nameToVertex[nodeID], graph))
+		if(!csr.degree(nodeID))
 			continue;
 
 		rcToNodes[rcScheduledTime[nodeID]].push_back(nodeID);
@@ -1914,6 +2136,9 @@ std::tuple<std::string, uint64_t> BaseDatapath::calculateResIIMemRec() {
 }
 
 uint64_t BaseDatapath::calculateRecII(uint64_t currAsapII) {
+	if(enablePipelining && !(args.fRecIIUnroll))
+		return calculateRecIIFromCycleRatio(currAsapII);
+
 	if(enablePipelining) {
 		int64_t sub = (int64_t) (asapII - currAsapII);
 
@@ -1971,6 +2196,71 @@ uint64_t BaseDatapath::calculateRecII(uint64_t currAsapII) {
 	}
 }
 
+uint64_t BaseDatapath::calculateRecIIFromCycleRatio(uint64_t currAsapII) {
+	if(nodeIterations.empty()) {
+		VERBOSE_PRINT(errs() << "\tNo loop iteration information available, assuming no recurrence\n");
+		return 1;
+	}
+
+	const std::vector<uint32_t> &instID = PC.getInstIDList();
+	unsigned numOfNodes = nodeIterations.size();
+	unsigned numOfIterations = nodeIterations.back() + 1;
+
+	// Fold the DDDG into one loop iteration: nodes executing the same instruction (and the same occurrence of it
+	// within their iterations) are the same node of the loop body
+	std::vector<unsigned> foldedNodes(numOfNodes);
+	std::unordered_map<uint64_t, unsigned> identity2FoldedNode;
+	std::unordered_map<uint32_t, unsigned> occurrences;
+	for(unsigned i = 0; i < numOfNodes; i++) {
+		if(i && nodeIterations[i] != nodeIterations[i - 1])
+			occurrences.clear();
+
+		uint64_t identity = (((uint64_t) instID.at(i)) << 32) | occurrences[instID.at(i)]++;
+		unsigned newFoldedNode = identity2FoldedNode.size();
+		foldedNodes[i] = identity2FoldedNode.insert(std::make_pair(identity, newFoldedNode)).first->second;
+	}
+
+	// Edges inside the DDDG cross as many iterations as between their nodes. Nodes created after the DDDG build (e.g.
+	// dummy sink and artificial nodes) are not part of any iteration and are ignored
+	MaxCycleRatio cycleRatio(identity2FoldedNode.size());
+	const CSRGraph &csr = getCSR();
+	for(unsigned source = 0; source < numOfNodes; source++) {
+		for(const CSRGraph::edgeRefTy *outEdge = csr.outBegin(source); outEdge != csr.outEnd(source); outEdge++) {
+			unsigned target = outEdge->node;
+			if(target >= numOfNodes || nodeIterations[target] < nodeIterations[source])
+				continue;
+
+			cycleRatio.addEdge(foldedNodes[source], foldedNodes[target], outEdge->weight, nodeIterations[target] - nodeIterations[source]);
+		}
+	}
+
+	// Dependencies into the iteration after the DDDG close the recurrences. Sources removed by the optimisations (i.e.
+	// isolated nodes) are ignored
+	for(auto &it : carriedEdges) {
+		if(!(csr.degree(it.source)))
+			continue;
+
+		cycleRatio.addEdge(foldedNodes[it.source], foldedNodes[it.sink], profile->getLatency(microops.at(it.source)), it.distance);
+	}
+
+	uint64_t weight, distance;
+	switch(cycleRatio.solve(weight, distance)) {
+		case MaxCycleRatio::NO_CYCLE:
+			return 1;
+		case MaxCycleRatio::ZERO_DISTANCE_CYCLE:
+			// Iterations of this loop do not execute the same instructions, the DDDG cannot be folded into one iteration.
+			// Without a recurrence, iterations do not overlap, which is always safe
+			VERBOSE_PRINT(errs() << "\tLoop iterations could not be folded, recurrence-constrained II is the iteration latency\n");
+			return currAsapII? currAsapII : 1;
+		default: {
+			// Each pipelined iteration of the DDDG executes numOfIterations loop iterations
+			uint64_t recII = (numOfIterations * weight + distance - 1) / distance;
+			VERBOSE_PRINT(errs() << "\tCritical recurrence: latency " << std::to_string(weight) << " over " << std::to_string(distance) << " iterations\n");
+			return recII? recII : 1;
+		}
+	}
+}
+
 uint64_t BaseDatapath::getLoopTotalLatency(uint64_t maxII) {
 	uint64_t noPipelineLatency = 0, pipelinedLatency = 0;
 
@@ -2227,67 +2517,62 @@ void BaseDatapath::dumpSummary(
 	/* XXX Resource estimation! */
 
 	// Finalise shared resources calculation
-	unsigned sharedFU = 0;
-	unsigned sharedDSP = 0;
-	unsigned sharedFF = 0;
-	unsigned sharedLUT = 0;
-#ifdef LEGACY_SEPARATOR
-	std::string value = P.mergeElements<Pack::resourceNodeTy>("_shared~fadd");
-#else
-	std::string value = P.mergeElements<Pack::resourceNodeTy>("_shared" GLOBAL_SEPARATOR "fadd");
-#endif
-	// Unpacking the values from the string. Each variable has 10 characters allocated
-	// I know this is ugly, please don't kill me...
-	sharedFU += stol(value.substr(0, 10));
-	sharedDSP += stol(value.substr(10, 10));
-	sharedFF += stol(value.substr(20, 10));
-	sharedLUT += stol(value.substr(30, 10));
 #ifdef LEGACY_SEPARATOR
-	value = P.mergeElements<Pack::resourceNodeTy>("_shared~fsub");
+	Pack::resourceNodeTy fAddResources = P.aggregateResources("_shared~fadd");
+	Pack::resourceNodeTy fSubResources = P.aggregateResources("_shared~fsub");
+	Pack::resourceNodeTy fMulResources = P.aggregateResources("_shared~fmul");
+	Pack::resourceNodeTy fDivResources = P.aggregateResources("_shared~fdiv");
 #else
-	std::string value = P.mergeElements<Pack::resourceNodeTy>("_shared" GLOBAL_SEPARATOR "fsub");
+	Pack::resourceNodeTy fAddResources = P.aggregateResources("_shared" GLOBAL_SEPARATOR "fadd");
+	Pack::resourceNodeTy fSubResources = P.aggregateResources("_shared" GLOBAL_SEPARATOR "fsub");
+	Pack::resourceNodeTy fMulResources = P.aggregateResources("_shared" GLOBAL_SEPARATOR "fmul");
+	Pack::resourceNodeTy fDivResources = P.aggregateResources("_shared" GLOBAL_SEPARATOR "fdiv");
 #endif
-	sharedFU += stol(value.substr(0, 10));
-	sharedDSP += stol(value.substr(10, 10));
-	sharedFF += stol(value.substr(20, 10));
-	sharedLUT += stol(value.substr(30, 10));
-#ifdef LEGACY_SEPARATOR
-	value = P.mergeElements<Pack::resourceNodeTy>("_shared~fmul");
-#else
-	std::string value = P.mergeElements<Pack::resourceNodeTy>("_shared" GLOBAL_SEPARATOR "fmul");
-#endif
-	sharedFU += stol(value.substr(0, 10));
-	sharedDSP += stol(value.substr(10, 10));
-	sharedFF += stol(value.substr(20, 10));
-	sharedLUT += stol(value.substr(30, 10));
-#ifdef LEGACY_SEPARATOR
-	value = P.mergeElements<Pack::resourceNodeTy>("_shared~fdiv");
-#else
-	std::string value = P.mergeElements<Pack::resourceNodeTy>("_shared" GLOBAL_SEPARATOR "fdiv");
-#endif
-	sharedFU += stol(value.substr(0, 10));
-	sharedDSP += stol(value.substr(10, 10));
-	sharedFF += stol(value.substr(20, 10));
-	sharedLUT += stol(value.substr(30, 10));
+	unsigned sharedFU = fAddResources.fus + fSubResources.fus + fMulResources.fus + fDivResources.fus;
+	unsigned sharedDSP = fAddResources.dsps + fSubResources.dsps + fMulResources.dsps + fDivResources.dsps;
+	unsigned sharedFF = fAddResources.ffs + fSubResources.ffs + fMulResources.ffs + fDivResources.ffs;
+	unsigned sharedLUT = fAddResources.luts + fSubResources.luts + fMulResources.luts + fDivResources.luts;
+
+	// One unit of each functional unit type in use, for the resource floor
+	unsigned floorFU = 0;
+	unsigned floorDSP = 0;
+	unsigned floorFF = 0;
+	unsigned floorLUT = 0;
+	for(const Pack::resourceNodeTy *it : {&fAddResources, &fSubResources, &fMulResources, &fDivResources}) {
+		if(it->fus) {
+			floorFU++;
+			floorDSP += it->dsps / it->fus;
+			floorFF += it->ffs / it->fus;
+			floorLUT += it->luts / it->fus;
+		}
+	}
 
 	// Finalise unshared resources calculation
 	unsigned unsharedFU = 0;
 	unsigned unsharedDSP = 0;
 	unsigned unsharedFF = 0;
 	unsigned unsharedLUT = 0;
-	for(auto &it : P.getStructure()) {
-		std::string name = std::get<0>(it);
+	const std::vector<Pack::descriptorTy> &structure = P.getStructure();
+	for(unsigned fieldID = 0; fieldID < structure.size(); fieldID++) {
+		const std::string &name = std::get<0>(structure[fieldID]);
 
 #ifdef LEGACY_SEPARATOR
 		if(!(name.compare(0, 10, "_unshared~"))) {
 #else
 		if(!(name.compare(0, 10, "_unshared" GLOBAL_SEPARATOR))) {
 #endif
-			value = P.mergeElements<Pack::resourceNodeTy>(name);
-			unsharedFU += stol(value.substr(0, 10));
-			unsharedDSP += stol(value.substr(10, 10));
-			unsharedFF += stol(value.substr(20, 10));
-			unsharedLUT += stol(value.substr(30, 10));
+			Pack::resourceNodeTy resources = P.aggregateResources(fieldID);
+			unsharedFU += resources.fus;
+			unsharedDSP += resources.dsps;
+			unsharedFF += resources.ffs;
+			unsharedLUT += resources.luts;
+
+			if(resources.fus) {
+				floorFU++;
+				floorDSP += resources.dsps / resources.fus;
+				floorFF += resources.ffs / resources.fus;
+				floorLUT += resources.luts / resources.fus;
+			}
 		}
 	}
 
@@ -2306,16 +2591,36 @@ void BaseDatapath::dumpSummary(
 	assert("true" == P.mergeElements<uint64_t>("_memlogicLUT") && "Merged values from datapaths differ where it should not differ (_memlogicLUT)");
 	unsigned mlLUT = P.getElements<uint64_t>("_memlogicLUT")[0];
 
-	uint64_t nStore = stol(P.mergeElements<uint64_t>("_nStore"));
-	uint64_t nLoad = stol(P.mergeElements<uint64_t>("_nLoad"));
+	uint64_t nStore = P.aggregate<uint64_t>("_nStore");
+	uint64_t nLoad = P.aggregate<uint64_t>("_nLoad");
 	uint64_t nOp = sharedFU + unsharedFU;
-	uint64_t tRcIL = stol(P.mergeElements<uint64_t>("_tRcIL"));
+	uint64_t tRcIL = P.aggregate<uint64_t>("_tRcIL");
 	unsigned lK = LpName2numLevelMap.at(loopName);
 	unsigned e = logNextPowerOf2(loopBound);
 	unsigned V1 = e + 1, V2 = 2 * e, V3 = e + 2;
 
-	for(auto &it : P.getStructure()) {
-		std::string name = std::get<0>(it);
+	// Use all unrolls
+	loopName2levelUnrollVecMapTy::iterator found2 = loopName2levelUnrollVecMap.find(loopName);
+	assert(found2 != loopName2levelUnrollVecMap.end() && "Could not find loop in loopName2levelUnrollVecMap");
+	std::vector<unsigned> targetUnroll = found2->second;
+	uint64_t accUnrollFactor = 1;
+	for(unsigned i = loopLevel - 1; i + 1; i--)
+		accUnrollFactor *= targetUnroll.at(i);
+
+	unsigned rFF = 32 * (nLoad + nStore + nOp) + tRcIL + (1 == lK? 1 : 2) * V1 * lK;
+	unsigned mLUT = 32 * (nStore + nOp) + 14 * nLoad + V1 * lK;
+	unsigned exLUT = (V1 + V2 + V3) * lK + V1 * (accUnrollFactor - 1);
+
+	estimatedResources.dsp = sharedDSP + unsharedDSP;
+	estimatedResources.ff = sharedFF + unsharedFF + rFF + mlFF;
+	estimatedResources.lut = sharedLUT + unsharedLUT + mLUT + exLUT + mlLUT;
+	estimatedResources.bram18k = P.getElements<uint64_t>("BRAM18k")[0];
+	estimatedResources.floorDSP = floorDSP;
+	estimatedResources.floorFF = floorFF + 32 * floorFU + (1 == lK? 1 : 2) * V1 * lK;
+	estimatedResources.floorLUT = floorLUT + 32 * floorFU + V1 * lK + exLUT;
+
+	for(unsigned fieldID = 0; fieldID < structure.size(); fieldID++) {
+		const std::string &name = std::get<0>(structure[fieldID]);
 
 		// Names starting with "_" are not printed (used for other purposes)
 		if('_' == name[0])
@@ -2323,49 +2628,32 @@ void BaseDatapath::dumpSummary(
 
 		// Special treament for certain merges (other arithmetics are performed instead of simple merge)
 		if("DSPs" == name) {
-			uint64_t value = sharedDSP + unsharedDSP;
-
-			*summaryFile << name << ": " << value << "\n";
+			*summaryFile << name << ": " << estimatedResources.dsp << "\n";
 			continue;
 		}
 		else if("FFs" == name) {
-			unsigned rFF = 32 * (nLoad + nStore + nOp) + tRcIL + (1 == lK? 1 : 2) * V1 * lK;
-			uint64_t value = sharedFF + unsharedFF + rFF + mlFF;
-
-			*summaryFile << name << ": " << value << "\n";
+			*summaryFile << name << ": " << estimatedResources.ff << "\n";
 			continue;
 		}
 		else if("LUTs" == name) {
-			unsigned mLUT = 32 * (nStore + nOp) + 14 * nLoad + V1 * lK;
-			// Use all unrolls
-			loopName2levelUnrollVecMapTy::iterator found2 = loopName2levelUnrollVecMap.find(loopName);
-			assert(found2 != loopName2levelUnrollVecMap.end() && "Could not find loop in loopName2levelUnrollVecMap");
-			std::vector<unsigned> targetUnroll = found2->second;
-			uint64_t accUnrollFactor = 1;
-			for(unsigned i = loopLevel - 1; i + 1; i--)
-				accUnrollFactor *= targetUnroll.at(i);
-			unsigned exLUT = (V1 + V2 + V3) * lK + V1 * (accUnrollFactor - 1);
-
-			uint64_t value = sharedLUT + unsharedLUT + mLUT + exLUT + mlLUT;
-
-			*summaryFile << name << ": " << value << "\n";
+			*summaryFile << name << ": " << estimatedResources.lut << "\n";
 			continue;
 		}
 
 		*summaryFile << name << ": ";
 
-		switch(std::get<2>(it)) {
+		switch(std::get<2>(structure[fieldID])) {
 			case Pack::TYPE_UNSIGNED:
-				*summaryFile << std::to_string(P.getElements<uint64_t>(std::get<0>(it))[0]) << "\n";
+				*summaryFile << std::to_string(P.getElements<uint64_t>(fieldID)[0]) << "\n";
 				break;
 			case Pack::TYPE_SIGNED:
-				*summaryFile << std::to_string(P.getElements<int64_t>(std::get<0>(it))[0]) << "\n";
+				*summaryFile << std::to_string(P.getElements<int64_t>(fieldID)[0]) << "\n";
 				break;
 			case Pack::TYPE_FLOAT:
-				*summaryFile << std::to_string(P.getElements<float>(std::get<0>(it))[0]) << "\n";
+				*summaryFile << std::to_string(P.getElements<float>(fieldID)[0]) << "\n";
 				break;
 			case Pack::TYPE_STRING:
-				*summaryFile << P.getElements<std::string>(std::get<0>(it))[0] << "\n";
+				*summaryFile << P.getElements<std::string>(fieldID)[0] << "\n";
 				break;
 		}
 	}
@@ -2385,17 +2673,22 @@ void BaseDatapath::dumpGraph(bool isOptimised) {
 
 	std::vector<std::string> functionNames;
 	for(auto &it : PC.getFuncList()) {
+		const std::string &dynamicFunction = symbolTable.getName(it);
 #ifdef LEGACY_SEPARATOR
-		size_t tagPos = it.find("-");
+		size_t tagPos = dynamicFunction.find("-");
 #else
-		size_t tagPos = it.find(GLOBAL_SEPARATOR);
+		size_t tagPos = dynamicFunction.find(GLOBAL_SEPARATOR);
 #endif
-		std::string functionName = it.substr(0, tagPos);
+		std::string functionName = dynamicFunction.substr(0, tagPos);
 
 		functionNames.push_back(functionName);
 	}
 
-	ColorWriter colorWriter(graph, vertexToName, PC.getCurrBBList(), functionNames, microops, bbFuncNamePair2lpNameLevelPairMap);
+	std::vector<std::string> bbNames;
+	for(auto &it : PC.getCurrBBList())
+		bbNames.push_back(symbolTable.getName(it));
+
+	ColorWriter colorWriter(graph, vertexToName, bbNames, functionNames, microops, bbFuncNamePair2lpNameLevelPairMap);
 	EdgeColorWriter edgeColorWriter(graph, edgeToWeight);
 	write_graphviz(out, graph, colorWriter, edgeColorWriter);
 
@@ -2404,18 +2697,17 @@ void BaseDatapath::dumpGraph(bool isOptimised) {
 
 BaseDatapath::RCScheduler::RCScheduler(
 	const std::string loopName, const unsigned loopLevel, const unsigned datapathType,
-	const std::vector<int> &microops, const std::unordered_map<int, unsigned> &resultSizeList,
-	const Graph &graph, unsigned numOfTotalNodes,
-	const std::unordered_map<unsigned, Vertex> &nameToVertex, const VertexNameMap &vertexToName,
+	const std::vector<int> &microops, const resultSizeColumnTy &resultSizeList,
+	const CSRGraph &csr, unsigned numOfTotalNodes,
 	HardwareProfile &profile, const std::unordered_map<int, std::pair<std::string, int64_t>> &baseAddress,
-	const std::vector<uint64_t> &asap, const std::vector<uint64_t> &alap, std::vector<uint64_t> &rc
+	const std::vector<uint64_t> &asap, const std::vector<uint64_t> &alap, std::vector<uint64_t> &rc,
+	std::vector<allocationEventTy> *allocationLog
 ) :
 	microops(microops), resultSizeList(resultSizeList),
-	graph(graph), numOfTotalNodes(numOfTotalNodes),
-	nameToVertex(nameToVertex), vertexToName(vertexToName),
+	csr(csr), numOfTotalNodes(numOfTotalNodes),
 	profile(profile), baseAddress(baseAddress),
-	asap(asap), alap(alap), rc(rc),
-	tcSched(microops, graph, numOfTotalNodes, nameToVertex, vertexToName, profile)
+	asap(asap), alap(alap), rc(rc), allocationLog(allocationLog),
+	tcSched(microops, csr, numOfTotalNodes, profile)
 {
 	numParents.assign(numOfTotalNodes, 0);
 	finalIsolated.assign(numOfTotalNodes, true);
@@ -2423,6 +2715,7 @@ BaseDatapath::RCScheduler::RCScheduler(
 	scheduledNodeCount = 0;
 	achievedPeriod = 0;
 	alapShift = 0;
+	resourceConstrained = false;
 
 	startingNodes.clear();
 
@@ -2460,15 +2753,15 @@ BaseDatapath::RCScheduler::RCScheduler(
 	callExecuting.clear();
 	ddrOpExecuting.clear();
 
-	// Select root connected nodes to start scheduling
-	VertexIterator vi, vEnd;
-	for(std::tie(vi, vEnd) = boost::vertices(graph); vi != vEnd; vi++) {
-		unsigned currNodeID = vertexToName[*vi];
+	// Filled when loads/stores become ready (see pushReady())
+	partitionIDs.assign(numOfTotalNodes, 0);
 
-		if(!(boost::degree(*vi, graph)))
+	// Select root connected nodes to start scheduling
+	for(unsigned currNodeID = 0; currNodeID < csr.getNumNodes(); currNodeID++) {
+		if(!(csr.degree(currNodeID)))
 			continue;
 
-		unsigned inDegree = boost::in_degree(*vi, graph);
+		unsigned inDegree = csr.inDegree(currNodeID);
 		numParents[currNodeID] = inDegree;
 		totalConnectedNodes++;
 		finalIsolated[currNodeID] = false;
@@ -2481,6 +2774,9 @@ BaseDatapath::RCScheduler::RCScheduler(
 		startingNodes.push_back(std::make_pair(currNodeID, alap[currNodeID]));
 	}
 
+	// Sort nodes by their ALAP, smallest first (urgent nodes first). No nodes are added to this list later, so this is done only once
+	startingNodes.sort(prioritiseSmallerALAP);
+
 	if(args.showScheduling) {
 		std::string datapathTypeStr(
 			(DatapathType::NON_PERFECT_BEFORE == datapathType)? "_before" : ((DatapathType::NON_PERFECT_AFTER == datapathType)? "_after" : ((DatapathType::NON_PERFECT_BETWEEN == datapathType)? "_inter" : "" ))
@@ -2565,6 +2861,7 @@ std::pair<uint64_t, double> BaseDatapath::RCScheduler::schedule() {
 
 		// Release pipelined functional units for next clock tick
 		profile.pipelinedRelease();
+		logAllocation(allocationEventTy::EVENT_TICK, 0);
 
 		if(args.fNoTCS) {
 			if(args.showScheduling)
@@ -2587,6 +2884,10 @@ std::pair<uint64_t, double> BaseDatapath::RCScheduler::schedule() {
 		else {
 			dumpFile << "\n\n";
 		}
+
+		// The scheduling report lists every cycle, thus no cycle is skipped when it is requested
+		if(!(args.showScheduling))
+			skipQuietCycles();
 	}
 
 	if(args.showScheduling) {
@@ -2601,9 +2902,7 @@ std::pair<uint64_t, double> BaseDatapath::RCScheduler::schedule() {
 }
 
 void BaseDatapath::RCScheduler::assignReadyStartingNodes() {
-	// Sort nodes by their ALAP, smallest first (urgent nodes first)
-	startingNodes.sort(prioritiseSmallerALAP);
-
+	// startingNodes is already sorted by ALAP (see constructor)
 	while(startingNodes.size()) {
 		unsigned currNodeID = startingNodes.front().first;
 		uint64_t alapTime = startingNodes.front().second;
@@ -2688,30 +2987,95 @@ void BaseDatapath::RCScheduler::release() {
 	tryRelease(ddrOpExecuting, ddrOpExecuted, &HardwareProfile::ddrOpRelease);
 }
 
+void BaseDatapath::RCScheduler::insertByALAP(nodeTickTy &ready, unsigned nodeID, uint64_t tick) {
+	// Nodes usually become ready in ALAP order, so the position is searched from the back
+	nodeTickTy::iterator it = ready.end();
+	while(it != ready.begin() && std::prev(it)->second > tick)
+		it--;
+
+	ready.insert(it, std::make_pair(nodeID, tick));
+}
+
+void BaseDatapath::RCScheduler::skipQuietCycles() {
+	// Nodes that are ready but blocked by resource or timing contention might be selected in the next cycle
+	if(othersReady.size() || fAddReady.size() || fSubReady.size() || fMulReady.size() || fDivReady.size() || fCmpReady.size() ||
+		loadReady.size() || storeReady.size() || intOpReady.size() || callReady.size() || ddrOpReady.size())
+		return;
+
+	// With no ready nodes, the following cycles only consume the latency of the executing nodes. The next cycle
+	// where something happens is either when an executing node finishes or when a starting node becomes ready
+	std::vector<executingMapTy *> executingMaps = {
+		&fAddExecuting, &fSubExecuting, &fMulExecuting, &fDivExecuting, &fCmpExecuting,
+		&loadExecuting, &storeExecuting, &intOpExecuting, &callExecuting, &ddrOpExecuting
+	};
+	uint64_t nextEventTick = std::numeric_limits<uint64_t>::max();
+	for(auto &executing : executingMaps) {
+		for(auto &it : *executing) {
+			if(cycleTick + it.second < nextEventTick)
+				nextEventTick = cycleTick + it.second;
+		}
+	}
+	if(startingNodes.size()) {
+		// Same condition as in assignReadyStartingNodes()
+		uint64_t alapTime = startingNodes.front().second;
+		uint64_t readyTick = (alapTime > alapShift)? alapTime - alapShift : 0;
+		if(readyTick < nextEventTick)
+			nextEventTick = readyTick;
+	}
+
+	if(std::numeric_limits<uint64_t>::max() == nextEventTick || nextEventTick <= cycleTick + 1)
+		return;
+
+	uint64_t skippedCycles = nextEventTick - cycleTick - 1;
+	for(auto &executing : executingMaps) {
+		for(auto &it : *executing)
+			it.second -= skippedCycles;
+	}
+
+	// All skipped cycles have the same timing budget usage: only the running nodes, marked in the same order as in release()
+	if(!(args.fNoTCS)) {
+		tcSched.clearFinishedNodes();
+
+		double currCriticalPath = tcSched.getCriticalPath();
+		if(currCriticalPath > achievedPeriod)
+			achievedPeriod = currCriticalPath;
+
+		for(auto &executing : executingMaps) {
+			for(auto &it : *executing)
+				tcSched.markAsRunning(it.first);
+		}
+	}
+
+	cycleTick += skippedCycles;
+}
+
 void BaseDatapath::RCScheduler::pushReady(unsigned nodeID, uint64_t tick) {
 	readyChanged = true;
 
 	switch(microops.at(nodeID)) {
 		case LLVM_IR_FAdd:
-			fAddReady.push_back(std::make_pair(nodeID, tick));
+			insertByALAP(fAddReady, nodeID, tick);
 			break;
 		case LLVM_IR_FSub:
-			fSubReady.push_back(std::make_pair(nodeID, tick));
+			insertByALAP(fSubReady, nodeID, tick);
 			break;
 		case LLVM_IR_FMul:
-			fMulReady.push_back(std::make_pair(nodeID, tick));
+			insertByALAP(fMulReady, nodeID, tick);
 			break;
 		case LLVM_IR_FDiv:
-			fDivReady.push_back(std::make_pair(nodeID, tick));
+			insertByALAP(fDivReady, nodeID, tick);
 			break;
 		case LLVM_IR_FCmp:
-			fCmpReady.push_back(std::make_pair(nodeID, tick));
+			insertByALAP(fCmpReady, nodeID, tick);
 			break;
 		case LLVM_IR_Load:
-			loadReady.push_back(std::make_pair(nodeID, tick));
+			// Partition names are resolved only once, allocation uses their IDs
+			partitionIDs[nodeID] = profile.arrayGetPartitionID(baseAddress.at(nodeID).first);
+			insertByALAP(loadReady, nodeID, tick);
 			break;
 		case LLVM_IR_Store:
-			storeReady.push_back(std::make_pair(nodeID, tick));
+			partitionIDs[nodeID] = profile.arrayGetPartitionID(baseAddress.at(nodeID).first);
+			insertByALAP(storeReady, nodeID, tick);
 			break;
 		case LLVM_IR_Add:
 		case LLVM_IR_Sub:
@@ -2745,10 +3109,10 @@ void BaseDatapath::RCScheduler::pushReady(unsigned nodeID, uint64_t tick) {
 		case LLVM_IR_APDiv:
 #endif
 #endif
-			intOpReady.push_back(std::make_pair(nodeID, tick));
+			insertByALAP(intOpReady, nodeID, tick);
 			break;
 		case LLVM_IR_Call:
-			callReady.push_back(std::make_pair(nodeID, tick));
+			insertByALAP(callReady, nodeID, tick);
 			break;
 		case LLVM_IR_DDRReadReq:
 		case LLVM_IR_DDRRead:
@@ -2760,7 +3124,7 @@ void BaseDatapath::RCScheduler::pushReady(unsigned nodeID, uint64_t tick) {
 		case LLVM_IR_DDRSilentWriteReq:
 		case LLVM_IR_DDRSilentWrite:
 		case LLVM_IR_DDRSilentWriteResp:
-			ddrOpReady.push_back(std::make_pair(nodeID, tick));
+			insertByALAP(ddrOpReady, nodeID, tick);
 			break;
 		default:
 			othersReady.push_back(std::make_pair(nodeID, tick));
@@ -2775,8 +3139,7 @@ void BaseDatapath::RCScheduler::trySelect(nodeTickTy &ready, selectedListTy &sel
 	if(ready.size()) {
 		selected.clear();
 
-		// Sort nodes by their ALAP, smallest first (urgent nodes first)
-		ready.sort(prioritiseSmallerALAP);
+		// Ready lists are kept sorted by their ALAP, smallest first (urgent nodes first). See pushReady()
 		size_t initialReadySize = ready.size();
 		for(unsigned i = 0; i < initialReadySize; i++) {
 			unsigned nodeID = ready.front().first;
@@ -2807,6 +3170,7 @@ void BaseDatapath::RCScheduler::trySelect(nodeTickTy &ready, selectedListTy &sel
 					ready.pop_front();
 					readyChanged = true;
 					rc[nodeID] = cycleTick;
+					logAllocation(allocationEventTy::EVENT_ALLOCATE, nodeID);
 				}
 				// Timing contention, not able to allocate now
 				else {
@@ -2815,6 +3179,7 @@ void BaseDatapath::RCScheduler::trySelect(nodeTickTy &ready, selectedListTy &sel
 			}
 			// Resource contention, not able to allocate now
 			else {
+				resourceConstrained = true;
 				break;
 			}
 		}
@@ -2825,8 +3190,7 @@ void BaseDatapath::RCScheduler::trySelect(nodeTickTy &ready, selectedListTy &sel
 	if(ready.size()) {
 		selected.clear();
 
-		// Sort nodes by their ALAP, smallest first (urgent nodes first)
-		ready.sort(prioritiseSmallerALAP);
+		// Ready lists are kept sorted by their ALAP, smallest first (urgent nodes first). See pushReady()
 #ifdef CONSTRAIN_INT_OP
 		for(auto it = ready.begin(); it != ready.end();) {
 			bool iteratorWasInvalidated = false;
@@ -2868,6 +3232,7 @@ void BaseDatapath::RCScheduler::trySelect(nodeTickTy &ready, selectedListTy &sel
 #endif
 					readyChanged = true;
 					rc[nodeID] = cycleTick;
+					logAllocation(allocationEventTy::EVENT_ALLOCATE, nodeID);
 				}
 #ifdef CONSTRAIN_INT_OP
 				// Timing contention, not able to allocate now (but the next, less-prioritised node might allocate, so no break here)
@@ -2880,6 +3245,9 @@ void BaseDatapath::RCScheduler::trySelect(nodeTickTy &ready, selectedListTy &sel
 			}
 #ifdef CONSTRAIN_INT_OP
 			// Resource contention, not able to allocate now (but the next, less-prioritised node might allocate, so no break here)
+			else {
+				resourceConstrained = true;
+			}
 
 			// Increment logic of iterator depends whether the iterator was invalidated by an erase (and later reconstructed)
 			if(!iteratorWasInvalidated)
@@ -2887,6 +3255,7 @@ void BaseDatapath::RCScheduler::trySelect(nodeTickTy &ready, selectedListTy &sel
 #else
 			// Resource contention, not able to allocate now
 			else {
+				resourceConstrained = true;
 				break;
 			}
 #endif
@@ -2894,29 +3263,28 @@ void BaseDatapath::RCScheduler::trySelect(nodeTickTy &ready, selectedListTy &sel
 	}
 }
 
-void BaseDatapath::RCScheduler::trySelect(nodeTickTy &ready, selectedListTy &selected, bool (HardwareProfile::*tryAllocateMem)(std::string, bool)) {
+void BaseDatapath::RCScheduler::trySelect(nodeTickTy &ready, selectedListTy &selected, bool (HardwareProfile::*tryAllocateMem)(unsigned, bool)) {
 	if(ready.size()) {
 		selected.clear();
 
-		// Sort nodes by their ALAP, smallest first (urgent nodes first)
-		ready.sort(prioritiseSmallerALAP);
+		// Ready lists are kept sorted by their ALAP, smallest first (urgent nodes first). See pushReady()
 		size_t initialReadySize = ready.size();
 		for(unsigned i = 0; i < initialReadySize; i++) {
 			unsigned nodeID = ready.front().first;
 
-			// Load/store resource allocation is based on the array name
-			std::string arrayPartitionName = baseAddress.at(nodeID).first;
+			// Load/store resource allocation is based on the array partition
+			unsigned partitionID = partitionIDs[nodeID];
 
 			// If allocation is successful (i.e. there is one operation unit available), select this operation
 			// If timing-constrained scheduling is enabled, allocation is not yet performed, only attempted
-			if((profile.*tryAllocateMem)(arrayPartitionName, args.fNoTCS)) {
+			if((profile.*tryAllocateMem)(partitionID, args.fNoTCS)) {
 				bool timingConstrained = false;
 
 				// Timing-constrained scheduling (taa-daa)
 				if(!(args.fNoTCS)) {
 					// If selecting the current node does not violate timing in any way, proceed
 					if(tcSched.tryAllocate(nodeID))
-						(profile.*tryAllocateMem)(arrayPartitionName, true);
+						(profile.*tryAllocateMem)(partitionID, true);
 					// Else, fail
 					else
 						timingConstrained = true;
@@ -2933,6 +3301,7 @@ void BaseDatapath::RCScheduler::trySelect(nodeTickTy &ready, selectedListTy &sel
 					ready.pop_front();
 					readyChanged = true;
 					rc[nodeID] = cycleTick;
+					logAllocation(allocationEventTy::EVENT_ALLOCATE, nodeID);
 				}
 				// Timing contention, not able to allocate now
 				else {
@@ -2941,6 +3310,7 @@ void BaseDatapath::RCScheduler::trySelect(nodeTickTy &ready, selectedListTy &sel
 			}
 			// Resource contention, not able to allocate now
 			else {
+				resourceConstrained = true;
 				break;
 			}
 		}
@@ -2956,10 +3326,11 @@ void BaseDatapath::RCScheduler::trySelect(nodeTickTy &ready, selectedListTy &sel
 	// (which doesn't happen in the other trySelects), this iteration loop is slightly different
 
 	if(ready.size()) {
+		// Off-chip allocations depend on the memory model state and are not logged, thus this schedule cannot be replayed
+		resourceConstrained = true;
 		selected.clear();
 
-		// Sort nodes by their ALAP, smallest first (urgent nodes first)
-		ready.sort(prioritiseSmallerALAP);
+		// Ready lists are kept sorted by their ALAP, smallest first (urgent nodes first). See pushReady()
 		for(auto it = ready.begin(); it != ready.end(); it++) {
 			unsigned nodeID = it->first;
 			int microop = microops.at(nodeID);
@@ -3045,11 +3416,10 @@ void BaseDatapath::RCScheduler::enqueueExecute(selectedListTy &selected, executi
 	}
 }
 
-void BaseDatapath::RCScheduler::enqueueExecute(unsigned opcode, selectedListTy &selected, executingMapTy &executing, void (HardwareProfile::*releaseMem)(std::string)) {
+void BaseDatapath::RCScheduler::enqueueExecute(unsigned opcode, selectedListTy &selected, executingMapTy &executing, void (HardwareProfile::*releaseMem)(unsigned)) {
 	while(selected.size()) {
 		unsigned selectedNodeID = selected.front();
 		unsigned latency = profile.getLatency(opcode);
-		std::string arrayName = baseAddress.at(selectedNodeID).first;
 
 		// Latency 0 or 1: this node was solved already. Set as scheduled and assign its children as ready
 		if(latency <= 1) {
@@ -3119,8 +3489,10 @@ void BaseDatapath::RCScheduler::tryRelease(unsigned opcode, executingMapTy &exec
 			toErase.push_back(executingNodeID);
 
 			// If operation is pipelined, the resource was already released before
-			if(!(profile.isPipelined(opcode)))
+			if(!(profile.isPipelined(opcode))) {
 				(profile.*release)();
+				logAllocation(allocationEventTy::EVENT_RELEASE, executingNodeID);
+			}
 		}
 		else {
 			if(args.showScheduling)
@@ -3163,8 +3535,10 @@ void BaseDatapath::RCScheduler::tryRelease(executingMapTy &executing, executedLi
 			toErase.push_back(executingNodeID);
 
 			// If operation is pipelined, the resource was already released before
-			if(!(profile.isPipelined(opcode)))
+			if(!(profile.isPipelined(opcode))) {
 				(profile.*releaseOp)(opcode);
+				logAllocation(allocationEventTy::EVENT_RELEASE, executingNodeID);
+			}
 		}
 		else {
 			if(args.showScheduling)
@@ -3180,12 +3554,11 @@ void BaseDatapath::RCScheduler::tryRelease(executingMapTy &executing, executedLi
 		executing.erase(it);
 }
 
-void BaseDatapath::RCScheduler::tryRelease(unsigned opcode, executingMapTy &executing, executedListTy &executed, void (HardwareProfile::*releaseMem)(std::string)) {
+void BaseDatapath::RCScheduler::tryRelease(unsigned opcode, executingMapTy &executing, executedListTy &executed, void (HardwareProfile::*releaseMem)(unsigned)) {
 	std::vector<unsigned> toErase;
 
 	for(auto &it: executing) {
 		unsigned executingNodeID = it.first;
-		std::string arrayName = baseAddress.at(executingNodeID).first;
 
 		// Check if this node was already accounted in this clock tick. If positive, pass.
 		if(executed.end() == std::find(executed.begin(), executed.end(), executingNodeID))
@@ -3207,8 +3580,10 @@ void BaseDatapath::RCScheduler::tryRelease(unsigned opcode, executingMapTy &exec
 			toErase.push_back(executingNodeID);
 
 			// If operation is pipelined, the resource was already released before
-			if(!(profile.isPipelined(opcode)))
-				(profile.*releaseMem)(arrayName);
+			if(!(profile.isPipelined(opcode))) {
+				(profile.*releaseMem)(partitionIDs[executingNodeID]);
+				logAllocation(allocationEventTy::EVENT_RELEASE, executingNodeID);
+			}
 		}
 		else {
 			if(args.showScheduling)
@@ -3271,10 +3646,8 @@ void BaseDatapath::RCScheduler::tryRelease(executingMapTy &executing, executedLi
 void BaseDatapath::RCScheduler::setScheduledAndAssignReadyChildren(unsigned nodeID) {
 	scheduledNodeCount++;
 
-	OutEdgeIterator outEdgei, outEdgeEnd;
-	for(std::tie(outEdgei, outEdgeEnd) = boost::out_edges(nameToVertex.at(nodeID), graph); outEdgei != outEdgeEnd; outEdgei++) {
-		Vertex childVertex = boost::target(*outEdgei, graph);
-		unsigned childNodeID = vertexToName[childVertex];
+	for(const CSRGraph::edgeRefTy *outEdge = csr.outBegin(nodeID); outEdge != csr.outEnd(nodeID); outEdge++) {
+		unsigned childNodeID = outEdge->node;
 		numParents[childNodeID]--;
 
 		// Assign this child node as ready if all its parents were scheduled and it's not an isolated node
@@ -3285,13 +3658,11 @@ void BaseDatapath::RCScheduler::setScheduledAndAssignReadyChildren(unsigned node
 
 BaseDatapath::TCScheduler::TCScheduler(
 	const std::vector<int> &microops,
-	const Graph &graph, unsigned numOfTotalNodes,
-	const std::unordered_map<unsigned, Vertex> &nameToVertex, const VertexNameMap &vertexToName,
+	const CSRGraph &csr, unsigned numOfTotalNodes,
 	HardwareProfile &profile
 ) :
 	microops(microops),
-	graph(graph), numOfTotalNodes(numOfTotalNodes),
-	nameToVertex(nameToVertex), vertexToName(vertexToName),
+	csr(csr), numOfTotalNodes(numOfTotalNodes),
 	profile(profile)
 {
 	effectivePeriod = (1000 / args.frequency) - (10 * args.uncertainty / args.frequency);
@@ -3325,9 +3696,8 @@ bool BaseDatapath::TCScheduler::tryAllocate(unsigned nodeID, bool checkTiming) {
 	// Calculate the delay up to this node according to its parent nodes
 	double nodeDelay = inCycleLatency;
 	double parentLargestDelay = 0;
-	InEdgeIterator inEdgei, inEdgeEnd;
-	for(std::tie(inEdgei, inEdgeEnd) = boost::in_edges(nameToVertex.at(nodeID), graph); inEdgei != inEdgeEnd; inEdgei++) {
-		unsigned parentID = vertexToName[boost::source(*inEdgei, graph)];
+	for(const CSRGraph::edgeRefTy *inEdge = csr.inBegin(nodeID); inEdge != csr.inEnd(nodeID); inEdge++) {
+		unsigned parentID = inEdge->node;
 		std::unordered_map<unsigned, double>::iterator found = delayMap.find(parentID);
 		double parentDelay = (delayMap.end() == found)? 0 : found->second;
 		if(parentDelay > parentLargestDelay)
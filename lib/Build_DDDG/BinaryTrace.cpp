@@ -0,0 +1,407 @@
+#include "profile_h/BinaryTrace.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "profile_h/auxiliary.h"
+
+BinaryTraceWriter::BinaryTraceWriter(std::string fileName, unsigned compression, unsigned numThreads) : compression(compression) {
+	file = fopen(fileName.c_str(), "wb");
+	assert(file != nullptr && "Could not open binary trace output file");
+
+	numRecords = 0;
+	currSlot = 0;
+	nextWriteSlot = 0;
+	finishing = false;
+
+	ring.resize(numThreads? numThreads * BINARY_TRACE_RING_SLOTS_PER_THREAD : 1);
+	for(auto &it : ring) {
+		it.records.resize(BINARY_TRACE_BLOCK_RECORDS);
+		it.numRecords = 0;
+		it.firstRecord = 0;
+		it.storedSize = 0;
+		it.state = SLOT_FREE;
+	}
+
+	// Write header
+	uint8_t version = BINARY_TRACE_VERSION;
+	uint32_t recordSize = sizeof(binaryTraceRecordTy);
+	uint32_t blockRecords = BINARY_TRACE_BLOCK_RECORDS;
+	uint32_t compression32 = compression;
+	fwrite(BINARY_TRACE_MAGIC_STRING, sizeof(char), std::string(BINARY_TRACE_MAGIC_STRING).size(), file);
+	fwrite(&version, sizeof(uint8_t), 1, file);
+	fwrite(&recordSize, sizeof(uint32_t), 1, file);
+	fwrite(&blockRecords, sizeof(uint32_t), 1, file);
+	fwrite(&compression32, sizeof(uint32_t), 1, file);
+
+	for(unsigned i = 0; i < numThreads; i++)
+		workers.push_back(std::thread(&BinaryTraceWriter::worker, this));
+}
+
+BinaryTraceWriter::~BinaryTraceWriter() {
+	if(file)
+		close();
+}
+
+void BinaryTraceWriter::flushBlock() {
+	slotTy &slot = ring[currSlot];
+	if(!(slot.numRecords))
+		return;
+
+	slot.firstRecord = numRecords - slot.numRecords;
+
+	// No background threads, compress and write in this thread
+	if(workers.empty()) {
+		compressSlot(slot);
+		slot.state = SLOT_DONE;
+		writeDoneSlots();
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(mutex);
+
+	slot.state = SLOT_FILLED;
+	filledSlots.push_back(currSlot);
+	slotFilled.notify_one();
+
+	// Wait for the next slot to be written out. This only happens when compression cannot keep up with the kernel
+	currSlot = (currSlot + 1) % ring.size();
+	slotFreed.wait(lock, [this] { return SLOT_FREE == ring[currSlot].state; });
+}
+
+void BinaryTraceWriter::compressSlot(slotTy &slot) {
+	uint32_t rawSize = slot.numRecords * sizeof(binaryTraceRecordTy);
+	slot.storedSize = rawSize;
+
+	if(COMPRESSION_ZLIB == compression) {
+		uLongf compressedSize = compressBound(rawSize);
+		slot.compressed.resize(compressedSize);
+
+		int retVal = compress2(slot.compressed.data(), &compressedSize, (const Bytef *) slot.records.data(), rawSize, 1);
+		assert(Z_OK == retVal && "Could not compress binary trace block");
+
+		slot.storedSize = compressedSize;
+	}
+}
+
+// Must be called with the mutex locked when there are background threads
+void BinaryTraceWriter::writeDoneSlots() {
+	while(SLOT_DONE == ring[nextWriteSlot].state) {
+		slotTy &slot = ring[nextWriteSlot];
+		uint32_t rawSize = slot.numRecords * sizeof(binaryTraceRecordTy);
+		const Bytef *payload = (COMPRESSION_ZLIB == compression)? slot.compressed.data() : (const Bytef *) slot.records.data();
+
+		blockIndex.push_back(std::make_pair((uint64_t) ftell(file), slot.firstRecord));
+		fwrite(&(slot.storedSize), sizeof(uint32_t), 1, file);
+		fwrite(&rawSize, sizeof(uint32_t), 1, file);
+		fwrite(payload, sizeof(Bytef), slot.storedSize, file);
+
+		slot.numRecords = 0;
+		slot.state = SLOT_FREE;
+		nextWriteSlot = (nextWriteSlot + 1) % ring.size();
+	}
+
+	slotFreed.notify_all();
+}
+
+void BinaryTraceWriter::worker() {
+	std::unique_lock<std::mutex> lock(mutex);
+
+	while(true) {
+		slotFilled.wait(lock, [this] { return finishing || !(filledSlots.empty()); });
+		// Only leave when all filled slots were taken
+		if(filledSlots.empty())
+			break;
+
+		unsigned slotNo = filledSlots.front();
+		filledSlots.pop_front();
+
+		lock.unlock();
+		compressSlot(ring[slotNo]);
+		lock.lock();
+
+		ring[slotNo].state = SLOT_DONE;
+		writeDoneSlots();
+	}
+}
+
+uint32_t BinaryTraceWriter::intern(const std::string &str) {
+	std::unordered_map<std::string, uint32_t>::iterator found = stringIDs.find(str);
+	if(found != stringIDs.end())
+		return found->second;
+
+	uint32_t ID = strings.size();
+	strings.push_back(str);
+	stringIDs.insert(std::make_pair(str, ID));
+
+	return ID;
+}
+
+uint32_t BinaryTraceWriter::intern(const char *str) {
+	std::unordered_map<const char *, uint32_t>::iterator found = pointerIDs.find(str);
+	if(found != pointerIDs.end())
+		return found->second;
+
+	uint32_t ID = intern(std::string(str));
+	pointerIDs.insert(std::make_pair(str, ID));
+
+	return ID;
+}
+
+void BinaryTraceWriter::appendInstruction(int lineNo, uint32_t funcID, uint32_t bbID, uint32_t instID, int opcode, uint64_t count) {
+	binaryTraceRecordTy record;
+
+	record.type = binaryTraceRecordTy::TYPE_INST;
+	record.flags = 0;
+	record.opcode = opcode;
+	record.lineNo = lineNo;
+	record.size = 0;
+	record.funcID = funcID;
+	record.bbID = bbID;
+	record.instID = instID;
+	record.value.u = count;
+
+	append(record);
+}
+
+void BinaryTraceWriter::appendIntOperand(uint8_t type, int param, int size, int64_t value, int isReg, uint32_t labelID) {
+	binaryTraceRecordTy record;
+
+	record.type = type;
+	record.flags = (isReg? binaryTraceRecordTy::FLAG_ISREG : 0) | ((labelID != BINARY_TRACE_NO_LABEL)? binaryTraceRecordTy::FLAG_LABEL : 0);
+	record.opcode = 0;
+	record.lineNo = param;
+	record.size = size;
+	record.funcID = labelID;
+	record.bbID = 0;
+	record.instID = 0;
+	record.value.i = value;
+
+	append(record);
+}
+
+void BinaryTraceWriter::appendDoubleOperand(uint8_t type, int param, int size, double value, int isReg, uint32_t labelID) {
+	binaryTraceRecordTy record;
+
+	record.type = type;
+	record.flags = binaryTraceRecordTy::FLAG_DOUBLE | (isReg? binaryTraceRecordTy::FLAG_ISREG : 0) | ((labelID != BINARY_TRACE_NO_LABEL)? binaryTraceRecordTy::FLAG_LABEL : 0);
+	record.opcode = 0;
+	record.lineNo = param;
+	record.size = size;
+	record.funcID = labelID;
+	record.bbID = 0;
+	record.instID = 0;
+	record.value.d = value;
+
+	append(record);
+}
+
+void BinaryTraceWriter::append(binaryTraceRecordTy &record) {
+	slotTy &slot = ring[currSlot];
+	slot.records[(slot.numRecords)++] = record;
+	numRecords++;
+
+	if(slot.numRecords >= BINARY_TRACE_BLOCK_RECORDS)
+		flushBlock();
+}
+
+void BinaryTraceWriter::close() {
+	assert(file != nullptr && "Binary trace file is already closed");
+
+	flushBlock();
+
+	// Background threads write all pending blocks before leaving
+	if(!(workers.empty())) {
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			finishing = true;
+		}
+		slotFilled.notify_all();
+
+		for(auto &it : workers)
+			it.join();
+		workers.clear();
+	}
+	assert(filledSlots.empty() && SLOT_FREE == ring[nextWriteSlot].state && "Binary trace blocks were not written");
+
+	uint64_t footerOffset = ftell(file);
+
+	// Write string table
+	uint64_t numStrings = strings.size();
+	fwrite(&numStrings, sizeof(uint64_t), 1, file);
+	for(auto &it : strings) {
+		uint32_t length = it.size();
+		fwrite(&length, sizeof(uint32_t), 1, file);
+		fwrite(it.c_str(), sizeof(char), length, file);
+	}
+
+	// Write block index
+	uint64_t numBlocks = blockIndex.size();
+	fwrite(&numBlocks, sizeof(uint64_t), 1, file);
+	for(auto &it : blockIndex) {
+		fwrite(&(it.first), sizeof(uint64_t), 1, file);
+		fwrite(&(it.second), sizeof(uint64_t), 1, file);
+	}
+
+	fwrite(&numRecords, sizeof(uint64_t), 1, file);
+	fwrite(&footerOffset, sizeof(uint64_t), 1, file);
+
+	fclose(file);
+	file = nullptr;
+}
+
+BinaryTraceReader::BinaryTraceReader(std::string fileName) {
+	file = fopen(fileName.c_str(), "rb");
+	assert(file != nullptr && "Could not open binary trace input file");
+
+	// Read and check header
+	char magicBits[4];
+	uint8_t version;
+	uint32_t recordSize;
+	uint32_t compression32;
+	size_t readCount = fread(magicBits, sizeof(char), std::string(BINARY_TRACE_MAGIC_STRING).size(), file);
+	magicBits[3] = '\0';
+	assert(3 == readCount && std::string(magicBits) == BINARY_TRACE_MAGIC_STRING && "Invalid binary trace file");
+	readCount = fread(&version, sizeof(uint8_t), 1, file);
+	assert(1 == readCount && BINARY_TRACE_VERSION == version && "Unsupported binary trace version");
+	readCount = fread(&recordSize, sizeof(uint32_t), 1, file);
+	assert(1 == readCount && sizeof(binaryTraceRecordTy) == recordSize && "Binary trace record size mismatch");
+	readCount = fread(&blockRecords, sizeof(uint32_t), 1, file);
+	readCount = fread(&compression32, sizeof(uint32_t), 1, file);
+	assert(1 == readCount && "Truncated binary trace header");
+	compression = compression32;
+
+	// Locate and read footer
+	uint64_t footerOffset;
+	fseek(file, -((long int) sizeof(uint64_t)), SEEK_END);
+	readCount = fread(&footerOffset, sizeof(uint64_t), 1, file);
+	assert(1 == readCount && "Binary trace is missing its footer (was trace generation interrupted?)");
+	fseek(file, footerOffset, SEEK_SET);
+
+	uint64_t numStrings;
+	readCount = fread(&numStrings, sizeof(uint64_t), 1, file);
+	assert(1 == readCount && "Truncated binary trace footer");
+	strings.reserve(numStrings);
+	for(uint64_t i = 0; i < numStrings; i++) {
+		uint32_t length;
+		readCount = fread(&length, sizeof(uint32_t), 1, file);
+		std::string str(length, '\0');
+		if(length)
+			readCount = fread(&str[0], sizeof(char), length, file);
+		strings.push_back(str);
+	}
+
+	uint64_t numBlocks;
+	readCount = fread(&numBlocks, sizeof(uint64_t), 1, file);
+	assert(1 == readCount && "Truncated binary trace footer");
+	blockIndex.resize(numBlocks);
+	for(uint64_t i = 0; i < numBlocks; i++) {
+		readCount = fread(&(blockIndex[i].first), sizeof(uint64_t), 1, file);
+		readCount = fread(&(blockIndex[i].second), sizeof(uint64_t), 1, file);
+	}
+
+	readCount = fread(&numRecords, sizeof(uint64_t), 1, file);
+	assert(1 == readCount && "Truncated binary trace footer");
+
+	loadedBlock = -1;
+	cursor = 0;
+}
+
+BinaryTraceReader::~BinaryTraceReader() {
+	if(file)
+		fclose(file);
+}
+
+void BinaryTraceReader::loadBlock(uint64_t blockNo) {
+	assert(blockNo < blockIndex.size() && "Binary trace block out of bounds");
+
+	uint32_t storedSize, rawSize;
+	fseek(file, blockIndex[blockNo].first, SEEK_SET);
+	size_t readCount = fread(&storedSize, sizeof(uint32_t), 1, file);
+	readCount = fread(&rawSize, sizeof(uint32_t), 1, file);
+	assert(1 == readCount && "Truncated binary trace block");
+
+	block.resize(rawSize / sizeof(binaryTraceRecordTy));
+
+	if(BinaryTraceWriter::COMPRESSION_ZLIB == compression) {
+		compressedBlock.resize(storedSize);
+		readCount = fread(compressedBlock.data(), sizeof(Bytef), storedSize, file);
+		assert(storedSize == readCount && "Truncated binary trace block");
+
+		uLongf uncompressedSize = rawSize;
+		int retVal = uncompress((Bytef *) block.data(), &uncompressedSize, compressedBlock.data(), storedSize);
+		assert(Z_OK == retVal && rawSize == uncompressedSize && "Could not uncompress binary trace block");
+	}
+	else {
+		readCount = fread(block.data(), sizeof(Bytef), rawSize, file);
+		assert(rawSize == readCount && "Truncated binary trace block");
+	}
+
+	loadedBlock = blockNo;
+}
+
+const binaryTraceRecordTy *BinaryTraceReader::read() {
+	if(cursor >= numRecords)
+		return nullptr;
+
+	uint64_t blockNo = cursor / blockRecords;
+	if((int64_t) blockNo != loadedBlock)
+		loadBlock(blockNo);
+
+	return &(block[(cursor++) - blockIndex[blockNo].second]);
+}
+
+void convertTextTraceToBinary(std::string textFileName, std::string binFileName, unsigned compression) {
+	gzFile textFile = gzopen(textFileName.c_str(), "r");
+	assert(textFile != Z_NULL && "Could not open trace input file");
+
+	BinaryTraceWriter writer(binFileName, compression);
+
+	char buffer[BUFF_STR_SZ];
+	char buffer2[BUFF_STR_SZ];
+	char buffer3[BUFF_STR_SZ];
+	char buffer4[BUFF_STR_SZ];
+	while(Z_NULL != gzgets(textFile, buffer, sizeof(buffer))) {
+		char *tagEnd = strchr(buffer, ',');
+
+		if(!tagEnd)
+			continue;
+
+		*tagEnd = '\0';
+		char *rest = tagEnd + 1;
+
+		if(!strcmp(buffer, "0")) {
+			int lineNo, opcode;
+			uint64_t count;
+			sscanf(rest, "%d,%[^,],%[^,],%[^,],%d,%lu\n", &lineNo, buffer2, buffer3, buffer4, &opcode, &count);
+
+			writer.appendInstruction(
+				lineNo, writer.intern(std::string(buffer2)), writer.intern(std::string(buffer3)), writer.intern(std::string(buffer4)),
+				opcode, count
+			);
+		}
+		else {
+			uint8_t type = binaryTraceRecordTy::TYPE_PARAM;
+			int param = 0;
+			if(!strcmp(buffer, "r"))
+				type = binaryTraceRecordTy::TYPE_RESULT;
+			else if(!strcmp(buffer, "f"))
+				type = binaryTraceRecordTy::TYPE_FORWARD;
+			else
+				param = atoi(buffer);
+
+			int size, isReg;
+			int matched = sscanf(rest, "%d,%[^,],%d,%[^\n]\n", &size, buffer2, &isReg, buffer3);
+			uint32_t labelID = (4 == matched)? writer.intern(std::string(buffer3)) : BINARY_TRACE_NO_LABEL;
+
+			// Integer values are written with %ld, doubles with %f (which always has a dot, or is inf/nan)
+			if(strpbrk(buffer2, ".ni"))
+				writer.appendDoubleOperand(type, param, size, strtod(buffer2, nullptr), isReg, labelID);
+			else
+				writer.appendIntOperand(type, param, size, strtoll(buffer2, nullptr, 10), isReg, labelID);
+		}
+	}
+
+	writer.close();
+	gzclose(textFile);
+}
@@ -0,0 +1,54 @@
+#include "profile_h/CSRGraph.h"
+
+void CSRGraph::build(const Graph &graph, const VertexNameMap &vertexToName) {
+	numNodes = boost::num_vertices(graph);
+	unsigned numEdges = boost::num_edges(graph);
+
+	// Count edges per node, then transform the counts into offsets
+	outOffsets.assign(numNodes + 1, 0);
+	inOffsets.assign(numNodes + 1, 0);
+	VertexIterator vi, viEnd;
+	for(std::tie(vi, viEnd) = boost::vertices(graph); vi != viEnd; vi++) {
+		unsigned nodeID = vertexToName[*vi];
+		outOffsets[nodeID + 1] = boost::out_degree(*vi, graph);
+		inOffsets[nodeID + 1] = boost::in_degree(*vi, graph);
+	}
+	for(unsigned i = 0; i < numNodes; i++) {
+		outOffsets[i + 1] += outOffsets[i];
+		inOffsets[i + 1] += inOffsets[i];
+	}
+
+	outEdges.resize(numEdges);
+	inEdges.resize(numEdges);
+	for(std::tie(vi, viEnd) = boost::vertices(graph); vi != viEnd; vi++) {
+		unsigned nodeID = vertexToName[*vi];
+
+		unsigned pos = outOffsets[nodeID];
+		OutEdgeIterator outEdgei, outEdgeEnd;
+		for(std::tie(outEdgei, outEdgeEnd) = boost::out_edges(*vi, graph); outEdgei != outEdgeEnd; outEdgei++)
+			outEdges[pos++] = {(unsigned) vertexToName[boost::target(*outEdgei, graph)], boost::get(boost::edge_weight, graph, *outEdgei)};
+
+		pos = inOffsets[nodeID];
+		InEdgeIterator inEdgei, inEdgeEnd;
+		for(std::tie(inEdgei, inEdgeEnd) = boost::in_edges(*vi, graph); inEdgei != inEdgeEnd; inEdgei++)
+			inEdges[pos++] = {(unsigned) vertexToName[boost::source(*inEdgei, graph)], boost::get(boost::edge_weight, graph, *inEdgei)};
+	}
+
+	// boost returns the topological sort in reverse order
+	std::vector<Vertex> topologicalSortedNodes;
+	topologicalSortedNodes.reserve(numNodes);
+	boost::topological_sort(graph, std::back_inserter(topologicalSortedNodes));
+	topologicalOrder.clear();
+	topologicalOrder.reserve(numNodes);
+	for(auto vi = topologicalSortedNodes.rbegin(); vi != topologicalSortedNodes.rend(); vi++)
+		topologicalOrder.push_back(vertexToName[*vi]);
+}
+
+void CSRGraph::clear() {
+	numNodes = 0;
+	std::vector<unsigned>().swap(outOffsets);
+	std::vector<edgeRefTy>().swap(outEdges);
+	std::vector<unsigned>().swap(inOffsets);
+	std::vector<edgeRefTy>().swap(inEdges);
+	std::vector<unsigned>().swap(topologicalOrder);
+}
@@ -1,6 +1,12 @@
 #include "profile_h/ContextManager.h"
 
+#include <fcntl.h>
 #include <sstream>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <type_traits>
+#include <unistd.h>
 
 #include "profile_h/BaseDatapath.h"
 
@@ -12,50 +18,53 @@ const std::unordered_map<int, ContextManager::cfd_t> ContextManager::typeMap = {
 	{ContextManager::TYPE_GLOBAL_OUTBURSTS_INFO, cfd_t(-1)},
 	{ContextManager::TYPE_GLOBAL_DDR_MAP, cfd_t(-1)},
 	{ContextManager::TYPE_GLOBAL_PACK_INFO, cfd_t(-1)},
+	{ContextManager::TYPE_CACHE_KEY, cfd_t(-1)},
+	{ContextManager::TYPE_TOC, cfd_t(-1)},
 };
 
-// TODO Maybe create reverseSeek to speedup reading/
-
 // Seek to the desired type. If return is true, it means that the field was found.
 // In this case, the cursor will be positioned at the first data if the field length is fixed
 // Otherwise, the cursor will be positioned at the field length
 // Return will be false if element was not found
-// If the file is corrupt and the desired field is located right before EOF, this function
-// will return true and will be pointing to EOF, so careful!
 bool ContextManager::seekTo(int type) {
-	bool wentAround = false;
-	int origCurPos = contextFile.tellg();
+	if(hasTOC) {
+		tocTy::iterator found = toc.find(std::make_tuple((char) type, std::string(""), (uint64_t) 0));
+		if(toc.end() == found)
+			return false;
 
-	while(!wentAround || contextFile.tellg() < origCurPos) {
-		char readType;
-		contextFile.read((char *) &readType, 1);
+		readCursor = mapping + found->second.first + 1;
+		return true;
+	}
 
-		if(contextFile.eof()) {
-			assert(!(contextFile.gcount()) && "Context file is incomplete or corrupt");
-			// This is needed otherwise seekg() won't work (... really C++?)
-			contextFile.clear();
-			contextFile.seekg(3);
+	// No TOC, scan the file starting from the current position
+	bool wentAround = false;
+	const char *origCursor = readCursor;
+
+	while(!wentAround || readCursor < origCursor) {
+		if(mapping + mappingSize == readCursor) {
+			readCursor = mapping + std::string(FILE_CONTEXT_MANAGER_MAGIC_STRING).size();
 			wentAround = true;
 		}
 		else {
+			char readType;
+			readElement<char>(readType);
+
 			if(readType == (char) type) {
 				return true;
 			}
 			else {
-				int typeLength = typeMap.at(type).length;
+				int typeLength = typeMap.at(readType).length;
 
 				// Variable length
 				if(-1 == typeLength) {
 					size_t size;
-					contextFile.read((char *) &size, sizeof(size_t));
-
-					assert(!(contextFile.eof()) && "Context file is incomplete or corrupt");
+					readElement<size_t>(size);
 
 					// Skip this field entirely
-					contextFile.seekg(size, std::ios::cur);
+					skipBytes(size);
 				}
 				else {
-					contextFile.seekg(typeLength, std::ios::cur);
+					skipBytes(typeLength);
 				}
 			}
 		}
@@ -68,6 +77,22 @@ bool ContextManager::seekTo(int type) {
 // Differently of seekTo() that might point either to the content or to the field length, this function
 // will always point to the first content, if any.
 bool ContextManager::seekToIdentified(int type, std::string ID, uint64_t ID2) {
+	if(hasTOC) {
+		tocTy::iterator found = toc.find(std::make_tuple((char) type, ID, ID2));
+		if(toc.end() == found)
+			return false;
+
+		// Skip type, field length, ID and ID2
+		readCursor = mapping + found->second.first + 1;
+		skipElement<size_t>();
+		size_t stringSize;
+		readElement<size_t>(stringSize);
+		skipBytes(stringSize);
+		skipElement<uint64_t>();
+
+		return true;
+	}
+
 	std::string readID = "";
 	uint64_t readID2 = 0;
 	std::string readIDFirst = "none";
@@ -77,24 +102,23 @@ bool ContextManager::seekToIdentified(int type, std::string ID, uint64_t ID2) {
 	while(!foundTheRightOne) {
 		if(seekTo(type)) {
 			size_t totalFieldSize;
-			contextFile.read((char *) &totalFieldSize, sizeof(size_t));
+			readElement<size_t>(totalFieldSize);
 
 			size_t stringSize;
-			contextFile.read((char *) &stringSize, sizeof(size_t));
+			readElement<size_t>(stringSize);
 
 			assert(stringSize < BUFF_STR_SZ && "A read of more than BUFF_STR_SZ bytes was requested from context file and it was blocked. If you believe that this was not caused by a corrupt context file, increase BUFF_STR_SZ");
 
-			char buff[BUFF_STR_SZ];
-			contextFile.read(buff, stringSize);
-			buff[stringSize] = '\0';
-			readID.assign(buff);
+			const char *stringStart = readCursor;
+			skipBytes(stringSize);
+			readID.assign(stringStart, stringSize);
 
-			contextFile.read((char *) &readID2, sizeof(uint64_t));
+			readElement<uint64_t>(readID2);
 
 			if(ID == readID && ID2 == readID2)
 				foundTheRightOne = true;
 			else
-				contextFile.seekg(totalFieldSize - sizeof(size_t) - stringSize - sizeof(uint64_t), std::ios::cur);
+				skipBytes(totalFieldSize - sizeof(size_t) - stringSize - sizeof(uint64_t));
 
 			if("none" == readIDFirst) {
 				readIDFirst.assign(readID);
@@ -112,6 +136,18 @@ bool ContextManager::seekToIdentified(int type, std::string ID, uint64_t ID2) {
 	return foundTheRightOne;
 }
 
+void ContextManager::readBytes(char *buffer, size_t size) {
+	assert(size <= (size_t) (mapping + mappingSize - readCursor) && "Context file is incomplete or corrupt");
+
+	memcpy(buffer, readCursor, size);
+	readCursor += size;
+}
+
+void ContextManager::skipBytes(size_t size) {
+	assert(size <= (size_t) (mapping + mappingSize - readCursor) && "Context file is incomplete or corrupt");
+
+	readCursor += size;
+}
 
 template<typename T> size_t ContextManager::writeElement(std::stringstream &ss, T &elem) {
 	ss.write((char *) &elem, sizeof(T));
@@ -299,10 +335,10 @@ template<> size_t ContextManager::writeElement<ParsedTraceContainer>(std::string
 	DBG_DUMP("Dump of ParsedTraceContainer\n");
 	DBG_DUMP("-- funcList:\n");
 	for(auto const &x : elem.getFuncList())
-		DBG_DUMP("---- " << x << "\n");
+		DBG_DUMP("---- " << symbolTable.getName(x) << "\n");
 	DBG_DUMP("-- instIDList:\n");
 	for(auto const &x : elem.getInstIDList())
-		DBG_DUMP("---- " << x << "\n");
+		DBG_DUMP("---- " << symbolTable.getName(x) << "\n");
 	DBG_DUMP("-- lineNoList:\n");
 	for(auto const &x : elem.getLineNoList())
 		DBG_DUMP("---- " << x << "\n");
@@ -311,282 +347,214 @@ template<> size_t ContextManager::writeElement<ParsedTraceContainer>(std::string
 		DBG_DUMP("---- " << x.first << ": <" << x.second.first << ", " << x.second.second << ">\n");
 	DBG_DUMP("-- getElementPtrList:\n");
 	for(auto const &x : elem.getGetElementPtrList())
-		DBG_DUMP("---- " << x.first << ": <" << x.second.first << ", " << x.second.second << ">\n");
+		DBG_DUMP("---- " << x.first << ": <" << symbolTable.getName(x.second.first) << ", " << x.second.second << ">\n");
 	DBG_DUMP("-- prevBBList:\n");
 	for(auto const &x : elem.getPrevBBList())
-		DBG_DUMP("---- " << x << "\n");
+		DBG_DUMP("---- " << symbolTable.getName(x) << "\n");
 	DBG_DUMP("-- currBBList:\n");
 	for(auto const &x : elem.getCurrBBList())
-		DBG_DUMP("---- " << x << "\n");
+		DBG_DUMP("---- " << symbolTable.getName(x) << "\n");
 	DBG_DUMP("-- resultSizeList:\n");
 	for(auto const &x : elem.getResultSizeList())
 		DBG_DUMP("---- " << x.first << ": <" << x.second << "\n");
 #endif
 
-	writtenSize += writeElement<std::string>(ss, const_cast<std::vector<std::string> &>(elem.getFuncList()));
-	writtenSize += writeElement<std::string>(ss, const_cast<std::vector<std::string> &>(elem.getInstIDList()));
-	writtenSize += writeElement<int>(ss, const_cast<std::vector<int> &>(elem.getLineNoList()));
-	writtenSize += writeElement<int, int64_t, unsigned>(ss, const_cast<std::unordered_map<int, std::pair<int64_t, unsigned>> &>(elem.getMemoryTraceList()));
-	writtenSize += writeElement<int, std::string, int64_t>(ss, const_cast<std::unordered_map<int, std::pair<std::string, int64_t>> &>(elem.getGetElementPtrList()));
-	writtenSize += writeElement<std::string>(ss, const_cast<std::vector<std::string> &>(elem.getPrevBBList()));
-	writtenSize += writeElement<std::string>(ss, const_cast<std::vector<std::string> &>(elem.getCurrBBList()));
-	writtenSize += writeElement<int, unsigned>(ss, const_cast<std::unordered_map<int, unsigned> &>(elem.getResultSizeList()));
+	std::string buffer;
+	elem.serialise(buffer);
+	size_t bufferSize = buffer.size();
+	writtenSize += writeElement<size_t>(ss, bufferSize);
+	ss.write(buffer.data(), bufferSize);
+	writtenSize += bufferSize;
 
 	return writtenSize;
 }
 
-template<typename T> void ContextManager::readElement(std::fstream &fs, T &elem) {
-	fs.read((char *) &elem, sizeof(T));
+template<typename T> void ContextManager::readElement(T &elem) {
+	readBytes((char *) &elem, sizeof(T));
 }
 
-template<> void ContextManager::readElement<std::string>(std::fstream &fs, std::string &elem) {
+template<> void ContextManager::readElement<std::string>(std::string &elem) {
 	size_t stringSize;
-	readElement<size_t>(fs, stringSize);
+	readElement<size_t>(stringSize);
 
 	assert(stringSize < BUFF_STR_SZ && "A read of more than BUFF_STR_SZ bytes was requested from context file and it was blocked. If you believe that this was not caused by a corrupt context file, increase BUFF_STR_SZ");
+	assert(stringSize <= (size_t) (mapping + mappingSize - readCursor) && "Context file is incomplete or corrupt");
 
-	char buff[BUFF_STR_SZ];
-	fs.read(buff, stringSize);
-	buff[stringSize] = '\0';
-	elem.assign(buff);
+	elem.assign(readCursor, stringSize);
+	readCursor += stringSize;
 }
 
-template<> void ContextManager::readElement<edgeNodeInfo>(std::fstream &fs, edgeNodeInfo &elem) {
-	readElement<unsigned>(fs, elem.sink);
-	readElement<int>(fs, elem.paramID);
+template<> void ContextManager::readElement<edgeNodeInfo>(edgeNodeInfo &elem) {
+	readElement<unsigned>(elem.sink);
+	readElement<int>(elem.paramID);
 }
 
-template<> void ContextManager::readElement<ddrInfoTy>(std::fstream &fs, ddrInfoTy &elem) {
-	readElement<unsigned>(fs, elem.loopLevel);
-	readElement<unsigned>(fs, elem.datapathType);
-	readElement<std::string>(fs, elem.arraysLoaded);
-	readElement<std::string>(fs, elem.arraysStored);
+template<> void ContextManager::readElement<ddrInfoTy>(ddrInfoTy &elem) {
+	readElement<unsigned>(elem.loopLevel);
+	readElement<unsigned>(elem.datapathType);
+	readElement<std::string>(elem.arraysLoaded);
+	readElement<std::string>(elem.arraysStored);
 }
 
-template<> void ContextManager::readElement<packInfoTy>(std::fstream &fs, packInfoTy &elem) {
-	readElement<unsigned>(fs, elem.loopLevel);
-	readElement<unsigned>(fs, elem.datapathType);
-	readElement<unsigned, unsigned, unsigned>(fs, elem.loadAlignments);
-	readElement<unsigned, unsigned, unsigned>(fs, elem.storeAlignments);
+template<> void ContextManager::readElement<packInfoTy>(packInfoTy &elem) {
+	readElement<unsigned>(elem.loopLevel);
+	readElement<unsigned>(elem.datapathType);
+	readElement<unsigned, unsigned, unsigned>(elem.loadAlignments);
+	readElement<unsigned, unsigned, unsigned>(elem.storeAlignments);
 }
 
-template<> void ContextManager::readElement<outBurstInfoTy>(std::fstream &fs, outBurstInfoTy &elem) {
-	readElement<bool>(fs, elem.canOutBurst);
-	readElement<bool>(fs, elem.isRegistered);
-	readElement<uint64_t>(fs, elem.baseAddress);
-	readElement<uint64_t>(fs, elem.offset);
+template<> void ContextManager::readElement<outBurstInfoTy>(outBurstInfoTy &elem) {
+	readElement<bool>(elem.canOutBurst);
+	readElement<bool>(elem.isRegistered);
+	readElement<uint64_t>(elem.baseAddress);
+	readElement<uint64_t>(elem.offset);
 #ifdef VAR_WSIZE
-	readElement<uint64_t>(fs, elem.wordSize);
+	readElement<uint64_t>(elem.wordSize);
 #endif
 }
 
-template<> void ContextManager::readElement<globalOutBurstsInfoTy>(std::fstream &fs, globalOutBurstsInfoTy &elem) {
-	readElement<unsigned>(fs, elem.loopLevel);
-	readElement<unsigned>(fs, elem.datapathType);
-	readElement<std::string, outBurstInfoTy>(fs, elem.loadOutBurstsFound);
-	readElement<std::string, outBurstInfoTy>(fs, elem.storeOutBurstsFound);
+template<> void ContextManager::readElement<globalOutBurstsInfoTy>(globalOutBurstsInfoTy &elem) {
+	readElement<unsigned>(elem.loopLevel);
+	readElement<unsigned>(elem.datapathType);
+	readElement<std::string, outBurstInfoTy>(elem.loadOutBurstsFound);
+	readElement<std::string, outBurstInfoTy>(elem.storeOutBurstsFound);
 }
 
-template<typename E> void ContextManager::readElement(std::fstream &fs, std::vector<E> &elem) {
+template<typename E> void ContextManager::readElement(std::vector<E> &elem) {
 	size_t elemSize;
-	readElement<size_t>(fs, elemSize);
+	readElement<size_t>(elemSize);
 
 	elem.clear();
+
+	// Vectors of plain values are copied at once from the mapping
+	if(std::is_arithmetic<E>::value) {
+		assert(elemSize <= (size_t) (mapping + mappingSize - readCursor) / sizeof(E) && "Context file is incomplete or corrupt");
+		elem.resize(elemSize);
+		readBytes((char *) elem.data(), elemSize * sizeof(E));
+		return;
+	}
+
+	elem.reserve(elemSize);
 	for(size_t i = 0; i < elemSize; i++) {
 		E ee;
-		readElement<E>(fs, ee);
+		readElement<E>(ee);
 
 		elem.push_back(ee);
 	}
 }
 
-template<typename E> void ContextManager::readElement(std::fstream &fs, std::set<E> &elem) {
+template<typename E> void ContextManager::readElement(std::set<E> &elem) {
 	size_t setSize;
-	readElement<size_t>(fs, setSize);
+	readElement<size_t>(setSize);
 
 	elem.clear();
 	for(size_t i = 0; i < setSize; i++) {
 		E ee;
-		readElement<E>(fs, ee);
+		readElement<E>(ee);
 
 		elem.insert(ee);
 	}
 }
 
-template<typename K, typename E> void ContextManager::readElement(std::fstream &fs, std::map<K, E> &elem) {
+template<typename K, typename E> void ContextManager::readElement(std::map<K, E> &elem) {
 	size_t mapSize;
-	readElement<size_t>(fs, mapSize);
+	readElement<size_t>(mapSize);
 
 	elem.clear();
 	for(size_t i = 0; i < mapSize; i++) {
 		K kk;
-		readElement<K>(fs, kk);
+		readElement<K>(kk);
 		E ee;
-		readElement<E>(fs, ee);
+		readElement<E>(ee);
 
 		elem.insert(std::make_pair(kk, ee));
 	}
 }
 
-template<typename K, typename E> void ContextManager::readElement(std::fstream &fs, std::unordered_map<K, E> &elem) {
+template<typename K, typename E> void ContextManager::readElement(std::unordered_map<K, E> &elem) {
 	size_t mapSize;
-	readElement<size_t>(fs, mapSize);
+	readElement<size_t>(mapSize);
 
 	elem.clear();
 	for(size_t i = 0; i < mapSize; i++) {
 		K kk;
-		readElement<K>(fs, kk);
+		readElement<K>(kk);
 		E ee;
-		readElement<E>(fs, ee);
+		readElement<E>(ee);
 
 		elem.insert(std::make_pair(kk, ee));
 	}
 }
 
-template<typename K, typename E> void ContextManager::readElement(std::fstream &fs, std::unordered_map<K, std::vector<E>> &elem) {
+template<typename K, typename E> void ContextManager::readElement(std::unordered_map<K, std::vector<E>> &elem) {
 	size_t mapSize;
-	readElement<size_t>(fs, mapSize);
+	readElement<size_t>(mapSize);
 
 	elem.clear();
 	for(size_t i = 0; i < mapSize; i++) {
 		K kk;
-		readElement<K>(fs, kk);
+		readElement<K>(kk);
 		std::vector<E> ee;
-		readElement<E>(fs, ee);
+		readElement<E>(ee);
 
 		elem.insert(std::make_pair(kk, ee));
 	}
 }
 
-template<typename K, typename L, typename E> void ContextManager::readElement(std::fstream &fs, std::unordered_map<std::pair<K, L>, std::vector<E>, boost::hash<std::pair<K, L>>> &elem) {
+template<typename K, typename L, typename E> void ContextManager::readElement(std::unordered_map<std::pair<K, L>, std::vector<E>, boost::hash<std::pair<K, L>>> &elem) {
 	size_t mapSize;
-	readElement<size_t>(fs, mapSize);
+	readElement<size_t>(mapSize);
 
 	elem.clear();
 	for(size_t i = 0; i < mapSize; i++) {
 		K kk;
-		readElement<K>(fs, kk);
+		readElement<K>(kk);
 		L ll;
-		readElement<L>(fs, ll);
+		readElement<L>(ll);
 		std::vector<E> ee;
-		readElement<E>(fs, ee);
+		readElement<E>(ee);
 
 		elem.insert(std::make_pair(std::make_pair(kk, ll), ee));
 	}
 }
 
-template<typename K, typename E, typename F> void ContextManager::readElement(std::fstream &fs, std::unordered_map<K, std::pair<E, F>> &elem) {
+template<typename K, typename E, typename F> void ContextManager::readElement(std::unordered_map<K, std::pair<E, F>> &elem) {
 	size_t mapSize;
-	readElement<size_t>(fs, mapSize);
+	readElement<size_t>(mapSize);
 
 	elem.clear();
 	for(size_t i = 0; i < mapSize; i++) {
 		K kk;
-		readElement<K>(fs, kk);
+		readElement<K>(kk);
 		E ee;
-		readElement<E>(fs, ee);
+		readElement<E>(ee);
 		F ff;
-		readElement<F>(fs, ff);
+		readElement<F>(ff);
 
 		elem.insert(std::make_pair(kk, std::make_pair(ee, ff)));
 	}
 }
 
-template<> void ContextManager::readElement<ParsedTraceContainer>(std::fstream &fs, ParsedTraceContainer &elem) {
+template<> void ContextManager::readElement<ParsedTraceContainer>(ParsedTraceContainer &elem) {
 	elem = ParsedTraceContainer(elem.getKernelName());
 
-	elem.openAndClearAllFiles();
-
-	size_t funcListSize;
-	readElement<size_t>(fs, funcListSize);
-	for(size_t i = 0; i < funcListSize; i++) {
-		std::string ee;
-		readElement<std::string>(fs, ee);
-
-		elem.appendToFuncList(ee);
-	}
-
-	size_t instIDListSize;
-	readElement<size_t>(fs, instIDListSize);
-	for(size_t i = 0; i < instIDListSize; i++) {
-		std::string ee;
-		readElement<std::string>(fs, ee);
-
-		elem.appendToInstIDList(ee);
-	}
-
-	size_t lineNoListSize;
-	readElement<size_t>(fs, lineNoListSize);
-	for(size_t i = 0; i < lineNoListSize; i++) {
-		int ee;
-		readElement<int>(fs, ee);
-
-		elem.appendToLineNoList(ee);
-	}
+	size_t bufferSize;
+	readElement<size_t>(bufferSize);
+	assert(bufferSize <= (size_t) (mapping + mappingSize - readCursor) && "Context file is incomplete or corrupt");
 
-	size_t memoryTraceListSize;
-	readElement<size_t>(fs, memoryTraceListSize);
-	for(size_t i = 0; i < memoryTraceListSize; i++) {
-		int kk;
-		readElement<int>(fs, kk);
-		int64_t ee;
-		readElement<int64_t>(fs, ee);
-		unsigned ff;
-		readElement<unsigned>(fs, ff);
-
-		elem.appendToMemoryTraceList(kk, ee, ff);
-	}
-
-	size_t getElementPtrListSize;
-	readElement<size_t>(fs, getElementPtrListSize);
-	for(size_t i = 0; i < getElementPtrListSize; i++) {
-		int kk;
-		readElement<int>(fs, kk);
-		std::string ee;
-		readElement<std::string>(fs, ee);
-		int64_t ff;
-		readElement<int64_t>(fs, ff);
-
-		elem.appendToGetElementPtrList(kk, ee, ff);
-	}
-
-	size_t prevBBListSize;
-	readElement<size_t>(fs, prevBBListSize);
-	for(size_t i = 0; i < prevBBListSize; i++) {
-		std::string ee;
-		readElement<std::string>(fs, ee);
-
-		elem.appendToPrevBBList(ee);
-	}
-
-	size_t currBBListSize;
-	readElement<size_t>(fs, currBBListSize);
-	for(size_t i = 0; i < currBBListSize; i++) {
-		std::string ee;
-		readElement<std::string>(fs, ee);
-
-		elem.appendToCurrBBList(ee);
-	}
-
-	size_t resultSizeListSize;
-	readElement<size_t>(fs, resultSizeListSize);
-	for(size_t i = 0; i < resultSizeListSize; i++) {
-		int ee;
-		readElement<int>(fs, ee);
-		unsigned ff;
-		readElement<unsigned>(fs, ff);
-
-		elem.appendToResultSizeList(ee, ff);
-	}
+	// Deserialised straight from the mapping
+	elem.deserialise(readCursor, bufferSize);
+	readCursor += bufferSize;
+	elem.pack();
 
 #if defined(DBG_PRINT_CTX) || defined(DBG_PRINT_ALL)
 	DBG_DUMP("Dump of ParsedTraceContainer\n");
 	DBG_DUMP("-- funcList:\n");
 	for(auto const &x : elem.getFuncList())
-		DBG_DUMP("---- " << x << "\n");
+		DBG_DUMP("---- " << symbolTable.getName(x) << "\n");
 	DBG_DUMP("-- instIDList:\n");
 	for(auto const &x : elem.getInstIDList())
-		DBG_DUMP("---- " << x << "\n");
+		DBG_DUMP("---- " << symbolTable.getName(x) << "\n");
 	DBG_DUMP("-- lineNoList:\n");
 	for(auto const &x : elem.getLineNoList())
 		DBG_DUMP("---- " << x << "\n");
@@ -595,20 +563,20 @@ template<> void ContextManager::readElement<ParsedTraceContainer>(std::fstream &
 		DBG_DUMP("---- " << x.first << ": <" << x.second.first << ", " << x.second.second << ">\n");
 	DBG_DUMP("-- getElementPtrList:\n");
 	for(auto const &x : elem.getGetElementPtrList())
-		DBG_DUMP("---- " << x.first << ": <" << x.second.first << ", " << x.second.second << ">\n");
+		DBG_DUMP("---- " << x.first << ": <" << symbolTable.getName(x.second.first) << ", " << x.second.second << ">\n");
 	DBG_DUMP("-- prevBBList:\n");
 	for(auto const &x : elem.getPrevBBList())
-		DBG_DUMP("---- " << x << "\n");
+		DBG_DUMP("---- " << symbolTable.getName(x) << "\n");
 	DBG_DUMP("-- currBBList:\n");
 	for(auto const &x : elem.getCurrBBList())
-		DBG_DUMP("---- " << x << "\n");
+		DBG_DUMP("---- " << symbolTable.getName(x) << "\n");
 	DBG_DUMP("-- resultSizeList:\n");
 	for(auto const &x : elem.getResultSizeList())
 		DBG_DUMP("---- " << x.first << ": <" << x.second << "\n");
 #endif
 }
 
-template<> void ContextManager::readElement<BaseDatapath>(std::fstream &fs, BaseDatapath &elem) {
+template<> void ContextManager::readElement<BaseDatapath>(BaseDatapath &elem) {
 #if defined(DBG_PRINT_CTX) || defined(DBG_PRINT_ALL)
 	DBG_DUMP("Dump of DDDG:\n");
 #endif
@@ -619,12 +587,12 @@ template<> void ContextManager::readElement<BaseDatapath>(std::fstream &fs, Base
 	DBG_DUMP("-- edgeTables.first:\n");
 #endif
 	size_t edgeListFirstSize;
-	readElement<size_t>(fs, edgeListFirstSize);
+	readElement<size_t>(edgeListFirstSize);
 	for(size_t i = 0; i < edgeListFirstSize; i++) {
 		unsigned kk;
-		readElement<unsigned>(fs, kk);
+		readElement<unsigned>(kk);
 		edgeNodeInfo ee;
-		readElement<edgeNodeInfo>(fs, ee);
+		readElement<edgeNodeInfo>(ee);
 
 #if defined(DBG_PRINT_CTX) || defined(DBG_PRINT_ALL)
 		DBG_DUMP("---- " << kk << ": <" << ee.sink << ", " << ee.paramID << ">\n");
@@ -636,12 +604,12 @@ template<> void ContextManager::readElement<BaseDatapath>(std::fstream &fs, Base
 	DBG_DUMP("-- edgeTables.second:\n");
 #endif
 	size_t edgeListSecondSize;
-	readElement<size_t>(fs, edgeListSecondSize);
+	readElement<size_t>(edgeListSecondSize);
 	for(size_t i = 0; i < edgeListSecondSize; i++) {
 		unsigned kk;
-		readElement<unsigned>(fs, kk);
+		readElement<unsigned>(kk);
 		edgeNodeInfo ee;
-		readElement<edgeNodeInfo>(fs, ee);
+		readElement<edgeNodeInfo>(ee);
 
 #if defined(DBG_PRINT_CTX) || defined(DBG_PRINT_ALL)
 		DBG_DUMP("---- " << kk << ": <" << ee.sink << ", " << ee.paramID << ">\n");
@@ -653,25 +621,118 @@ template<> void ContextManager::readElement<BaseDatapath>(std::fstream &fs, Base
 	DBG_DUMP("-- microops:\n");
 #endif
 	size_t microopsSize;
-	readElement<size_t>(fs, microopsSize);
+	readElement<size_t>(microopsSize);
 	for(size_t i = 0; i < microopsSize; i++) {
 		int ee;
-		readElement<int>(fs, ee);
+		readElement<int>(ee);
 
 #if defined(DBG_PRINT_CTX) || defined(DBG_PRINT_ALL)
 		DBG_DUMP("---- " << ee << "\n");
 #endif
 		elem.insertMicroop(ee);
 	}
+
+#if defined(DBG_PRINT_CTX) || defined(DBG_PRINT_ALL)
+	DBG_DUMP("-- nodeIterations:\n");
+#endif
+	size_t nodeIterationsSize;
+	readElement<size_t>(nodeIterationsSize);
+	for(size_t i = 0; i < nodeIterationsSize; i++) {
+		unsigned ee;
+		readElement<unsigned>(ee);
+
+#if defined(DBG_PRINT_CTX) || defined(DBG_PRINT_ALL)
+		DBG_DUMP("---- " << ee << "\n");
+#endif
+		elem.insertNodeIteration(ee);
+	}
+
+#if defined(DBG_PRINT_CTX) || defined(DBG_PRINT_ALL)
+	DBG_DUMP("-- carriedEdges:\n");
+#endif
+	size_t carriedEdgesSize;
+	readElement<size_t>(carriedEdgesSize);
+	for(size_t i = 0; i < carriedEdgesSize; i++) {
+		carriedEdgeTy ee;
+		readElement<carriedEdgeTy>(ee);
+
+#if defined(DBG_PRINT_CTX) || defined(DBG_PRINT_ALL)
+		DBG_DUMP("---- " << ee.source << ": <" << ee.sink << ", " << ee.distance << ">\n");
+#endif
+		elem.insertCarriedEdge(ee.source, ee.sink, ee.distance);
+	}
+}
+
+template<typename T> void ContextManager::skipElement() {
+	skipBytes(sizeof(T));
+}
+
+// Append the TOC to a context file being written
+void ContextManager::writeTOC() {
+	size_t totalFieldSize = 0;
+	std::stringstream ss;
+
+	uint64_t numEntries = toc.size();
+	totalFieldSize += writeElement<uint64_t>(ss, numEntries);
+	for(auto &it : toc) {
+		char type = std::get<0>(it.first);
+		std::string ID = std::get<1>(it.first);
+		uint64_t ID2 = std::get<2>(it.first);
+		totalFieldSize += writeElement<char>(ss, type);
+		totalFieldSize += writeElement<std::string>(ss, ID);
+		totalFieldSize += writeElement<uint64_t>(ss, ID2);
+		totalFieldSize += writeElement<uint64_t>(ss, it.second.first);
+		totalFieldSize += writeElement<uint64_t>(ss, it.second.second);
+	}
+
+	uint64_t tocOffset = contextFile.tellp();
+	totalFieldSize += writeElement<uint64_t>(ss, tocOffset);
+
+	commit(ContextManager::TYPE_TOC, ss, totalFieldSize);
 }
 
-template<typename T> void ContextManager::skipElement(std::fstream &fs) {
-	fs.seekg(sizeof(T), std::ios::cur);
+// Load the TOC of a mapped context file. Returns false if the file has no (complete) TOC
+bool ContextManager::readTOC() {
+	size_t magicSize = std::string(FILE_CONTEXT_MANAGER_MAGIC_STRING).size();
+	if(mappingSize < magicSize + 1 + sizeof(size_t) + 2 * sizeof(uint64_t))
+		return false;
+
+	uint64_t tocOffset;
+	memcpy(&tocOffset, mapping + mappingSize - sizeof(uint64_t), sizeof(uint64_t));
+	if(tocOffset < magicSize || tocOffset > mappingSize - (1 + sizeof(size_t) + 2 * sizeof(uint64_t)))
+		return false;
+
+	size_t totalFieldSize;
+	readCursor = mapping + tocOffset;
+	char type;
+	readElement<char>(type);
+	readElement<size_t>(totalFieldSize);
+	if(ContextManager::TYPE_TOC != type || totalFieldSize != mappingSize - tocOffset - 1 - sizeof(size_t))
+		return false;
+
+	uint64_t numEntries;
+	readElement<uint64_t>(numEntries);
+	for(uint64_t i = 0; i < numEntries; i++) {
+		char entryType;
+		std::string ID;
+		uint64_t ID2, offset, size;
+		readElement<char>(entryType);
+		readElement<std::string>(ID);
+		readElement<uint64_t>(ID2);
+		readElement<uint64_t>(offset);
+		readElement<uint64_t>(size);
+
+		assert(offset >= magicSize && offset <= tocOffset && size <= tocOffset - offset && "Context file is corrupt");
+		toc.insert(std::make_pair(std::make_tuple(entryType, ID, ID2), std::make_pair(offset, size)));
+	}
+
+	return true;
 }
 
 void ContextManager::commit(char elemType, std::stringstream &ss, size_t totalFieldSize, std::string optID, uint64_t optID2) {
 	std::string toWrite(ss.str());
 	size_t toWriteLen = toWrite.length();
+	uint64_t offset = contextFile.tellp();
 
 	// Commit to file
 	contextFile.write(&elemType, 1);
@@ -690,19 +751,38 @@ void ContextManager::commit(char elemType, std::stringstream &ss, size_t totalFi
 		contextFile.write((char *) &totalFieldSize, sizeof(size_t));
 	}
 	contextFile.write(toWrite.c_str(), toWriteLen);
+
+	// If a record is written more than once, the TOC points to the first one
+	if(elemType != ContextManager::TYPE_TOC)
+		toc.insert(std::make_pair(std::make_tuple(elemType, optID, optID2), std::make_pair(offset, (uint64_t) contextFile.tellp() - offset)));
 }
 
 void ContextManager::commit(char elemType, std::stringstream &ss) {
 	std::string toWrite(ss.str());
 	size_t toWriteLen = toWrite.length();
+	uint64_t offset = contextFile.tellp();
 
 	// Commit to file
 	contextFile.write(&elemType, 1);
 	contextFile.write(toWrite.c_str(), toWriteLen);
+
+	toc.insert(std::make_pair(std::make_tuple(elemType, std::string(""), (uint64_t) 0), std::make_pair(offset, (uint64_t) 1 + toWriteLen)));
 }
 
 ContextManager::ContextManager() : fileName(args.outWorkDir + FILE_CONTEXT_MANAGER) {
 	readOnly = false;
+	hasTOC = false;
+	mapping = nullptr;
+	mappingSize = 0;
+	readCursor = nullptr;
+}
+
+ContextManager::ContextManager(std::string fileName) : fileName(fileName) {
+	readOnly = false;
+	hasTOC = false;
+	mapping = nullptr;
+	mappingSize = 0;
+	readCursor = nullptr;
 }
 
 ContextManager::~ContextManager() {
@@ -722,25 +802,54 @@ void ContextManager::openForWrite() {
 
 void ContextManager::openForRead() {
 	close();
-	contextFile.open(fileName, std::ios::in | std::ios::binary);
 
-	assert(contextFile.is_open() && "Could not open context file");
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	assert(fd != -1 && "Could not open context file");
+
+	struct stat fileStat;
+	size_t magicSize = std::string(FILE_CONTEXT_MANAGER_MAGIC_STRING).size();
+	assert(!fstat(fd, &fileStat) && (size_t) fileStat.st_size >= magicSize && "Invalid or corrupt context file found");
+
+	void *addr = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	// The mapping stays valid after the file descriptor is closed
+	::close(fd);
+	assert(addr != MAP_FAILED && "Could not map context file");
 
-	char magicBits[4];
-	contextFile.read(magicBits, std::string(FILE_CONTEXT_MANAGER_MAGIC_STRING).size());
-	magicBits[3] = '\0';
-	assert(std::string(magicBits) == FILE_CONTEXT_MANAGER_MAGIC_STRING && "Invalid or corrupt context file found");
+	mapping = (const char *) addr;
+	mappingSize = fileStat.st_size;
+
+	std::string magicBits(mapping, magicSize);
+	assert((FILE_CONTEXT_MANAGER_MAGIC_STRING == magicBits || magicBits.compare(0, std::string(FILE_CONTEXT_MANAGER_MAGIC_PREFIX).size(), FILE_CONTEXT_MANAGER_MAGIC_PREFIX)) && "Context file was written by another version, regenerate it (e.g. with \"--mma-mode=gen\")");
+	assert(FILE_CONTEXT_MANAGER_MAGIC_STRING == magicBits && "Invalid or corrupt context file found");
+
+	// Files that were not closed properly have no TOC
+	hasTOC = readTOC();
+	if(!hasTOC)
+		toc.clear();
+	readCursor = mapping + magicSize;
 
 	readOnly = true;
 }
 
 void ContextManager::close() {
-	if(isOpen())
+	if(contextFile.is_open()) {
+		if(!readOnly)
+			writeTOC();
 		contextFile.close();
+	}
+
+	if(mapping)
+		munmap((void *) mapping, mappingSize);
+
+	toc.clear();
+	hasTOC = false;
+	mapping = nullptr;
+	mappingSize = 0;
+	readCursor = nullptr;
 }
 
 bool ContextManager::isOpen() {
-	return contextFile.is_open();
+	return contextFile.is_open() || mapping != nullptr;
 }
 
 void ContextManager::saveProgressiveTraceInfo(long int &cursor, uint64_t &instCount) {
@@ -756,10 +865,9 @@ void ContextManager::getProgressiveTraceInfo(long int *cursor, uint64_t *instCou
 	assert(readOnly && "Attempt to read progressive trace info from a write-only context manager");
 	assert(seekTo(ContextManager::TYPE_PROGRESSIVE_TRACE_INFO) && "Progressive trace info not found at the context manager");
 
-	readElement<long int>(contextFile, *cursor);
-	readElement<uint64_t>(contextFile, *instCount);
+	readElement<long int>(*cursor);
+	readElement<uint64_t>(*instCount);
 
-	assert(!(contextFile.eof()) && "Context file is incomplete or corrupt");
 }
 
 void ContextManager::saveLoopBoundInfo(wholeloopName2loopBoundMapTy &wholeloopName2loopBoundMap) {
@@ -781,8 +889,8 @@ void ContextManager::getLoopBoundInfo(wholeloopName2loopBoundMapTy *wholeloopNam
 	assert(readOnly && "Attempt to read loop bound info from a write-only context manager");
 	assert(seekTo(ContextManager::TYPE_LOOP_BOUND_INFO) && "Loop bound info not found at the context manager");
 
-	skipElement<size_t>(contextFile);
-	readElement<std::string, uint64_t>(contextFile, *wholeloopName2loopBoundMap);
+	skipElement<size_t>();
+	readElement<std::string, uint64_t>(*wholeloopName2loopBoundMap);
 
 #if defined(DBG_PRINT_CTX) || defined(DBG_PRINT_ALL)
 	DBG_DUMP("Dump of wholeloopName2loopBoundMap:\n");
@@ -790,7 +898,6 @@ void ContextManager::getLoopBoundInfo(wholeloopName2loopBoundMapTy *wholeloopNam
 		DBG_DUMP("-- " << x.first << ": " << x.second << "\n");
 #endif
 
-	assert(!(contextFile.eof()) && "Context file is incomplete or corrupt");
 }
 
 void ContextManager::saveParsedTraceContainer(std::string wholeLoopName, unsigned datapathType, unsigned unrollFactor, ParsedTraceContainer &PC) {
@@ -808,9 +915,8 @@ void ContextManager::getParsedTraceContainer(std::string wholeLoopName, unsigned
 	uint64_t code = ((((uint64_t) unrollFactor) << 32) & 0xffffffff00000000) | (datapathType & 0x00000000ffffffff);
 	assert(seekToIdentified(ContextManager::TYPE_PARSED_TRACE_CONTAINER, wholeLoopName, code) && "Requested progressive trace container not found at the context manager");
 
-	readElement<ParsedTraceContainer>(contextFile, *PC);
+	readElement<ParsedTraceContainer>(*PC);
 
-	assert(!(contextFile.eof()) && "Context file is incomplete or corrupt");
 }
 
 void ContextManager::saveDDDG(std::string wholeLoopName, unsigned datapathType, unsigned unrollFactor, DDDGBuilder &builder, std::vector<int> &microops) {
@@ -828,6 +934,12 @@ void ContextManager::saveDDDG(std::string wholeLoopName, unsigned datapathType,
 	DBG_DUMP("-- microops:\n");
 	for(auto const &x : microops)
 		DBG_DUMP("---- " << x << "\n");
+	DBG_DUMP("-- nodeIterations:\n");
+	for(auto const &x : builder.getNodeIterations())
+		DBG_DUMP("---- " << x << "\n");
+	DBG_DUMP("-- carriedEdges:\n");
+	for(auto const &x : builder.getCarriedEdges())
+		DBG_DUMP("---- " << x.source << ": <" << x.sink << ", " << x.distance << ">\n");
 #endif
 
 	size_t totalFieldSize = 0;
@@ -836,6 +948,8 @@ void ContextManager::saveDDDG(std::string wholeLoopName, unsigned datapathType,
 	totalFieldSize += writeElement<unsigned, edgeNodeInfo>(ss, const_cast<u2eMMap &>(edgeTables.first));
 	totalFieldSize += writeElement<unsigned, edgeNodeInfo>(ss, const_cast<u2eMMap &>(edgeTables.second));
 	totalFieldSize += writeElement<int>(ss, microops);
+	totalFieldSize += writeElement<unsigned>(ss, const_cast<std::vector<unsigned> &>(builder.getNodeIterations()));
+	totalFieldSize += writeElement<carriedEdgeTy>(ss, const_cast<std::vector<carriedEdgeTy> &>(builder.getCarriedEdges()));
 	commit(ContextManager::TYPE_DDDG, ss, totalFieldSize, wholeLoopName, code);
 }
 
@@ -844,9 +958,8 @@ void ContextManager::getDDDG(std::string wholeLoopName, unsigned datapathType, u
 	uint64_t code = ((((uint64_t) unrollFactor) << 32) & 0xffffffff00000000) | (datapathType & 0x00000000ffffffff);
 	assert(seekToIdentified(ContextManager::TYPE_DDDG, wholeLoopName, code) && "Requested DDDG not found at the context manager");
 
-	readElement<BaseDatapath>(contextFile, *datapath);
+	readElement<BaseDatapath>(*datapath);
 
-	assert(!(contextFile.eof()) && "Context file is incomplete or corrupt");
 }
 
 void ContextManager::saveGlobalOutBurstsInfo(std::unordered_map<std::string, std::vector<globalOutBurstsInfoTy>> &globalOutBurstsInfo) {
@@ -894,8 +1007,8 @@ void ContextManager::getGlobalOutBurstsInfo(std::unordered_map<std::string, std:
 	assert(readOnly && "Attempt to read global out-bursts info from a write-only context manager");
 	assert(seekTo(ContextManager::TYPE_GLOBAL_OUTBURSTS_INFO) && "Global out-bursts info not found at the context manager");
 
-	skipElement<size_t>(contextFile);
-	readElement<std::string, globalOutBurstsInfoTy>(contextFile, *globalOutBurstsInfo);
+	skipElement<size_t>();
+	readElement<std::string, globalOutBurstsInfoTy>(*globalOutBurstsInfo);
 
 #if defined(DBG_PRINT_CTX) || defined(DBG_PRINT_ALL)
 	DBG_DUMP("Dump of globalOutBurstsInfo:\n");
@@ -929,7 +1042,6 @@ void ContextManager::getGlobalOutBurstsInfo(std::unordered_map<std::string, std:
 	}
 #endif
 
-	assert(!(contextFile.eof()) && "Context file is incomplete or corrupt");
 }
 
 void ContextManager::saveGlobalDDRMap(std::unordered_map<std::string, std::vector<ddrInfoTy>> &globalDDRMap) {
@@ -961,8 +1073,8 @@ void ContextManager::getGlobalDDRMap(std::unordered_map<std::string, std::vector
 	assert(readOnly && "Attempt to read global DDR map from a write-only context manager");
 	assert(seekTo(ContextManager::TYPE_GLOBAL_DDR_MAP) && "Requested global DDR map not found at the context manager");
 
-	skipElement<size_t>(contextFile);
-	readElement<std::string, ddrInfoTy>(contextFile, *globalDDRMap);
+	skipElement<size_t>();
+	readElement<std::string, ddrInfoTy>(*globalDDRMap);
 
 #if defined(DBG_PRINT_CTX) || defined(DBG_PRINT_ALL)
 	DBG_DUMP("Dump of globalDDRMap:\n");
@@ -980,7 +1092,6 @@ void ContextManager::getGlobalDDRMap(std::unordered_map<std::string, std::vector
 	}
 #endif
 
-	assert(!(contextFile.eof()) && "Context file is incomplete or corrupt");
 }
 
 void ContextManager::saveGlobalPackInfo(std::unordered_map<arrayPackSzPairTy, std::vector<packInfoTy>, boost::hash<arrayPackSzPairTy>> &globalPackInfo) {
@@ -1012,8 +1123,8 @@ void ContextManager::getGlobalPackInfo(std::unordered_map<arrayPackSzPairTy, std
 	assert(readOnly && "Attempt to read global pack info from a write-only context manager");
 	assert(seekTo(ContextManager::TYPE_GLOBAL_PACK_INFO) && "Requested global pack info not found at the context manager");
 
-	skipElement<size_t>(contextFile);
-	readElement<std::string, unsigned, packInfoTy>(contextFile, *globalPackInfo);
+	skipElement<size_t>();
+	readElement<std::string, unsigned, packInfoTy>(*globalPackInfo);
 
 #if defined(DBG_PRINT_CTX) || defined(DBG_PRINT_ALL)
 	DBG_DUMP("Dump of globalPackInfo:\n");
@@ -1031,6 +1142,23 @@ void ContextManager::getGlobalPackInfo(std::unordered_map<arrayPackSzPairTy, std
 	}
 #endif
 
-	assert(!(contextFile.eof()) && "Context file is incomplete or corrupt");
+}
+
+void ContextManager::saveCacheKey(std::string &key) {
+	assert(!readOnly && "Attempt to save cache key on a read-only context manager");
+
+	size_t totalFieldSize = 0;
+	std::stringstream ss;
+	totalFieldSize += writeElement<std::string>(ss, key);
+	commit(ContextManager::TYPE_CACHE_KEY, ss, totalFieldSize);
+}
+
+void ContextManager::getCacheKey(std::string *key) {
+	assert(readOnly && "Attempt to read cache key from a write-only context manager");
+	assert(seekTo(ContextManager::TYPE_CACHE_KEY) && "Cache key not found at the context manager");
+
+	skipElement<size_t>();
+	readElement<std::string>(*key);
+
 }
 
@@ -1,6 +1,14 @@
 #include "profile_h/DDDGBuilder.h"
 
+#include <string.h>
+
 #include "profile_h/BaseDatapath.h"
+#ifdef LOOP_TRIP_COUNTS
+#include "profile_h/LoopTripCounts.h"
+#endif
+#ifdef TRACE_INTERVAL_PLAN
+#include "profile_h/TraceIntervalPlan.h"
+#endif
 
 #ifdef FUTURE_CACHE
 std::string FutureCache::constructKey(
@@ -23,7 +31,7 @@ void FutureCache::dumpSummary(std::ofstream *summaryFile) {
 bool FutureCache::load() {
 	std::ifstream futureCacheFile;
 
-	futureCacheFile.open(args.workDir + FILE_FUTURE_CACHE, std::ios::in | std::ios::binary);
+	futureCacheFile.open(args.workDir + (args.binaryTrace? FILE_FUTURE_CACHE_BIN : FILE_FUTURE_CACHE), std::ios::in | std::ios::binary);
 	if(futureCacheFile.is_open()) {
 		/* Check for magic bits in future cache file */
 		char magicBits[4];
@@ -81,7 +89,7 @@ bool FutureCache::load() {
 void FutureCache::save() {
 	std::ofstream futureCacheFile;
 
-	futureCacheFile.open(args.workDir + FILE_FUTURE_CACHE, std::ios::out | std::ios::binary);
+	futureCacheFile.open(args.workDir + (args.binaryTrace? FILE_FUTURE_CACHE_BIN : FILE_FUTURE_CACHE), std::ios::out | std::ios::binary);
 	if(futureCacheFile.is_open()) {
 		futureCacheFile.write(FILE_FUTURE_CACHE_MAGIC_STRING, std::string(FILE_FUTURE_CACHE_MAGIC_STRING).size());
 
@@ -137,617 +145,394 @@ std::pair<FutureCache::iterator, bool> FutureCache::insert(
 }
 #endif
 
-ParsedTraceContainer::ParsedTraceContainer(std::string kernelName) : kernelName(kernelName) {
-	funcFileName = args.outWorkDir + kernelName + "_dynamicfuncid.gz";
-	instIDFileName = args.outWorkDir + kernelName + "_instid.gz";
-	lineNoFileName = args.outWorkDir + kernelName + "_linenum.gz";
-	memoryTraceFileName = args.outWorkDir + kernelName + "_memaddr.gz";
-	getElementPtrFileName = args.outWorkDir + kernelName + "_getelementptr.gz";
-	prevBasicBlockFileName = args.outWorkDir + kernelName + "_prevbasicblock.gz";
-	currBasicBlockFileName = args.outWorkDir + kernelName + "_currbasicblock.gz";
-	resultSizeFileName = args.outWorkDir + kernelName + "_resultsize.gz";
-
-	funcFile = Z_NULL;
-	instIDFile = Z_NULL;
-	lineNoFile = Z_NULL;
-	memoryTraceFile = Z_NULL;
-	getElementPtrFile = Z_NULL;
-	prevBasicBlockFile = Z_NULL;
-	currBasicBlockFile = Z_NULL;
-	resultSizeFile = Z_NULL;
-
-	compressed = args.compressed;
-	keepAliveRead = false;
-	keepAliveWrite = false;
-	locked = false;
-
-	funcList.clear();
-	instIDList.clear();
-	lineNoList.clear();
-	memoryTraceList.clear();
-	getElementPtrList.clear();
-	prevBasicBlockList.clear();
-	currBasicBlockList.clear();
-	resultSizeList.clear();
+// Column (de)serialisation. Values are copied raw, pairs field by field
+template<typename T> static void packValue(std::string &buffer, const T &value) {
+	buffer.append((const char *) &value, sizeof(T));
 }
 
-ParsedTraceContainer::~ParsedTraceContainer() {
-	if(funcFile)
-		gzclose(funcFile);
-	if(instIDFile)
-		gzclose(instIDFile);
-	if(lineNoFile)
-		gzclose(lineNoFile);
-	if(memoryTraceFile)
-		gzclose(memoryTraceFile);
-	if(getElementPtrFile)
-		gzclose(getElementPtrFile);
-	if(prevBasicBlockFile)
-		gzclose(prevBasicBlockFile);
-	if(currBasicBlockFile)
-		gzclose(currBasicBlockFile);
-	if(resultSizeFile)
-		gzclose(resultSizeFile);
-}
-
-void ParsedTraceContainer::openAndClearAllFiles() {
-	assert(!locked && "This container is locked, no modification permitted");
-	assert(!keepAliveRead && "This container is open for read, no modification permitted");
-
-	closeAllFiles();
-
-	if(compressed) {
-		funcFile = gzopen(funcFileName.c_str(), "w");
-		assert(funcFile != Z_NULL && "Could not open dynamic funcID file for write");
-		instIDFile = gzopen(instIDFileName.c_str(), "w");
-		assert(instIDFile != Z_NULL && "Could not open instID file for write");
-		lineNoFile = gzopen(lineNoFileName.c_str(), "w");
-		assert(lineNoFile != Z_NULL && "Could not open line num file for write");
-		memoryTraceFile = gzopen(memoryTraceFileName.c_str(), "w");
-		assert(memoryTraceFile != Z_NULL && "Could not open memory trace file for write");
-		getElementPtrFile = gzopen(getElementPtrFileName.c_str(), "w");
-		assert(getElementPtrFile != Z_NULL && "Could not open getelementptr file for write");
-		prevBasicBlockFile = gzopen(prevBasicBlockFileName.c_str(), "w");
-		assert(prevBasicBlockFile != Z_NULL && "Could not open prev BB file for write");
-		currBasicBlockFile = gzopen(currBasicBlockFileName.c_str(), "w");
-		assert(currBasicBlockFile != Z_NULL && "Could not open curr BB file for write");
-		resultSizeFile = gzopen(resultSizeFileName.c_str(), "w");
-		assert(resultSizeFile != Z_NULL && "Could not open result size file for write");
-
-		keepAliveWrite = true;
-	}
+template<typename T, typename U> static void packValue(std::string &buffer, const std::pair<T, U> &value) {
+	packValue(buffer, value.first);
+	packValue(buffer, value.second);
 }
 
-void ParsedTraceContainer::openAllFilesForWrite() {
-	assert(!locked && "This container is locked, no modification permitted");
-	assert(!keepAliveRead && "This container is open for read, no modification permitted");
-
-	closeAllFiles();
-
-	if(compressed) {
-		funcFile = gzopen(funcFileName.c_str(), "a");
-		assert(funcFile != Z_NULL && "Could not open dynamic funcID file for write");
-		instIDFile = gzopen(instIDFileName.c_str(), "a");
-		assert(instIDFile != Z_NULL && "Could not open instID file for write");
-		lineNoFile = gzopen(lineNoFileName.c_str(), "a");
-		assert(lineNoFile != Z_NULL && "Could not open line num file for write");
-		memoryTraceFile = gzopen(memoryTraceFileName.c_str(), "a");
-		assert(memoryTraceFile != Z_NULL && "Could not open memory trace file for write");
-		getElementPtrFile = gzopen(getElementPtrFileName.c_str(), "a");
-		assert(getElementPtrFile != Z_NULL && "Could not open getelementptr file for write");
-		prevBasicBlockFile = gzopen(prevBasicBlockFileName.c_str(), "a");
-		assert(prevBasicBlockFile != Z_NULL && "Could not open prev BB file for write");
-		currBasicBlockFile = gzopen(currBasicBlockFileName.c_str(), "a");
-		assert(currBasicBlockFile != Z_NULL && "Could not open curr BB file for write");
-		resultSizeFile = gzopen(resultSizeFileName.c_str(), "r");
-		assert(resultSizeFile != Z_NULL && "Could not open result size file for read");
-
-		keepAliveWrite = true;
-	}
+template<typename T> static void unpackValue(const char *&cursor, T &value) {
+	memcpy(&value, cursor, sizeof(T));
+	cursor += sizeof(T);
 }
 
-void ParsedTraceContainer::openAllFilesForRead() {
-	assert(!keepAliveWrite && "This container is open for write, no reading permitted");
-
-	closeAllFiles();
-
-	if(compressed) {
-		funcFile = gzopen(funcFileName.c_str(), "r");
-		assert(funcFile != Z_NULL && "Could not open dynamic funcID file for read");
-		instIDFile = gzopen(instIDFileName.c_str(), "r");
-		assert(instIDFile != Z_NULL && "Could not open instID file for read");
-		lineNoFile = gzopen(lineNoFileName.c_str(), "r");
-		assert(lineNoFile != Z_NULL && "Could not open line num file for read");
-		memoryTraceFile = gzopen(memoryTraceFileName.c_str(), "r");
-		assert(memoryTraceFile != Z_NULL && "Could not open memory trace file for read");
-		getElementPtrFile = gzopen(getElementPtrFileName.c_str(), "r");
-		assert(getElementPtrFile != Z_NULL && "Could not open getelementptr file for read");
-		prevBasicBlockFile = gzopen(prevBasicBlockFileName.c_str(), "r");
-		assert(prevBasicBlockFile != Z_NULL && "Could not open prev BB file for read");
-		currBasicBlockFile = gzopen(currBasicBlockFileName.c_str(), "r");
-		assert(currBasicBlockFile != Z_NULL && "Could not open curr BB file for read");
-
-		keepAliveRead = true;
-	}
+template<typename T, typename U> static void unpackValue(const char *&cursor, std::pair<T, U> &value) {
+	unpackValue(cursor, value.first);
+	unpackValue(cursor, value.second);
 }
 
-void ParsedTraceContainer::closeAllFiles() {
-	if(compressed) {
-		if(funcFile)
-			gzclose(funcFile);
-		if(instIDFile)
-			gzclose(instIDFile);
-		if(lineNoFile)
-			gzclose(lineNoFile);
-		if(memoryTraceFile)
-			gzclose(memoryTraceFile);
-		if(getElementPtrFile)
-			gzclose(getElementPtrFile);
-		if(prevBasicBlockFile)
-			gzclose(prevBasicBlockFile);
-		if(currBasicBlockFile)
-			gzclose(currBasicBlockFile);
-		if(resultSizeFile)
-			gzclose(resultSizeFile);
-		funcFile = Z_NULL;
-		instIDFile = Z_NULL;
-		lineNoFile = Z_NULL;
-		memoryTraceFile = Z_NULL;
-		getElementPtrFile = Z_NULL;
-		prevBasicBlockFile = Z_NULL;
-		currBasicBlockFile = Z_NULL;
-		resultSizeFile = Z_NULL;
-
-		keepAliveRead = false;
-		keepAliveWrite = false;
-	}
+template<typename T> static void packElems(std::string &buffer, const std::vector<T> &elems) {
+	packValue<uint64_t>(buffer, elems.size());
+	buffer.append((const char *) elems.data(), elems.size() * sizeof(T));
 }
 
-void ParsedTraceContainer::lock() {
-	locked = true;
-}
+template<typename T> static void unpackElems(const char *&cursor, std::vector<T> &elems) {
+	uint64_t size;
+	unpackValue(cursor, size);
 
-void ParsedTraceContainer::unlock() {
-	locked = false;
+	elems.resize(size);
+	memcpy(elems.data(), cursor, size * sizeof(T));
+	cursor += size * sizeof(T);
 }
 
-void ParsedTraceContainer::appendToFuncList(std::string elem) {
-	assert(!locked && "This container is locked, no modification permitted");
-	assert(!keepAliveRead && "This container is open for read, no modification permitted");
-
-	if(compressed) {
-		if(!funcFile) {
-			funcFile = gzopen(funcFileName.c_str(), "a");
-			assert(funcFile != Z_NULL && "Could not open dynamic funcID file for write");
-		}
+template<typename T> static void packElems(std::string &buffer, const SparseColumn<T> &elems) {
+	packValue<uint64_t>(buffer, elems.size());
+	for(auto &it : elems)
+		packValue(buffer, it);
+}
 
-		gzprintf(funcFile, "%s\n", elem.c_str());
+template<typename T> static void unpackElems(const char *&cursor, SparseColumn<T> &elems) {
+	uint64_t size;
+	unpackValue(cursor, size);
 
-		if(!keepAliveWrite) {
-			gzclose(funcFile);
-			funcFile = Z_NULL;
-		}
-	}
-	else {
-		funcList.push_back(elem);
+	elems.clear();
+	for(uint64_t i = 0; i < size; i++) {
+		std::pair<int, T> elem;
+		unpackValue(cursor, elem);
+		elems.insert(elem.first, elem.second);
 	}
 }
 
-void ParsedTraceContainer::appendToInstIDList(std::string elem) {
-	assert(!locked && "This container is locked, no modification permitted");
-	assert(!keepAliveRead && "This container is open for read, no modification permitted");
-
-	if(compressed) {
-		if(!instIDFile) {
-			instIDFile = gzopen(instIDFileName.c_str(), "a");
-			assert(instIDFile != Z_NULL && "Could not open dynamic instID file for write");
-		}
-
-		gzprintf(instIDFile, "%s\n", elem.c_str());
-
-		if(!keepAliveWrite) {
-			gzclose(instIDFile);
-			instIDFile = Z_NULL;
-		}
+// Symbol columns are stored with a local dictionary: each name once, followed by the dictionary index of each element
+static void packSymbols(std::string &buffer, const std::vector<uint32_t> &elems) {
+	std::unordered_map<uint32_t, uint32_t> localIDs;
+	std::vector<uint32_t> dictionary;
+	std::vector<uint32_t> indices;
+
+	indices.reserve(elems.size());
+	for(auto &it : elems) {
+		std::pair<std::unordered_map<uint32_t, uint32_t>::iterator, bool> inserted = localIDs.insert(std::make_pair(it, dictionary.size()));
+		if(inserted.second)
+			dictionary.push_back(it);
+		indices.push_back(inserted.first->second);
 	}
-	else {
-		instIDList.push_back(elem);
+
+	packValue<uint64_t>(buffer, dictionary.size());
+	for(auto &it : dictionary) {
+		const std::string &name = symbolTable.getName(it);
+		packValue<uint64_t>(buffer, name.size());
+		buffer.append(name);
 	}
+	packElems(buffer, indices);
 }
 
-void ParsedTraceContainer::appendToLineNoList(int elem) {
-	assert(!locked && "This container is locked, no modification permitted");
-	assert(!keepAliveRead && "This container is open for read, no modification permitted");
-
-	if(compressed) {
-		if(!lineNoFile) {
-			lineNoFile = gzopen(lineNoFileName.c_str(), "a");
-			assert(lineNoFile != Z_NULL && "Could not open line num file for write");
-		}
-
-		gzprintf(lineNoFile, "%d\n", elem);
-
-		if(!keepAliveWrite) {
-			gzclose(lineNoFile);
-			lineNoFile = Z_NULL;
-		}
+static void unpackSymbols(const char *&cursor, std::vector<uint32_t> &elems) {
+	uint64_t dictionarySize;
+	unpackValue(cursor, dictionarySize);
+
+	std::vector<uint32_t> dictionary;
+	dictionary.reserve(dictionarySize);
+	for(uint64_t i = 0; i < dictionarySize; i++) {
+		uint64_t nameSize;
+		unpackValue(cursor, nameSize);
+		dictionary.push_back(symbolTable.getID(std::string(cursor, nameSize)));
+		cursor += nameSize;
 	}
-	else {
-		lineNoList.push_back(elem);
+
+	unpackElems(cursor, elems);
+	for(auto &it : elems) {
+		assert(it < dictionary.size() && "Parsed trace container is corrupt");
+		it = dictionary[it];
 	}
 }
 
-void ParsedTraceContainer::appendToMemoryTraceList(int key, int64_t elem, unsigned elem2) {
-	assert(!locked && "This container is locked, no modification permitted");
-	assert(!keepAliveRead && "This container is open for read, no modification permitted");
-
-	if(compressed) {
-		if(!memoryTraceFile) {
-			memoryTraceFile = gzopen(memoryTraceFileName.c_str(), "a");
-			assert(memoryTraceFile != Z_NULL && "Could not open memory trace file for write");
-		}
-
-		gzprintf(memoryTraceFile, "%d,%ld,%u\n", key, elem, elem2);
-
-		if(!keepAliveWrite) {
-			gzclose(memoryTraceFile);
-			memoryTraceFile = Z_NULL;
-		}
-	}
-	else {
-		memoryTraceList.insert(std::make_pair(key, std::make_pair(elem, elem2)));
+ParsedTraceContainer::ParsedTraceContainer(std::string kernelName) : kernelName(kernelName) {
+	for(unsigned i = 0; i < NUM_COLUMNS; i++) {
+		packedColumns[i].rawSize = 0;
+		packedColumns[i].exposed = false;
 	}
-}
 
-void ParsedTraceContainer::appendToGetElementPtrList(int key, std::string elem, int64_t elem2) {
-	assert(!locked && "This container is locked, no modification permitted");
-	assert(!keepAliveRead && "This container is open for read, no modification permitted");
+	compressed = args.compressed;
+	locked = false;
+}
 
-	// In the original code, this is performed when the getElementPtrList is requested, not
-	// when the element is inserted. However, getElementPtrList is only used at initBaseAddress(),
-	// where the array name is used instead of the arrayidxXX. Therefore, I think there is no
-	// problem to add the arrayidxXX-to-arrayName conversion here instead of in getGetElementPtr()
-	getElementPtrName2arrayNameMapTy::iterator found = getElementPtrName2arrayNameMap.find(elem);
-	std::string arrayName = (found != getElementPtrName2arrayNameMap.end())? found->second : elem;
+template<typename C> void ParsedTraceContainer::packColumn(unsigned column, C &elems) {
+	packedColumnTy &packed = packedColumns[column];
+	if(!compressed || packed.exposed || !(packed.data.empty()))
+		return;
 
-	if(compressed) {
-		if(!getElementPtrFile) {
-			getElementPtrFile = gzopen(getElementPtrFileName.c_str(), "a");
-			assert(getElementPtrFile != Z_NULL && "Could not open getelementptr file for write");
-		}
+	std::string raw;
+	packElems(raw, elems);
 
-		gzprintf(getElementPtrFile, "%d,%s,%ld\n", key, arrayName.c_str(), elem2);
+	uLongf packedSize = compressBound(raw.size());
+	packed.data.resize(packedSize);
+	int retVal = compress2(packed.data.data(), &packedSize, (const Bytef *) raw.data(), raw.size(), Z_BEST_SPEED);
+	assert(Z_OK == retVal && "Could not compress parsed trace column");
+	packed.data.resize(packedSize);
+	packed.data.shrink_to_fit();
+	packed.rawSize = raw.size();
 
-		if(!keepAliveWrite) {
-			gzclose(getElementPtrFile);
-			getElementPtrFile = Z_NULL;
-		}
-	}
-	else {
-		getElementPtrList.insert(std::make_pair(key, std::make_pair(arrayName, elem2)));
-	}
+	// Release the inflated column
+	elems = C();
 }
 
-void ParsedTraceContainer::appendToPrevBBList(std::string elem) {
-	assert(!locked && "This container is locked, no modification permitted");
-	assert(!keepAliveRead && "This container is open for read, no modification permitted");
-
-	if(compressed) {
-		if(!prevBasicBlockFile) {
-			prevBasicBlockFile = gzopen(prevBasicBlockFileName.c_str(), "a");
-			assert(prevBasicBlockFile != Z_NULL && "Could not open prev BB file for write");
-		}
+template<typename C> C &ParsedTraceContainer::unpackColumn(unsigned column, C &elems) {
+	packedColumnTy &packed = packedColumns[column];
 
-		gzprintf(prevBasicBlockFile, "%s\n", elem.c_str());
+	if(!(packed.data.empty())) {
+		std::string raw(packed.rawSize, '\0');
+		uLongf rawSize = packed.rawSize;
+		int retVal = uncompress((Bytef *) &raw[0], &rawSize, packed.data.data(), packed.data.size());
+		assert(Z_OK == retVal && rawSize == packed.rawSize && "Could not decompress parsed trace column");
 
-		if(!keepAliveWrite) {
-			gzclose(prevBasicBlockFile);
-			prevBasicBlockFile = Z_NULL;
-		}
+		const char *cursor = raw.data();
+		unpackElems(cursor, elems);
+		std::vector<Bytef>().swap(packed.data);
 	}
-	else {
-		prevBasicBlockList.push_back(elem);
-	}
-}
 
-void ParsedTraceContainer::appendToCurrBBList(std::string elem) {
-	assert(!locked && "This container is locked, no modification permitted");
-	assert(!keepAliveRead && "This container is open for read, no modification permitted");
-
-	if(compressed) {
-		if(!currBasicBlockFile) {
-			currBasicBlockFile = gzopen(currBasicBlockFileName.c_str(), "a");
-			assert(currBasicBlockFile != Z_NULL && "Could not open curr BB file for write");
-		}
+	return elems;
+}
 
-		gzprintf(currBasicBlockFile, "%s\n", elem.c_str());
+template<typename C> C &ParsedTraceContainer::exposeColumn(unsigned column, C &elems) {
+	// Callers keep references to the column, it cannot be packed anymore
+	packedColumns[column].exposed = true;
 
-		if(!keepAliveWrite) {
-			gzclose(currBasicBlockFile);
-			currBasicBlockFile = Z_NULL;
-		}
-	}
-	else {
-		currBasicBlockList.push_back(elem);
-	}
+	return unpackColumn(column, elems);
 }
 
-void ParsedTraceContainer::appendToResultSizeList(int key, unsigned elem) {
+void ParsedTraceContainer::clear() {
 	assert(!locked && "This container is locked, no modification permitted");
-	assert(!keepAliveRead && "This container is open for read, no modification permitted");
-
-	if(compressed) {
-		if(!resultSizeFile) {
-			resultSizeFile = gzopen(resultSizeFileName.c_str(), "a");
-			assert(resultSizeFile != Z_NULL && "Could not open result size file for write");
-		}
 
-		gzprintf(resultSizeFile, "%d,%u\n", key, elem);
+	funcList.clear();
+	instIDList.clear();
+	lineNoList.clear();
+	memoryTraceList.clear();
+	getElementPtrList.clear();
+	prevBasicBlockList.clear();
+	currBasicBlockList.clear();
+	resultSizeList.clear();
 
-		if(!keepAliveWrite) {
-			gzclose(resultSizeFile);
-			resultSizeFile = Z_NULL;
-		}
-	}
-	else {
-		resultSizeList.insert(std::make_pair(key, elem));
-	}
+	for(unsigned i = 0; i < NUM_COLUMNS; i++)
+		std::vector<Bytef>().swap(packedColumns[i].data);
 }
 
-const std::vector<std::string> &ParsedTraceContainer::getFuncList() {
-	if(compressed) {
-		assert(!keepAliveWrite && "This container is open for write, no reading permitted");
-
-		if(!funcFile) {
-			funcFile = gzopen(funcFileName.c_str(), "r");
-			assert(funcFile != Z_NULL && "Could not open dynamic funcID file for read");
-		}
-
-		funcList.clear();
-
-		char buffer[BUFF_STR_SZ];
-		while(!gzeof(funcFile)) {
-			if(Z_NULL == gzgets(funcFile, buffer, sizeof(buffer)))
-				continue;
-
-			std::string line(buffer);
-			line.pop_back();
-			funcList.push_back(line);
-		}
-
-		if(!keepAliveRead) {
-			gzclose(funcFile);
-			funcFile = Z_NULL;
-		}
-	}
-
-	return funcList;
+void ParsedTraceContainer::pack() {
+	packColumn(COLUMN_FUNC, funcList);
+	packColumn(COLUMN_INSTID, instIDList);
+	packColumn(COLUMN_LINENO, lineNoList);
+	packColumn(COLUMN_MEMORYTRACE, memoryTraceList);
+	packColumn(COLUMN_GETELEMENTPTR, getElementPtrList);
+	packColumn(COLUMN_PREVBB, prevBasicBlockList);
+	packColumn(COLUMN_CURRBB, currBasicBlockList);
+	packColumn(COLUMN_RESULTSIZE, resultSizeList);
 }
 
-const std::vector<std::string> &ParsedTraceContainer::getInstIDList() {
-	if(compressed) {
-		assert(!keepAliveWrite && "This container is open for write, no reading permitted");
-
-		if(!instIDFile) {
-			instIDFile = gzopen(instIDFileName.c_str(), "r");
-			assert(instIDFile != Z_NULL && "Could not open instID file for read");
-		}
-
-		instIDList.clear();
-
-		char buffer[BUFF_STR_SZ];
-		while(!gzeof(instIDFile)) {
-			if(Z_NULL == gzgets(instIDFile, buffer, sizeof(buffer)))
-				continue;
+void ParsedTraceContainer::lock() {
+	locked = true;
+}
 
-			std::string line(buffer);
-			line.pop_back();
-			instIDList.push_back(line);
-		}
+void ParsedTraceContainer::unlock() {
+	locked = false;
+}
 
-		if(!keepAliveRead) {
-			gzclose(instIDFile);
-			instIDFile = Z_NULL;
-		}
+void ParsedTraceContainer::serialise(std::string &buffer) {
+	packSymbols(buffer, getFuncList());
+	packSymbols(buffer, getInstIDList());
+	packElems(buffer, getLineNoList());
+	packElems(buffer, getMemoryTraceList());
+
+	// Array names of getelementptr are stored as a symbol column
+	const getElementPtrColumnTy &getElementPtrs = getGetElementPtrList();
+	std::vector<uint32_t> arrayNames;
+	arrayNames.reserve(getElementPtrs.size());
+	packValue<uint64_t>(buffer, getElementPtrs.size());
+	for(auto &it : getElementPtrs) {
+		packValue(buffer, it.first);
+		packValue(buffer, it.second.second);
+		arrayNames.push_back(it.second.first);
 	}
+	packSymbols(buffer, arrayNames);
 
-	return instIDList;
+	packSymbols(buffer, getPrevBBList());
+	packSymbols(buffer, getCurrBBList());
+	packElems(buffer, getResultSizeList());
 }
 
-const std::vector<int> &ParsedTraceContainer::getLineNoList() {
-	if(compressed) {
-		assert(!keepAliveWrite && "This container is open for write, no reading permitted");
-
-		if(!lineNoFile) {
-			lineNoFile = gzopen(lineNoFileName.c_str(), "r");
-			assert(lineNoFile != Z_NULL && "Could not open line num file for read");
-		}
-
-		lineNoList.clear();
+void ParsedTraceContainer::deserialise(const char *buffer, size_t size) {
+	clear();
+
+	const char *cursor = buffer;
+	unpackSymbols(cursor, funcList);
+	unpackSymbols(cursor, instIDList);
+	unpackElems(cursor, lineNoList);
+	unpackElems(cursor, memoryTraceList);
+
+	uint64_t getElementPtrsSize;
+	unpackValue(cursor, getElementPtrsSize);
+	std::vector<std::pair<int, int64_t>> getElementPtrs(getElementPtrsSize);
+	for(auto &it : getElementPtrs)
+		unpackValue(cursor, it);
+	std::vector<uint32_t> arrayNames;
+	unpackSymbols(cursor, arrayNames);
+	assert(arrayNames.size() == getElementPtrs.size() && "Parsed trace container is corrupt");
+	for(size_t i = 0; i < getElementPtrs.size(); i++)
+		getElementPtrList.insert(getElementPtrs[i].first, std::make_pair(arrayNames[i], getElementPtrs[i].second));
+
+	unpackSymbols(cursor, prevBasicBlockList);
+	unpackSymbols(cursor, currBasicBlockList);
+	unpackElems(cursor, resultSizeList);
+
+	assert(cursor == buffer + size && "Parsed trace container is corrupt");
+}
 
-		char buffer[BUFF_STR_SZ];
-		while(!gzeof(lineNoFile)) {
-			if(Z_NULL == gzgets(lineNoFile, buffer, sizeof(buffer)))
-				continue;
+void ParsedTraceContainer::appendToFuncList(uint32_t elem) {
+	assert(!locked && "This container is locked, no modification permitted");
 
-			int elem;
-			sscanf(buffer, "%d\n", &elem);
-			lineNoList.push_back(elem);
-		}
+	unpackColumn(COLUMN_FUNC, funcList).push_back(elem);
+}
 
-		if(!keepAliveRead) {
-			gzclose(lineNoFile);
-			lineNoFile = Z_NULL;
-		}
-	}
+void ParsedTraceContainer::appendToInstIDList(uint32_t elem) {
+	assert(!locked && "This container is locked, no modification permitted");
 
-	return lineNoList;
+	unpackColumn(COLUMN_INSTID, instIDList).push_back(elem);
 }
 
-const std::unordered_map<int, std::pair<int64_t, unsigned>> &ParsedTraceContainer::getMemoryTraceList() {
-	if(compressed) {
-		assert(!keepAliveWrite && "This container is open for write, no reading permitted");
+void ParsedTraceContainer::appendToLineNoList(int elem) {
+	assert(!locked && "This container is locked, no modification permitted");
 
-		if(!memoryTraceFile) {
-			memoryTraceFile = gzopen(memoryTraceFileName.c_str(), "r");
-			assert(memoryTraceFile != Z_NULL && "Could not open memory trace file for read");
-		}
+	unpackColumn(COLUMN_LINENO, lineNoList).push_back(elem);
+}
 
-		memoryTraceList.clear();
+void ParsedTraceContainer::appendToMemoryTraceList(int key, int64_t elem, unsigned elem2) {
+	assert(!locked && "This container is locked, no modification permitted");
 
-		char buffer[BUFF_STR_SZ];
-		while(!gzeof(memoryTraceFile)) {
-			if(Z_NULL == gzgets(memoryTraceFile, buffer, sizeof(buffer)))
-				continue;
+	unpackColumn(COLUMN_MEMORYTRACE, memoryTraceList).insert(key, std::make_pair(elem, elem2));
+}
 
-			int elem;
-			int64_t elem2;
-			unsigned elem3;
-			sscanf(buffer, "%d,%ld,%u\n", &elem, &elem2, &elem3);
-			memoryTraceList.insert(std::make_pair(elem, std::make_pair(elem2, elem3)));
-		}
+void ParsedTraceContainer::appendToGetElementPtrList(int key, std::string elem, int64_t elem2) {
+	assert(!locked && "This container is locked, no modification permitted");
 
-		if(!keepAliveRead) {
-			gzclose(memoryTraceFile);
-			memoryTraceFile = Z_NULL;
-		}
-	}
+	// In the original code, this is performed when the getElementPtrList is requested, not
+	// when the element is inserted. However, getElementPtrList is only used at initBaseAddress(),
+	// where the array name is used instead of the arrayidxXX. Therefore, I think there is no
+	// problem to add the arrayidxXX-to-arrayName conversion here instead of in getGetElementPtr()
+	getElementPtrName2arrayNameMapTy::iterator found = getElementPtrName2arrayNameMap.find(elem);
+	uint32_t arrayName = symbolTable.getID((found != getElementPtrName2arrayNameMap.end())? found->second : elem);
 
-	return memoryTraceList;
+	unpackColumn(COLUMN_GETELEMENTPTR, getElementPtrList).insert(key, std::make_pair(arrayName, elem2));
 }
 
-const std::unordered_map<int, std::pair<std::string, int64_t>> &ParsedTraceContainer::getGetElementPtrList() {
-	if(compressed) {
-		assert(!keepAliveWrite && "This container is open for write, no reading permitted");
+void ParsedTraceContainer::appendToPrevBBList(uint32_t elem) {
+	assert(!locked && "This container is locked, no modification permitted");
 
-		if(!getElementPtrFile) {
-			getElementPtrFile = gzopen(getElementPtrFileName.c_str(), "r");
-			assert(getElementPtrFile != Z_NULL && "Could not open getelementptr file for read");
-		}
+	unpackColumn(COLUMN_PREVBB, prevBasicBlockList).push_back(elem);
+}
 
-		getElementPtrList.clear();
+void ParsedTraceContainer::appendToCurrBBList(uint32_t elem) {
+	assert(!locked && "This container is locked, no modification permitted");
 
-		char buffer[BUFF_STR_SZ];
-		while(!gzeof(getElementPtrFile)) {
-			if(Z_NULL == gzgets(getElementPtrFile, buffer, sizeof(buffer)))
-				continue;
+	unpackColumn(COLUMN_CURRBB, currBasicBlockList).push_back(elem);
+}
 
-			int elem;
-			char elem2[BUFF_STR_SZ];
-			int64_t elem3;
-			sscanf(buffer, "%d,%[^,],%ld\n", &elem, elem2, &elem3);
-			getElementPtrList.insert(std::make_pair(elem, std::make_pair(std::string(elem2), elem3)));
-		}
+void ParsedTraceContainer::appendToResultSizeList(int key, unsigned elem) {
+	assert(!locked && "This container is locked, no modification permitted");
 
-		if(!keepAliveRead) {
-			gzclose(getElementPtrFile);
-			getElementPtrFile = Z_NULL;
-		}
-	}
+	unpackColumn(COLUMN_RESULTSIZE, resultSizeList).insert(key, elem);
+}
 
-	return getElementPtrList;
+const std::vector<uint32_t> &ParsedTraceContainer::getFuncList() {
+	return exposeColumn(COLUMN_FUNC, funcList);
 }
 
-const std::vector<std::string> &ParsedTraceContainer::getPrevBBList() {
-	if(compressed) {
-		assert(!keepAliveWrite && "This container is open for write, no reading permitted");
+const std::vector<uint32_t> &ParsedTraceContainer::getInstIDList() {
+	return exposeColumn(COLUMN_INSTID, instIDList);
+}
 
-		if(!prevBasicBlockFile) {
-			prevBasicBlockFile = gzopen(prevBasicBlockFileName.c_str(), "r");
-			assert(prevBasicBlockFile != Z_NULL && "Could not open prev BB file for read");
-		}
+const std::vector<int> &ParsedTraceContainer::getLineNoList() {
+	return exposeColumn(COLUMN_LINENO, lineNoList);
+}
 
-		prevBasicBlockList.clear();
+const memoryTraceColumnTy &ParsedTraceContainer::getMemoryTraceList() {
+	return exposeColumn(COLUMN_MEMORYTRACE, memoryTraceList);
+}
 
-		char buffer[BUFF_STR_SZ];
-		while(!gzeof(prevBasicBlockFile)) {
-			if(Z_NULL == gzgets(prevBasicBlockFile, buffer, sizeof(buffer)))
-				continue;
+const getElementPtrColumnTy &ParsedTraceContainer::getGetElementPtrList() {
+	return exposeColumn(COLUMN_GETELEMENTPTR, getElementPtrList);
+}
 
-			std::string line(buffer);
-			line.pop_back();
-			prevBasicBlockList.push_back(line);
-		}
+const std::vector<uint32_t> &ParsedTraceContainer::getPrevBBList() {
+	return exposeColumn(COLUMN_PREVBB, prevBasicBlockList);
+}
 
-		if(!keepAliveRead) {
-			gzclose(prevBasicBlockFile);
-			prevBasicBlockFile = Z_NULL;
-		}
-	}
+const std::vector<uint32_t> &ParsedTraceContainer::getCurrBBList() {
+	return exposeColumn(COLUMN_CURRBB, currBasicBlockList);
+}
 
-	return prevBasicBlockList;
+const resultSizeColumnTy &ParsedTraceContainer::getResultSizeList() {
+	return exposeColumn(COLUMN_RESULTSIZE, resultSizeList);
 }
 
-const std::vector<std::string> &ParsedTraceContainer::getCurrBBList() {
-	if(compressed) {
-		assert(!keepAliveWrite && "This container is open for write, no reading permitted");
+DDDGBuilder::DDDGBuilder(BaseDatapath *datapath, ParsedTraceContainer &PC) : datapath(datapath), PC(PC) {
+	numOfInstructions = -1;
+	lastParameter = true;
+	prevBB = symbolTable.getID("-1");
+	currBB = currInstID = currDynamicFunction = calleeFunction = calleeDynamicFunction = symbolTable.getID("");
+	numOfRegDeps = 0;
+	numOfMemDeps = 0;
+	loopFunction = loopHeaderBB = iterationEndInst = SymbolTable::NO_SYMBOL;
+	currIteration = 0;
+	shadowIteration = false;
+	numOfDDDGNodes = 0;
+	shadowCounterpart = -1;
+}
 
-		if(!currBasicBlockFile) {
-			currBasicBlockFile = gzopen(currBasicBlockFileName.c_str(), "r");
-			assert(currBasicBlockFile != Z_NULL && "Could not open curr BB file for read");
-		}
+// Runtime loop bounds are counted per innermost loop, adjust them to the actual loop nest structure
+static void adjustRuntimeLoopBounds() {
+	for(auto &it : loopName2levelUnrollVecMap) {
+		std::string loopName = it.first;
+		unsigned levelSize = it.second.size();
 
-		currBasicBlockList.clear();
+		assert(levelSize >= 1 && "This loop level is less than 1");
 
-		char buffer[BUFF_STR_SZ];
-		while(!gzeof(currBasicBlockFile)) {
-			if(Z_NULL == gzgets(currBasicBlockFile, buffer, sizeof(buffer)))
-				continue;
+		// Create temporary vector with values inside wholeloopName2loopBoundMap
+		std::vector<unsigned> loopBounds(levelSize, 0);
+		for(unsigned i = 0; i < levelSize; i++) {
+			std::string wholeLoopName = appendDepthToLoopName(loopName, i + 1);
+			wholeloopName2loopBoundMapTy::iterator found7 = wholeloopName2loopBoundMap.find(wholeLoopName);
+			assert(found7 != wholeloopName2loopBoundMap.end() && "Could not find loop in wholeloopName2loopBoundMap");
 
-			std::string line(buffer);
-			line.pop_back();
-			currBasicBlockList.push_back(line);
+			loopBounds[i] = found7->second;
 		}
 
-		if(!keepAliveRead) {
-			gzclose(currBasicBlockFile);
-			currBasicBlockFile = Z_NULL;
+		// The trace only keep trace of the innermost loop that an instruction was executed.
+		// This means that the runtime-calculated loop bounds are not reflecting actual nesting structure of the loops
+		// We must correct/adjust the runtime-calculated loop bounds to reflect the actual nesting structure of the loops
+		for(unsigned i = 1; i < levelSize; i++) {
+			std::string wholeLoopName = appendDepthToLoopName(loopName, i + 1);
+			wholeloopName2loopBoundMapTy::iterator found8 = wholeloopName2loopBoundMap.find(wholeLoopName);
+			assert(found8 != wholeloopName2loopBoundMap.end() && "Could not find loop in wholeloopName2loopBoundMap");
+
+			loopBounds[i] = loopBounds[i] / loopBounds[i - 1];
+			wholeloopName2loopBoundMap[wholeLoopName] = loopBounds[i];
 		}
 	}
-
-	return currBasicBlockList;
 }
 
-const std::unordered_map<int, unsigned> &ParsedTraceContainer::getResultSizeList() {
-	if(compressed) {
-		assert(!keepAliveWrite && "This container is open for write, no reading permitted");
-
-		if(!resultSizeFile) {
-			resultSizeFile = gzopen(resultSizeFileName.c_str(), "r");
-			assert(resultSizeFile != Z_NULL && "Could not open result size file for read");
-		}
-
-		resultSizeList.clear();
-
-		char buffer[BUFF_STR_SZ];
-		while(!gzeof(resultSizeFile)) {
-			if(Z_NULL == gzgets(resultSizeFile, buffer, sizeof(buffer)))
-				continue;
+#ifdef LOOP_TRIP_COUNTS
+// Add the header executions recorded during tracing to the runtime loop bounds, as the trace scan would do.
+// The scan counts from where the search starts, thus this is only valid when it starts at the beginning of the trace
+static bool addRecordedLoopBounds() {
+#ifdef PROGRESSIVE_TRACE_CURSOR
+	if(args.progressive && progressiveTraceCursor)
+		return false;
+#endif
 
-			int elem;
-			unsigned elem2;
-			sscanf(buffer, "%d,%u\n", &elem, &elem2);
-			resultSizeList.insert(std::make_pair(elem, elem2));
-		}
+	LoopTripCounts tripCounts;
+	if(!tripCounts.load(args.workDir + FILE_LOOP_TRIP_COUNTS))
+		return false;
 
-		if(!keepAliveRead) {
-			gzclose(resultSizeFile);
-			resultSizeFile = Z_NULL;
-		}
-	}
+	for(auto &it : tripCounts.getLoops())
+		wholeloopName2loopBoundMap[it.first] += it.second.headerExecutions;
 
-	return resultSizeList;
-}
-
-DDDGBuilder::DDDGBuilder(BaseDatapath *datapath, ParsedTraceContainer &PC) : datapath(datapath), PC(PC) {
-	numOfInstructions = -1;
-	lastParameter = true;
-	prevBB = "-1";
-	numOfRegDeps = 0;
-	numOfMemDeps = 0;
+	return true;
 }
+#endif
 
-intervalTy DDDGBuilder::getTraceLineFromToBeforeNestedLoop(gzFile &traceFile) {
+intervalTy DDDGBuilder::getTraceLineFromToBeforeNestedLoop(TraceReader &traceFile) {
 	std::string loopName = datapath->getTargetLoopName();
 	unsigned loopLevel = datapath->getTargetLoopLevel();
 	std::string functionName = std::get<0>(parseLoopName(loopName));
@@ -778,7 +563,9 @@ intervalTy DDDGBuilder::getTraceLineFromToBeforeNestedLoop(gzFile &traceFile) {
 		std::string funcName = std::get<0>(parseLoopName(loopName));
 		std::string headerBBName = it.second;
 		std::pair<std::string, std::string> headerBBFuncNamePair = std::make_pair(headerBBName, funcName);
-		std::string headerBBLastInst = headerBBFuncNamePair2lastInstMap[headerBBFuncNamePair];
+		// XXX: Using find() instead of operator[], as this map is shared among threads when running "--batch-threads"
+		headerBBFuncNamePair2lastInstMapTy::iterator found = headerBBFuncNamePair2lastInstMap.find(headerBBFuncNamePair);
+		std::string headerBBLastInst = (found != headerBBFuncNamePair2lastInstMap.end())? found->second : "";
 		std::pair<std::string, unsigned> loopNameLevelPair = std::make_pair(loopName, loopLevel);
 		headerBBlastInst2loopNameLevelPairMap.insert(std::make_pair(headerBBLastInst, loopNameLevelPair));
 	}
@@ -787,29 +574,34 @@ intervalTy DDDGBuilder::getTraceLineFromToBeforeNestedLoop(gzFile &traceFile) {
 	uint64_t loopBound = wholeloopName2loopBoundMap.at(wholeLoopName);
 	bool skipRuntimeLoopBound = (loopBound > 0);
 
+#ifdef LOOP_TRIP_COUNTS
+	if(!skipRuntimeLoopBound && addRecordedLoopBounds()) {
+		VERBOSE_PRINT(errs() << "\t\tThere are loops with unknown static bounds, using loop trip counts recorded during tracing\n");
+		adjustRuntimeLoopBounds();
+		skipRuntimeLoopBound = true;
+	}
+#endif
+
 #ifdef PROGRESSIVE_TRACE_CURSOR
 	uint64_t instCount = progressiveTraceInstCount;
 #else
 	uint64_t instCount = 0;
 #endif
 	uint64_t byteFrom, to = 0;
-	// This queue saves exactly the last (numInstInHeaderBB - 1) byte offsets for the beggining of each line
-	LimitedQueue lineByteOffset(numInstInHeaderBB - 1);
 	bool firstTraverseHeader = true;
 	//uint64_t lastInstExitingCounter = 0;
-	char buffer[BUFF_STR_SZ];
 
 	// Iterate through dynamic trace
 #ifdef PROGRESSIVE_TRACE_CURSOR
 	if(args.progressive) {
 		VERBOSE_PRINT(errs() << "\t\tUsing progressive trace cursor, skipping " << std::to_string(progressiveTraceCursor) << " bytes from trace\n");
-		gzseek(traceFile, progressiveTraceCursor, SEEK_SET);
+		traceFile.seek(progressiveTraceCursor);
 	}
 	else {
-		gzrewind(traceFile);
+		traceFile.rewind();
 	}
 #else
-	gzrewind(traceFile);
+	traceFile.rewind();
 #endif
 
 #ifdef FUTURE_CACHE
@@ -824,7 +616,7 @@ intervalTy DDDGBuilder::getTraceLineFromToBeforeNestedLoop(gzFile &traceFile) {
 				VERBOSE_PRINT(errs() << "\t\tCached cursor hit\n");
 				VERBOSE_PRINT(errs() << "\t\tSkipping further " << std::to_string(cacheHit->second.gzCursor - progressiveTraceCursor) << " bytes from trace\n");
 
-				gzseek(traceFile, cacheHit->second.gzCursor, SEEK_SET);
+				traceFile.seek(cacheHit->second.gzCursor);
 				byteFrom = cacheHit->second.byteFrom;
 				instCount = cacheHit->second.instCount;
 				progressiveTraceCursor = cacheHit->second.progressiveTraceCursor;
@@ -845,24 +637,18 @@ intervalTy DDDGBuilder::getTraceLineFromToBeforeNestedLoop(gzFile &traceFile) {
 	}
 #endif
 
-	while(!gzeof(traceFile)) {
-		if(Z_NULL == gzgets(traceFile, buffer, sizeof(buffer)))
-			continue;
-
-		std::string line(buffer);
-		size_t tagPos = line.find(",");
+	// Jump close to the first execution of the loop header using the trace index checkpoints
+	if(skipRuntimeLoopBound && firstTraverseHeader && traceFile.seekNearHeader(headerBBName, functionName, instCount))
+		VERBOSE_PRINT(errs() << "\t\tTrace index checkpoint found, skipping to byte " << std::to_string(traceFile.tell()) << " of trace\n");
 
-		if(std::string::npos == tagPos)
-			continue;
+	// The reader saves exactly the last numInstInHeaderBB byte offsets of instruction lines
+	traceFile.trackInstructions(numInstInHeaderBB - 1);
 
-		std::string tag = line.substr(0, tagPos);
-		std::string rest = line.substr(tagPos + 1);
-
-		if(!tag.compare("0")) {
-			char buffer2[BUFF_STR_SZ];
-			int count;
-			sscanf(rest.c_str(), "%*d,%*[^,],%*[^,],%[^,],%*d,%d\n", buffer2, &count);
-			std::string instName(buffer2);
+	traceLineTy line;
+	while(traceFile.next(line, false)) {
+		if(traceLineTy::TYPE_INST == line.type) {
+			const std::string &instName = line.instName;
+			uint64_t count = line.count;
 
 			// Mark the first line of the first iteration of this loop
 			if(firstTraverseHeader) {
@@ -870,15 +656,15 @@ intervalTy DDDGBuilder::getTraceLineFromToBeforeNestedLoop(gzFile &traceFile) {
 
 				if(!instName.compare(lastInstHeaderBB)) {
 					// Save in byteFrom the amount of bytes between beginning of trace of file and first instruction
-					// of first loop iteration (the front() of this queue has the line byte offset for the header)
-					byteFrom = lineByteOffset.front();
+					// of first loop iteration (numInstInHeaderBB - 1 instruction lines before this one)
+					byteFrom = traceFile.getInstructionPos(numInstInHeaderBB - 1);
 					instCount -= numInstInHeaderBB;
 					firstTraverseHeader = false;
 
 #ifdef FUTURE_CACHE
 					if(args.futureCache) {
 						// Save to cache
-						FutureCache::elemTy cacheElem(gztell(traceFile) - line.size(), byteFrom, instCount, byteFrom, instCount, 0, 0);
+						FutureCache::elemTy cacheElem(line.pos, byteFrom, instCount, byteFrom, instCount, 0, 0);
 						futureCache.insert(
 							wholeLoopName, DatapathType::NON_PERFECT_BEFORE, progressiveTraceCursor, progressiveTraceInstCount,
 							cacheElem
@@ -892,10 +678,6 @@ intervalTy DDDGBuilder::getTraceLineFromToBeforeNestedLoop(gzFile &traceFile) {
 					}
 #endif
 				}
-				else {
-					// Save this line byte offset
-					lineByteOffset.push(gztell(traceFile) - line.size());
-				}
 			}
 
 			// Mark the last line right before another loop nest
@@ -922,42 +704,14 @@ intervalTy DDDGBuilder::getTraceLineFromToBeforeNestedLoop(gzFile &traceFile) {
 	// Post-process runtime loop bound calculations
 	if(!skipRuntimeLoopBound) {
 		VERBOSE_PRINT(errs() << "\t\tThere are loops with unknown static bounds, using trace to determine their bounds\n");
-
-		for(auto &it : loopName2levelUnrollVecMap) {
-			std::string loopName = it.first;
-			unsigned levelSize = it.second.size();
-
-			assert(levelSize >= 1 && "This loop level is less than 1");
-
-			// Create temporary vector with values inside wholeloopName2loopBoundMap
-			std::vector<unsigned> loopBounds(levelSize, 0);
-			for(unsigned i = 0; i < levelSize; i++) {
-				std::string wholeLoopName = appendDepthToLoopName(loopName, i + 1);
-				wholeloopName2loopBoundMapTy::iterator found7 = wholeloopName2loopBoundMap.find(wholeLoopName);
-				assert(found7 != wholeloopName2loopBoundMap.end() && "Could not find loop in wholeloopName2loopBoundMap");
-
-				loopBounds[i] = found7->second;
-			}
-
-			// The trace only keep trace of the innermost loop that an instruction was executed.
-			// This means that the runtime-calculated loop bounds are not reflecting actual nesting structure of the loops
-			// We must correct/adjust the runtime-calculated loop bounds to reflect the actual nesting structure of the loops
-			for(unsigned i = 1; i < levelSize; i++) {
-				std::string wholeLoopName = appendDepthToLoopName(loopName, i + 1);
-				wholeloopName2loopBoundMapTy::iterator found8 = wholeloopName2loopBoundMap.find(wholeLoopName);
-				assert(found8 != wholeloopName2loopBoundMap.end() && "Could not find loop in wholeloopName2loopBoundMap");
-
-				loopBounds[i] = loopBounds[i] / loopBounds[i - 1];
-				wholeloopName2loopBoundMap[wholeLoopName] = loopBounds[i];
-			}
-		}
+		adjustRuntimeLoopBounds();
 	}
 
 	DBG_DUMP("getTraceLineFromToBeforeNestedLoop(): " << byteFrom << " " << to << "\n");
 	return std::make_tuple(byteFrom, to, instCount);
 }
 
-intervalTy DDDGBuilder::getTraceLineFromToAfterNestedLoop(gzFile &traceFile) {
+intervalTy DDDGBuilder::getTraceLineFromToAfterNestedLoop(TraceReader &traceFile) {
 	std::string loopName = datapath->getTargetLoopName();
 	int loopLevel = datapath->getTargetLoopLevel();
 	int prevLoopLevel = 0, currLoopLevel = 0;
@@ -982,19 +736,18 @@ intervalTy DDDGBuilder::getTraceLineFromToAfterNestedLoop(gzFile &traceFile) {
 #endif
 	uint64_t byteFrom, to = 0;
 	bool firstTraverse = true;
-	char buffer[BUFF_STR_SZ];
 
 	// Iterate through dynamic trace
 #ifdef PROGRESSIVE_TRACE_CURSOR
 	if(args.progressive) {
 		VERBOSE_PRINT(errs() << "\t\tUsing progressive trace cursor, skipping " << std::to_string(progressiveTraceCursor) << " bytes from trace\n");
-		gzseek(traceFile, progressiveTraceCursor, SEEK_SET);
+		traceFile.seek(progressiveTraceCursor);
 	}
 	else {
-		gzrewind(traceFile);
+		traceFile.rewind();
 	}
 #else
-	gzrewind(traceFile);
+	traceFile.rewind();
 #endif
 
 #ifdef FUTURE_CACHE
@@ -1009,7 +762,7 @@ intervalTy DDDGBuilder::getTraceLineFromToAfterNestedLoop(gzFile &traceFile) {
 			VERBOSE_PRINT(errs() << "\t\tCached cursor hit\n");
 			VERBOSE_PRINT(errs() << "\t\tSkipping further " << std::to_string(cacheHit->second.gzCursor - progressiveTraceCursor) << " bytes from trace\n");
 
-			gzseek(traceFile, cacheHit->second.gzCursor, SEEK_SET);
+			traceFile.seek(cacheHit->second.gzCursor);
 			byteFrom = cacheHit->second.byteFrom;
 			instCount = cacheHit->second.instCount;
 			progressiveTraceCursor = cacheHit->second.progressiveTraceCursor;
@@ -1027,28 +780,13 @@ intervalTy DDDGBuilder::getTraceLineFromToAfterNestedLoop(gzFile &traceFile) {
 	}
 #endif
 
-	while(!gzeof(traceFile)) {
-		if(Z_NULL == gzgets(traceFile, buffer, sizeof(buffer)))
-			continue;
-
-		std::string line(buffer);
-		size_t tagPos = line.find(",");
-
-		if(std::string::npos == tagPos)
-			continue;
-
-		std::string tag = line.substr(0, tagPos);
-		std::string rest = line.substr(tagPos + 1);
-
-		if(!tag.compare("0")) {
-			char buffer2[BUFF_STR_SZ];
-			char buffer3[BUFF_STR_SZ];
-			char buffer4[BUFF_STR_SZ];
-			int count;
-			sscanf(rest.c_str(), "%*d,%[^,],%[^,],%[^,],%*d,%d\n", buffer2, buffer3, buffer4, &count);
-			std::string funcName(buffer2);
-			std::string bbName(buffer3);
-			std::string instName(buffer4);
+	traceLineTy line;
+	while(traceFile.next(line, false)) {
+		if(traceLineTy::TYPE_INST == line.type) {
+			const std::string &funcName = line.funcName;
+			const std::string &bbName = line.bbName;
+			const std::string &instName = line.instName;
+			uint64_t count = line.count;
 
 			prevLoopLevel = currLoopLevel;
 			bbFuncNamePair2lpNameLevelPairMapTy::iterator found5 = bbFuncNamePair2lpNameLevelPairMap.find(std::make_pair(bbName, funcName));
@@ -1063,14 +801,14 @@ intervalTy DDDGBuilder::getTraceLineFromToAfterNestedLoop(gzFile &traceFile) {
 				// Recall that consecutive loops are not allowed out of the top-level body of the function. So this logic works without problems
 				if(currLoopLevel < prevLoopLevel && currLoopLevel == loopLevel) {
 					// Save in byteFrom the amount of bytes between beginning of trace of file and first instruction after the nested loop
-					byteFrom = gztell(traceFile) - line.size();
+					byteFrom = line.pos;
 					instCount--;
 					firstTraverse = false;
 
 #ifdef FUTURE_CACHE
 					if(args.futureCache) {
 						// Save to cache
-						FutureCache::elemTy cacheElem(gztell(traceFile) - line.size(), byteFrom, instCount, byteFrom, instCount, 0, to);
+						FutureCache::elemTy cacheElem(line.pos, byteFrom, instCount, byteFrom, instCount, 0, to);
 						futureCache.insert(
 							wholeLoopName, DatapathType::NON_PERFECT_AFTER, progressiveTraceCursor, progressiveTraceInstCount,
 							cacheElem
@@ -1099,7 +837,7 @@ intervalTy DDDGBuilder::getTraceLineFromToAfterNestedLoop(gzFile &traceFile) {
 	return std::make_tuple(byteFrom, to, instCount);
 }
 
-intervalTy DDDGBuilder::getTraceLineFromToBetweenAfterAndBefore(gzFile &traceFile) {
+intervalTy DDDGBuilder::getTraceLineFromToBetweenAfterAndBefore(TraceReader &traceFile) {
 	std::string loopName = datapath->getTargetLoopName();
 	int loopLevel = datapath->getTargetLoopLevel();
 	int prevLoopLevel = 0, currLoopLevel = 0;
@@ -1113,19 +851,18 @@ intervalTy DDDGBuilder::getTraceLineFromToBetweenAfterAndBefore(gzFile &traceFil
 #endif
 	uint64_t byteFrom, to = 0;
 	bool firstTraverse = true;
-	char buffer[BUFF_STR_SZ];
 
 	// Iterate through dynamic trace
 #ifdef PROGRESSIVE_TRACE_CURSOR
 	if(args.progressive) {
 		VERBOSE_PRINT(errs() << "\t\tUsing progressive trace cursor, skipping " << std::to_string(progressiveTraceCursor) << " bytes from trace\n");
-		gzseek(traceFile, progressiveTraceCursor, SEEK_SET);
+		traceFile.seek(progressiveTraceCursor);
 	}
 	else {
-		gzrewind(traceFile);
+		traceFile.rewind();
 	}
 #else
-	gzrewind(traceFile);
+	traceFile.rewind();
 #endif
 
 #ifdef FUTURE_CACHE
@@ -1140,7 +877,7 @@ intervalTy DDDGBuilder::getTraceLineFromToBetweenAfterAndBefore(gzFile &traceFil
 			VERBOSE_PRINT(errs() << "\t\tCached cursor hit\n");
 			VERBOSE_PRINT(errs() << "\t\tSkipping further " << std::to_string(cacheHit->second.gzCursor - progressiveTraceCursor) << " bytes from trace\n");
 
-			gzseek(traceFile, cacheHit->second.gzCursor, SEEK_SET);
+			traceFile.seek(cacheHit->second.gzCursor);
 			byteFrom = cacheHit->second.byteFrom;
 			instCount = cacheHit->second.instCount;
 
@@ -1156,28 +893,12 @@ intervalTy DDDGBuilder::getTraceLineFromToBetweenAfterAndBefore(gzFile &traceFil
 	}
 #endif
 
-	while(!gzeof(traceFile)) {
-		if(Z_NULL == gzgets(traceFile, buffer, sizeof(buffer)))
-			continue;
-
-		std::string line(buffer);
-		size_t tagPos = line.find(",");
-
-		if(std::string::npos == tagPos)
-			continue;
-
-		std::string tag = line.substr(0, tagPos);
-		std::string rest = line.substr(tagPos + 1);
-
-		if(!tag.compare("0")) {
-			char buffer2[BUFF_STR_SZ];
-			char buffer3[BUFF_STR_SZ];
-			char buffer4[BUFF_STR_SZ];
-			int count;
-			sscanf(rest.c_str(), "%*d,%[^,],%[^,],%[^,],%*d,%d\n", buffer2, buffer3, buffer4, &count);
-			std::string funcName(buffer2);
-			std::string bbName(buffer3);
-			std::string instName(buffer4);
+	traceLineTy line;
+	while(traceFile.next(line, false)) {
+		if(traceLineTy::TYPE_INST == line.type) {
+			const std::string &funcName = line.funcName;
+			const std::string &bbName = line.bbName;
+			uint64_t count = line.count;
 
 			prevLoopLevel = currLoopLevel;
 			bbFuncNamePair2lpNameLevelPairMapTy::iterator found = bbFuncNamePair2lpNameLevelPairMap.find(std::make_pair(bbName, funcName));
@@ -1192,14 +913,14 @@ intervalTy DDDGBuilder::getTraceLineFromToBetweenAfterAndBefore(gzFile &traceFil
 				// Recall that consecutive loops are not allowed out of the top-level body of the function. So this logic works without problems
 				if(currLoopLevel < prevLoopLevel && currLoopLevel == loopLevel) {
 					// Save in byteFrom the amount of bytes between beginning of trace of file and first instruction after the nested loop
-					byteFrom = gztell(traceFile) - line.size();
+					byteFrom = line.pos;
 					instCount--;
 					firstTraverse = false;
 
 #ifdef FUTURE_CACHE
 					if(args.futureCache) {
 						// Save to cache
-						FutureCache::elemTy cacheElem(gztell(traceFile) - line.size(), byteFrom, instCount, progressiveTraceCursor, progressiveTraceInstCount, 0, 0);
+						FutureCache::elemTy cacheElem(line.pos, byteFrom, instCount, progressiveTraceCursor, progressiveTraceInstCount, 0, 0);
 						futureCache.insert(
 							wholeLoopName, DatapathType::NON_PERFECT_BETWEEN, progressiveTraceCursor, progressiveTraceInstCount,
 							cacheElem
@@ -1223,11 +944,7 @@ intervalTy DDDGBuilder::getTraceLineFromToBetweenAfterAndBefore(gzFile &traceFil
 }
 
 void DDDGBuilder::buildInitialDDDG() {
-	std::string traceFileName = args.workDir + FILE_DYNAMIC_TRACE;
-	gzFile traceFile;
-
-	traceFile = gzopen(traceFileName.c_str(), "r");
-	assert(traceFile != Z_NULL && "Could not open trace input file");
+	TraceReader traceFile;
 
 	VERBOSE_PRINT(errs() << "\t\tStarted build of initial DDDG\n");
 
@@ -1248,11 +965,7 @@ void DDDGBuilder::buildInitialDDDG() {
 }
 
 void DDDGBuilder::buildInitialDDDG(intervalTy interval) {
-	std::string traceFileName = args.workDir + FILE_DYNAMIC_TRACE;
-	gzFile traceFile;
-
-	traceFile = gzopen(traceFileName.c_str(), "r");
-	assert(traceFile != Z_NULL && "Could not open trace input file");
+	TraceReader traceFile;
 
 	VERBOSE_PRINT(errs() << "\t\tStarted build of initial DDDG\n");
 
@@ -1282,7 +995,15 @@ std::pair<const u2eMMap, const u2eMMap> DDDGBuilder::getEdgeTables() {
 	return std::make_pair(registerEdgeTable, memoryEdgeTable);
 }
 
-intervalTy DDDGBuilder::getTraceLineFromTo(gzFile &traceFile) {
+const std::vector<unsigned> &DDDGBuilder::getNodeIterations() {
+	return nodeIterations;
+}
+
+const std::vector<carriedEdgeTy> &DDDGBuilder::getCarriedEdges() {
+	return carriedEdges;
+}
+
+intervalTy DDDGBuilder::getTraceLineFromTo(TraceReader &traceFile) {
 	std::string loopName = datapath->getTargetLoopName();
 	unsigned loopLevel = datapath->getTargetLoopLevel();
 	uint64_t unrollFactor = datapath->getTargetLoopUnrollFactor();
@@ -1317,6 +1038,14 @@ intervalTy DDDGBuilder::getTraceLineFromTo(gzFile &traceFile) {
 	assert(found5 != funcBBNmPair2numInstInBBMap.end() && "Could not find number of instructions in header BB inside funcBBNmPair2numInstInBBMap");
 	unsigned numInstInHeaderBB = found5->second;
 
+	// Iterations of this loop are tracked during DDDG construction, only if the datapath uses them. Otherwise no
+	// shadow iteration is parsed and no per-node iteration bookkeeping is done
+	if(datapath->tracksLoopIterations()) {
+		loopFunction = symbolTable.getID(functionName);
+		loopHeaderBB = symbolTable.getID(headerBBName);
+		iterationEndInst = symbolTable.getID(lastInstExitingBB);
+	}
+
 	// Create database of headerBBName-lastInst -> loopName-level
 	headerBBlastInst2loopNameLevelPairMapTy headerBBlastInst2loopNameLevelPairMap;
 	for(auto &it : lpNameLevelPair2headBBnameMap) {
@@ -1325,7 +1054,9 @@ intervalTy DDDGBuilder::getTraceLineFromTo(gzFile &traceFile) {
 		std::string funcName = std::get<0>(parseLoopName(loopName));
 		std::string headerBBName = it.second;
 		std::pair<std::string, std::string> headerBBFuncNamePair = std::make_pair(headerBBName, funcName);
-		std::string headerBBLastInst = headerBBFuncNamePair2lastInstMap[headerBBFuncNamePair];
+		// XXX: Using find() instead of operator[], as this map is shared among threads when running "--batch-threads"
+		headerBBFuncNamePair2lastInstMapTy::iterator found = headerBBFuncNamePair2lastInstMap.find(headerBBFuncNamePair);
+		std::string headerBBLastInst = (found != headerBBFuncNamePair2lastInstMap.end())? found->second : "";
 		std::pair<std::string, unsigned> loopNameLevelPair = std::make_pair(loopName, loopLevel);
 		headerBBlastInst2loopNameLevelPairMap.insert(std::make_pair(headerBBLastInst, loopNameLevelPair));
 	}
@@ -1334,29 +1065,68 @@ intervalTy DDDGBuilder::getTraceLineFromTo(gzFile &traceFile) {
 	uint64_t loopBound = wholeloopName2loopBoundMap.at(wholeLoopName);
 	bool skipRuntimeLoopBound = (loopBound > 0);
 
+#ifdef LOOP_TRIP_COUNTS
+	if(!skipRuntimeLoopBound && addRecordedLoopBounds()) {
+		VERBOSE_PRINT(errs() << "\t\tThere are loops with unknown static bounds, using loop trip counts recorded during tracing\n");
+		adjustRuntimeLoopBounds();
+		skipRuntimeLoopBound = true;
+	}
+#endif
+
 #ifdef PROGRESSIVE_TRACE_CURSOR
 	uint64_t instCount = progressiveTraceInstCount;
 #else
 	uint64_t instCount = 0;
 #endif
 	uint64_t byteFrom, to = 0;
-	// This queue saves exactly the last (numInstInHeaderBB - 1) byte offsets for the beggining of each line
-	LimitedQueue lineByteOffset(numInstInHeaderBB - 1);
 	bool firstTraverseHeader = true;
 	uint64_t lastInstExitingCounter = 0;
-	char buffer[BUFF_STR_SZ];
+
+#ifdef TRACE_INTERVAL_PLAN
+	// Use the interval found by the single-pass scan, if it is the same that the search below would find
+#ifdef FUTURE_CACHE
+	if(!(args.futureCache)) {
+#else
+	{
+#endif
+#ifdef PROGRESSIVE_TRACE_CURSOR
+		uint64_t cursor = args.progressive? progressiveTraceCursor : 0;
+#else
+		uint64_t cursor = 0;
+#endif
+		intervalTy interval;
+		if(traceIntervalPlan.get(loopName, loopLevel, unrollFactor, cursor, instCount, !skipRuntimeLoopBound, interval)) {
+			VERBOSE_PRINT(errs() << "\t\tInterval recovered from trace interval plan\n");
+
+#ifdef PROGRESSIVE_TRACE_CURSOR
+			if(args.progressive) {
+				progressiveTraceCursor = std::get<0>(interval);
+				progressiveTraceInstCount = std::get<2>(interval);
+			}
+#endif
+
+			if(!skipRuntimeLoopBound) {
+				VERBOSE_PRINT(errs() << "\t\tThere are loops with unknown static bounds, using trace to determine their bounds\n");
+				adjustRuntimeLoopBounds();
+			}
+
+			DBG_DUMP("getTraceLineFromTo(): " << std::get<0>(interval) << " " << std::get<1>(interval) << "\n");
+			return interval;
+		}
+	}
+#endif
 
 	// Iterate through dynamic trace
 #ifdef PROGRESSIVE_TRACE_CURSOR
 	if(args.progressive) {
 		VERBOSE_PRINT(errs() << "\t\tUsing progressive trace cursor, skipping " << std::to_string(progressiveTraceCursor) << " bytes from trace\n");
-		gzseek(traceFile, progressiveTraceCursor, SEEK_SET);
+		traceFile.seek(progressiveTraceCursor);
 	}
 	else {
-		gzrewind(traceFile);
+		traceFile.rewind();
 	}
 #else
-	gzrewind(traceFile);
+	traceFile.rewind();
 #endif
 
 #ifdef FUTURE_CACHE
@@ -1371,7 +1141,7 @@ intervalTy DDDGBuilder::getTraceLineFromTo(gzFile &traceFile) {
 				VERBOSE_PRINT(errs() << "\t\tCached cursor hit\n");
 				VERBOSE_PRINT(errs() << "\t\tSkipping further " << std::to_string(cacheHit->second.gzCursor - progressiveTraceCursor) << " bytes from trace\n");
 
-				gzseek(traceFile, cacheHit->second.gzCursor, SEEK_SET);
+				traceFile.seek(cacheHit->second.gzCursor);
 				byteFrom = cacheHit->second.byteFrom;
 				instCount = cacheHit->second.instCount;
 				progressiveTraceCursor = cacheHit->second.progressiveTraceCursor;
@@ -1398,24 +1168,18 @@ intervalTy DDDGBuilder::getTraceLineFromTo(gzFile &traceFile) {
 	}
 #endif
 
-	while(!gzeof(traceFile)) {
-		if(Z_NULL == gzgets(traceFile, buffer, sizeof(buffer)))
-			continue;
-
-		std::string line(buffer);
-		size_t tagPos = line.find(",");
+	// Jump close to the first execution of the loop header using the trace index checkpoints
+	if(skipRuntimeLoopBound && firstTraverseHeader && traceFile.seekNearHeader(headerBBName, functionName, instCount))
+		VERBOSE_PRINT(errs() << "\t\tTrace index checkpoint found, skipping to byte " << std::to_string(traceFile.tell()) << " of trace\n");
 
-		if(std::string::npos == tagPos)
-			continue;
+	// The reader saves exactly the last numInstInHeaderBB byte offsets of instruction lines
+	traceFile.trackInstructions(numInstInHeaderBB - 1);
 
-		std::string tag = line.substr(0, tagPos);
-		std::string rest = line.substr(tagPos + 1);
-
-		if(!tag.compare("0")) {
-			char buffer2[BUFF_STR_SZ];
-			int count;
-			sscanf(rest.c_str(), "%*d,%*[^,],%*[^,],%[^,],%*d,%d\n", buffer2, &count);
-			std::string instName(buffer2);
+	traceLineTy line;
+	while(traceFile.next(line, false)) {
+		if(traceLineTy::TYPE_INST == line.type) {
+			const std::string &instName = line.instName;
+			uint64_t count = line.count;
 
 			// Mark the first line of the first iteration of this loop
 			if(firstTraverseHeader) {
@@ -1423,15 +1187,15 @@ intervalTy DDDGBuilder::getTraceLineFromTo(gzFile &traceFile) {
 
 				if(!instName.compare(lastInstHeaderBB)) {
 					// Save in byteFrom the amount of bytes between beginning of trace of file and first instruction
-					// of first loop iteration (the front() of this queue has the line byte offset for the header)
-					byteFrom = lineByteOffset.front();
+					// of first loop iteration (numInstInHeaderBB - 1 instruction lines before this one)
+					byteFrom = traceFile.getInstructionPos(numInstInHeaderBB - 1);
 					instCount -= numInstInHeaderBB;
 					firstTraverseHeader = false;
 
 #ifdef FUTURE_CACHE
 					if(args.futureCache) {
 						// Save to cache
-						FutureCache::elemTy cacheElem(gztell(traceFile) - line.size(), byteFrom, instCount, byteFrom, instCount, lastInstExitingCounter, to);
+						FutureCache::elemTy cacheElem(line.pos, byteFrom, instCount, byteFrom, instCount, lastInstExitingCounter, to);
 						futureCache.insert(
 							wholeLoopName, DatapathType::NORMAL_LOOP, progressiveTraceCursor, progressiveTraceInstCount,
 							cacheElem
@@ -1445,10 +1209,6 @@ intervalTy DDDGBuilder::getTraceLineFromTo(gzFile &traceFile) {
 					}
 #endif
 				}
-				else {
-					// Save this line byte offset
-					lineByteOffset.push(gztell(traceFile) - line.size());
-				}
 			}
 
 			// Mark the last line of the last iteration of this loop
@@ -1479,68 +1239,44 @@ intervalTy DDDGBuilder::getTraceLineFromTo(gzFile &traceFile) {
 	// Post-process runtime loop bound calculations
 	if(!skipRuntimeLoopBound) {
 		VERBOSE_PRINT(errs() << "\t\tThere are loops with unknown static bounds, using trace to determine their bounds\n");
-
-		for(auto &it : loopName2levelUnrollVecMap) {
-			std::string loopName = it.first;
-			unsigned levelSize = it.second.size();
-
-			assert(levelSize >= 1 && "This loop level is less than 1");
-
-			// Create temporary vector with values inside wholeloopName2loopBoundMap
-			std::vector<unsigned> loopBounds(levelSize, 0);
-			for(unsigned i = 0; i < levelSize; i++) {
-				std::string wholeLoopName = appendDepthToLoopName(loopName, i + 1);
-				wholeloopName2loopBoundMapTy::iterator found7 = wholeloopName2loopBoundMap.find(wholeLoopName);
-				assert(found7 != wholeloopName2loopBoundMap.end() && "Could not find loop in wholeloopName2loopBoundMap");
-
-				loopBounds[i] = found7->second;
-			}
-
-			// The trace only keep trace of the innermost loop that an instruction was executed.
-			// This means that the runtime-calculated loop bounds are not reflecting actual nesting structure of the loops
-			// We must correct/adjust the runtime-calculated loop bounds to reflect the actual nesting structure of the loops
-			for(unsigned i = 1; i < levelSize; i++) {
-				std::string wholeLoopName = appendDepthToLoopName(loopName, i + 1);
-				wholeloopName2loopBoundMapTy::iterator found8 = wholeloopName2loopBoundMap.find(wholeLoopName);
-				assert(found8 != wholeloopName2loopBoundMap.end() && "Could not find loop in wholeloopName2loopBoundMap");
-
-				loopBounds[i] = loopBounds[i] / loopBounds[i - 1];
-				wholeloopName2loopBoundMap[wholeLoopName] = loopBounds[i];
-			}
-		}
+		adjustRuntimeLoopBounds();
 	}
 
 	DBG_DUMP("getTraceLineFromTo(): " << byteFrom << " " << to << "\n");
 	return std::make_tuple(byteFrom, to, instCount);
 }
 
-void DDDGBuilder::parseTraceFile(gzFile &traceFile, intervalTy interval) {
-	PC.openAndClearAllFiles();
+void DDDGBuilder::parseTraceFile(TraceReader &traceFile, intervalTy interval) {
+	PC.clear();
 
 	uint64_t from = std::get<0>(interval), to = std::get<1>(interval);
 	uint64_t instCount = std::get<2>(interval);
 	bool parseInst = false;
-	char buffer[BUFF_STR_SZ];
+	unsigned numOfIterations = 0;
+	bool shadowStarted = false;
+	traceLineTy line;
 
 	// Iterate through dynamic trace, but only process the specified interval
-	gzseek(traceFile, from, SEEK_SET);
-	while(!gzeof(traceFile)) {
-		if(Z_NULL == gzgets(traceFile, buffer, sizeof(buffer)))
-			continue;
-
-		std::string line(buffer);
-		size_t tagPos = line.find(",");
-
-		if(std::string::npos == tagPos)
-			continue;
-
-		std::string tag = line.substr(0, tagPos);
-		rest = line.substr(tagPos + 1);
-
-		if(!tag.compare("0")) {
+	traceFile.seek(from);
+#ifdef PIPELINED_TRACE_READ
+	traceFile.startPipeline();
+#endif
+	while(traceFile.next(line)) {
+		if(traceLineTy::TYPE_INST == line.type) {
 			if(instCount <= to) {
-				parseInstructionLine();
+				parseInstructionLine(line);
+				parseInst = true;
+			}
+			else if(shadowIteration) {
+				// Shadow iteration is over, or the loop exited after the last iteration (i.e. there is no next iteration)
+				if(currIteration > numOfIterations)
+					break;
+				if(!shadowStarted && (symbolTable.getID(line.funcName) != loopFunction || symbolTable.getID(line.bbName) != loopHeaderBB))
+					break;
+
+				parseInstructionLine(line);
 				parseInst = true;
+				shadowStarted = true;
 			}
 			else {
 				parseInst = false;
@@ -1548,66 +1284,83 @@ void DDDGBuilder::parseTraceFile(gzFile &traceFile, intervalTy interval) {
 			instCount++;
 		}
 
-		if(tag.compare("0") && parseInst) {
-			if(!tag.compare("r"))
-				parseResult();
-			else if(!tag.compare("f"))
-				parseForward();
+		if(line.type != traceLineTy::TYPE_INST && parseInst) {
+			if(traceLineTy::TYPE_RESULT == line.type)
+				parseResult(line);
+			else if(traceLineTy::TYPE_FORWARD == line.type)
+				parseForward(line);
 			else
-				parseParameter(std::atoi(tag.c_str()));
+				parseParameter(line);
 		}
-		else if(instCount > to) {
-			break;
+		else if(instCount > to && !shadowIteration) {
+			// If the interval ends with a complete iteration, the next one is parsed as a shadow iteration to find the
+			// dependencies that cross iterations (used for the recurrence-constrained II)
+			if(SymbolTable::NO_SYMBOL == iterationEndInst || currInstID != iterationEndInst)
+				break;
+
+			shadowIteration = true;
+			numOfDDDGNodes = numOfInstructions + 1;
+			numOfIterations = currIteration;
+			parseInst = false;
 		}
 	}
+#ifdef PIPELINED_TRACE_READ
+	traceFile.stopPipeline();
+#endif
 
-	PC.closeAllFiles();
+	PC.pack();
 	PC.lock();
 }
 
-void DDDGBuilder::parseInstructionLine() {
-	int lineNo;
-	char buffer[BUFF_STR_SZ];
-	char buffer2[BUFF_STR_SZ];
-	char buffer3[BUFF_STR_SZ];
-	int microop;
-	int count;
-	sscanf(rest.c_str(), "%d,%[^,],%[^,],%[^,],%d,%d\n", &lineNo, buffer, buffer2, buffer3, &microop, &count);
-	std::string currStaticFunction(buffer);
-	std::string bbID(buffer2);
-	std::string instID(buffer3);
+uint32_t DDDGBuilder::getDynamicFunctionID(uint32_t staticFunction, unsigned counter) {
+	uint64_t key = (((uint64_t) staticFunction) << 32) | counter;
+
+	// The dynamic function name is only constructed (and interned) once per execution of a function
+	std::unordered_map<uint64_t, uint32_t>::iterator found = dynamicFunctionIDs.find(key);
+	if(found != dynamicFunctionIDs.end())
+		return found->second;
+
+#ifdef LEGACY_SEPARATOR
+	uint32_t dynamicFunction = symbolTable.getID(symbolTable.getName(staticFunction) + "-" + std::to_string(counter));
+#else
+	uint32_t dynamicFunction = symbolTable.getID(symbolTable.getName(staticFunction) + GLOBAL_SEPARATOR + std::to_string(counter));
+#endif
+	dynamicFunctionIDs.insert(std::make_pair(key, dynamicFunction));
+
+	return dynamicFunction;
+}
+
+void DDDGBuilder::parseInstructionLine(const traceLineTy &line) {
+	int lineNo = line.lineNo;
+	int microop = line.opcode;
+	uint32_t currStaticFunction = symbolTable.getID(line.funcName);
+	uint32_t bbID = symbolTable.getID(line.bbName);
+	uint32_t instID = symbolTable.getID(line.instName);
 
 	prevMicroop = currMicroop;
 	currMicroop = (uint8_t) microop;
-	datapath->insertMicroop(currMicroop);
+	if(!shadowIteration)
+		datapath->insertMicroop(currMicroop);
 	currInstID = instID;
 
 	// Not first run
 	if(!activeMethod.empty()) {
-		std::string prevStaticFunction = activeMethod.top().first;
+		uint32_t prevStaticFunction = activeMethod.top().first;
 		int prevCount = activeMethod.top().second;
 
 		// Function name in stack differs from current name, i.e. we are in a different function now
-		if(currStaticFunction.compare(prevStaticFunction)) {
-			s2uMap::iterator found = functionCounter.find(currStaticFunction);
+		if(currStaticFunction != prevStaticFunction) {
+			u322uMap::iterator found = functionCounter.find(currStaticFunction);
 			// Add information from this function and reset counter to 0
 			if(functionCounter.end() == found) {
 				functionCounter.insert(std::make_pair(currStaticFunction, 0));
-#ifdef LEGACY_SEPARATOR
-				currDynamicFunction = currStaticFunction + "-0";
-#else
-				currDynamicFunction = currStaticFunction + GLOBAL_SEPARATOR "0";
-#endif
+				currDynamicFunction = getDynamicFunctionID(currStaticFunction, 0);
 				activeMethod.push(std::make_pair(currStaticFunction, 0));
 			}
 			// Update (increment) counter for this function
 			else {
 				found->second++;
-#ifdef LEGACY_SEPARATOR
-				currDynamicFunction = currStaticFunction + "-" + std::to_string(found->second);
-#else
-				currDynamicFunction = currStaticFunction + GLOBAL_SEPARATOR + std::to_string(found->second);
-#endif
+				currDynamicFunction = getDynamicFunctionID(currStaticFunction, found->second);
 				activeMethod.push(std::make_pair(currStaticFunction, found->second));
 			}
 		}
@@ -1615,24 +1368,16 @@ void DDDGBuilder::parseInstructionLine() {
 		else {
 			// Last opcode was a call to this same function, increment counter
 			if(LLVM_IR_Call == prevMicroop && calleeFunction == currStaticFunction) {
-				s2uMap::iterator found = functionCounter.find(currStaticFunction);
+				u322uMap::iterator found = functionCounter.find(currStaticFunction);
 				assert(found != functionCounter.end() && "Current static function not found in function counter");
 
 				found->second++;
-#ifdef LEGACY_SEPARATOR
-				currDynamicFunction = currStaticFunction + "-" + std::to_string(found->second);
-#else
-				currDynamicFunction = currStaticFunction + GLOBAL_SEPARATOR + std::to_string(found->second);
-#endif
+				currDynamicFunction = getDynamicFunctionID(currStaticFunction, found->second);
 				activeMethod.push(std::make_pair(currStaticFunction, found->second));
 			}
 			// Nothing changed, just change the current dynamic function
 			else {
-#ifdef LEGACY_SEPARATOR
-				currDynamicFunction = prevStaticFunction + "-" + std::to_string(prevCount);
-#else
-				currDynamicFunction = prevStaticFunction + GLOBAL_SEPARATOR + std::to_string(prevCount);
-#endif
+				currDynamicFunction = getDynamicFunctionID(prevStaticFunction, prevCount);
 			}
 		}
 
@@ -1642,26 +1387,18 @@ void DDDGBuilder::parseInstructionLine() {
 	}
 	// First run, add information about this function to stack
 	else {
-		s2uMap::iterator found = functionCounter.find(currStaticFunction);
+		u322uMap::iterator found = functionCounter.find(currStaticFunction);
 		// Add information from this function and reset counter to 0
 		if(functionCounter.end() == found) {
 			functionCounter.insert(std::make_pair(currStaticFunction, 0));
-#ifdef LEGACY_SEPARATOR
-			currDynamicFunction = currStaticFunction + "-0";
-#else
-			currDynamicFunction = currStaticFunction + GLOBAL_SEPARATOR "0";
-#endif
+			currDynamicFunction = getDynamicFunctionID(currStaticFunction, 0);
 			activeMethod.push(std::make_pair(currStaticFunction, 0));
 			functionCounter.insert(std::make_pair(currStaticFunction, 0));
 		}
 		// Update (increment) counter for this function
 		else {
 			found->second++;
-#ifdef LEGACY_SEPARATOR
-			currDynamicFunction = currStaticFunction + "-" + std::to_string(found->second);
-#else
-			currDynamicFunction = currStaticFunction + GLOBAL_SEPARATOR + std::to_string(found->second);
-#endif
+			currDynamicFunction = getDynamicFunctionID(currStaticFunction, found->second);
 			activeMethod.push(std::make_pair(currStaticFunction, found->second));
 		}
 	}
@@ -1671,12 +1408,14 @@ void DDDGBuilder::parseInstructionLine() {
 		prevBB = currBB;
 	currBB = bbID;
 
-	// Store collected info to compressed files or memory lists
-	PC.appendToFuncList(currDynamicFunction);
-	PC.appendToInstIDList(currInstID);
-	PC.appendToLineNoList(lineNo);
-	PC.appendToPrevBBList(prevBB);
-	PC.appendToCurrBBList(currBB);
+	// Store collected info to compressed files or memory lists (nodes of the shadow iteration are not part of the DDDG)
+	if(!shadowIteration) {
+		PC.appendToFuncList(currDynamicFunction);
+		PC.appendToInstIDList(currInstID);
+		PC.appendToLineNoList(lineNo);
+		PC.appendToPrevBBList(prevBB);
+		PC.appendToCurrBBList(currBB);
+	}
 
 	// Reset variables for the following lines
 	numOfInstructions++;
@@ -1684,33 +1423,49 @@ void DDDGBuilder::parseInstructionLine() {
 	parameterValuePerInst.clear();
 	parameterSizePerInst.clear();
 	parameterLabelPerInst.clear();
+
+	if(SymbolTable::NO_SYMBOL == iterationEndInst)
+		return;
+
+	// Nodes executing the same instruction (and the same occurrence of it) in different iterations have the same identity
+	uint64_t identity = (((uint64_t) currInstID) << 32) | occurrencesInIteration[currInstID]++;
+	if(shadowIteration) {
+		std::unordered_map<uint64_t, unsigned>::iterator found = identity2Node.find(identity);
+		shadowCounterpart = (found != identity2Node.end())? found->second : -1;
+	}
+	else {
+		nodeIterations.push_back(currIteration);
+		identity2Node[identity] = numOfInstructions;
+	}
+
+	if(iterationEndInst == currInstID) {
+		currIteration++;
+		occurrencesInIteration.clear();
+	}
 }
 
-void DDDGBuilder::parseResult() {
-	int size;
-	double value;
-	int isReg;
-	char buffer[BUFF_STR_SZ];
-	sscanf(rest.c_str(), "%d,%lf,%d,%[^\n]\n", &size, &value, &isReg, buffer);
-	std::string label(buffer);
+void DDDGBuilder::parseResult(const traceLineTy &line) {
+	int size = line.size;
+	double value = line.value;
+	int isReg = line.isReg;
+	const std::string &label = line.label;
 
 	assert(isReg && "Result trace line must be a register");
 
-#ifdef LEGACY_SEPARATOR
-	std::string uniqueRegID = currDynamicFunction + "-" + label;
-#else
-	std::string uniqueRegID = currDynamicFunction + GLOBAL_SEPARATOR + label;
-#endif
-
-	PC.appendToResultSizeList(numOfInstructions, size);
+	uint64_t uniqueRegID = getUniqueRegID(currDynamicFunction, line.labelID);
 
 	// Store the instruction where this register was written
-	s2uMap::iterator found = registerLastWritten.find(uniqueRegID);
+	u642uMap::iterator found = registerLastWritten.find(uniqueRegID);
 	if(found != registerLastWritten.end())
 		found->second = numOfInstructions;
 	else
 		registerLastWritten.insert(std::make_pair(uniqueRegID, numOfInstructions));
 
+	if(shadowIteration)
+		return;
+
+	PC.appendToResultSizeList(numOfInstructions, size);
+
 	// Register an allocation request
 	if(LLVM_IR_Alloca == currMicroop) {
 		PC.appendToGetElementPtrList(numOfInstructions, label, (int64_t) value);
@@ -1728,57 +1483,42 @@ void DDDGBuilder::parseResult() {
 	}
 }
 
-void DDDGBuilder::parseForward() {
-	int size, isReg;
-	double value;
-	char buffer[BUFF_STR_SZ];
-	sscanf(rest.c_str(), "%d,%lf,%d,%[^\n]\n", &size, &value, &isReg, buffer);
-	std::string label(buffer);
+void DDDGBuilder::parseForward(const traceLineTy &line) {
+	int isReg = line.isReg;
 
 	assert(isReg && "Forward trace line must be a register");
 	assert(isCallOp(currMicroop) && "Invalid forward line found in trace with no attached DMA/call instruction");
 
-#ifdef LEGACY_SEPARATOR
-	std::string uniqueRegID = calleeDynamicFunction + "-" + label;
-#else
-	std::string uniqueRegID = calleeDynamicFunction + GLOBAL_SEPARATOR + label;
-#endif
+	uint64_t uniqueRegID = getUniqueRegID(calleeDynamicFunction, line.labelID);
 
 	int tmpWrittenInst = (lastCallSource != -1)? lastCallSource : numOfInstructions;
 
-	s2uMap::iterator found = registerLastWritten.find(uniqueRegID);
+	u642uMap::iterator found = registerLastWritten.find(uniqueRegID);
 	if(found != registerLastWritten.end())
 		found->second = tmpWrittenInst;
 	else
 		registerLastWritten.insert(std::make_pair(uniqueRegID, tmpWrittenInst));
 }
 
-void DDDGBuilder::parseParameter(int param) {
-	int size, isReg;
-	double value;
-	char buffer[BUFF_STR_SZ];
-	sscanf(rest.c_str(), "%d,%lf,%d,%[^\n]\n", &size, &value, &isReg, buffer);
-	std::string label(buffer);
+void DDDGBuilder::parseParameter(const traceLineTy &line) {
+	int param = line.param;
+	int size = line.size;
+	double value = line.value;
+	int isReg = line.isReg;
+	const std::string &label = line.label;
 
 	// First line after log0 is the last parameter (parameters are traced backwards!)
 	if(lastParameter) {
 		// This is a call, save the called function
 		if(LLVM_IR_Call == currMicroop)
-			calleeFunction = label;
+			calleeFunction = line.labelID;
 
 		// Update dynamic function
-		s2uMap::iterator found = functionCounter.find(calleeFunction);
-#ifdef LEGACY_SEPARATOR
-		if(found != functionCounter.end())
-			calleeDynamicFunction = calleeFunction + "-" + std::to_string(found->second + 1);
-		else
-			calleeDynamicFunction = calleeFunction + "-0";
-#else
+		u322uMap::iterator found = functionCounter.find(calleeFunction);
 		if(found != functionCounter.end())
-			calleeDynamicFunction = calleeFunction + GLOBAL_SEPARATOR + std::to_string(found->second + 1);
+			calleeDynamicFunction = getDynamicFunctionID(calleeFunction, found->second + 1);
 		else
-			calleeDynamicFunction = calleeFunction + GLOBAL_SEPARATOR "0";
-#endif
+			calleeDynamicFunction = getDynamicFunctionID(calleeFunction, 0);
 	}
 
 	// Note that the last parameter is listed first in the trace, hence this non-intuitive logic
@@ -1790,24 +1530,29 @@ void DDDGBuilder::parseParameter(int param) {
 		// If this is a PHI node and previous analysed BB is the same as the PHI operand, no need to check for dependency
 		bool processDep = true;
 		if(isPhiOp(currMicroop)) {
-			std::string operandBB = instName2bbNameMap.at(label);
-			if(operandBB != prevBB)
+			const std::string &operandBB = instName2bbNameMap.at(label);
+			if(operandBB != symbolTable.getName(prevBB))
 				processDep = false;
 		}
 
 		// Process register dependency
 		if(processDep) {
-			std::string uniqueRegID = currDynamicFunction + "-" + label;
+			uint64_t uniqueRegID = getUniqueRegID(currDynamicFunction, line.labelID);
 
 			// Update, register a new register dependency, storing the instruction that writes the register
-			s2uMap::iterator found = registerLastWritten.find(uniqueRegID);
+			u642uMap::iterator found = registerLastWritten.find(uniqueRegID);
 			if(found != registerLastWritten.end()) {
-				edgeNodeInfo tmp;
-				tmp.sink = numOfInstructions;
-				tmp.paramID = param;
+				if(shadowIteration) {
+					insertCarriedEdge(found->second);
+				}
+				else {
+					edgeNodeInfo tmp;
+					tmp.sink = numOfInstructions;
+					tmp.paramID = param;
 
-				registerEdgeTable.insert(std::make_pair(found->second, tmp));
-				numOfRegDeps++;
+					registerEdgeTable.insert(std::make_pair(found->second, tmp));
+					numOfRegDeps++;
+				}
 
 				if(LLVM_IR_Call == currMicroop)
 					lastCallSource = found->second;
@@ -1826,7 +1571,10 @@ void DDDGBuilder::parseParameter(int param) {
 			int64_t addr = parameterValuePerInst.back();
 			i642uMap::iterator found = addressLastWritten.find(addr);
 
-			if(found != addressLastWritten.end()) {
+			if(found != addressLastWritten.end() && shadowIteration) {
+				insertCarriedEdge(found->second);
+			}
+			else if(found != addressLastWritten.end()) {
 				unsigned source = found->second;
 				auto sameSource = memoryEdgeTable.equal_range(source);
 				bool exists = false;
@@ -1848,8 +1596,10 @@ void DDDGBuilder::parseParameter(int param) {
 				}
 			}
 
-			std::string baseLabel = parameterLabelPerInst.back();
-			PC.appendToGetElementPtrList(numOfInstructions, baseLabel, addr);
+			if(!shadowIteration) {
+				std::string baseLabel = parameterLabelPerInst.back();
+				PC.appendToGetElementPtrList(numOfInstructions, baseLabel, addr);
+			}
 		}
 		// Second parameter of store is the pointer
 		else if(2 == param && isStoreOp(currMicroop)) {
@@ -1862,15 +1612,16 @@ void DDDGBuilder::parseParameter(int param) {
 			else
 				addressLastWritten.insert(std::make_pair(addr, numOfInstructions));
 
-			PC.appendToGetElementPtrList(numOfInstructions, baseLabel, addr);
+			if(!shadowIteration)
+				PC.appendToGetElementPtrList(numOfInstructions, baseLabel, addr);
 		}
 		// First parameter of store is the value
-		else if(1 == param && isStoreOp(currMicroop)) {
+		else if(1 == param && isStoreOp(currMicroop) && !shadowIteration) {
 			int64_t addr = parameterValuePerInst[0];
 			unsigned size = parameterSizePerInst.back();
 			PC.appendToMemoryTraceList(numOfInstructions, addr, size);
 		}
-		else if(1 == param && LLVM_IR_GetElementPtr == currMicroop) {
+		else if(1 == param && LLVM_IR_GetElementPtr == currMicroop && !shadowIteration) {
 			int64_t addr = parameterValuePerInst.back();
 			std::string label = parameterLabelPerInst.back();
 			PC.appendToGetElementPtrList(numOfInstructions, label, addr);
@@ -1878,37 +1629,47 @@ void DDDGBuilder::parseParameter(int param) {
 	}
 }
 
-bool DDDGBuilder::lookaheadIsSameLoopLevel(gzFile &traceFile, unsigned loopLevel) {
-	size_t rollbackBytes = 0;
-	char buffer[BUFF_STR_SZ];
-	bool result = false;
+void DDDGBuilder::insertCarriedEdge(unsigned source) {
+	std::vector<unsigned> sources;
 
-	while(!gzeof(traceFile)) {
-		if(Z_NULL == gzgets(traceFile, buffer, sizeof(buffer)))
-			continue;
+	// A source in the shadow iteration is a PHI or bitcast node, that forwards its own loop-carried sources (if any)
+	if(source >= numOfDDDGNodes) {
+		std::unordered_map<unsigned, std::vector<unsigned>>::iterator found = shadowForwards.find(source);
+		if(shadowForwards.end() == found)
+			return;
 
-		std::string line(buffer);
+		sources = found->second;
+	}
+	else {
+		sources.push_back(source);
+	}
 
-		// Save the number of bytes read for posterior rollback
-		rollbackBytes += line.length();
+	unsigned shadowIndex = nodeIterations.back() + 1;
 
-		size_t tagPos = line.find(",");
+	for(auto &it : sources) {
+		if(shadowCounterpart != -1) {
+			carriedEdgeTy edge;
+			edge.source = it;
+			edge.sink = shadowCounterpart;
+			edge.distance = shadowIndex - nodeIterations.at(it);
+			carriedEdges.push_back(edge);
+		}
 
-		if(std::string::npos == tagPos)
-			continue;
+		if(LLVM_IR_PHI == currMicroop || LLVM_IR_BitCast == currMicroop)
+			shadowForwards[numOfInstructions].push_back(it);
+	}
+}
 
-		std::string tag = line.substr(0, tagPos);
-		std::string rest = line.substr(tagPos + 1);
+bool DDDGBuilder::lookaheadIsSameLoopLevel(TraceReader &traceFile, unsigned loopLevel) {
+	// Mark the current position for posterior rollback
+	traceFile.mark();
+	traceLineTy line;
+	bool result = false;
 
+	while(traceFile.next(line, false)) {
 		// Found another instruction
-		if(!tag.compare("0")) {
-			char buffer2[BUFF_STR_SZ];
-			char buffer3[BUFF_STR_SZ];
-			sscanf(rest.c_str(), "%*d,%[^,],%[^,],%*[^,],%*d,%*d\n", buffer2, buffer3);
-			std::string funcName(buffer2);
-			std::string bbName(buffer3);
-
-			unsigned currLoopLevel = bbFuncNamePair2lpNameLevelPairMap.at(std::make_pair(bbName, funcName)).second;
+		if(traceLineTy::TYPE_INST == line.type) {
+			unsigned currLoopLevel = bbFuncNamePair2lpNameLevelPairMap.at(std::make_pair(line.bbName, line.funcName)).second;
 			assert(currLoopLevel >= loopLevel && "Trace lookahead resulted in upper loop level, which is not expected in non-perfect loops");
 
 			// Save if this next instruction is part of another loop level
@@ -1918,7 +1679,7 @@ bool DDDGBuilder::lookaheadIsSameLoopLevel(gzFile &traceFile, unsigned loopLevel
 	}
 
 	// Rollback
-	gzseek(traceFile, -rollbackBytes, SEEK_CUR);
+	traceFile.reset();
 
 	return result;
 }
@@ -1929,4 +1690,10 @@ void DDDGBuilder::writeDDDG() {
 
 	for(auto &it : memoryEdgeTable)
 		datapath->insertDDDGEdge(it.first, it.second.sink, it.second.paramID);
+
+	for(auto &it : nodeIterations)
+		datapath->insertNodeIteration(it);
+
+	for(auto &it : carriedEdges)
+		datapath->insertCarriedEdge(it.source, it.sink, it.distance);
 }
@@ -0,0 +1,97 @@
+#include "profile_h/DDDGCache.h"
+
+#include <errno.h>
+#include <functional>
+#include <sstream>
+#include <stdio.h>
+#include <sys/stat.h>
+#include <thread>
+
+#include "profile_h/BaseDatapath.h"
+
+DDDGCache::DDDGCache(std::string wholeLoopName, unsigned datapathType, uint64_t unrollFactor, bool loopIterations) :
+	wholeLoopName(wholeLoopName), datapathType(datapathType), unrollFactor(unrollFactor)
+{
+	key = constructKey(wholeLoopName, datapathType, unrollFactor) + (loopIterations? "~iter" : "~noiter");
+
+	std::stringstream ss;
+	ss << std::hex << std::hash<std::string>()(key);
+	fileName = args.workDir + FOLDER_DDDG_CACHE + ss.str() + FILE_DDDG_CACHE_SUFFIX;
+}
+
+std::string DDDGCache::constructKey(std::string wholeLoopName, unsigned datapathType, uint64_t unrollFactor) {
+	// Traces generated by different executions will have (most likely) different sizes
+	std::string traceFileName = args.workDir + (args.binaryTrace? FILE_DYNAMIC_TRACE_BIN : FILE_DYNAMIC_TRACE);
+	struct stat traceStat;
+	uint64_t traceSize = stat(traceFileName.c_str(), &traceStat)? 0 : traceStat.st_size;
+
+	// Runtime-calculated loop bounds change during the estimation, they are hashed to keep the key short
+	std::stringstream loopBounds;
+	for(auto &it : wholeloopName2loopBoundMap)
+		loopBounds << it.first << "=" << it.second << ";";
+
+	long int cursor = 0;
+	uint64_t instCount = 0;
+#ifdef PROGRESSIVE_TRACE_CURSOR
+	if(args.progressive) {
+		cursor = progressiveTraceCursor;
+		instCount = progressiveTraceInstCount;
+	}
+#endif
+
+	std::stringstream ss;
+	ss << DDDG_CACHE_VERSION << "~" << wholeLoopName << "~" << datapathType << "~" << unrollFactor << "~" << cursor << "~" << instCount << "~";
+	ss << (args.binaryTrace? "bin" : "txt") << "~" << traceSize << "~" << std::hex << std::hash<std::string>()(loopBounds.str());
+
+	return ss.str();
+}
+
+bool DDDGCache::load(BaseDatapath *datapath, ParsedTraceContainer *PC) {
+	std::ifstream testFile(fileName);
+	if(!(testFile.is_open()))
+		return false;
+	testFile.close();
+
+	ContextManager CtxM(fileName);
+	CtxM.openForRead();
+
+	std::string readKey;
+	CtxM.getCacheKey(&readKey);
+	if(readKey != key)
+		return false;
+
+	CtxM.getParsedTraceContainer(wholeLoopName, datapathType, unrollFactor, PC);
+	CtxM.getDDDG(wholeLoopName, datapathType, unrollFactor, datapath);
+	CtxM.getLoopBoundInfo(&wholeloopName2loopBoundMap);
+#ifdef PROGRESSIVE_TRACE_CURSOR
+	CtxM.getProgressiveTraceInfo(&progressiveTraceCursor, &progressiveTraceInstCount);
+#endif
+	CtxM.close();
+
+	return true;
+}
+
+void DDDGCache::save(DDDGBuilder &builder, ParsedTraceContainer &PC, std::vector<int> &microops) {
+	std::string folderName = args.workDir + FOLDER_DDDG_CACHE;
+	int mkdirResult = mkdir(folderName.c_str(), 0755);
+	assert((!mkdirResult || EEXIST == errno) && "Could not create DDDG cache folder");
+
+	// Entries are written to a temporary file and then renamed, so that concurrent executions
+	// (or threads with "--batch-threads") never see incomplete entries
+	std::stringstream ss;
+	ss << fileName << ".tmp" << std::hex << std::hash<std::thread::id>()(std::this_thread::get_id());
+	std::string tempFileName = ss.str();
+
+	ContextManager CtxM(tempFileName);
+	CtxM.openForWrite();
+	CtxM.saveCacheKey(key);
+#ifdef PROGRESSIVE_TRACE_CURSOR
+	CtxM.saveProgressiveTraceInfo(progressiveTraceCursor, progressiveTraceInstCount);
+#endif
+	CtxM.saveLoopBoundInfo(wholeloopName2loopBoundMap);
+	CtxM.saveParsedTraceContainer(wholeLoopName, datapathType, unrollFactor, PC);
+	CtxM.saveDDDG(wholeLoopName, datapathType, unrollFactor, builder, microops);
+	CtxM.close();
+
+	rename(tempFileName.c_str(), fileName.c_str());
+}
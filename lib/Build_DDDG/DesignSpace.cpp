@@ -0,0 +1,318 @@
+#include "profile_h/DesignSpace.h"
+
+#include <algorithm>
+#include <assert.h>
+#include <fstream>
+#include <numeric>
+#include <sstream>
+
+#include "profile_h/auxiliary.h"
+
+using namespace llvm;
+
+// Weight of a completely partitioned array when ranking points, larger than any partitioning factor
+#define COMPLETE_PARTITION_RANK (((uint64_t) 1) << 32)
+
+bool DesignSpace::objectivesTy::isCovering(const objectivesTy &other) const {
+	return cycles <= other.cycles && dsp <= other.dsp && ff <= other.ff && lut <= other.lut && bram18k <= other.bram18k;
+}
+
+DesignSpace::DesignSpace(std::string spaceFileName) {
+	std::ifstream spaceFile(spaceFileName);
+	assert(spaceFile.is_open() && "Error opening design space file");
+
+	std::string line;
+	while(std::getline(spaceFile, line)) {
+		if(!line.size() || '#' == line[0])
+			continue;
+
+		if(line.compare(0, 7, "option,")) {
+			sharedDirectives.push_back(line);
+			continue;
+		}
+
+		size_t dimensionPos = line.find(",", 7);
+		assert(dimensionPos != std::string::npos && "Invalid \"option\" line in design space file, expected \"option,DIMENSION,DIRECTIVES\"");
+		std::string dimension = line.substr(7, dimensionPos - 7);
+		std::string rest = line.substr(dimensionPos + 1);
+
+		unsigned dimensionID = std::find(dimensions.begin(), dimensions.end(), dimension) - dimensions.begin();
+		if(dimensions.size() == dimensionID) {
+			dimensions.push_back(dimension);
+			options.push_back(std::vector<std::vector<std::string>>());
+		}
+
+		std::vector<std::string> directives;
+		if(rest.compare("none")) {
+			std::stringstream ss(rest);
+			std::string directive;
+			while(std::getline(ss, directive, ';')) {
+				if(directive.size())
+					directives.push_back(directive);
+			}
+		}
+		options[dimensionID].push_back(directives);
+	}
+	spaceFile.close();
+
+	assert(dimensions.size() && "Design space file has no \"option\" lines");
+
+	// A dimension is a partitioning dimension if all of its options only partition arrays
+	partitionings.resize(dimensions.size());
+	for(unsigned i = 0; i < dimensions.size(); i++) {
+		std::vector<partitioningTy> dimensionPartitionings;
+		bool isPartitioningDimension = true;
+
+		for(auto &it : options[i]) {
+			partitioningTy partitioning;
+			for(auto &it2 : it) {
+				if(!parsePartitioning(it2, partitioning))
+					isPartitioningDimension = false;
+			}
+			dimensionPartitionings.push_back(partitioning);
+		}
+
+		if(isPartitioningDimension)
+			partitionings[i] = dimensionPartitionings;
+	}
+
+	// Enumerate all combinations of options
+	std::vector<unsigned> current(dimensions.size(), 0);
+	for(bool done = false; !done;) {
+		pointTy point;
+		point.name = "p" + std::to_string(points.size());
+		point.options = current;
+		point.status = pointTy::POINT_PENDING;
+		points.push_back(point);
+
+		// Points are ranked by how much they are partitioned
+		uint64_t rank = 0;
+		for(unsigned i = 0; i < dimensions.size(); i++) {
+			if(partitionings[i].empty())
+				continue;
+
+			for(auto &it : partitionings[i][current[i]]) {
+				if(ConfigurationManager::partitionCfgTy::PARTITION_TYPE_COMPLETE == it.second.first)
+					rank += COMPLETE_PARTITION_RANK;
+				else if(it.second.second > 1)
+					rank += it.second.second;
+			}
+		}
+		pointRank.push_back(rank);
+
+		done = true;
+		for(unsigned i = 0; i < dimensions.size(); i++) {
+			if(++(current[i]) < options[i].size()) {
+				done = false;
+				break;
+			}
+
+			current[i] = 0;
+		}
+	}
+
+	pointGroup.assign(points.size(), 0);
+	pointMemory.assign(points.size(), objectivesTy());
+}
+
+bool DesignSpace::parsePartitioning(const std::string &directive, partitioningTy &partitioning) {
+	std::vector<std::string> fields;
+	std::stringstream ss(directive);
+	std::string field;
+	while(std::getline(ss, field, ','))
+		fields.push_back(field);
+
+	if(fields.size() < 3 || fields[0].compare("partition"))
+		return false;
+
+	if(!(fields[1].compare("complete"))) {
+		assert(4 == fields.size() && "Invalid complete partition directive in design space file, expected \"partition,complete,NAME,SIZE\"");
+		partitioning[fields[2]] = std::make_pair((unsigned) ConfigurationManager::partitionCfgTy::PARTITION_TYPE_COMPLETE, (uint64_t) 0);
+	}
+	else {
+		assert(6 == fields.size() && "Invalid partition directive in design space file, expected \"partition,cyclic|block,NAME,SIZE,WORDSIZE,FACTOR\"");
+		unsigned type = (!(fields[1].compare("block")))? ConfigurationManager::partitionCfgTy::PARTITION_TYPE_BLOCK : ConfigurationManager::partitionCfgTy::PARTITION_TYPE_CYCLIC;
+		partitioning[fields[2]] = std::make_pair(type, (uint64_t) std::stoull(fields[5]));
+	}
+
+	return true;
+}
+
+bool DesignSpace::isPartitionedLessOrEqual(const partitioningTy &first, const partitioningTy &second) {
+	for(auto &it : first) {
+		unsigned type = it.second.first;
+		uint64_t factor = it.second.second;
+
+		// Partitioning factor 1 is the same as no partitioning
+		if(type != ConfigurationManager::partitionCfgTy::PARTITION_TYPE_COMPLETE && factor <= 1)
+			continue;
+
+		partitioningTy::const_iterator found = second.find(it.first);
+		if(second.end() == found)
+			return false;
+		if(ConfigurationManager::partitionCfgTy::PARTITION_TYPE_COMPLETE == found->second.first)
+			continue;
+		if(ConfigurationManager::partitionCfgTy::PARTITION_TYPE_COMPLETE == type || type != found->second.first || factor > found->second.second)
+			return false;
+	}
+
+	return true;
+}
+
+bool DesignSpace::isPartitionedLessOrEqual(unsigned first, unsigned second) const {
+	for(unsigned i = 0; i < dimensions.size(); i++) {
+		if(partitionings[i].empty())
+			continue;
+
+		if(!isPartitionedLessOrEqual(partitionings[i][points[first].options[i]], partitionings[i][points[second].options[i]]))
+			return false;
+	}
+
+	return true;
+}
+
+void DesignSpace::writeConfigurationFiles(std::string prefix) {
+	for(auto &it : points) {
+		it.cfgFileName = prefix + it.name + ".cfg";
+
+		// The configuration parser stops at the first empty line, thus none is written
+		std::ofstream cfgFile(it.cfgFileName);
+		assert(cfgFile.is_open() && "Could not open configuration file for design point");
+		for(auto &it2 : sharedDirectives)
+			cfgFile << it2 << "\n";
+		for(unsigned i = 0; i < dimensions.size(); i++) {
+			for(auto &it2 : options[i][it.options[i]])
+				cfgFile << it2 << "\n";
+		}
+		cfgFile.close();
+	}
+}
+
+void DesignSpace::setPointInfo(unsigned pointID, std::string groupKeySuffix, uint64_t memBRAM18k, uint64_t memFF, uint64_t memLUT) {
+	std::stringstream groupKey;
+	for(unsigned i = 0; i < dimensions.size(); i++) {
+		if(partitionings[i].empty())
+			groupKey << points.at(pointID).options[i] << ",";
+	}
+	groupKey << "~" << groupKeySuffix;
+
+	std::map<std::string, unsigned>::iterator found = groupKeyToID.find(groupKey.str());
+	if(groupKeyToID.end() == found) {
+		found = groupKeyToID.insert(std::make_pair(groupKey.str(), groupFloor.size())).first;
+		groupFloor.push_back(objectivesTy());
+	}
+	pointGroup[pointID] = found->second;
+
+	pointMemory[pointID].bram18k = memBRAM18k;
+	pointMemory[pointID].ff = memFF;
+	pointMemory[pointID].lut = memLUT;
+}
+
+std::vector<unsigned> DesignSpace::getEvaluationOrder() const {
+	std::vector<unsigned> sorted(points.size());
+	std::iota(sorted.begin(), sorted.end(), 0);
+	std::stable_sort(sorted.begin(), sorted.end(), [&](unsigned first, unsigned second) {
+		if(pointGroup[first] != pointGroup[second])
+			return pointGroup[first] < pointGroup[second];
+		return pointRank[first] > pointRank[second];
+	});
+
+	std::vector<unsigned> order;
+	std::vector<unsigned> rest;
+	for(unsigned i = 0; i < sorted.size(); i++) {
+		if(!i || pointGroup[sorted[i]] != pointGroup[sorted[i - 1]])
+			order.push_back(sorted[i]);
+		else
+			rest.push_back(sorted[i]);
+	}
+	order.insert(order.end(), rest.begin(), rest.end());
+
+	return order;
+}
+
+DesignSpace::objectivesTy DesignSpace::getLowerBound(unsigned pointID) const {
+	objectivesTy bound;
+
+	for(unsigned i = 0; i < points.size(); i++) {
+		if(i == pointID || pointTy::POINT_PENDING == points[i].status || pointGroup[i] != pointGroup[pointID])
+			continue;
+
+		if(isPartitionedLessOrEqual(pointID, i))
+			bound.cycles = std::max(bound.cycles, points[i].objectives.cycles);
+	}
+
+	const objectivesTy &floor = groupFloor.at(pointGroup[pointID]);
+	bound.dsp = floor.dsp;
+	bound.ff = floor.ff + pointMemory[pointID].ff;
+	bound.lut = floor.lut + pointMemory[pointID].lut;
+	bound.bram18k = pointMemory[pointID].bram18k;
+
+	return bound;
+}
+
+bool DesignSpace::isDominated(const objectivesTy &objectives) const {
+	for(auto &it : front) {
+		if(points[it].objectives.isCovering(objectives))
+			return true;
+	}
+
+	return false;
+}
+
+void DesignSpace::setPruned(unsigned pointID, const objectivesTy &bound) {
+	points.at(pointID).status = pointTy::POINT_PRUNED;
+	points.at(pointID).objectives = bound;
+}
+
+void DesignSpace::setEvaluated(unsigned pointID, const objectivesTy &objectives, const objectivesTy &floor) {
+	points.at(pointID).status = pointTy::POINT_EVALUATED;
+	points.at(pointID).objectives = objectives;
+
+	objectivesTy &currFloor = groupFloor.at(pointGroup[pointID]);
+	currFloor.dsp = std::max(currFloor.dsp, floor.dsp);
+	currFloor.ff = std::max(currFloor.ff, floor.ff);
+	currFloor.lut = std::max(currFloor.lut, floor.lut);
+
+	if(isDominated(objectives))
+		return;
+
+	front.erase(std::remove_if(front.begin(), front.end(), [&](unsigned it) { return objectives.isCovering(points[it].objectives); }), front.end());
+	front.push_back(pointID);
+}
+
+void DesignSpace::dumpResults(std::string fileName) const {
+	std::ofstream resultsFile(fileName);
+	assert(resultsFile.is_open() && "Could not open design space exploration results output file");
+
+	resultsFile << "point";
+	for(auto &it : dimensions)
+		resultsFile << "," << it;
+	resultsFile << ",status,cycles,dsp,ff,lut,bram18k,pareto\n";
+
+	for(unsigned i = 0; i < points.size(); i++) {
+		const pointTy &point = points[i];
+
+		resultsFile << point.name;
+		for(auto &it : point.options)
+			resultsFile << "," << std::to_string(it);
+
+		switch(point.status) {
+			case pointTy::POINT_EVALUATED:
+				resultsFile << ",evaluated";
+				break;
+			case pointTy::POINT_PRUNED:
+				resultsFile << ",pruned";
+				break;
+			default:
+				resultsFile << ",pending";
+				break;
+		}
+
+		resultsFile << "," << std::to_string(point.objectives.cycles) << "," << std::to_string(point.objectives.dsp);
+		resultsFile << "," << std::to_string(point.objectives.ff) << "," << std::to_string(point.objectives.lut);
+		resultsFile << "," << std::to_string(point.objectives.bram18k);
+		resultsFile << "," << ((std::find(front.begin(), front.end(), i) != front.end())? "1" : "0") << "\n";
+	}
+
+	resultsFile.close();
+}
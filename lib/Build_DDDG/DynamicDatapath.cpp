@@ -1,7 +1,7 @@
 #include "profile_h/DynamicDatapath.h"
 
 DynamicDatapath::DynamicDatapath(
-	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
+	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ostream *summaryFile,
 	std::string loopName, unsigned loopLevel, uint64_t loopUnrollFactor
 ) : BaseDatapath(kernelName, CM, CtxM, summaryFile, loopName, loopLevel, loopUnrollFactor, false, 0) {
 	VERBOSE_PRINT(errs() << "[][][][dynamicDatapath] Analysing DDDG for loop \"" << loopName << "\"\n");
@@ -19,7 +19,7 @@ DynamicDatapath::DynamicDatapath(
 }
 
 DynamicDatapath::DynamicDatapath(
-	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
+	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ostream *summaryFile,
 	std::string loopName, unsigned loopLevel, uint64_t loopUnrollFactor,
 	bool enablePipelining, uint64_t asapII
 ) : BaseDatapath(kernelName, CM, CtxM, summaryFile, loopName, loopLevel, loopUnrollFactor, enablePipelining, asapII) {
@@ -43,37 +43,47 @@ DynamicDatapath::DynamicDatapath(
 
 // Constructor with no nodes to import
 DynamicDatapath::DynamicDatapath(
-	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
+	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ostream *summaryFile,
 	std::string loopName, unsigned loopLevel, uint64_t loopUnrollFactor,
-	unsigned datapathType
+	unsigned datapathType, std::function<void()> *traceStateReady
 ) : BaseDatapath(kernelName, CM, CtxM, summaryFile, loopName, loopLevel, loopUnrollFactor, datapathType) {
-	_DynamicDatapath(kernelName, CM, CtxM, summaryFile, loopName, loopLevel, loopUnrollFactor, nullptr, datapathType);
+	_DynamicDatapath(kernelName, CM, CtxM, summaryFile, loopName, loopLevel, loopUnrollFactor, nullptr, datapathType, traceStateReady);
 }
 
 // Constructor with nodes to import
 DynamicDatapath::DynamicDatapath(
-	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
+	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ostream *summaryFile,
 	std::string loopName, unsigned loopLevel, uint64_t loopUnrollFactor,
-	std::vector<MemoryModel::nodeExportTy> &nodesToImport, unsigned datapathType
+	std::vector<MemoryModel::nodeExportTy> &nodesToImport, unsigned datapathType, std::function<void()> *traceStateReady
 ) : BaseDatapath(kernelName, CM, CtxM, summaryFile, loopName, loopLevel, loopUnrollFactor, datapathType) {
-	_DynamicDatapath(kernelName, CM, CtxM, summaryFile, loopName, loopLevel, loopUnrollFactor, &nodesToImport, datapathType);
+	_DynamicDatapath(kernelName, CM, CtxM, summaryFile, loopName, loopLevel, loopUnrollFactor, &nodesToImport, datapathType, traceStateReady);
 }
 
 // Inner logic for non-perfect loop nest constructor
 void DynamicDatapath::_DynamicDatapath(
-	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
+	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ostream *summaryFile,
 	std::string loopName, unsigned loopLevel, uint64_t loopUnrollFactor,
-	std::vector<MemoryModel::nodeExportTy> *nodesToImport, unsigned datapathType
+	std::vector<MemoryModel::nodeExportTy> *nodesToImport, unsigned datapathType, std::function<void()> *traceStateReady
 ) {
 	VERBOSE_PRINT(errs() << "\tBuild initial DDDG\n");
 
-	std::string traceFileName = args.workDir + FILE_DYNAMIC_TRACE;
-	gzFile traceFile;
+	TraceReader traceFile;
 
-	traceFile = gzopen(traceFileName.c_str(), "r");
-	assert(traceFile != Z_NULL && "Could not open trace input file");
+	bool recoveredFromCache = false;
+#ifdef DDDG_CACHE
+	DDDGCache dddgCache(appendDepthToLoopName(loopName, loopLevel), datapathType, loopUnrollFactor, tracksLoopIterations());
+	// When generating a context the DDDG builder is needed, thus the cache is only written
+	if(args.dddgCache && ArgPack::MMA_MODE_GEN != args.mmaMode && (args.fNoMMA || args.mmaMode != ArgPack::MMA_MODE_USE))
+		recoveredFromCache = dddgCache.load(this, &PC);
+#endif
+
+	if(recoveredFromCache) {
+		VERBOSE_PRINT(errs() << "\tInitial DDDG recovered from DDDG cache\n");
 
-	if(args.fNoMMA || args.mmaMode != ArgPack::MMA_MODE_USE) {
+		if(traceStateReady)
+			(*traceStateReady)();
+	}
+	else if(args.fNoMMA || args.mmaMode != ArgPack::MMA_MODE_USE) {
 		VERBOSE_PRINT(errs() << "\tBuild initial DDDG\n");
 
 		builder = new DDDGBuilder(this, PC);
@@ -87,6 +97,10 @@ void DynamicDatapath::_DynamicDatapath(
 		else
 			assert(false && "Invalid type of datapath passed to this type of dynamic datapath constructor");
 
+		// The trace analysis state is not changed from this point on
+		if(traceStateReady)
+			(*traceStateReady)();
+
 		builder->buildInitialDDDG(interval);
 
 		if(ArgPack::MMA_MODE_GEN == args.mmaMode) {
@@ -96,6 +110,13 @@ void DynamicDatapath::_DynamicDatapath(
 			CtxM.saveDDDG(wholeLoopName, datapathType, loopUnrollFactor, *builder, microops);
 		}
 
+#ifdef DDDG_CACHE
+		if(args.dddgCache) {
+			VERBOSE_PRINT(errs() << "\tSaving initial DDDG to DDDG cache\n");
+			dddgCache.save(*builder, PC, microops);
+		}
+#endif
+
 		delete builder;
 		builder = nullptr;
 	}
@@ -105,6 +126,9 @@ void DynamicDatapath::_DynamicDatapath(
 		std::string wholeLoopName = appendDepthToLoopName(loopName, loopLevel);
 		CtxM.getParsedTraceContainer(wholeLoopName, datapathType, loopUnrollFactor, &PC);
 		CtxM.getDDDG(wholeLoopName, datapathType, loopUnrollFactor, this);
+
+		if(traceStateReady)
+			(*traceStateReady)();
 	}
 
 	if(nodesToImport)
@@ -93,10 +93,11 @@ void HardwareProfile::constrainHardware(
 
 	arrayNameToConfig.clear();
 	arrayNameToEfficiency.clear();
-	arrayPartitionToReadPorts.clear();
-	arrayPartitionToReadPortsInUse.clear();
-	arrayPartitionToWritePorts.clear();
-	arrayPartitionToWritePortsInUse.clear();
+	arrayPartitionToID.clear();
+	partitionReadPorts.clear();
+	partitionReadPortsInUse.clear();
+	partitionWritePorts.clear();
+	partitionWritePortsInUse.clear();
 
 	limitedBy.clear();
 	fAddThreshold = INFINITE_RESOURCES;
@@ -197,19 +198,18 @@ void HardwareProfile::fillPack(Pack &P, unsigned loopLevel, unsigned datapathTyp
 
 #ifdef CONSTRAIN_INT_OP
 	for(auto &it : constrainedIntOps) {
-		std::string key = reverseOpcodeMap.at(it) + " units";
-		P.addDescriptor(key, Pack::MERGE_MAX, Pack::TYPE_UNSIGNED);
-		P.addElement<uint64_t>(key, intOpGetAmount(it));
+		unsigned fieldID = P.addDescriptor(reverseOpcodeMap.at(it) + " units", Pack::MERGE_MAX, Pack::TYPE_UNSIGNED);
+		P.addElement<uint64_t>(fieldID, intOpGetAmount(it));
 	}
 #endif
 
 	for(auto &it : arrayGetNumOfPartitions()) {
-		P.addDescriptor("Number of partitions for array \"" + demangleArrayName(it.first) + "\"", Pack::MERGE_EQUAL, Pack::TYPE_UNSIGNED);
-		P.addElement<uint64_t>("Number of partitions for array \"" + demangleArrayName(it.first) + "\"", it.second);
+		unsigned fieldID = P.addDescriptor("Number of partitions for array \"" + demangleArrayName(it.first) + "\"", Pack::MERGE_EQUAL, Pack::TYPE_UNSIGNED);
+		P.addElement<uint64_t>(fieldID, it.second);
 	}
 	for(auto &it : arrayGetEfficiency()) {
-		P.addDescriptor("Memory efficiency for array \"" + demangleArrayName(it.first) + "\"", Pack::MERGE_EQUAL, Pack::TYPE_FLOAT);
-		P.addElement<float>("Memory efficiency for array \"" + demangleArrayName(it.first) + "\"", it.second);
+		unsigned fieldID = P.addDescriptor("Memory efficiency for array \"" + demangleArrayName(it.first) + "\"", Pack::MERGE_EQUAL, Pack::TYPE_FLOAT);
+		P.addElement<float>(fieldID, it.second);
 	}
 }
 
@@ -218,16 +218,28 @@ unsigned HardwareProfile::arrayGetNumOfPartitions(std::string arrayName) {
 	return arrayNameToNumOfPartitions[arrayName];
 }
 
-unsigned HardwareProfile::arrayGetPartitionReadPorts(std::string partitionName) {
-	std::map<std::string, unsigned>::iterator found = arrayPartitionToReadPorts.find(partitionName);
-	assert(found != arrayPartitionToReadPorts.end() && "Array has no storage allocated for it");
+void HardwareProfile::addPartition(std::string partitionName, unsigned readPorts, unsigned writePorts) {
+	if(!(arrayPartitionToID.insert(std::make_pair(partitionName, partitionReadPorts.size())).second))
+		return;
+
+	partitionReadPorts.push_back(readPorts);
+	partitionReadPortsInUse.push_back(0);
+	partitionWritePorts.push_back(writePorts);
+	partitionWritePortsInUse.push_back(0);
+}
+
+unsigned HardwareProfile::arrayGetPartitionID(std::string partitionName) {
+	std::map<std::string, unsigned>::iterator found = arrayPartitionToID.find(partitionName);
+	assert(found != arrayPartitionToID.end() && "Array has no storage allocated for it");
 	return found->second;
 }
 
+unsigned HardwareProfile::arrayGetPartitionReadPorts(std::string partitionName) {
+	return partitionReadPorts[arrayGetPartitionID(partitionName)];
+}
+
 unsigned HardwareProfile::arrayGetPartitionWritePorts(std::string partitionName) {
-	std::map<std::string, unsigned>::iterator found = arrayPartitionToWritePorts.find(partitionName);
-	assert(found != arrayPartitionToWritePorts.end() && "Array has no storage allocated for it");
-	return found->second;
+	return partitionWritePorts[arrayGetPartitionID(partitionName)];
 }
 
 
@@ -360,40 +372,35 @@ bool HardwareProfile::fCmpTryAllocate(bool commit) {
 	return true;
 }
 
-bool HardwareProfile::loadTryAllocate(std::string arrayPartitionName, bool commit) {
+bool HardwareProfile::loadTryAllocate(unsigned partitionID, bool commit) {
 	assert(isConstrained && "This hardware profile is not resource-constrained");
-
-	std::map<std::string, unsigned>::iterator found = arrayPartitionToReadPorts.find(arrayPartitionName);
-	std::map<std::string, unsigned>::iterator found2 = arrayPartitionToReadPortsInUse.find(arrayPartitionName);
-	assert(found != arrayPartitionToReadPorts.end() && "Array has no storage allocated for it");
-	assert(found2 != arrayPartitionToReadPortsInUse.end() && "Array has no storage allocated for it");
+	assert(partitionID < partitionReadPorts.size() && "Array has no storage allocated for it");
 
 	// All ports are being used, not able to allocate right now
-	if(found2->second >= found->second)
+	if(partitionReadPortsInUse[partitionID] >= partitionReadPorts[partitionID])
 		return false;
 
 	// Allocate a port
 	if(commit)
-		(found2->second)++;
+		partitionReadPortsInUse[partitionID]++;
 
 	return true;
 }
 
-bool HardwareProfile::storeTryAllocate(std::string arrayPartitionName, bool commit) {
+bool HardwareProfile::storeTryAllocate(unsigned partitionID, bool commit) {
 	assert(isConstrained && "This hardware profile is not resource-constrained");
+	assert(partitionID < partitionWritePorts.size() && "Array has no storage allocated for it");
 
-	std::map<std::string, unsigned>::iterator found = arrayPartitionToWritePorts.find(arrayPartitionName);
-	std::map<std::string, unsigned>::iterator found2 = arrayPartitionToWritePortsInUse.find(arrayPartitionName);
-	assert(found != arrayPartitionToWritePorts.end() && "Array has no storage allocated for it");
-	assert(found2 != arrayPartitionToWritePortsInUse.end() && "Array has no storage allocated for it");
+	unsigned &ports = partitionWritePorts[partitionID];
+	unsigned &portsInUse = partitionWritePortsInUse[partitionID];
 
 	// All ports are being used
-	if(found2->second >= found->second) {
+	if(portsInUse >= ports) {
 		// If RW ports are enabled, attempt to allocate a new port
-		if(args.fRWRWMem && found->second < arrayGetMaximumWritePortsPerPartition()) {
+		if(args.fRWRWMem && ports < arrayGetMaximumWritePortsPerPartition()) {
 			if(commit) {
-				(found->second)++;
-				(found2->second)++;
+				ports++;
+				portsInUse++;
 			}
 
 			return true;
@@ -406,7 +413,7 @@ bool HardwareProfile::storeTryAllocate(std::string arrayPartitionName, bool comm
 
 	// Allocate a port
 	if(commit)
-		(found2->second)++;
+		portsInUse++;
 
 	return true;
 }
@@ -488,14 +495,10 @@ void HardwareProfile::pipelinedRelease() {
 		fDivInUse = 0;
 
 	// Release memory ports if load/store are pipelined
-	if(isPipelined(LLVM_IR_Load)) {
-		for(auto &it : arrayPartitionToReadPortsInUse)
-			it.second = 0;
-	}
-	if(isPipelined(LLVM_IR_Store)) {
-		for(auto &it : arrayPartitionToWritePortsInUse)
-			it.second = 0;
-	}
+	if(isPipelined(LLVM_IR_Load))
+		std::fill(partitionReadPortsInUse.begin(), partitionReadPortsInUse.end(), 0);
+	if(isPipelined(LLVM_IR_Store))
+		std::fill(partitionWritePortsInUse.begin(), partitionWritePortsInUse.end(), 0);
 
 #ifdef CONSTRAIN_INT_OP
 	for(auto &it : constrainedIntOps) {
@@ -533,18 +536,16 @@ void HardwareProfile::fCmpRelease() {
 	//assert(false && "fCmp is not constrained");
 }
 
-void HardwareProfile::loadRelease(std::string arrayPartitionName) {
-	std::map<std::string, unsigned>::iterator found = arrayPartitionToReadPortsInUse.find(arrayPartitionName);
-	assert(found != arrayPartitionToReadPortsInUse.end() && "No array/partition found with the provided name");
-	assert(found->second && "Attempt to release read port when none is allocated for this array/partition");
-	(found->second)--;
+void HardwareProfile::loadRelease(unsigned partitionID) {
+	assert(partitionID < partitionReadPortsInUse.size() && "No array/partition found with the provided ID");
+	assert(partitionReadPortsInUse[partitionID] && "Attempt to release read port when none is allocated for this array/partition");
+	partitionReadPortsInUse[partitionID]--;
 }
 
-void HardwareProfile::storeRelease(std::string arrayPartitionName) {
-	std::map<std::string, unsigned>::iterator found = arrayPartitionToWritePortsInUse.find(arrayPartitionName);
-	assert(found != arrayPartitionToWritePortsInUse.end() && "No array/partition found with the provided name");
-	assert(found->second && "Attempt to release write port when none is allocated for this array/partition");
-	(found->second)--;
+void HardwareProfile::storeRelease(unsigned partitionID) {
+	assert(partitionID < partitionWritePortsInUse.size() && "No array/partition found with the provided ID");
+	assert(partitionWritePortsInUse[partitionID] && "Attempt to release write port when none is allocated for this array/partition");
+	partitionWritePortsInUse[partitionID]--;
 }
 
 void HardwareProfile::intOpRelease(int opcode) {
@@ -1024,8 +1025,7 @@ void XilinxHardwareProfile::setMemoryCurrentUsage(
 				usedBRAM18k += numOfBRAM18k;
 				arrayNameToUsedBRAM18k.insert(std::make_pair(arrayName, numOfBRAM18k));
 				arrayNameToEfficiency.insert(std::make_pair(arrayName, efficiency));
-				arrayPartitionToReadPorts.insert(std::make_pair(arrayName, PER_PARTITION_PORTS_R));
-				arrayPartitionToWritePorts.insert(std::make_pair(arrayName, PER_PARTITION_PORTS_W));
+				addPartition(arrayName, PER_PARTITION_PORTS_R, PER_PARTITION_PORTS_W);
 			}
 			// Complete partition
 			else {
@@ -1036,12 +1036,8 @@ void XilinxHardwareProfile::setMemoryCurrentUsage(
 				arrayNameToUsedBRAM18k.insert(std::make_pair(arrayName + GLOBAL_SEPARATOR "register", 0));
 				arrayNameToEfficiency.insert(std::make_pair(arrayName + GLOBAL_SEPARATOR "register", 0));
 #endif
-				arrayPartitionToReadPorts.insert(std::make_pair(arrayName, INFINITE_RESOURCES));
-				arrayPartitionToWritePorts.insert(std::make_pair(arrayName, INFINITE_RESOURCES));
+				addPartition(arrayName, INFINITE_RESOURCES, INFINITE_RESOURCES);
 			}
-
-			arrayPartitionToReadPortsInUse.insert(std::make_pair(arrayName, 0));
-			arrayPartitionToWritePortsInUse.insert(std::make_pair(arrayName, 0));
 		}
 
 		assert(usedBRAM18k <= maxBRAM18k && "Current BRAM18k exceeds the available amount of selected board even with partitioning disabled");
@@ -1049,9 +1045,6 @@ void XilinxHardwareProfile::setMemoryCurrentUsage(
 	}
 	// BRAM18k setting with partitioning fits in current device
 	else {
-		arrayPartitionToReadPorts.clear();
-		arrayPartitionToWritePorts.clear();
-
 		for(auto &it : arrayNameToConfig) {
 			std::string arrayName = it.first;
 			uint64_t numOfPartitions = std::get<0>(it.second);
@@ -1064,25 +1057,16 @@ void XilinxHardwareProfile::setMemoryCurrentUsage(
 #else
 					std::string partitionName = arrayName + GLOBAL_SEPARATOR + std::to_string(i);
 #endif
-					arrayPartitionToReadPorts.insert(std::make_pair(partitionName, PER_PARTITION_PORTS_R));
-					arrayPartitionToWritePorts.insert(std::make_pair(partitionName, PER_PARTITION_PORTS_W));
-					arrayPartitionToReadPortsInUse.insert(std::make_pair(partitionName, 0));
-					arrayPartitionToWritePortsInUse.insert(std::make_pair(partitionName, 0));
+					addPartition(partitionName, PER_PARTITION_PORTS_R, PER_PARTITION_PORTS_W);
 				}
 			}
 			// No partitioning
 			else if(numOfPartitions) {
-				arrayPartitionToReadPorts.insert(std::make_pair(arrayName, PER_PARTITION_PORTS_R));
-				arrayPartitionToWritePorts.insert(std::make_pair(arrayName, PER_PARTITION_PORTS_W));
-				arrayPartitionToReadPortsInUse.insert(std::make_pair(arrayName, 0));
-				arrayPartitionToWritePortsInUse.insert(std::make_pair(arrayName, 0));
+				addPartition(arrayName, PER_PARTITION_PORTS_R, PER_PARTITION_PORTS_W);
 			}
 			// Complete partitioning
 			else {
-				arrayPartitionToReadPorts.insert(std::make_pair(arrayName, INFINITE_RESOURCES));
-				arrayPartitionToWritePorts.insert(std::make_pair(arrayName, INFINITE_RESOURCES));
-				arrayPartitionToReadPortsInUse.insert(std::make_pair(arrayName, 0));
-				arrayPartitionToWritePortsInUse.insert(std::make_pair(arrayName, 0));
+				addPartition(arrayName, INFINITE_RESOURCES, INFINITE_RESOURCES);
 			}
 		}
 
@@ -1114,8 +1098,8 @@ void XilinxHardwareProfile::fillPack(Pack &P, unsigned loopLevel, unsigned datap
 	HardwareProfile::fillPack(P, loopLevel, datapathType, targetII);
 
 	for(auto &it : arrayGetUsedBRAM18k()) {
-		P.addDescriptor("Used BRAM18k for array \"" + demangleArrayName(it.first) + "\"", Pack::MERGE_EQUAL, Pack::TYPE_UNSIGNED);
-		P.addElement<uint64_t>("Used BRAM18k for array \"" + demangleArrayName(it.first) + "\"", it.second);
+		unsigned fieldID = P.addDescriptor("Used BRAM18k for array \"" + demangleArrayName(it.first) + "\"", Pack::MERGE_EQUAL, Pack::TYPE_UNSIGNED);
+		P.addElement<uint64_t>(fieldID, it.second);
 	}
 
 	/* Change FU count if pipeline is active */
@@ -1167,8 +1151,8 @@ void XilinxHardwareProfile::fillPack(Pack &P, unsigned loopLevel, unsigned datap
 		std::string descriptor = "_unshared" GLOBAL_SEPARATOR + reverseOpcodeMap.at(it);
 #endif
 
-		P.addDescriptor(descriptor, Pack::MERGE_RESOURCETREEMAX, Pack::TYPE_RESOURCENET);
-		P.addElement<Pack::resourceNodeTy>(descriptor, Pack::resourceNodeTy(
+		unsigned fieldID = P.addDescriptor(descriptor, Pack::MERGE_RESOURCETREEMAX, Pack::TYPE_RESOURCENET);
+		P.addElement<Pack::resourceNodeTy>(fieldID, Pack::resourceNodeTy(
 			loopLevel, datapathType,
 			finalIntOpCount,
 			finalIntOpCount * intOpResources[it].dsp,
@@ -0,0 +1,176 @@
+#include "profile_h/LoopTripCounts.h"
+
+#include <assert.h>
+#include <fstream>
+#include <sstream>
+
+#include "profile_h/auxiliary.h"
+
+using namespace llvm;
+
+bool LoopTripCounts::load(std::string fileName) {
+	std::ifstream file(fileName);
+	if(!file.is_open())
+		return false;
+
+	loops.clear();
+
+	std::string line;
+	while(std::getline(file, line)) {
+		if(!line.size() || '#' == line[0])
+			continue;
+
+		std::vector<std::string> fields;
+		std::stringstream ss(line);
+		std::string field;
+		while(std::getline(ss, field, ','))
+			fields.push_back(field);
+		if(5 == fields.size())
+			fields.push_back("");
+
+		if(fields.size() != 6) {
+			loops.clear();
+			return false;
+		}
+
+		loopTy loop;
+		loop.headerExecutions = std::stoull(fields[1]);
+		loop.entries = std::stoull(fields[2]);
+		loop.min = std::stoull(fields[3]);
+		loop.max = std::stoull(fields[4]);
+
+		std::stringstream ss2(fields[5]);
+		std::string bin;
+		while(std::getline(ss2, bin, ';')) {
+			size_t sepPos = bin.find(":");
+			if(std::string::npos == sepPos) {
+				loops.clear();
+				return false;
+			}
+
+			loop.histogram[std::stoull(bin.substr(0, sepPos))] = std::stoull(bin.substr(sepPos + 1));
+		}
+
+		loops[fields[0]] = loop;
+	}
+
+	return true;
+}
+
+void LoopTripCounts::save(std::string fileName) {
+	std::ofstream file(fileName);
+	assert(file.is_open() && "Could not open loop trip counts output file");
+
+	file << "# WHOLELOOPNAME,HEADER EXECUTIONS,ENTRIES,MIN,MAX,HISTOGRAM (TRIPCOUNT:ENTRIES;...)\n";
+	for(auto &it : loops) {
+		file << it.first << "," << std::to_string(it.second.headerExecutions) << "," << std::to_string(it.second.entries);
+		file << "," << std::to_string(it.second.min) << "," << std::to_string(it.second.max) << ",";
+
+		bool first = true;
+		for(auto &it2 : it.second.histogram) {
+			file << (first? "" : ";") << std::to_string(it2.first) << ":" << std::to_string(it2.second);
+			first = false;
+		}
+		file << "\n";
+	}
+
+	file.close();
+}
+
+LoopTripCounter::LoopTripCounter(
+	const std::map<std::pair<std::string, std::string>, std::string> &headerBBs,
+	const std::map<std::pair<std::string, std::string>, std::string> &headerLastInsts,
+	const std::map<std::pair<std::string, std::string>, std::pair<std::string, unsigned>> &bbLoops
+) : bbLoops(bbLoops) {
+	// Same headers as the runtime loop bound calculation (see DDDGBuilder::getTraceLineFromTo())
+	for(auto &it : headerBBs) {
+		std::string loopName = it.first.first;
+		unsigned loopLevel = std::stoul(it.first.second);
+		std::string funcName = std::get<0>(parseLoopName(loopName));
+
+		std::map<std::pair<std::string, std::string>, std::string>::const_iterator found = headerLastInsts.find(std::make_pair(it.second, funcName));
+		if(headerLastInsts.end() == found)
+			continue;
+		if(!(lastInst2Slot.insert(std::make_pair(found->second, slots.size())).second))
+			continue;
+
+		slotTy slot;
+		slot.wholeLoopName = appendDepthToLoopName(loopName, loopLevel);
+		slot.loopID = getLoopID(loopName);
+		slot.loopLevel = loopLevel;
+		slot.currentTrips = 0;
+		slot.counts.headerExecutions = 0;
+		slot.counts.entries = 0;
+		slot.counts.min = 0;
+		slot.counts.max = 0;
+		slots.push_back(slot);
+	}
+}
+
+int LoopTripCounter::getLoopID(std::string loopName) {
+	return loopName2ID.insert(std::make_pair(loopName, loopName2ID.size())).first->second;
+}
+
+const LoopTripCounter::siteTy &LoopTripCounter::getSite(const char *funcName, const char *bbName, const char *instName) {
+	std::unordered_map<const char *, siteTy>::iterator found = pointer2Site.find(instName);
+	if(found != pointer2Site.end())
+		return found->second;
+
+	siteTy site;
+	site.funcID = funcName2ID.insert(std::make_pair(std::string(funcName), funcName2ID.size())).first->second;
+	if(site.funcID >= lastBranch.size())
+		lastBranch.resize(site.funcID + 1, nullptr);
+
+	std::map<std::pair<std::string, std::string>, std::pair<std::string, unsigned>>::const_iterator found2 = bbLoops.find(std::make_pair(std::string(bbName), std::string(funcName)));
+	site.loopID = (found2 != bbLoops.end())? getLoopID(found2->second.first) : -1;
+	site.loopLevel = (found2 != bbLoops.end())? found2->second.second : 0;
+
+	std::unordered_map<std::string, int>::iterator found3 = lastInst2Slot.find(instName);
+	site.headerSlot = (found3 != lastInst2Slot.end())? found3->second : -1;
+
+	// Elements of unordered_map are not moved on rehash, thus references to sites are stable
+	return pointer2Site.insert(std::make_pair(instName, site)).first->second;
+}
+
+void LoopTripCounter::closeEntry(slotTy &slot) {
+	if(!(slot.currentTrips))
+		return;
+
+	if(!(slot.counts.entries) || slot.currentTrips < slot.counts.min)
+		slot.counts.min = slot.currentTrips;
+	if(slot.currentTrips > slot.counts.max)
+		slot.counts.max = slot.currentTrips;
+	slot.counts.entries++;
+	slot.counts.histogram[slot.currentTrips]++;
+	slot.currentTrips = 0;
+}
+
+void LoopTripCounter::hitBranch(const char *funcName, const char *bbName, const char *instName) {
+	const siteTy &site = getSite(funcName, bbName, instName);
+
+	if(site.headerSlot != -1) {
+		slotTy &slot = slots[site.headerSlot];
+
+		// A header is never the entry BB of a function, thus some branch of the same function executed before it. If this
+		// branch was inside the loop (including nested levels), this is a back edge. Otherwise the loop is entered again
+		const siteTy *prev = lastBranch[site.funcID];
+		if(!prev || prev->loopID != slot.loopID || prev->loopLevel < slot.loopLevel)
+			closeEntry(slot);
+
+		slot.currentTrips++;
+		slot.counts.headerExecutions++;
+	}
+
+	lastBranch[site.funcID] = &site;
+}
+
+void LoopTripCounter::close(std::string fileName) {
+	LoopTripCounts tripCounts;
+
+	for(auto &it : slots) {
+		closeEntry(it);
+		tripCounts.addLoop(it.wholeLoopName, it.counts);
+	}
+
+	tripCounts.save(fileName);
+}
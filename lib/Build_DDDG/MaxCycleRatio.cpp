@@ -0,0 +1,204 @@
+#include "profile_h/MaxCycleRatio.h"
+
+#include <algorithm>
+#include <math.h>
+
+// Howard's algorithm converges in few iterations in practice. This is only a safeguard
+static const unsigned MAX_ITERATIONS = 10000;
+static const double EPSILON = 1e-9;
+
+void MaxCycleRatio::addEdge(unsigned source, unsigned target, uint64_t weight, uint64_t distance) {
+	edgeTy edge;
+	edge.source = source;
+	edge.target = target;
+	edge.weight = weight;
+	edge.distance = distance;
+
+	edges.push_back(edge);
+}
+
+int MaxCycleRatio::solve(uint64_t &weight, uint64_t &distance) {
+	std::vector<std::vector<unsigned>> outEdges(numOfNodes), inEdges(numOfNodes);
+	for(unsigned i = 0; i < edges.size(); i++) {
+		outEdges[edges[i].source].push_back(i);
+		inEdges[edges[i].target].push_back(i);
+	}
+
+	// Cycles formed only by edges with no distance have no ratio (topological sort of these edges)
+	std::vector<unsigned> inDegree(numOfNodes, 0);
+	for(auto &it : edges) {
+		if(!(it.distance))
+			inDegree[it.target]++;
+	}
+	std::vector<unsigned> ready;
+	for(unsigned i = 0; i < numOfNodes; i++) {
+		if(!(inDegree[i]))
+			ready.push_back(i);
+	}
+	unsigned numOfSorted = 0;
+	while(!(ready.empty())) {
+		unsigned node = ready.back();
+		ready.pop_back();
+		numOfSorted++;
+
+		for(auto &it : outEdges[node]) {
+			if(!(edges[it].distance) && !(--inDegree[edges[it].target]))
+				ready.push_back(edges[it].target);
+		}
+	}
+	if(numOfSorted != numOfNodes)
+		return ZERO_DISTANCE_CYCLE;
+
+	// Nodes that cannot reach a cycle are removed, so that every remaining node has an out-edge
+	std::vector<bool> alive(numOfNodes, true);
+	std::vector<unsigned> outDegree(numOfNodes);
+	std::vector<unsigned> dead;
+	for(unsigned i = 0; i < numOfNodes; i++) {
+		outDegree[i] = outEdges[i].size();
+		if(!(outDegree[i]))
+			dead.push_back(i);
+	}
+	while(!(dead.empty())) {
+		unsigned node = dead.back();
+		dead.pop_back();
+		alive[node] = false;
+
+		for(auto &it : inEdges[node]) {
+			unsigned source = edges[it].source;
+			if(alive[source] && !(--outDegree[source]))
+				dead.push_back(source);
+		}
+	}
+
+	std::vector<unsigned> nodes;
+	for(unsigned i = 0; i < numOfNodes; i++) {
+		if(alive[i])
+			nodes.push_back(i);
+	}
+	if(nodes.empty())
+		return NO_CYCLE;
+
+	// Initial policy: heaviest out-edge of each node
+	std::vector<unsigned> policy(numOfNodes);
+	for(auto &node : nodes) {
+		bool found = false;
+		for(auto &it : outEdges[node]) {
+			if(!(alive[edges[it].target]))
+				continue;
+
+			if(!found || edges[it].weight > edges[policy[node]].weight) {
+				policy[node] = it;
+				found = true;
+			}
+		}
+	}
+
+	std::vector<double> ratio(numOfNodes), value(numOfNodes);
+	std::vector<unsigned> stamp(numOfNodes);
+	std::vector<unsigned> path;
+	uint64_t bestWeight = 0, bestDistance = 1;
+
+	for(unsigned iteration = 0; iteration < MAX_ITERATIONS; iteration++) {
+		// Value determination: each walk follows the policy until it reaches a node of a previous walk or closes a new cycle
+		double bestRatio = -1;
+		unsigned currStamp = 0;
+		std::fill(stamp.begin(), stamp.end(), 0);
+
+		for(auto &start : nodes) {
+			if(stamp[start])
+				continue;
+
+			currStamp++;
+			path.clear();
+			unsigned node = start;
+			while(!(stamp[node])) {
+				stamp[node] = currStamp;
+				path.push_back(node);
+				node = edges[policy[node]].target;
+			}
+
+			// New cycle: node is its handle, with value 0
+			bool newCycle = (stamp[node] == currStamp);
+			if(newCycle) {
+				uint64_t cycleWeight = 0, cycleDistance = 0;
+				unsigned cycleNode = node;
+				do {
+					cycleWeight += edges[policy[cycleNode]].weight;
+					cycleDistance += edges[policy[cycleNode]].distance;
+					cycleNode = edges[policy[cycleNode]].target;
+				} while(cycleNode != node);
+
+				ratio[node] = ((double) cycleWeight) / cycleDistance;
+				value[node] = 0;
+
+				if(ratio[node] > bestRatio) {
+					bestRatio = ratio[node];
+					bestWeight = cycleWeight;
+					bestDistance = cycleDistance;
+				}
+			}
+
+			// Successors are always evaluated before their predecessors
+			for(size_t i = path.size(); i--;) {
+				if(newCycle && path[i] == node)
+					continue;
+
+				const edgeTy &edge = edges[policy[path[i]]];
+				ratio[path[i]] = ratio[edge.target];
+				value[path[i]] = edge.weight - ratio[path[i]] * edge.distance + value[edge.target];
+			}
+		}
+
+		// Policy improvement, first by ratio
+		bool changed = false;
+		for(auto &node : nodes) {
+			double bestNodeRatio = ratio[node];
+			unsigned bestEdge = policy[node];
+
+			for(auto &it : outEdges[node]) {
+				unsigned target = edges[it].target;
+				if(alive[target] && ratio[target] > bestNodeRatio + EPSILON) {
+					bestNodeRatio = ratio[target];
+					bestEdge = it;
+				}
+			}
+
+			if(bestEdge != policy[node]) {
+				policy[node] = bestEdge;
+				changed = true;
+			}
+		}
+
+		// Then by value, among edges reaching the same ratio
+		if(!changed) {
+			for(auto &node : nodes) {
+				double bestNodeValue = value[node];
+				unsigned bestEdge = policy[node];
+
+				for(auto &it : outEdges[node]) {
+					unsigned target = edges[it].target;
+					if(!(alive[target]) || fabs(ratio[target] - ratio[node]) > EPSILON)
+						continue;
+
+					double newValue = edges[it].weight - ratio[node] * edges[it].distance + value[target];
+					if(newValue > bestNodeValue + EPSILON) {
+						bestNodeValue = newValue;
+						bestEdge = it;
+					}
+				}
+
+				if(bestEdge != policy[node]) {
+					policy[node] = bestEdge;
+					changed = true;
+				}
+			}
+		}
+
+		if(!changed)
+			break;
+	}
+
+	weight = bestWeight;
+	distance = bestDistance;
+	return CYCLE_FOUND;
+}
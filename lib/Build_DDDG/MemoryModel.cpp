@@ -5,9 +5,22 @@
 extern memoryTraceMapTy memoryTraceMap;
 extern bool memoryTraceGenerated;
 
-std::unordered_map<std::string, std::vector<ddrInfoTy>> globalDDRMap;
-std::unordered_map<std::string, std::vector<globalOutBurstsInfoTy>> globalOutBurstsInfo;
-std::unordered_map<arrayPackSzPairTy, std::vector<packInfoTy>, boost::hash<arrayPackSzPairTy>> globalPackInfo;
+// Find the addresses of an instruction in the memory trace, either mapped from "mem_trace_short.bin" or in memoryTraceMap
+static bool findInMemoryTrace(const std::string &wholeLoopName, const std::string &instName, MappedMemoryTrace::addressSpanTy &span) {
+	if(mappedMemoryTrace.isOpen())
+		return mappedMemoryTrace.find(wholeLoopName, instName, span);
+
+	memoryTraceMapTy::iterator found = memoryTraceMap.find(std::make_pair(wholeLoopName, instName));
+	if(memoryTraceMap.end() == found)
+		return false;
+
+	span = MappedMemoryTrace::addressSpanTy(found->second.data(), found->second.size());
+	return true;
+}
+
+thread_local std::unordered_map<std::string, std::vector<ddrInfoTy>> globalDDRMap;
+thread_local std::unordered_map<std::string, std::vector<globalOutBurstsInfoTy>> globalOutBurstsInfo;
+thread_local std::unordered_map<arrayPackSzPairTy, std::vector<packInfoTy>, boost::hash<arrayPackSzPairTy>> globalPackInfo;
 std::unordered_map<std::string, std::pair<unsigned, unsigned>> globalPackSizes;
 
 // Static attributes
@@ -20,17 +33,17 @@ const std::string Reporter::warnReasonMap[] = {
 	"cannot align read with pack size",
 	"misaligned read (left and/or right) comprises more than one element"
 };
-std::ofstream Reporter::rptFile;
-std::string Reporter::loopName;
+thread_local std::ofstream Reporter::rptFile;
+thread_local std::string Reporter::loopName;
 
 void Reporter::open(std::string loopName) {
 	Reporter::loopName = loopName;
-	rptFile.open(loopName + FILE_MEM_ANALYSIS_RPT_SUFFIX, std::ios::trunc);
+	rptFile.open(args.outWorkDir + loopName + FILE_MEM_ANALYSIS_RPT_SUFFIX, std::ios::trunc);
 }
 
 void Reporter::reopen(unsigned loopLevel, unsigned datapathType, ParsedTraceContainer *PC, std::vector<int> *microops) {
 	setCurrent(loopLevel, datapathType, PC, microops);
-	rptFile.open(loopName + FILE_MEM_ANALYSIS_RPT_SUFFIX, std::ios::app);
+	rptFile.open(args.outWorkDir + loopName + FILE_MEM_ANALYSIS_RPT_SUFFIX, std::ios::app);
 }
 
 bool Reporter::isOpen() {
@@ -172,9 +185,9 @@ void Reporter::footer() {
 }
 
 // Static attributes
-bool MemoryModel::shouldRpt = false;
-Reporter MemoryModel::reporter;
-std::string MemoryModel::preprocessedLoopName = "";
+thread_local bool MemoryModel::shouldRpt = false;
+thread_local Reporter MemoryModel::reporter;
+thread_local std::string MemoryModel::preprocessedLoopName = "";
 
 MemoryModel::MemoryModel(BaseDatapath *datapath) :
 	datapath(datapath), microops(datapath->getMicroops()), graph(datapath->getDDDG()),
@@ -215,6 +228,13 @@ bool MemoryModel::preprocess(std::string loopName) {
 	return false;
 }
 
+void MemoryModel::reset() {
+	preprocessedLoopName = "";
+	shouldRpt = false;
+	if(reporter.isOpen())
+		reporter.close();
+}
+
 bool MemoryModel::canOutBurstsOverlap(std::vector<MemoryModel::nodeExportTy> toBefore, std::vector<MemoryModel::nodeExportTy> toAfter) {
 	// We follow here the policies as documented in tryAllocate()
 	for(auto &after : toAfter) {
@@ -284,11 +304,88 @@ void MemoryModel::finishReport() {
 
 void MemoryModel::analyseAndTransform() { }
 
+// Make sure that a segment starts at this address
+std::map<uint64_t, unsigned>::iterator MemoryModel::activeTransactionsTy::splitCoverage(uint64_t address) {
+	std::map<uint64_t, unsigned>::iterator it = coverage.lower_bound(address);
+	if(it != coverage.end() && address == it->first)
+		return it;
+
+	unsigned count = (coverage.begin() == it)? 0 : std::prev(it)->second;
+	return coverage.insert(it, std::make_pair(address, count));
+}
+
+// Remove a segment that has the same count as the previous one
+void MemoryModel::activeTransactionsTy::mergeCoverage(std::map<uint64_t, unsigned>::iterator it) {
+	unsigned prevCount = (coverage.begin() == it)? 0 : std::prev(it)->second;
+	if(prevCount == it->second)
+		coverage.erase(it);
+}
+
+void MemoryModel::activeTransactionsTy::updateCoverage(uint64_t base, uint64_t end, bool increment) {
+	assert(end < std::numeric_limits<uint64_t>::max() && "DDR transaction reaches the end of the address space");
+
+	std::map<uint64_t, unsigned>::iterator first = splitCoverage(base);
+	std::map<uint64_t, unsigned>::iterator last = splitCoverage(end + 1);
+
+	for(std::map<uint64_t, unsigned>::iterator it = first; it != last; it++) {
+		if(increment)
+			(it->second)++;
+		else
+			(it->second)--;
+	}
+
+	// Segments inside the range are still different from each other, only the range borders may merge
+	mergeCoverage(last);
+	mergeCoverage(first);
+}
+
+void MemoryModel::activeTransactionsTy::insert(unsigned rootID, uint64_t base, uint64_t end, bool bursted) {
+	if(!(ranges.insert(std::make_pair(rootID, std::make_tuple(base, end, bursted))).second))
+		return;
+
+	if(bursted)
+		burstedCount++;
+	updateCoverage(base, end, true);
+}
+
+void MemoryModel::activeTransactionsTy::erase(unsigned rootID) {
+	std::unordered_map<unsigned, std::tuple<uint64_t, uint64_t, bool>>::iterator found = ranges.find(rootID);
+	if(ranges.end() == found)
+		return;
+
+	if(std::get<2>(found->second))
+		burstedCount--;
+	updateCoverage(std::get<0>(found->second), std::get<1>(found->second), false);
+
+	ranges.erase(found);
+}
+
+bool MemoryModel::activeTransactionsTy::overlaps(uint64_t base, uint64_t end) {
+	// Segment where the range starts. If not covered, the next segment is (if there is any)
+	std::map<uint64_t, unsigned>::iterator it = coverage.upper_bound(base);
+	bool overlapping = (it != coverage.begin() && std::prev(it)->second) || (it != coverage.end() && it->first <= end);
+
+#ifdef CHECK_ACTIVE_TRANSACTIONS
+	bool scanOverlapping = false;
+	unsigned scanBurstedCount = 0;
+	for(auto &it2 : ranges) {
+		if(std::get<1>(it2.second) >= base && end >= std::get<0>(it2.second))
+			scanOverlapping = true;
+		if(std::get<2>(it2.second))
+			scanBurstedCount++;
+	}
+	assert(scanOverlapping == overlapping && "Coverage map and active transactions disagree on overlap");
+	assert(scanBurstedCount == burstedCount && "Bursted transaction counter and active transactions disagree");
+#endif
+
+	return overlapping;
+}
+
 // Static attributes
-std::vector<ddrInfoTy> XilinxZCUMemoryModel::filteredDDRMap;
-std::unordered_map<std::string, std::vector<globalOutBurstsInfoTy>>::iterator XilinxZCUMemoryModel::filteredOutBurstsInfo;
-bool XilinxZCUMemoryModel::ddrBanking = false;
-std::unordered_map<std::string, unsigned> XilinxZCUMemoryModel::packSizes;
+thread_local std::vector<ddrInfoTy> XilinxZCUMemoryModel::filteredDDRMap;
+thread_local std::unordered_map<std::string, std::vector<globalOutBurstsInfoTy>>::iterator XilinxZCUMemoryModel::filteredOutBurstsInfo;
+thread_local bool XilinxZCUMemoryModel::ddrBanking = false;
+thread_local std::unordered_map<std::string, unsigned> XilinxZCUMemoryModel::packSizes;
 
 void XilinxZCUMemoryModel::preprocess(std::string loopName, ConfigurationManager &CM) {
 	// Run parent preprocess. It will return false if preprocess was already executed for this loop nest
@@ -774,7 +871,7 @@ bool XilinxZCUMemoryModel::analyseStoreOutBurstFeasability(unsigned burstID, std
 std::unordered_map<std::string, outBurstInfoTy> XilinxZCUMemoryModel::findOutBursts(
 	std::unordered_map<unsigned, burstInfoTy> &burstedNodes,
 	std::unordered_map<unsigned, std::pair<std::string, uint64_t>> &foundNodes,
-	const std::vector<std::string> &instIDList,
+	const std::vector<uint32_t> &instIDList,
 	bool (XilinxZCUMemoryModel::*analyseOutBurstFeasability)(unsigned, std::string)
 ) {
 	std::unordered_map<std::string, outBurstInfoTy> canOutBurst;
@@ -853,15 +950,14 @@ std::unordered_map<std::string, outBurstInfoTy> XilinxZCUMemoryModel::findOutBur
 				// maybe not even here!
 				std::string loopName = datapath->getTargetLoopName();
 				unsigned numLevels = LpName2numLevelMap.at(loopName);
-				memoryTraceMapTy::iterator found2;
+				MappedMemoryTrace::addressSpanTy addresses;
+				bool found2 = false;
 				for(unsigned i = datapath->getTargetLoopLevel(); i <= numLevels; i++) {
-					std::pair<std::string, std::string> wholeLoopNameInstNamePair = std::make_pair(appendDepthToLoopName(loopName, i), instIDList[it2]);
-					found2 = memoryTraceMap.find(wholeLoopNameInstNamePair);
-					if(found2 != memoryTraceMap.end())
+					found2 = findInMemoryTrace(appendDepthToLoopName(loopName, i), symbolTable.getName(instIDList[it2]), addresses);
+					if(found2)
 						break;
 				}
-				assert(found2 != memoryTraceMap.end() && "Could not find the respective loop level of the instruction in memory trace map");
-				std::vector<uint64_t> addresses = found2->second;
+				assert(found2 && "Could not find the respective loop level of the instruction in memory trace map");
 				//std::vector<uint64_t> addresses = memoryTraceMap.at(wholeLoopNameInstNamePair);
 #ifdef VAR_WSIZE
 				uint64_t nextAddress = addresses[0] + wordSize * (offset / adjustFactor);
@@ -1029,64 +1125,54 @@ XilinxZCUMemoryModel::XilinxZCUMemoryModel(BaseDatapath *datapath) : MemoryModel
 	lastWriteAllocated = -1;
 }
 
-void XilinxZCUMemoryModel::analyseAndTransform() {
-	// This will normally execute at setUp(), but if mma mode is OFF or GEN, it will not.
-	// So we execute it here. If setUp() already ran it, this execution will be ignored
-	preprocess(datapath->getTargetLoopName(), CM);
-
-	if(shouldRpt) {
-		if(reporter.isOpen())
-			reporter.close();
-		reporter.reopen(datapath->getTargetLoopLevel(), datapath->getDatapathType(), &PC, &microops);
-		reporter.currentHeader();
-	}
-
-	std::unordered_map<std::string, outBurstInfoTy> loadOutBurstsFound;
-	std::unordered_map<std::string, outBurstInfoTy> storeOutBurstsFound;
-
+void XilinxZCUMemoryModel::loadMemoryTrace() {
 	// The memory trace map can be generated in two ways:
 	// - Running Lina with "--mem-trace" and any other mode than "--mode=estimation"
 	// - After running Lina once with the aforementioned configuration, the file "mem_trace.txt" will be available and can be used
 
-	// If memory trace map was not constructed yet, try to generate it from "mem_trace.txt"
 	if(!memoryTraceGenerated) {
 		if(args.shortMemTrace) {
 			std::string traceShortFileName = args.workDir + FILE_MEM_TRACE_SHORT;
-			std::ifstream traceShortFile;
-			std::string bufferedWholeLoopName = "";
 
-			traceShortFile.open(traceShortFileName, std::ios::binary);
-			assert(traceShortFile.is_open() && "No short memory trace found. Please run Lina with \"--short-mem-trace\" or \"--mem-trace\" (short mem trace is recommended) flag (leave it enabled) and any mode other than \"--mode=estimation\" (only once is needed) to generate it; or deactivate inter-iteration burst analysis with \"--fno-mmaburst\"");
+			// The short memory trace is mapped and lookups are performed directly in the file. Files from older versions
+			// (version 1, see MemoryTrace.h) are loaded into memoryTraceMap
+			if(!(mappedMemoryTrace.open(traceShortFileName))) {
+				std::ifstream traceShortFile;
+				std::string bufferedWholeLoopName = "";
 
-			while(!(traceShortFile.eof())) {
-				size_t bufferSz;
-				char buffer[BUFF_STR_SZ];
-				std::vector<uint64_t> addrVec;
-				size_t addrVecSize;
+				traceShortFile.open(traceShortFileName, std::ios::binary);
+				assert(traceShortFile.is_open() && "No short memory trace found. Please run Lina with \"--short-mem-trace\" or \"--mem-trace\" (short mem trace is recommended) flag (leave it enabled) and any mode other than \"--mode=estimation\" (only once is needed) to generate it; or deactivate inter-iteration burst analysis with \"--fno-mmaburst\"");
 
-				if(!(traceShortFile.read((char *) &bufferSz, sizeof(size_t))))
-					break;
-				assert(bufferSz < BUFF_STR_SZ && "String buffer not big enough to allocate key read from memory trace binary file. Please change BUFF_STR_SZ");
-				traceShortFile.read(buffer, bufferSz);
-				buffer[bufferSz] = '\0';
-				bufferedWholeLoopName.assign(buffer);
+				while(!(traceShortFile.eof())) {
+					size_t bufferSz;
+					char buffer[BUFF_STR_SZ];
+					std::vector<uint64_t> addrVec;
+					size_t addrVecSize;
 
-				if(!(traceShortFile.read((char *) &bufferSz, sizeof(size_t))))
-					break;
-				assert(bufferSz < BUFF_STR_SZ && "String buffer not big enough to allocate key read from memory trace binary file. Please change BUFF_STR_SZ");
-				traceShortFile.read(buffer, bufferSz);
-				buffer[bufferSz] = '\0';
+					if(!(traceShortFile.read((char *) &bufferSz, sizeof(size_t))))
+						break;
+					assert(bufferSz < BUFF_STR_SZ && "String buffer not big enough to allocate key read from memory trace binary file. Please change BUFF_STR_SZ");
+					traceShortFile.read(buffer, bufferSz);
+					buffer[bufferSz] = '\0';
+					bufferedWholeLoopName.assign(buffer);
 
-				traceShortFile.read((char *) &addrVecSize, sizeof(size_t));
-				addrVec.resize(addrVecSize);
+					if(!(traceShortFile.read((char *) &bufferSz, sizeof(size_t))))
+						break;
+					assert(bufferSz < BUFF_STR_SZ && "String buffer not big enough to allocate key read from memory trace binary file. Please change BUFF_STR_SZ");
+					traceShortFile.read(buffer, bufferSz);
+					buffer[bufferSz] = '\0';
 
-				std::pair<std::string, std::string> wholeLoopNameInstNamePair = std::make_pair(std::string(bufferedWholeLoopName), std::string(buffer));
-				// XXX THIS DOES NOT SEEM TO BE A GOOD IDEA (but works...)
-				traceShortFile.read((char *) addrVec.data(), addrVecSize * sizeof(uint64_t));
-				memoryTraceMap.insert(std::make_pair(wholeLoopNameInstNamePair, addrVec));
-			}
+					traceShortFile.read((char *) &addrVecSize, sizeof(size_t));
+					addrVec.resize(addrVecSize);
+
+					std::pair<std::string, std::string> wholeLoopNameInstNamePair = std::make_pair(std::string(bufferedWholeLoopName), std::string(buffer));
+					// XXX THIS DOES NOT SEEM TO BE A GOOD IDEA (but works...)
+					traceShortFile.read((char *) addrVec.data(), addrVecSize * sizeof(uint64_t));
+					memoryTraceMap.insert(std::make_pair(wholeLoopNameInstNamePair, addrVec));
+				}
 
-			traceShortFile.close();
+				traceShortFile.close();
+			}
 		}
 		else {
 			std::string line;
@@ -1114,6 +1200,25 @@ void XilinxZCUMemoryModel::analyseAndTransform() {
 
 		memoryTraceGenerated = true;
 	}
+}
+
+void XilinxZCUMemoryModel::analyseAndTransform() {
+	// This will normally execute at setUp(), but if mma mode is OFF or GEN, it will not.
+	// So we execute it here. If setUp() already ran it, this execution will be ignored
+	preprocess(datapath->getTargetLoopName(), CM);
+
+	if(shouldRpt) {
+		if(reporter.isOpen())
+			reporter.close();
+		reporter.reopen(datapath->getTargetLoopLevel(), datapath->getDatapathType(), &PC, &microops);
+		reporter.currentHeader();
+	}
+
+	std::unordered_map<std::string, outBurstInfoTy> loadOutBurstsFound;
+	std::unordered_map<std::string, outBurstInfoTy> storeOutBurstsFound;
+
+	// If memory trace map was not constructed yet, try to generate it from "mem_trace.txt"
+	loadMemoryTrace();
 
 	const ConfigurationManager::arrayInfoCfgMapTy arrayInfoCfgMap = CM.getArrayInfoCfgMap();
 
@@ -1189,7 +1294,7 @@ void XilinxZCUMemoryModel::analyseAndTransform() {
 
 	assert((!args.fBurstMix || ddrBanking) && "Currently burst mix is not supported when iteration burst analysis is active");
 
-	const std::vector<std::string> &instIDList = PC.getInstIDList();
+	const std::vector<uint32_t> &instIDList = PC.getInstIDList();
 
 	// If mode is not USE, we run findOutBursts() normally
 	if(args.mmaMode != ArgPack::MMA_MODE_USE) {
@@ -1589,6 +1694,9 @@ void XilinxZCUMemoryModel::analyseAndTransform() {
 	loadNodes.insert(genFromImpLoadNodes.begin(), genFromImpLoadNodes.end());
 	storeNodes.insert(genFromImpStoreNodes.begin(), genFromImpStoreNodes.end());
 
+	for(auto &it : burstedLoads)
+		burstedLoadsByLastLoad[it.second.participants.back()].push_back(it.first);
+
 	datapath->refreshDDDG();
 
 	// Create a dummy last node and connect the DDDG leaves and the imported nodes to it,
@@ -1633,7 +1741,7 @@ bool XilinxZCUMemoryModel::tryAllocate(unsigned node, int opcode, bool commit) {
 
 	if(LLVM_IR_DDRReadReq == opcode || LLVM_IR_DDRSilentReadReq == opcode) {
 		unsigned nodeToRootLS = ddrNodesToRootLS.at(node);
-		burstInfoTy readInfo = burstedLoads.at(nodeToRootLS);
+		const burstInfoTy &readInfo = burstedLoads.at(nodeToRootLS);
 		// If no DDR banking, we deactivate filtering by array (i.e. "")
 		std::string readArrayName = ddrBanking? loadNodes[nodeToRootLS].first : "";
 		uint64_t readBase = readInfo.baseAddress;
@@ -1644,8 +1752,8 @@ bool XilinxZCUMemoryModel::tryAllocate(unsigned node, int opcode, bool commit) {
 		uint64_t readEnd = readBase + readInfo.offset * 4;
 #endif
 
-		std::set<unsigned> &curActiveReads = activeReads[readArrayName];
-		std::set<unsigned> &curActiveWrites = activeWrites[readArrayName];
+		activeTransactionsTy &curActiveReads = activeReads[readArrayName];
+		activeTransactionsTy &curActiveWrites = activeWrites[readArrayName];
 		bool &curReadActive = readActive[readArrayName];
 		bool &curWriteActive = writeActive[readArrayName];
 
@@ -1657,33 +1765,10 @@ bool XilinxZCUMemoryModel::tryAllocate(unsigned node, int opcode, bool commit) {
 			// XXX: readActive and writeActive already handle this
 
 			// - If there are active reads, they must be unbursted;
-			bool allActiveReadsAreUnbursted = true;
-			if(curReadActive) {
-				for(auto &it : curActiveReads) {
-					if(burstedLoads.at(it).offset) {
-						allActiveReadsAreUnbursted = false;
-						break;
-					}
-				}
-			}
+			bool allActiveReadsAreUnbursted = !curReadActive || !(curActiveReads.hasBursted());
 
 			// - If there are active writes, they must be for different regions
-			bool activeWritesDoNotOverlap = true;
-			if(curWriteActive) {
-				for(auto &it : curActiveWrites) {
-					burstInfoTy otherInfo = burstedStores.at(it);
-					uint64_t otherBase = otherInfo.baseAddress;
-#ifdef VAR_WSIZE
-					uint64_t otherEnd = otherBase + otherInfo.offset * otherInfo.wordSize;
-#else
-					// XXX: As always, assuming 32-bit
-					uint64_t otherEnd = otherBase + otherInfo.offset * 4;
-#endif
-
-					if(otherEnd >= readBase && readEnd >= otherBase)
-						activeWritesDoNotOverlap = false;
-				}
-			}
+			bool activeWritesDoNotOverlap = !curWriteActive || !(curActiveWrites.overlaps(readBase, readEnd));
 
 			finalCond = (!curReadActive && !curWriteActive) || (allActiveReadsAreUnbursted && activeWritesDoNotOverlap);
 		}
@@ -1694,40 +1779,10 @@ bool XilinxZCUMemoryModel::tryAllocate(unsigned node, int opcode, bool commit) {
 			// XXX: readActive and writeActive already handle this
 
 			// - If there are active reads, they must be for different regions
-			bool activeReadsDoNotOverlap = true;
-			if(curReadActive) {
-				for(auto &it : curActiveReads) {
-					burstInfoTy otherInfo = burstedLoads.at(it);
-					uint64_t otherBase = otherInfo.baseAddress;
-#ifdef VAR_WSIZE
-					uint64_t otherEnd = otherBase + otherInfo.offset * otherInfo.wordSize;
-#else
-					// XXX: As always, assuming 32-bit
-					uint64_t otherEnd = otherBase + otherInfo.offset * 4;
-#endif
-
-					if(otherEnd >= readBase && readEnd >= otherBase)
-						activeReadsDoNotOverlap = false;
-				}
-			}
+			bool activeReadsDoNotOverlap = !curReadActive || !(curActiveReads.overlaps(readBase, readEnd));
 
 			// - If there are active writes, they must be for different regions
-			bool activeWritesDoNotOverlap = true;
-			if(curWriteActive) {
-				for(auto &it : curActiveWrites) {
-					burstInfoTy otherInfo = burstedStores.at(it);
-					uint64_t otherBase = otherInfo.baseAddress;
-#ifdef VAR_WSIZE
-					uint64_t otherEnd = otherBase + otherInfo.offset * otherInfo.wordSize;
-#else
-					// XXX: As always, assuming 32-bit
-					uint64_t otherEnd = otherBase + otherInfo.offset * 4;
-#endif
-
-					if(otherEnd >= readBase && readEnd >= otherBase)
-						activeWritesDoNotOverlap = false;
-				}
-			}
+			bool activeWritesDoNotOverlap = !curWriteActive || !(curActiveWrites.overlaps(readBase, readEnd));
 
 			finalCond = (!curReadActive && !curWriteActive) || (activeReadsDoNotOverlap && activeWritesDoNotOverlap);
 		}
@@ -1737,7 +1792,7 @@ bool XilinxZCUMemoryModel::tryAllocate(unsigned node, int opcode, bool commit) {
 
 		if(finalCond) {
 			if(commit) {
-				activeReads[readArrayName].insert(nodeToRootLS);
+				curActiveReads.insert(nodeToRootLS, readBase, readEnd, 0 != readInfo.offset);
 				readActive[readArrayName] = true;
 			}
 		}
@@ -1757,12 +1812,14 @@ bool XilinxZCUMemoryModel::tryAllocate(unsigned node, int opcode, bool commit) {
 				reporter.warnReadAfterWrite(loadNodes.at(node).first, node, storeNodes.at(lastWriteAllocated).first, lastWriteAllocated);
 
 			// If this is the last load, we must close this burst
-			for(auto &it : burstedLoads) {
-				if(it.second.participants.back() == node)
-					activeReads[readArrayName].erase(it.first);
+			activeTransactionsTy &curActiveReads = activeReads[readArrayName];
+			std::unordered_map<unsigned, std::vector<unsigned>>::iterator found = burstedLoadsByLastLoad.find(node);
+			if(found != burstedLoadsByLastLoad.end()) {
+				for(auto &it : found->second)
+					curActiveReads.erase(it);
 			}
 
-			if(!(activeReads[readArrayName].size()))
+			if(curActiveReads.empty())
 				readActive[readArrayName] = false;
 		}
 
@@ -1770,7 +1827,7 @@ bool XilinxZCUMemoryModel::tryAllocate(unsigned node, int opcode, bool commit) {
 	}
 	else if(LLVM_IR_DDRWriteReq == opcode || LLVM_IR_DDRSilentWriteReq == opcode) {
 		unsigned nodeToRootLS = ddrNodesToRootLS.at(node);
-		burstInfoTy writeInfo = burstedStores.at(nodeToRootLS);
+		const burstInfoTy &writeInfo = burstedStores.at(nodeToRootLS);
 		// If no DDR banking, we deactivate filtering by array (i.e. "")
 		std::string writeArrayName = ddrBanking? storeNodes.at(nodeToRootLS).first : "";
 		uint64_t writeBase = writeInfo.baseAddress;
@@ -1781,8 +1838,8 @@ bool XilinxZCUMemoryModel::tryAllocate(unsigned node, int opcode, bool commit) {
 		uint64_t writeEnd = writeBase + writeInfo.offset * 4;
 #endif
 
-		std::set<unsigned> &curActiveReads = activeReads[writeArrayName];
-		std::set<unsigned> &curActiveWrites = activeWrites[writeArrayName];
+		activeTransactionsTy &curActiveReads = activeReads[writeArrayName];
+		activeTransactionsTy &curActiveWrites = activeWrites[writeArrayName];
 		bool &curReadActive = readActive[writeArrayName];
 		bool &curWriteActive = writeActive[writeArrayName];
 
@@ -1800,47 +1857,17 @@ bool XilinxZCUMemoryModel::tryAllocate(unsigned node, int opcode, bool commit) {
 			// XXX: readActive and writeActive already handle this
 
 			// - If there are active reads, they must be for different regions
-			bool activeReadsDoNotOverlap = true;
-			if(curReadActive) {
-				for(auto &it : curActiveReads) {
-					burstInfoTy otherInfo = burstedLoads.at(it);
-					uint64_t otherBase = otherInfo.baseAddress;
-#ifdef VAR_WSIZE
-					uint64_t otherEnd = otherBase + otherInfo.offset * otherInfo.wordSize;
-#else
-					// XXX: As always, assuming 32-bit
-					uint64_t otherEnd = otherBase + otherInfo.offset * 4;
-#endif
-
-					if(otherEnd >= writeBase && writeEnd >= otherBase)
-						activeReadsDoNotOverlap = false;
-				}
-			}
+			bool activeReadsDoNotOverlap = !curReadActive || !(curActiveReads.overlaps(writeBase, writeEnd));
 
 			// - If there are active writes, they must be for different regions
-			bool activeWritesDoNotOverlap = true;
-			if(curWriteActive) {
-				for(auto &it : curActiveWrites) {
-					burstInfoTy otherInfo = burstedStores.at(it);
-					uint64_t otherBase = otherInfo.baseAddress;
-#ifdef VAR_WSIZE
-					uint64_t otherEnd = otherBase + otherInfo.offset * otherInfo.wordSize;
-#else
-					// XXX: As always, assuming 32-bit
-					uint64_t otherEnd = otherBase + otherInfo.offset * 4;
-#endif
-
-					if(otherEnd >= writeBase && writeEnd >= otherBase)
-						activeWritesDoNotOverlap = false;
-				}
-			}
+			bool activeWritesDoNotOverlap = !curWriteActive || !(curActiveWrites.overlaps(writeBase, writeEnd));
 
 			finalCond = (!curReadActive && !curWriteActive) || (activeReadsDoNotOverlap && activeWritesDoNotOverlap);
 		}
 
 		if(finalCond) {
 			if(commit) {
-				activeWrites[writeArrayName].insert(nodeToRootLS);
+				curActiveWrites.insert(nodeToRootLS, writeBase, writeEnd, 0 != writeInfo.offset);
 				writeActive[writeArrayName] = true;
 			}
 		}
@@ -1855,7 +1882,7 @@ bool XilinxZCUMemoryModel::tryAllocate(unsigned node, int opcode, bool commit) {
 	}
 	else if(LLVM_IR_DDRWriteResp == opcode || LLVM_IR_DDRSilentWriteResp == opcode) {
 		unsigned nodeToRootLS = ddrNodesToRootLS.at(node);
-		burstInfoTy writeInfo = burstedStores.at(nodeToRootLS);
+		const burstInfoTy &writeInfo = burstedStores.at(nodeToRootLS);
 		// If no DDR banking, we deactivate filtering by array (i.e. "")
 		std::string writeArrayName = ddrBanking? storeNodes.at(nodeToRootLS).first : "";
 		uint64_t writeBase = writeInfo.baseAddress;
@@ -1866,7 +1893,7 @@ bool XilinxZCUMemoryModel::tryAllocate(unsigned node, int opcode, bool commit) {
 		uint64_t writeEnd = writeBase + writeInfo.offset * 4;
 #endif
 
-		std::set<unsigned> &curActiveReads = activeReads[writeArrayName];
+		activeTransactionsTy &curActiveReads = activeReads[writeArrayName];
 		bool &curReadActive = readActive[writeArrayName];
 
 		bool finalCond;
@@ -1877,22 +1904,7 @@ bool XilinxZCUMemoryModel::tryAllocate(unsigned node, int opcode, bool commit) {
 			// XXX: readActive already handles this
 
 			// - If there are active reads, they must be for different regions
-			bool activeReadsDoNotOverlap = true;
-			if(curReadActive) {
-				for(auto &it : curActiveReads) {
-					burstInfoTy otherInfo = burstedLoads.at(it);
-					uint64_t otherBase = otherInfo.baseAddress;
-#ifdef VAR_WSIZE
-					uint64_t otherEnd = otherBase + otherInfo.offset * otherInfo.wordSize;
-#else
-					// XXX: As always, assuming 32-bit
-					uint64_t otherEnd = otherBase + otherInfo.offset * 4;
-#endif
-
-					if(otherEnd >= writeBase && writeEnd >= otherBase)
-						activeReadsDoNotOverlap = false;
-				}
-			}
+			bool activeReadsDoNotOverlap = !curReadActive || !(curActiveReads.overlaps(writeBase, writeEnd));
 
 			finalCond = !curReadActive || activeReadsDoNotOverlap;
 		}
@@ -1914,9 +1926,10 @@ void XilinxZCUMemoryModel::release(unsigned node, int opcode) {
 		unsigned nodeToRootLS = ddrNodesToRootLS.at(node);
 		// If no DDR banking, we deactivate filtering by array (i.e. "")
 		std::string writeArrayName = ddrBanking? storeNodes.at(nodeToRootLS).first : "";
-		activeWrites[writeArrayName].erase(nodeToRootLS);
+		activeTransactionsTy &curActiveWrites = activeWrites[writeArrayName];
+		curActiveWrites.erase(nodeToRootLS);
 
-		if(!(activeWrites[writeArrayName].size()))
+		if(curActiveWrites.empty())
 			writeActive[writeArrayName] = false;
 	}
 }
@@ -2242,6 +2255,14 @@ void XilinxZCUMemoryModel::printDatabase() {
 		for(auto const &y : x.second)
 			errs() << "---- " << y << "\n";
 	}
+	for(uint64_t i = 0; i < mappedMemoryTrace.getNumKeys(); i++) {
+		std::string wholeLoopName, instName;
+		MappedMemoryTrace::addressSpanTy addresses;
+		mappedMemoryTrace.getKey(i, wholeLoopName, instName, addresses);
+		errs() << "-- <" << wholeLoopName << ", " << instName << ">\n";
+		for(auto const &y : addresses)
+			errs() << "---- " << y << "\n";
+	}
 	errs() << "-----------------\n";
 }
 #endif
@@ -0,0 +1,157 @@
+#include "profile_h/MemoryTrace.h"
+
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+MappedMemoryTrace mappedMemoryTrace;
+
+void MappedMemoryTrace::write(FILE *file, const memoryTraceMapTy &memoryTraceMap) {
+	headerTy header;
+	memset(&header, 0, sizeof(headerTy));
+	memcpy(header.magic, MEMORY_TRACE_MAGIC_STRING, 3);
+	header.version = MEMORY_TRACE_VERSION;
+	header.numKeys = memoryTraceMap.size();
+	header.stringsOffset = sizeof(headerTy) + header.numKeys * sizeof(keyTy);
+
+	// memoryTraceMap is ordered by (whole loop name, instruction name), thus the directory is already sorted
+	std::string stringPool;
+	std::vector<keyTy> keys;
+	for(auto &it : memoryTraceMap) {
+		keyTy key;
+		key.loopNameOffset = stringPool.size();
+		key.loopNameLength = it.first.first.size();
+		stringPool.append(it.first.first);
+		key.instNameOffset = stringPool.size();
+		key.instNameLength = it.first.second.size();
+		stringPool.append(it.first.second);
+		key.numAddresses = it.second.size();
+		keys.push_back(key);
+	}
+	assert(stringPool.size() <= 0xFFFFFFFF && "String pool of short memory trace is too large");
+	header.stringsSize = stringPool.size();
+
+	uint64_t addressesOffset = header.stringsOffset + header.stringsSize;
+	uint64_t padding = (sizeof(uint64_t) - (addressesOffset % sizeof(uint64_t))) % sizeof(uint64_t);
+	addressesOffset += padding;
+	for(auto &it : keys) {
+		it.addressesOffset = addressesOffset;
+		addressesOffset += it.numAddresses * sizeof(uint64_t);
+	}
+
+	fwrite(&header, sizeof(headerTy), 1, file);
+	if(keys.size())
+		fwrite(keys.data(), sizeof(keyTy), keys.size(), file);
+	fwrite(stringPool.data(), sizeof(char), stringPool.size(), file);
+	uint64_t zero = 0;
+	fwrite(&zero, 1, padding, file);
+	for(auto &it : memoryTraceMap) {
+		if(it.second.size())
+			fwrite(it.second.data(), sizeof(uint64_t), it.second.size(), file);
+	}
+}
+
+bool MappedMemoryTrace::open(std::string fileName) {
+	close();
+
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	if(-1 == fd)
+		return false;
+
+	struct stat fileStat;
+	if(fstat(fd, &fileStat) || (size_t) fileStat.st_size < sizeof(headerTy)) {
+		::close(fd);
+		return false;
+	}
+
+	// Check header before mapping, version 1 files have no header
+	headerTy header;
+	if(read(fd, &header, sizeof(headerTy)) != sizeof(headerTy) || memcmp(header.magic, MEMORY_TRACE_MAGIC_STRING, 3) || header.version != MEMORY_TRACE_VERSION) {
+		::close(fd);
+		return false;
+	}
+
+	size_t fileSize = fileStat.st_size;
+	void *addr = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+	// The mapping stays valid after the file descriptor is closed
+	::close(fd);
+	if(MAP_FAILED == addr)
+		return false;
+
+	mapping = (const char *) addr;
+	mappingSize = fileSize;
+	numKeys = header.numKeys;
+	keys = (const keyTy *) (mapping + sizeof(headerTy));
+	strings = mapping + header.stringsOffset;
+
+	// Sanity check of all offsets, so that lookups never read outside the mapping
+	bool valid = (numKeys <= (fileSize - sizeof(headerTy)) / sizeof(keyTy)) &&
+		(header.stringsOffset == sizeof(headerTy) + numKeys * sizeof(keyTy)) &&
+		(header.stringsSize <= fileSize - header.stringsOffset);
+	for(uint64_t i = 0; valid && i < numKeys; i++) {
+		const keyTy &key = keys[i];
+		valid = ((uint64_t) key.loopNameOffset + key.loopNameLength <= header.stringsSize) &&
+			((uint64_t) key.instNameOffset + key.instNameLength <= header.stringsSize) &&
+			!(key.addressesOffset % sizeof(uint64_t)) && (key.addressesOffset <= fileSize) &&
+			(key.numAddresses <= (fileSize - key.addressesOffset) / sizeof(uint64_t));
+	}
+	assert(valid && "Short memory trace is corrupt");
+
+	madvise(addr, fileSize, MADV_RANDOM);
+
+	return true;
+}
+
+void MappedMemoryTrace::close() {
+	if(mapping)
+		munmap((void *) mapping, mappingSize);
+
+	mapping = nullptr;
+	mappingSize = 0;
+	keys = nullptr;
+	numKeys = 0;
+	strings = nullptr;
+}
+
+int MappedMemoryTrace::compare(const keyTy &key, const std::string &wholeLoopName, const std::string &instName) const {
+	int result = wholeLoopName.compare(0, std::string::npos, strings + key.loopNameOffset, key.loopNameLength);
+	if(!result)
+		result = instName.compare(0, std::string::npos, strings + key.instNameOffset, key.instNameLength);
+
+	// Positive if key is greater than (wholeLoopName, instName)
+	return -result;
+}
+
+bool MappedMemoryTrace::find(const std::string &wholeLoopName, const std::string &instName, addressSpanTy &span) const {
+	uint64_t low = 0, high = numKeys;
+
+	while(low < high) {
+		uint64_t mid = low + (high - low) / 2;
+		int result = compare(keys[mid], wholeLoopName, instName);
+
+		if(!result) {
+			span = addressSpanTy((const uint64_t *) (mapping + keys[mid].addressesOffset), keys[mid].numAddresses);
+			return true;
+		}
+		else if(result < 0) {
+			low = mid + 1;
+		}
+		else {
+			high = mid;
+		}
+	}
+
+	return false;
+}
+
+void MappedMemoryTrace::getKey(uint64_t i, std::string &wholeLoopName, std::string &instName, addressSpanTy &span) const {
+	assert(i < numKeys && "Key index out of bounds in short memory trace");
+
+	const keyTy &key = keys[i];
+	wholeLoopName.assign(strings + key.loopNameOffset, key.loopNameLength);
+	instName.assign(strings + key.instNameOffset, key.instNameLength);
+	span = addressSpanTy((const uint64_t *) (mapping + key.addressesOffset), key.numAddresses);
+}
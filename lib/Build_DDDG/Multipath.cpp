@@ -1,5 +1,31 @@
 #include "profile_h/Multipath.h"
 
+#include "profile_h/DynamicDatapath.h"
+
+#include <future>
+#include <sstream>
+#include <thread>
+
+void TraceAnalysisState::save() {
+	savedArgs = args;
+	loopBounds = wholeloopName2loopBoundMap;
+	levelUnrollVec = loopName2levelUnrollVecMap;
+#ifdef PROGRESSIVE_TRACE_CURSOR
+	cursor = progressiveTraceCursor;
+	instCount = progressiveTraceInstCount;
+#endif
+}
+
+void TraceAnalysisState::restore() const {
+	args = savedArgs;
+	wholeloopName2loopBoundMap = loopBounds;
+	loopName2levelUnrollVecMap = levelUnrollVec;
+#ifdef PROGRESSIVE_TRACE_CURSOR
+	progressiveTraceCursor = cursor;
+	progressiveTraceInstCount = instCount;
+#endif
+}
+
 void Multipath::_Multipath() {
 	VERBOSE_PRINT(errs() << "[][][][multipath] Analysing DDDG for loop \"" << loopName << "\"\n");
 
@@ -239,10 +265,11 @@ void Multipath::_Multipath() {
 	DBG_DUMP("Top level loop additional cycles: " << extraEnter << " " << extraExit << "\n");
 	numCycles += extraEnterExit;
 
-	for(auto &it : P.getStructure()) {
-		std::string name = std::get<0>(it);
-		unsigned mergeType = std::get<1>(it);
-		unsigned type = std::get<2>(it);
+	const std::vector<Pack::descriptorTy> &structure = P.getStructure();
+	for(unsigned fieldID = 0; fieldID < structure.size(); fieldID++) {
+		const std::string &name = std::get<0>(structure[fieldID]);
+		unsigned mergeType = std::get<1>(structure[fieldID]);
+		unsigned type = std::get<2>(structure[fieldID]);
 
 		// Names starting with "_" are not printed (used for other purposes)
 		if('_' == name[0])
@@ -250,34 +277,34 @@ void Multipath::_Multipath() {
 
 		if(Pack::MERGE_EQUAL == mergeType) {
 			if(Pack::TYPE_UNSIGNED == type) {
-				assert("true" == P.mergeElements<uint64_t>(name) && "Merged values from datapaths differ where it should not differ");
-				VERBOSE_PRINT(errs() << "\t" << name << ": " << std::to_string(P.getElements<uint64_t>(name)[0]) << "\n");
+				assert("true" == P.mergeElements<uint64_t>(fieldID) && "Merged values from datapaths differ where it should not differ");
+				VERBOSE_PRINT(errs() << "\t" << name << ": " << std::to_string(P.getElements<uint64_t>(fieldID)[0]) << "\n");
 			}
 			else if(Pack::TYPE_SIGNED == type) {
-				assert("true" == P.mergeElements<int64_t>(name) && "Merged values from datapaths differ where it should not differ");
-				VERBOSE_PRINT(errs() << "\t" << name << ": " << std::to_string(P.getElements<int64_t>(name)[0]) << "\n");
+				assert("true" == P.mergeElements<int64_t>(fieldID) && "Merged values from datapaths differ where it should not differ");
+				VERBOSE_PRINT(errs() << "\t" << name << ": " << std::to_string(P.getElements<int64_t>(fieldID)[0]) << "\n");
 			}
 			else if(Pack::TYPE_FLOAT == type) {
-				assert("true" == P.mergeElements<float>(name) && "Merged values from datapaths differ where it should not differ");
-				VERBOSE_PRINT(errs() << "\t" << name << ": " << std::to_string(P.getElements<float>(name)[0]) << "\n");
+				assert("true" == P.mergeElements<float>(fieldID) && "Merged values from datapaths differ where it should not differ");
+				VERBOSE_PRINT(errs() << "\t" << name << ": " << std::to_string(P.getElements<float>(fieldID)[0]) << "\n");
 			}
 			else if(Pack::TYPE_STRING == type) {
-				assert("true" == P.mergeElements<std::string>(name) && "Merged values from datapaths differ where it should not differ");
-				VERBOSE_PRINT(errs() << "\t" << name << ": " << P.getElements<std::string>(name)[0] << "\n");
+				assert("true" == P.mergeElements<std::string>(fieldID) && "Merged values from datapaths differ where it should not differ");
+				VERBOSE_PRINT(errs() << "\t" << name << ": " << P.getElements<std::string>(fieldID)[0] << "\n");
 			}
 		}
 		else {
 			if(Pack::TYPE_UNSIGNED == type) {
-				VERBOSE_PRINT(errs() << "\t" << name << ": " << P.mergeElements<uint64_t>(name) << "\n");
+				VERBOSE_PRINT(errs() << "\t" << name << ": " << P.mergeElements<uint64_t>(fieldID) << "\n");
 			}
 			else if(Pack::TYPE_SIGNED == type) {
-				VERBOSE_PRINT(errs() << "\t" << name << ": " << P.mergeElements<int64_t>(name) << "\n");
+				VERBOSE_PRINT(errs() << "\t" << name << ": " << P.mergeElements<int64_t>(fieldID) << "\n");
 			}
 			else if(Pack::TYPE_FLOAT == type) {
-				VERBOSE_PRINT(errs() << "\t" << name << ": " << P.mergeElements<float>(name) << "\n");
+				VERBOSE_PRINT(errs() << "\t" << name << ": " << P.mergeElements<float>(fieldID) << "\n");
 			}
 			else if(Pack::TYPE_STRING == type) {
-				std::string mergeResult = P.mergeElements<std::string>(name);
+				std::string mergeResult = P.mergeElements<std::string>(fieldID);
 				VERBOSE_PRINT(errs() << "\t" << name << ": " << (("" == mergeResult)? "none" : mergeResult) << "\n");
 			}
 		}
@@ -299,7 +326,7 @@ void Multipath::recursiveLookup(unsigned currLoopLevel, unsigned finalLoopLevel)
 	if(currLoopLevel >= finalLoopLevel) {
 		VERBOSE_PRINT(errs() << "[][][][multipath][" << std::to_string(finalLoopLevel) << "] Generating normal DDDG for this loop chain\n");
 
-		if(enablePipelining) {
+		if(enablePipelining && args.fRecIIUnroll) {
 			VERBOSE_PRINT(errs() << "[][][][multipath][" << std::to_string(finalLoopLevel) << "] Building dynamic datapath for recurrence-constrained II calculation\n");
 
 			DynamicDatapath DD(kernelName, CM, CtxM, summaryFile, loopName, finalLoopLevel, actualLoopUnrollFactor);
@@ -375,40 +402,42 @@ void Multipath::recursiveLookup(unsigned currLoopLevel, unsigned finalLoopLevel)
 			}
 
 			unsigned ddRCIL = 0;
-			// XXX: If was commented since for now calculateBefore is always true (uncommenting the if will cause some scope errors that i did not solve)
-			//if(calculateBefore) {
-				VERBOSE_PRINT(errs() << "[][][][multipath][" << std::to_string(currLoopLevel) << "] Building dynamic datapath for the region before the nested loop\n");
-				DynamicDatapath DD(kernelName, CM, CtxM, summaryFile, loopName, currLoopLevel, targetUnrollFactor, nodesToBeforeDDDG, DatapathType::NON_PERFECT_BEFORE);
-				latencies.push_back(std::make_tuple(currLoopLevel, DatapathType::NON_PERFECT_BEFORE, DD.getRCIL(), 0));
-				P.merge(DD.getPack());
-			//}
-			//else {
-			//	VERBOSE_PRINT(errs() << "[][][][multipath][" << std::to_string(currLoopLevel) << "] Region before the nested loop not tagged for exploration, skipping\n");
-			//	latencies.push_back(std::make_tuple(currLoopLevel, DatapathType::NON_PERFECT_BEFORE, 0, 0));
-			//}
-
 			unsigned dd2RCIL = 0;
-			// XXX: If was commented since for now calculateAfter is always true (uncommenting the if will cause some scope errors that i did not solve)
-			//if(calculateAfter) {
-				VERBOSE_PRINT(errs() << "[][][][multipath][" << std::to_string(currLoopLevel) << "] Building dynamic datapath for the region after the nested loop\n");
-				DynamicDatapath DD2(kernelName, CM, CtxM, summaryFile, loopName, currLoopLevel, targetUnrollFactor, nodesToAfterDDDG, DatapathType::NON_PERFECT_AFTER);
-				latencies.push_back(std::make_tuple(currLoopLevel, DatapathType::NON_PERFECT_AFTER, DD2.getRCIL(), 0));
-				P.merge(DD2.getPack());
-			//}
-			//else {
-			//	VERBOSE_PRINT(errs() << "[][][][multipath][" << std::to_string(currLoopLevel) << "] Region after the nested loop not tagged for exploration, skipping\n");
-			//	latencies.push_back(std::make_tuple(currLoopLevel, DatapathType::NON_PERFECT_AFTER, 0, 0));
-			//}
+			// XXX: calculateBefore and calculateAfter are always true for now, thus before and after DDDGs are always built
+			std::vector<unsigned> datapathTypes = {DatapathType::NON_PERFECT_BEFORE, DatapathType::NON_PERFECT_AFTER};
+			std::vector<std::vector<MemoryModel::nodeExportTy> *> datapathImports = {&nodesToBeforeDDDG, &nodesToAfterDDDG};
 
 			// Unroll detected. Since the code is statically replicated, we also calculate the inter-iteration scheduling to improve acurracy
-			if(targetUnrollFactor > 1) {
-				std::vector<MemoryModel::nodeExportTy> nodesToImport;
+			std::vector<MemoryModel::nodeExportTy> nodesToImport;
+			if(targetUnrollFactor > 1 && (ddRCIL || dd2RCIL)) {
 				nodesToImport.insert(nodesToImport.end(), nodesToBeforeDDDG.begin(), nodesToBeforeDDDG.end());
 				nodesToImport.insert(nodesToImport.end(), nodesToAfterDDDG.begin(), nodesToAfterDDDG.end());
 
-				if(ddRCIL || dd2RCIL) {
-					VERBOSE_PRINT(errs() << "[][][][multipath][" << std::to_string(currLoopLevel) << "] Building dynamic datapath for the region between the unrolled nested loops\n");
-					DynamicDatapath DD3(kernelName, CM, CtxM, summaryFile, loopName, currLoopLevel, targetUnrollFactor, nodesToImport, DatapathType::NON_PERFECT_BETWEEN);
+				datapathTypes.push_back(DatapathType::NON_PERFECT_BETWEEN);
+				datapathImports.push_back(&nodesToImport);
+			}
+
+			std::vector<DynamicDatapath *> datapaths(datapathTypes.size(), nullptr);
+			if(args.fParNPLA) {
+				buildNonPerfectDatapathsInParallel(currLoopLevel, targetUnrollFactor, datapathImports, datapathTypes, datapaths);
+			}
+			else {
+				for(unsigned i = 0; i < datapathTypes.size(); i++)
+					datapaths[i] = buildNonPerfectDatapath(currLoopLevel, targetUnrollFactor, *(datapathImports[i]), datapathTypes[i], summaryFile);
+			}
+
+			// Results are gathered in the same order regardless of how the datapaths were built
+			DynamicDatapath &DD = *(datapaths[0]);
+			latencies.push_back(std::make_tuple(currLoopLevel, DatapathType::NON_PERFECT_BEFORE, DD.getRCIL(), 0));
+			P.merge(DD.getPack());
+
+			DynamicDatapath &DD2 = *(datapaths[1]);
+			latencies.push_back(std::make_tuple(currLoopLevel, DatapathType::NON_PERFECT_AFTER, DD2.getRCIL(), 0));
+			P.merge(DD2.getPack());
+
+			if(targetUnrollFactor > 1) {
+				if(datapaths.size() > 2) {
+					DynamicDatapath &DD3 = *(datapaths[2]);
 					latencies.push_back(std::make_tuple(currLoopLevel, DatapathType::NON_PERFECT_BETWEEN, DD3.getRCIL(), 0));
 					P.merge(DD3.getPack());
 				}
@@ -424,6 +453,9 @@ void Multipath::recursiveLookup(unsigned currLoopLevel, unsigned finalLoopLevel)
 			bool canOutBurstsOverlap = MemoryModel::canOutBurstsOverlap(nodesToBeforeDDDG, nodesToAfterDDDG);
 			exportedNodes.insert(std::make_pair(currLoopLevel, std::make_tuple(nodesToBeforeDDDG, nodesToAfterDDDG, canOutBurstsOverlap)));
 
+			for(auto &it : datapaths)
+				delete it;
+
 			VERBOSE_PRINT(errs() << "[][][][multipath][" << std::to_string(currLoopLevel) << "] Finished\n");
 		}
 
@@ -431,6 +463,83 @@ void Multipath::recursiveLookup(unsigned currLoopLevel, unsigned finalLoopLevel)
 	}
 }
 
+DynamicDatapath *Multipath::buildNonPerfectDatapath(
+	unsigned currLoopLevel, unsigned targetUnrollFactor, std::vector<MemoryModel::nodeExportTy> &nodesToImport,
+	unsigned datapathType, std::ostream *summary, std::function<void()> *traceStateReady
+) {
+	switch(datapathType) {
+		case DatapathType::NON_PERFECT_BEFORE:
+			VERBOSE_PRINT(errs() << "[][][][multipath][" << std::to_string(currLoopLevel) << "] Building dynamic datapath for the region before the nested loop\n");
+			break;
+		case DatapathType::NON_PERFECT_AFTER:
+			VERBOSE_PRINT(errs() << "[][][][multipath][" << std::to_string(currLoopLevel) << "] Building dynamic datapath for the region after the nested loop\n");
+			break;
+		case DatapathType::NON_PERFECT_BETWEEN:
+			VERBOSE_PRINT(errs() << "[][][][multipath][" << std::to_string(currLoopLevel) << "] Building dynamic datapath for the region between the unrolled nested loops\n");
+			break;
+	}
+
+	return new DynamicDatapath(kernelName, CM, CtxM, summary, loopName, currLoopLevel, targetUnrollFactor, nodesToImport, datapathType, traceStateReady);
+}
+
+void Multipath::buildNonPerfectDatapathsInParallel(
+	unsigned currLoopLevel, unsigned targetUnrollFactor, std::vector<std::vector<MemoryModel::nodeExportTy> *> &nodesToImport,
+	std::vector<unsigned> &datapathTypes, std::vector<DynamicDatapath *> &datapaths
+) {
+	unsigned numDatapaths = datapathTypes.size();
+
+	VERBOSE_PRINT(errs() << "[][][][multipath][" << std::to_string(currLoopLevel) << "] Building " << std::to_string(numDatapaths) << " dynamic datapaths in parallel\n");
+
+	// Each datapath must start from the trace analysis state left by the previous one (i.e. the progressive trace cursor
+	// and runtime loop bounds found while searching for its region in the trace). This state is ready right after the
+	// search, so the next datapath starts while the previous is still being built and estimated
+	std::vector<std::promise<TraceAnalysisState>> readyStates(numDatapaths);
+	std::vector<std::future<TraceAnalysisState>> startStates;
+	for(unsigned i = 0; i + 1 < numDatapaths; i++)
+		startStates.push_back(readyStates[i].get_future());
+	TraceAnalysisState initialState;
+	initialState.save();
+	TraceAnalysisState finalState;
+
+	// Summaries are written to the summary file afterwards, in the same order as in a serial execution
+	std::vector<std::stringstream> summaries(numDatapaths);
+
+	std::vector<std::thread> threads;
+	for(unsigned i = 0; i < numDatapaths; i++) {
+		threads.push_back(std::thread([&, i]() {
+			if(i)
+				startStates[i - 1].get().restore();
+			else
+				initialState.restore();
+
+			bool stateSent = false;
+			std::function<void()> traceStateReady = [&]() {
+				if(!stateSent) {
+					TraceAnalysisState readyState;
+					readyState.save();
+					readyStates[i].set_value(readyState);
+					stateSent = true;
+				}
+			};
+
+			datapaths[i] = buildNonPerfectDatapath(currLoopLevel, targetUnrollFactor, *(nodesToImport[i]), datapathTypes[i], &(summaries[i]), &traceStateReady);
+
+			// Never leave the next datapath waiting
+			traceStateReady();
+			if(numDatapaths - 1 == i)
+				finalState.save();
+		}));
+	}
+	for(auto &it : threads)
+		it.join();
+
+	for(auto &it : summaries)
+		*summaryFile << it.str();
+
+	// Leave the calling thread as if the datapaths were built by it
+	finalState.restore();
+}
+
 Multipath::Multipath(
 	std::string kernelName, ConfigurationManager &CM, ContextManager &CtxM, std::ofstream *summaryFile,
 	std::string loopName, unsigned loopLevel, unsigned firstNonPerfectLoopLevel,
@@ -463,6 +572,10 @@ uint64_t Multipath::getCycles() const {
 	return numCycles;
 }
 
+const estimatedResourcesTy &Multipath::getEstimatedResources() const {
+	return estimatedResources;
+}
+
 void Multipath::dumpSummary(uint64_t numCycles) {
 	//*summaryFile << "=======================================================================\n";
 	//*summaryFile << "Non-perfect loop analysis results\n";
@@ -489,67 +602,62 @@ void Multipath::dumpSummary(uint64_t numCycles) {
 	/* XXX Resource estimation! */
 
 	// Finalise shared resources calculation
-	unsigned sharedFU = 0;
-	unsigned sharedDSP = 0;
-	unsigned sharedFF = 0;
-	unsigned sharedLUT = 0;
-#ifdef LEGACY_SEPARATOR
-	std::string value = P.mergeElements<Pack::resourceNodeTy>("_shared~fadd");
-#else
-	std::string value = P.mergeElements<Pack::resourceNodeTy>("_shared" GLOBAL_SEPARATOR "fadd");
-#endif
-	// Unpacking the values from the string. Each variable has 10 characters allocated
-	// I know this is ugly, please don't kill me...
-	sharedFU += stol(value.substr(0, 10));
-	sharedDSP += stol(value.substr(10, 10));
-	sharedFF += stol(value.substr(20, 10));
-	sharedLUT += stol(value.substr(30, 10));
 #ifdef LEGACY_SEPARATOR
-	value = P.mergeElements<Pack::resourceNodeTy>("_shared~fsub");
+	Pack::resourceNodeTy fAddResources = P.aggregateResources("_shared~fadd");
+	Pack::resourceNodeTy fSubResources = P.aggregateResources("_shared~fsub");
+	Pack::resourceNodeTy fMulResources = P.aggregateResources("_shared~fmul");
+	Pack::resourceNodeTy fDivResources = P.aggregateResources("_shared~fdiv");
 #else
-	std::string value = P.mergeElements<Pack::resourceNodeTy>("_shared" GLOBAL_SEPARATOR "fsub");
+	Pack::resourceNodeTy fAddResources = P.aggregateResources("_shared" GLOBAL_SEPARATOR "fadd");
+	Pack::resourceNodeTy fSubResources = P.aggregateResources("_shared" GLOBAL_SEPARATOR "fsub");
+	Pack::resourceNodeTy fMulResources = P.aggregateResources("_shared" GLOBAL_SEPARATOR "fmul");
+	Pack::resourceNodeTy fDivResources = P.aggregateResources("_shared" GLOBAL_SEPARATOR "fdiv");
 #endif
-	sharedFU += stol(value.substr(0, 10));
-	sharedDSP += stol(value.substr(10, 10));
-	sharedFF += stol(value.substr(20, 10));
-	sharedLUT += stol(value.substr(30, 10));
-#ifdef LEGACY_SEPARATOR
-	value = P.mergeElements<Pack::resourceNodeTy>("_shared~fmul");
-#else
-	std::string value = P.mergeElements<Pack::resourceNodeTy>("_shared" GLOBAL_SEPARATOR "fmul");
-#endif
-	sharedFU += stol(value.substr(0, 10));
-	sharedDSP += stol(value.substr(10, 10));
-	sharedFF += stol(value.substr(20, 10));
-	sharedLUT += stol(value.substr(30, 10));
-#ifdef LEGACY_SEPARATOR
-	value = P.mergeElements<Pack::resourceNodeTy>("_shared~fdiv");
-#else
-	std::string value = P.mergeElements<Pack::resourceNodeTy>("_shared" GLOBAL_SEPARATOR "fdiv");
-#endif
-	sharedFU += stol(value.substr(0, 10));
-	sharedDSP += stol(value.substr(10, 10));
-	sharedFF += stol(value.substr(20, 10));
-	sharedLUT += stol(value.substr(30, 10));
+	unsigned sharedFU = fAddResources.fus + fSubResources.fus + fMulResources.fus + fDivResources.fus;
+	unsigned sharedDSP = fAddResources.dsps + fSubResources.dsps + fMulResources.dsps + fDivResources.dsps;
+	unsigned sharedFF = fAddResources.ffs + fSubResources.ffs + fMulResources.ffs + fDivResources.ffs;
+	unsigned sharedLUT = fAddResources.luts + fSubResources.luts + fMulResources.luts + fDivResources.luts;
+
+	// One unit of each functional unit type in use, for the resource floor
+	unsigned floorFU = 0;
+	unsigned floorDSP = 0;
+	unsigned floorFF = 0;
+	unsigned floorLUT = 0;
+	for(const Pack::resourceNodeTy *it : {&fAddResources, &fSubResources, &fMulResources, &fDivResources}) {
+		if(it->fus) {
+			floorFU++;
+			floorDSP += it->dsps / it->fus;
+			floorFF += it->ffs / it->fus;
+			floorLUT += it->luts / it->fus;
+		}
+	}
 
 	// Finalise unshared resources calculation
 	unsigned unsharedFU = 0;
 	unsigned unsharedDSP = 0;
 	unsigned unsharedFF = 0;
 	unsigned unsharedLUT = 0;
-	for(auto &it : P.getStructure()) {
-		std::string name = std::get<0>(it);
+	const std::vector<Pack::descriptorTy> &structure = P.getStructure();
+	for(unsigned fieldID = 0; fieldID < structure.size(); fieldID++) {
+		const std::string &name = std::get<0>(structure[fieldID]);
 
 #ifdef LEGACY_SEPARATOR
 		if(!(name.compare(0, 10, "_unshared~"))) {
 #else
 		if(!(name.compare(0, 10, "_unshared" GLOBAL_SEPARATOR))) {
 #endif
-			value = P.mergeElements<Pack::resourceNodeTy>(name);
-			unsharedFU += stol(value.substr(0, 10));
-			unsharedDSP += stol(value.substr(10, 10));
-			unsharedFF += stol(value.substr(20, 10));
-			unsharedLUT += stol(value.substr(30, 10));
+			Pack::resourceNodeTy resources = P.aggregateResources(fieldID);
+			unsharedFU += resources.fus;
+			unsharedDSP += resources.dsps;
+			unsharedFF += resources.ffs;
+			unsharedLUT += resources.luts;
+
+			if(resources.fus) {
+				floorFU++;
+				floorDSP += resources.dsps / resources.fus;
+				floorFF += resources.ffs / resources.fus;
+				floorLUT += resources.luts / resources.fus;
+			}
 		}
 	}
 
@@ -568,18 +676,38 @@ void Multipath::dumpSummary(uint64_t numCycles) {
 	assert("true" == P.mergeElements<uint64_t>("_memlogicLUT") && "Merged values from datapaths differ where it should not differ (_memlogicLUT)");
 	unsigned mlLUT = P.getElements<uint64_t>("_memlogicLUT")[0];
 
-	uint64_t nStore = stol(P.mergeElements<uint64_t>("_nStore"));
-	uint64_t nLoad = stol(P.mergeElements<uint64_t>("_nLoad"));
+	uint64_t nStore = P.aggregate<uint64_t>("_nStore");
+	uint64_t nLoad = P.aggregate<uint64_t>("_nLoad");
 	uint64_t nOp = sharedFU + unsharedFU;
-	uint64_t tRcIL = stol(P.mergeElements<uint64_t>("_tRcIL"));
+	uint64_t tRcIL = P.aggregate<uint64_t>("_tRcIL");
 	unsigned lK = LpName2numLevelMap.at(loopName);
 	unsigned e = logNextPowerOf2(loopBound);
 	unsigned V1 = e + 1, V2 = 2 * e, V3 = e + 2;
 
-	for(auto &it : P.getStructure()) {
-		std::string name = std::get<0>(it);
-		unsigned mergeType = std::get<1>(it);
-		unsigned type = std::get<2>(it);
+	// Use all unrolls
+	loopName2levelUnrollVecMapTy::iterator found2 = loopName2levelUnrollVecMap.find(loopName);
+	assert(found2 != loopName2levelUnrollVecMap.end() && "Could not find loop in loopName2levelUnrollVecMap");
+	std::vector<unsigned> targetUnroll = found2->second;
+	uint64_t accUnrollFactor = 1;
+	for(unsigned i = loopLevel - 1; i + 1; i--)
+		accUnrollFactor *= targetUnroll.at(i);
+
+	unsigned rFF = 32 * (nLoad + nStore + nOp) + tRcIL + (1 == lK? 1 : 2) * V1 * lK;
+	unsigned mLUT = 32 * (nStore + nOp) + 14 * nLoad + V1 * lK;
+	unsigned exLUT = (V1 + V2 + V3) * lK + V1 * (accUnrollFactor - 1);
+
+	estimatedResources.dsp = sharedDSP + unsharedDSP;
+	estimatedResources.ff = sharedFF + unsharedFF + rFF + mlFF;
+	estimatedResources.lut = sharedLUT + unsharedLUT + mLUT + exLUT + mlLUT;
+	estimatedResources.bram18k = P.getElements<uint64_t>("BRAM18k")[0];
+	estimatedResources.floorDSP = floorDSP;
+	estimatedResources.floorFF = floorFF + 32 * floorFU + (1 == lK? 1 : 2) * V1 * lK;
+	estimatedResources.floorLUT = floorLUT + 32 * floorFU + V1 * lK + exLUT;
+
+	for(unsigned fieldID = 0; fieldID < structure.size(); fieldID++) {
+		const std::string &name = std::get<0>(structure[fieldID]);
+		unsigned mergeType = std::get<1>(structure[fieldID]);
+		unsigned type = std::get<2>(structure[fieldID]);
 
 		// Names starting with "_" are not printed (used for other purposes)
 		if('_' == name[0])
@@ -587,65 +715,48 @@ void Multipath::dumpSummary(uint64_t numCycles) {
 
 		// Special treament for certain merges (other arithmetics are performed instead of simple merge
 		if("DSPs" == name) {
-			uint64_t value = sharedDSP + unsharedDSP;
-
-			*summaryFile << name << ": " << value << "\n";
+			*summaryFile << name << ": " << estimatedResources.dsp << "\n";
 			continue;
 		}
 		else if("FFs" == name) {
-			unsigned rFF = 32 * (nLoad + nStore + nOp) + tRcIL + (1 == lK? 1 : 2) * V1 * lK;
-			uint64_t value = sharedFF + unsharedFF + rFF + mlFF;
-
-			*summaryFile << name << ": " << value << "\n";
+			*summaryFile << name << ": " << estimatedResources.ff << "\n";
 			continue;
 		}
 		else if("LUTs" == name) {
-			unsigned mLUT = 32 * (nStore + nOp) + 14 * nLoad + V1 * lK;
-			// Use all unrolls
-			loopName2levelUnrollVecMapTy::iterator found2 = loopName2levelUnrollVecMap.find(loopName);
-			assert(found2 != loopName2levelUnrollVecMap.end() && "Could not find loop in loopName2levelUnrollVecMap");
-			std::vector<unsigned> targetUnroll = found2->second;
-			uint64_t accUnrollFactor = 1;
-			for(unsigned i = loopLevel - 1; i + 1; i--)
-				accUnrollFactor *= targetUnroll.at(i);
-			unsigned exLUT = (V1 + V2 + V3) * lK + V1 * (accUnrollFactor - 1);
-
-			uint64_t value = sharedLUT + unsharedLUT + mLUT + exLUT + mlLUT;
-
-			*summaryFile << name << ": " << value << "\n";
+			*summaryFile << name << ": " << estimatedResources.lut << "\n";
 			continue;
 		}
 
 		if(Pack::MERGE_EQUAL == mergeType) {
 			if(Pack::TYPE_UNSIGNED == type) {
-				assert("true" == P.mergeElements<uint64_t>(name) && "Merged values from datapaths differ where it should not differ");
-				*summaryFile << name << ": " << std::to_string(P.getElements<uint64_t>(name)[0]) << "\n";
+				assert("true" == P.mergeElements<uint64_t>(fieldID) && "Merged values from datapaths differ where it should not differ");
+				*summaryFile << name << ": " << std::to_string(P.getElements<uint64_t>(fieldID)[0]) << "\n";
 			}
 			else if(Pack::TYPE_SIGNED == type) {
-				assert("true" == P.mergeElements<int64_t>(name) && "Merged values from datapaths differ where it should not differ");
-				*summaryFile << name << ": " << std::to_string(P.getElements<int64_t>(name)[0]) << "\n";
+				assert("true" == P.mergeElements<int64_t>(fieldID) && "Merged values from datapaths differ where it should not differ");
+				*summaryFile << name << ": " << std::to_string(P.getElements<int64_t>(fieldID)[0]) << "\n";
 			}
 			else if(Pack::TYPE_FLOAT == type) {
-				assert("true" == P.mergeElements<float>(name) && "Merged values from datapaths differ where it should not differ");
-				*summaryFile << name << ": " << std::to_string(P.getElements<float>(name)[0]) << "\n";
+				assert("true" == P.mergeElements<float>(fieldID) && "Merged values from datapaths differ where it should not differ");
+				*summaryFile << name << ": " << std::to_string(P.getElements<float>(fieldID)[0]) << "\n";
 			}
 			else if(Pack::TYPE_STRING == type) {
-				assert("true" == P.mergeElements<std::string>(name) && "Merged values from datapaths differ where it should not differ");
-				*summaryFile << name << ": " << P.getElements<std::string>(name)[0] << "\n";
+				assert("true" == P.mergeElements<std::string>(fieldID) && "Merged values from datapaths differ where it should not differ");
+				*summaryFile << name << ": " << P.getElements<std::string>(fieldID)[0] << "\n";
 			}
 		}
 		else {
 			if(Pack::TYPE_UNSIGNED == type) {
-				*summaryFile << name << ": " << P.mergeElements<uint64_t>(name) << "\n";
+				*summaryFile << name << ": " << P.mergeElements<uint64_t>(fieldID) << "\n";
 			}
 			else if(Pack::TYPE_SIGNED == type) {
-				*summaryFile << name << ": " << P.mergeElements<int64_t>(name) << "\n";
+				*summaryFile << name << ": " << P.mergeElements<int64_t>(fieldID) << "\n";
 			}
 			else if(Pack::TYPE_FLOAT == type) {
-				*summaryFile << name << ": " << P.mergeElements<float>(name) << "\n";
+				*summaryFile << name << ": " << P.mergeElements<float>(fieldID) << "\n";
 			}
 			else if(Pack::TYPE_STRING == type) {
-				std::string mergeResult = P.mergeElements<std::string>(name);
+				std::string mergeResult = P.mergeElements<std::string>(fieldID);
 				*summaryFile << name << ": " << (("" == mergeResult)? "none" : mergeResult) << "\n";
 			}
 		}
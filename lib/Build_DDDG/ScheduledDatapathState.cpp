@@ -0,0 +1,153 @@
+#include "profile_h/ScheduledDatapathState.h"
+
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+#include "profile_h/DDDGBuilder.h"
+#include "profile_h/DDDGCache.h"
+#include "profile_h/opcodes.h"
+
+std::mutex ScheduledDatapathState::storeMutex;
+std::map<std::string, std::shared_ptr<ScheduledDatapathState>> ScheduledDatapathState::store;
+std::list<std::string> ScheduledDatapathState::storeOrder;
+
+bool ScheduledDatapathState::isEnabled() {
+	return (!(args.batchFileName.empty()) || !(args.dseFileName.empty())) && args.fNoMMA && !(args.showScheduling) && !(args.showPostOptDDDG);
+}
+
+std::string ScheduledDatapathState::constructKey(std::string wholeLoopName, std::string loopName, unsigned datapathType, uint64_t unrollFactor, ConfigurationManager &CM) {
+	std::stringstream ss;
+	ss << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+	// Same initial DDDG
+	ss << args.workDir << "~" << DDDGCache::constructKey(wholeLoopName, datapathType, unrollFactor) << "~";
+
+	// Same transforms, latencies and optimisations
+	ss << args.target << "~" << args.frequency << "~" << args.uncertainty << "~";
+	ss << args.fNoTCS << args.fSBOpt << args.fSLROpt << args.fNoSLROpt << args.fRSROpt;
+	ss << args.fTHRFloatOpt << args.fTHRIntOpt << args.fMemDisambuigOpt << args.fExtraScalar << args.fILL << "~";
+
+	// Shared load removal depends on the unroll factors of the whole nest
+	loopName2levelUnrollVecMapTy::iterator found = loopName2levelUnrollVecMap.find(loopName);
+	assert(found != loopName2levelUnrollVecMap.end() && "Could not find loop in loopName2levelUnrollVecMap");
+	for(auto &it : found->second)
+		ss << it << ",";
+	ss << "~";
+
+	// Required resources depend on the array sizes
+	for(auto &it : CM.getArrayInfoCfgMap())
+		ss << it.first << ":" << it.second.totalSize << ":" << it.second.wordSize << ":" << it.second.type << ":" << it.second.scope << ";";
+
+	return ss.str();
+}
+
+std::shared_ptr<ScheduledDatapathState> ScheduledDatapathState::find(std::string key) {
+	std::lock_guard<std::mutex> lock(storeMutex);
+
+	std::map<std::string, std::shared_ptr<ScheduledDatapathState>>::iterator found = store.find(key);
+	return (store.end() == found)? nullptr : found->second;
+}
+
+void ScheduledDatapathState::insert(std::string key, std::shared_ptr<ScheduledDatapathState> state) {
+	std::lock_guard<std::mutex> lock(storeMutex);
+
+	// A design point running in parallel may have inserted the same state
+	if(!(store.insert(std::make_pair(key, state)).second))
+		return;
+
+	storeOrder.push_back(key);
+	if(storeOrder.size() > SCHEDULED_STATE_STORE_SIZE) {
+		store.erase(storeOrder.front());
+		storeOrder.pop_front();
+	}
+}
+
+std::shared_ptr<const ScheduledDatapathState::freeScheduleTy> ScheduledDatapathState::getFreeSchedule() {
+	std::lock_guard<std::mutex> lock(storeMutex);
+	return freeSchedule;
+}
+
+void ScheduledDatapathState::setFreeSchedule(std::shared_ptr<const freeScheduleTy> schedule) {
+	std::lock_guard<std::mutex> lock(storeMutex);
+	if(!freeSchedule)
+		freeSchedule = schedule;
+}
+
+bool ScheduledDatapathState::replay(
+	const freeScheduleTy &schedule, HardwareProfile &profile,
+	const std::vector<int> &microops, const std::unordered_map<int, std::pair<std::string, int64_t>> &baseAddress
+) {
+	for(auto &it : schedule.allocationLog) {
+		if(allocationEventTy::EVENT_TICK == it.type) {
+			profile.pipelinedRelease();
+			continue;
+		}
+
+		// Same mapping from opcodes to functional units as RCScheduler::select()
+		bool allocate = (allocationEventTy::EVENT_ALLOCATE == it.type);
+		bool success = true;
+		int opcode = microops.at(it.nodeID);
+		switch(opcode) {
+			case LLVM_IR_FAdd:
+				if(allocate)
+					success = profile.fAddTryAllocate();
+				else
+					profile.fAddRelease();
+				break;
+			case LLVM_IR_FSub:
+				if(allocate)
+					success = profile.fSubTryAllocate();
+				else
+					profile.fSubRelease();
+				break;
+			case LLVM_IR_FMul:
+				if(allocate)
+					success = profile.fMulTryAllocate();
+				else
+					profile.fMulRelease();
+				break;
+			case LLVM_IR_FDiv:
+				if(allocate)
+					success = profile.fDivTryAllocate();
+				else
+					profile.fDivRelease();
+				break;
+			case LLVM_IR_FCmp:
+				if(allocate)
+					success = profile.fCmpTryAllocate();
+				else
+					profile.fCmpRelease();
+				break;
+			case LLVM_IR_Load:
+				if(allocate)
+					success = profile.loadTryAllocate(profile.arrayGetPartitionID(baseAddress.at(it.nodeID).first));
+				else
+					profile.loadRelease(profile.arrayGetPartitionID(baseAddress.at(it.nodeID).first));
+				break;
+			case LLVM_IR_Store:
+				if(allocate)
+					success = profile.storeTryAllocate(profile.arrayGetPartitionID(baseAddress.at(it.nodeID).first));
+				else
+					profile.storeRelease(profile.arrayGetPartitionID(baseAddress.at(it.nodeID).first));
+				break;
+			case LLVM_IR_Call:
+				if(allocate)
+					success = profile.callTryAllocate();
+				else
+					profile.callRelease();
+				break;
+			default:
+				if(allocate)
+					success = profile.intOpTryAllocate(opcode);
+				else
+					profile.intOpRelease(opcode);
+				break;
+		}
+
+		if(!success)
+			return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,72 @@
+#include "profile_h/SymbolTable.h"
+
+#include "profile_h/DDDGBuilder.h"
+
+using namespace llvm;
+
+SymbolTable symbolTable;
+
+const uint32_t SymbolTable::NO_SYMBOL;
+
+SymbolTable::SymbolTable() : numOfSymbols(0) {
+	for(uint32_t i = 0; i < MAX_CHUNKS; i++)
+		chunks[i].store(nullptr, std::memory_order_relaxed);
+}
+
+SymbolTable::~SymbolTable() {
+	for(uint32_t i = 0; i < MAX_CHUNKS; i++) {
+		std::string *chunk = chunks[i].load(std::memory_order_relaxed);
+		if(chunk)
+			delete[] chunk;
+	}
+}
+
+void SymbolTable::populate() {
+	for(auto &it : instName2bbNameMap) {
+		getID(it.first);
+		getID(it.second);
+	}
+	for(auto &it : funcBBNmPair2numInstInBBMap) {
+		getID(it.first.first);
+		getID(it.first.second);
+	}
+
+	VERBOSE_PRINT(errs() << "[symbolTable] " << std::to_string(size()) << " names interned from static information\n");
+}
+
+uint32_t SymbolTable::getID(const std::string &name) {
+	// Names are never removed, thus a cached ID is always valid
+	static thread_local std::unordered_map<std::string, uint32_t> cache;
+
+	std::unordered_map<std::string, uint32_t>::iterator found = cache.find(name);
+	if(found != cache.end())
+		return found->second;
+
+	uint32_t ID;
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		std::unordered_map<std::string, uint32_t>::iterator found2 = name2IDMap.find(name);
+		if(found2 != name2IDMap.end()) {
+			ID = found2->second;
+		}
+		else {
+			ID = numOfSymbols.load(std::memory_order_relaxed);
+			assert(ID < NO_SYMBOL && "Symbol table is full");
+
+			std::string *chunk = chunks[ID >> CHUNK_BITS].load(std::memory_order_relaxed);
+			if(!chunk) {
+				chunk = new std::string[CHUNK_SIZE];
+				chunks[ID >> CHUNK_BITS].store(chunk, std::memory_order_release);
+			}
+			chunk[ID & (CHUNK_SIZE - 1)] = name;
+
+			name2IDMap.insert(std::make_pair(name, ID));
+			// Publish the name only after it is written
+			numOfSymbols.store(ID + 1, std::memory_order_release);
+		}
+	}
+
+	cache.insert(std::make_pair(name, ID));
+	return ID;
+}
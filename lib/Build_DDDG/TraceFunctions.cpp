@@ -1,22 +1,48 @@
 #include "profile_h/TraceFunctions.h"
 
-FILE *fullTraceFile;
+IndexedGzWriter *fullTraceFile = nullptr;
 FILE *memTraceFile;
 FILE *shortMemTraceFile;
+BinaryTraceWriter *binaryTraceWriter = nullptr;
+LoopTripCounter *loopTripCounter = nullptr;
 
 bool initp = false;
 int instCount = 0;
 
+#define BINARY_TRACE_TYPE(line) ((RESULT_LINE == (line))? binaryTraceRecordTy::TYPE_RESULT : ((FORWARD_LINE == (line))? binaryTraceRecordTy::TYPE_FORWARD : binaryTraceRecordTy::TYPE_PARAM))
+
 void trace_logger_init() {
-	std::string traceFileName = args.workDir + FILE_DYNAMIC_TRACE;
-	std::string popenComm("gzip -1 - > " + traceFileName);
-	fullTraceFile = popen(popenComm.c_str(), "w");
+	if(args.binaryTrace) {
+		binaryTraceWriter = new BinaryTraceWriter(args.workDir + FILE_DYNAMIC_TRACE_BIN, args.binaryTraceCompression, args.traceThreads);
+	}
+	else {
+		fullTraceFile = new IndexedGzWriter(
+			args.workDir + FILE_DYNAMIC_TRACE, args.workDir + FILE_DYNAMIC_TRACE_INDEX, headerBBFuncNamePair2lastInstMap
+		);
+	}
 
-	assert(fullTraceFile != Z_NULL && "Could not open trace output file");
+#ifdef LOOP_TRIP_COUNTS
+	loopTripCounter = new LoopTripCounter(lpNameLevelPair2headBBnameMap, headerBBFuncNamePair2lastInstMap, bbFuncNamePair2lpNameLevelPairMap);
+#endif
 }
 
 void trace_logger_fin() {
-	fclose(fullTraceFile);
+	if(binaryTraceWriter) {
+		binaryTraceWriter->close();
+		delete binaryTraceWriter;
+		binaryTraceWriter = nullptr;
+	}
+	else {
+		fullTraceFile->close();
+		delete fullTraceFile;
+		fullTraceFile = nullptr;
+	}
+
+	if(loopTripCounter) {
+		loopTripCounter->close(args.workDir + FILE_LOOP_TRIP_COUNTS);
+		delete loopTripCounter;
+		loopTripCounter = nullptr;
+	}
 }
 
 void trace_logger_log0(int line_number, char *name, char *bbid, char *instid, int opcode) {
@@ -25,52 +51,87 @@ void trace_logger_log0(int line_number, char *name, char *bbid, char *instid, in
 		initp = true;
 	}
 
-	fprintf(fullTraceFile, "\n0,%d,%s,%s,%s,%d,%d\n", line_number, name, bbid, instid, opcode, instCount);
+	if(binaryTraceWriter) {
+		binaryTraceWriter->appendInstruction(
+			line_number, binaryTraceWriter->intern(name), binaryTraceWriter->intern(bbid), binaryTraceWriter->intern(instid),
+			opcode, instCount
+		);
+	}
+	else {
+		// Checkpoints are placed right before instruction lines
+		fullTraceFile->checkpoint(instCount);
+		fullTraceFile->printf("\n0,%d,%s,%s,%s,%d,%d\n", line_number, name, bbid, instid, opcode, instCount);
+		if(LLVM_IR_Br == opcode)
+			fullTraceFile->hitHeader(instid);
+	}
+
+	if(loopTripCounter && (LLVM_IR_Br == opcode || LLVM_IR_Switch == opcode || LLVM_IR_IndirectBr == opcode))
+		loopTripCounter->hitBranch(name, bbid, instid);
 	instCount++;
 }
 
 void trace_logger_log_int(int line, int size, int64_t value, int is_reg, char *label) {
 	assert(initp && "Trace Logger functions were not initialised correctly");
 
+	if(binaryTraceWriter) {
+		binaryTraceWriter->appendIntOperand(BINARY_TRACE_TYPE(line), line, size, value, is_reg, binaryTraceWriter->intern(label));
+		return;
+	}
+
 	if(RESULT_LINE == line)
-		fprintf(fullTraceFile, "r,%d,%ld,%d,%s\n", size, value, is_reg, label);
+		fullTraceFile->printf("r,%d,%ld,%d,%s\n", size, value, is_reg, label);
 	else if(FORWARD_LINE == line)
-		fprintf(fullTraceFile, "f,%d,%ld,%d,%s\n", size, value, is_reg, label);
+		fullTraceFile->printf("f,%d,%ld,%d,%s\n", size, value, is_reg, label);
 	else
-		fprintf(fullTraceFile, "%d,%d,%ld,%d,%s\n", line, size, value, is_reg, label);
+		fullTraceFile->printf("%d,%d,%ld,%d,%s\n", line, size, value, is_reg, label);
 }
 
 void trace_logger_log_double(int line, int size, double value, int is_reg, char *label) {
 	assert(initp && "Trace Logger functions were not initialised correctly");
 
+	if(binaryTraceWriter) {
+		binaryTraceWriter->appendDoubleOperand(BINARY_TRACE_TYPE(line), line, size, value, is_reg, binaryTraceWriter->intern(label));
+		return;
+	}
+
 	if(RESULT_LINE == line)
-		fprintf(fullTraceFile, "r,%d,%f,%d,%s\n", size, value, is_reg, label);
+		fullTraceFile->printf("r,%d,%f,%d,%s\n", size, value, is_reg, label);
 	else if(FORWARD_LINE == line)
-		fprintf(fullTraceFile, "f,%d,%f,%d,%s\n", size, value, is_reg, label);
+		fullTraceFile->printf("f,%d,%f,%d,%s\n", size, value, is_reg, label);
 	else
-		fprintf(fullTraceFile, "%d,%d,%f,%d,%s\n", line, size, value, is_reg, label);
+		fullTraceFile->printf("%d,%d,%f,%d,%s\n", line, size, value, is_reg, label);
 }
 
 void trace_logger_log_int_noreg(int line, int size, int64_t value, int is_reg) {
 	assert(initp && "Trace Logger functions were not initialised correctly");
 
+	if(binaryTraceWriter) {
+		binaryTraceWriter->appendIntOperand(BINARY_TRACE_TYPE(line), line, size, value, is_reg);
+		return;
+	}
+
 	if(RESULT_LINE == line)
-		fprintf(fullTraceFile, "r,%d,%ld,%d\n", size, value, is_reg);
+		fullTraceFile->printf("r,%d,%ld,%d\n", size, value, is_reg);
 	else if(FORWARD_LINE == line)
-		fprintf(fullTraceFile, "f,%d,%ld,%d\n", size, value, is_reg);
+		fullTraceFile->printf("f,%d,%ld,%d\n", size, value, is_reg);
 	else
-		fprintf(fullTraceFile, "%d,%d,%ld,%d\n", line, size, value, is_reg);
+		fullTraceFile->printf("%d,%d,%ld,%d\n", line, size, value, is_reg);
 }
 
 void trace_logger_log_double_noreg(int line, int size, double value, int is_reg) {
 	assert(initp && "Trace Logger functions were not initialised correctly");
 
+	if(binaryTraceWriter) {
+		binaryTraceWriter->appendDoubleOperand(BINARY_TRACE_TYPE(line), line, size, value, is_reg);
+		return;
+	}
+
 	if(RESULT_LINE == line)
-		fprintf(fullTraceFile, "r,%d,%f,%d\n", size, value, is_reg);
+		fullTraceFile->printf("r,%d,%f,%d\n", size, value, is_reg);
 	else if(FORWARD_LINE == line)
-		fprintf(fullTraceFile, "f,%d,%f,%d\n", size, value, is_reg);
+		fullTraceFile->printf("f,%d,%f,%d\n", size, value, is_reg);
 	else
-		fprintf(fullTraceFile, "%d,%d,%f,%d\n", line, size, value, is_reg);
+		fullTraceFile->printf("%d,%d,%f,%d\n", line, size, value, is_reg);
 }
 
 bool traceEntry;
@@ -111,21 +172,7 @@ void trace_logger_fin_m() {
 	if(args.memTrace)
 		fclose(memTraceFile);
 	if(args.shortMemTrace) {
-		for(auto &tracePair : memoryTraceMap) {
-			std::string key1 = tracePair.first.first;
-			size_t key1Size = key1.length();
-			std::string key2 = tracePair.first.second;
-			size_t key2Size = key2.length();
-			std::vector<uint64_t> addrVec = tracePair.second;
-			size_t addrVecSize = addrVec.size();
-			fwrite((char *) &key1Size, sizeof(size_t), 1, shortMemTraceFile);
-			fwrite(key1.c_str(), sizeof(char), key1Size, shortMemTraceFile);
-			fwrite((char *) &key2Size, sizeof(size_t), 1, shortMemTraceFile);
-			fwrite(key2.c_str(), sizeof(char), key2Size, shortMemTraceFile);
-			fwrite((char *) &addrVecSize, sizeof(size_t), 1, shortMemTraceFile);
-			fwrite((char *) &addrVec[0], sizeof(uint64_t), addrVecSize, shortMemTraceFile);
-		}
-
+		MappedMemoryTrace::write(shortMemTraceFile, memoryTraceMap);
 		fclose(shortMemTraceFile);
 	}
 
@@ -0,0 +1,464 @@
+#include "profile_h/TraceIndex.h"
+
+#include <algorithm>
+#include <stdarg.h>
+#include <string.h>
+
+// Size of the zlib input/output staging buffers
+#define TRACE_INDEX_CHUNK_SIZE (256 * 1024)
+// Size of the gzip trailer (CRC32 and input size)
+#define GZIP_TRAILER_SIZE 8
+
+static void writeString(FILE *file, const std::string &str) {
+	uint32_t length = str.size();
+	fwrite(&length, sizeof(uint32_t), 1, file);
+	fwrite(str.data(), sizeof(char), length, file);
+}
+
+static bool readString(FILE *file, std::string &str) {
+	uint32_t length;
+	if(fread(&length, sizeof(uint32_t), 1, file) != 1)
+		return false;
+
+	str.resize(length);
+	return fread(&str[0], sizeof(char), length, file) == length;
+}
+
+void TraceIndex::setHeaders(const std::vector<std::pair<std::string, std::string>> &headers) {
+	this->headers = headers;
+
+	header2Slot.clear();
+	for(unsigned i = 0; i < headers.size(); i++)
+		header2Slot.insert(std::make_pair(headers[i], i));
+}
+
+int TraceIndex::getHeaderSlot(std::string bbName, std::string funcName) {
+	std::map<std::pair<std::string, std::string>, unsigned>::iterator found = header2Slot.find(std::make_pair(bbName, funcName));
+	return (found != header2Slot.end())? found->second : -1;
+}
+
+bool TraceIndex::load(std::string fileName) {
+	FILE *file = fopen(fileName.c_str(), "rb");
+	if(!file)
+		return false;
+
+	std::string magic(std::string(TRACE_INDEX_MAGIC_STRING).size(), '\0');
+	uint8_t version;
+	bool valid = fread(&magic[0], sizeof(char), magic.size(), file) == magic.size() &&
+		!magic.compare(TRACE_INDEX_MAGIC_STRING) &&
+		fread(&version, sizeof(uint8_t), 1, file) == 1 &&
+		TRACE_INDEX_VERSION == version &&
+		fread(&traceSize, sizeof(uint64_t), 1, file) == 1;
+
+	uint64_t numHeaders = 0;
+	valid = valid && fread(&numHeaders, sizeof(uint64_t), 1, file) == 1;
+
+	std::vector<std::pair<std::string, std::string>> headers(numHeaders);
+	for(uint64_t i = 0; valid && i < numHeaders; i++)
+		valid = readString(file, headers[i].first) && readString(file, headers[i].second);
+
+	uint64_t numCheckpoints = 0;
+	valid = valid && fread(&numCheckpoints, sizeof(uint64_t), 1, file) == 1;
+
+	checkpoints.clear();
+	checkpoints.reserve(numCheckpoints);
+	for(uint64_t i = 0; valid && i < numCheckpoints; i++) {
+		checkpointTy checkpoint;
+		checkpoint.headerHits.resize(numHeaders);
+		valid = fread(&(checkpoint.compressedOffset), sizeof(uint64_t), 1, file) == 1 &&
+			fread(&(checkpoint.uncompressedOffset), sizeof(uint64_t), 1, file) == 1 &&
+			fread(&(checkpoint.instCount), sizeof(uint64_t), 1, file) == 1 &&
+			fread(checkpoint.headerHits.data(), sizeof(uint64_t), numHeaders, file) == numHeaders;
+		checkpoints.push_back(checkpoint);
+	}
+
+	fclose(file);
+
+	if(!valid) {
+		checkpoints.clear();
+		return false;
+	}
+
+	setHeaders(headers);
+	return true;
+}
+
+void TraceIndex::save(std::string fileName) {
+	FILE *file = fopen(fileName.c_str(), "wb");
+	assert(file != nullptr && "Could not open trace index output file");
+
+	uint8_t version = TRACE_INDEX_VERSION;
+	fwrite(TRACE_INDEX_MAGIC_STRING, sizeof(char), std::string(TRACE_INDEX_MAGIC_STRING).size(), file);
+	fwrite(&version, sizeof(uint8_t), 1, file);
+	fwrite(&traceSize, sizeof(uint64_t), 1, file);
+
+	uint64_t numHeaders = headers.size();
+	fwrite(&numHeaders, sizeof(uint64_t), 1, file);
+	for(auto &it : headers) {
+		writeString(file, it.first);
+		writeString(file, it.second);
+	}
+
+	uint64_t numCheckpoints = checkpoints.size();
+	fwrite(&numCheckpoints, sizeof(uint64_t), 1, file);
+	for(auto &it : checkpoints) {
+		fwrite(&(it.compressedOffset), sizeof(uint64_t), 1, file);
+		fwrite(&(it.uncompressedOffset), sizeof(uint64_t), 1, file);
+		fwrite(&(it.instCount), sizeof(uint64_t), 1, file);
+		fwrite(it.headerHits.data(), sizeof(uint64_t), numHeaders, file);
+	}
+
+	fclose(file);
+}
+
+const TraceIndex::checkpointTy *TraceIndex::findCheckpoint(uint64_t uncompressedOffset) {
+	std::vector<checkpointTy>::iterator found = std::upper_bound(checkpoints.begin(), checkpoints.end(), uncompressedOffset,
+		[](uint64_t offset, const checkpointTy &checkpoint) { return offset < checkpoint.uncompressedOffset; }
+	);
+
+	return (found != checkpoints.begin())? &(*(found - 1)) : nullptr;
+}
+
+const TraceIndex::checkpointTy *TraceIndex::findCheckpointBeforeHeader(std::string bbName, std::string funcName, uint64_t from) {
+	int slot = getHeaderSlot(bbName, funcName);
+	if(-1 == slot)
+		return nullptr;
+
+	// First checkpoint at or after "from"
+	std::vector<checkpointTy>::iterator found = std::lower_bound(checkpoints.begin(), checkpoints.end(), from,
+		[](const checkpointTy &checkpoint, uint64_t offset) { return checkpoint.uncompressedOffset < offset; }
+	);
+	if(checkpoints.end() == found)
+		return nullptr;
+	size_t first = found - checkpoints.begin();
+
+	// If "from" is not exactly on a checkpoint, we must be sure that the header was not executed between "from" and the first checkpoint
+	if(checkpoints[first].uncompressedOffset != from) {
+		if(!first || checkpoints[first].headerHits[slot] != checkpoints[first - 1].headerHits[slot])
+			return nullptr;
+	}
+
+	// Find the last checkpoint that still has the same hit count (i.e. the header is executed somewhere after it)
+	size_t last = first;
+	while(last + 1 < checkpoints.size() && checkpoints[last + 1].headerHits[slot] == checkpoints[first].headerHits[slot])
+		last++;
+
+	// The header execution may happen right after the last checkpoint, with the rest of the header BB straddling
+	// before it. We go back one more checkpoint so that the whole header BB is traversed
+	if(last == first)
+		return nullptr;
+
+	return &(checkpoints[last - 1]);
+}
+
+IndexedGzWriter::IndexedGzWriter(std::string fileName, std::string indexFileName, const std::map<std::pair<std::string, std::string>, std::string> &headerLastInsts) :
+	indexFileName(indexFileName) {
+	file = fopen(fileName.c_str(), "wb");
+	assert(file != nullptr && "Could not open trace output file");
+
+	// Level 1 and gzip wrapper, same as the former "gzip -1" pipe
+	memset(&strm, 0, sizeof(z_stream));
+	int retVal = deflateInit2(&strm, 1, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY);
+	assert(Z_OK == retVal && "Could not initialise trace compression");
+
+	inBuffer.resize(TRACE_INDEX_CHUNK_SIZE);
+	inLen = 0;
+	outBuffer.resize(TRACE_INDEX_CHUNK_SIZE);
+
+	compressedOffset = 0;
+	uncompressedOffset = 0;
+	nextCheckpoint = 0;
+
+	std::vector<std::pair<std::string, std::string>> headers;
+	for(auto &it : headerLastInsts) {
+		lastInst2Slot.insert(std::make_pair(it.second, headers.size()));
+		headers.push_back(it.first);
+	}
+	index.setHeaders(headers);
+	headerHits.assign(headers.size(), 0);
+}
+
+IndexedGzWriter::~IndexedGzWriter() {
+	if(file)
+		close();
+}
+
+void IndexedGzWriter::deflateBuffer(int flush) {
+	strm.next_in = (Bytef *) inBuffer.data();
+	strm.avail_in = inLen;
+
+	do {
+		strm.next_out = outBuffer.data();
+		strm.avail_out = outBuffer.size();
+
+		int retVal = deflate(&strm, flush);
+		assert(retVal != Z_STREAM_ERROR && "Could not compress trace");
+
+		size_t produced = outBuffer.size() - strm.avail_out;
+		fwrite(outBuffer.data(), sizeof(Bytef), produced, file);
+		compressedOffset += produced;
+	} while(!strm.avail_out);
+
+	inLen = 0;
+}
+
+void IndexedGzWriter::printf(const char *format, ...) {
+	va_list ap;
+	size_t available = inBuffer.size() - inLen;
+
+	va_start(ap, format);
+	int written = vsnprintf(&inBuffer[inLen], available, format, ap);
+	va_end(ap);
+	assert(written >= 0 && "Could not format trace line");
+
+	// Line did not fit, compress what is buffered and try again
+	if((size_t) written >= available) {
+		deflateBuffer(Z_NO_FLUSH);
+		if((size_t) written >= inBuffer.size())
+			inBuffer.resize(written + 1);
+
+		va_start(ap, format);
+		vsnprintf(inBuffer.data(), inBuffer.size(), format, ap);
+		va_end(ap);
+	}
+
+	inLen += written;
+	uncompressedOffset += written;
+}
+
+void IndexedGzWriter::checkpoint(uint64_t instCount) {
+	if(uncompressedOffset < nextCheckpoint)
+		return;
+
+	// Full flush: output becomes byte-aligned and the deflate dictionary is reset
+	deflateBuffer(Z_FULL_FLUSH);
+
+	TraceIndex::checkpointTy checkpoint;
+	checkpoint.compressedOffset = compressedOffset;
+	checkpoint.uncompressedOffset = uncompressedOffset;
+	checkpoint.instCount = instCount;
+	checkpoint.headerHits = headerHits;
+	index.addCheckpoint(checkpoint);
+
+	nextCheckpoint = uncompressedOffset + TRACE_INDEX_CHECKPOINT_SPACING;
+}
+
+void IndexedGzWriter::hitHeader(const char *instName) {
+	int slot;
+
+	std::unordered_map<const char *, int>::iterator found = pointer2Slot.find(instName);
+	if(found != pointer2Slot.end()) {
+		slot = found->second;
+	}
+	else {
+		std::unordered_map<std::string, int>::iterator found2 = lastInst2Slot.find(instName);
+		slot = (found2 != lastInst2Slot.end())? found2->second : -1;
+		pointer2Slot.insert(std::make_pair(instName, slot));
+	}
+
+	if(slot != -1)
+		headerHits[slot]++;
+}
+
+void IndexedGzWriter::close() {
+	deflateBuffer(Z_FINISH);
+	deflateEnd(&strm);
+	fclose(file);
+	file = nullptr;
+
+	index.setTraceSize(compressedOffset);
+	index.save(indexFileName);
+}
+
+IndexedGzReader::IndexedGzReader(std::string fileName, std::string indexFileName) {
+	file = fopen(fileName.c_str(), "rb");
+	assert(file != nullptr && "Could not open trace input file");
+
+	memset(&strm, 0, sizeof(z_stream));
+	int retVal = inflateInit2(&strm, 15 + 32);
+	assert(Z_OK == retVal && "Could not initialise trace decompression");
+
+	inBuffer.resize(TRACE_INDEX_CHUNK_SIZE);
+	window.resize(TRACE_INDEX_WINDOW_SIZE);
+	pinned = false;
+	pinnedPos = 0;
+
+	// Index is only used if it matches the trace file
+	hasIndex = index.load(indexFileName) && !index.empty();
+	if(hasIndex) {
+		fseek(file, 0, SEEK_END);
+		hasIndex = ((uint64_t) ftell(file) == index.getTraceSize());
+	}
+
+	restart(nullptr);
+}
+
+IndexedGzReader::~IndexedGzReader() {
+	inflateEnd(&strm);
+	fclose(file);
+}
+
+bool IndexedGzReader::readInput() {
+	if(inputEnded)
+		return false;
+
+	size_t bytesRead = fread(inBuffer.data(), sizeof(Bytef), inBuffer.size(), file);
+	if(!bytesRead) {
+		inputEnded = true;
+		return false;
+	}
+
+	strm.next_in = inBuffer.data();
+	strm.avail_in = bytesRead;
+
+	return true;
+}
+
+void IndexedGzReader::skipInput(size_t len) {
+	while(len) {
+		if(!(strm.avail_in) && !readInput())
+			return;
+
+		size_t skipped = std::min(len, (size_t) strm.avail_in);
+		strm.next_in += skipped;
+		strm.avail_in -= skipped;
+		len -= skipped;
+	}
+}
+
+void IndexedGzReader::restart(const TraceIndex::checkpointTy *checkpoint) {
+	// Checkpoints are in the middle of the deflate stream, thus there is no gzip header to be parsed
+	rawMode = (checkpoint != nullptr);
+	fseek(file, rawMode? checkpoint->compressedOffset : 0, SEEK_SET);
+	int retVal = inflateReset2(&strm, rawMode? -15 : 15 + 32);
+	assert(Z_OK == retVal && "Could not reset trace decompression");
+
+	inputEnded = false;
+	strm.next_in = inBuffer.data();
+	strm.avail_in = 0;
+
+	windowStart = rawMode? checkpoint->uncompressedOffset : 0;
+	windowLen = 0;
+	windowPos = 0;
+}
+
+bool IndexedGzReader::fill() {
+	// Slide the window, keeping the pinned data (if any)
+	size_t kept = 0;
+	if(pinned && pinnedPos >= windowStart && pinnedPos < windowStart + windowLen) {
+		kept = windowStart + windowLen - pinnedPos;
+		memmove(&window[0], &window[pinnedPos - windowStart], kept);
+
+		// Pinned data takes most of the window, grow it so that decompression still advances in large chunks
+		if(kept > window.size() / 2)
+			window.resize(window.size() * 2);
+	}
+
+	windowStart += windowLen - kept;
+	windowLen = kept;
+	windowPos = kept;
+
+	while(windowLen < window.size()) {
+		if(!(strm.avail_in) && !readInput())
+			break;
+
+		strm.next_out = (Bytef *) &window[windowLen];
+		strm.avail_out = window.size() - windowLen;
+
+		int retVal = inflate(&strm, Z_NO_FLUSH);
+		assert((Z_OK == retVal || Z_STREAM_END == retVal || Z_BUF_ERROR == retVal) && "Dynamic trace file is corrupted");
+
+		windowLen = window.size() - strm.avail_out;
+
+		// End of a gzip member. If decompression started from a checkpoint, the trailer must be skipped manually
+		if(Z_STREAM_END == retVal) {
+			if(rawMode) {
+				skipInput(GZIP_TRAILER_SIZE);
+				rawMode = false;
+			}
+
+			retVal = inflateReset2(&strm, 15 + 32);
+			assert(Z_OK == retVal && "Could not reset trace decompression");
+		}
+	}
+
+	return windowLen > kept;
+}
+
+char *IndexedGzReader::gets(char *buffer, int len) {
+	int copied = 0;
+
+	while(copied < len - 1) {
+		if(windowPos == windowLen && !fill())
+			break;
+
+		char *start = &window[windowPos];
+		size_t available = std::min(windowLen - windowPos, (size_t) (len - 1 - copied));
+		char *newLine = (char *) memchr(start, '\n', available);
+		size_t toCopy = newLine? newLine - start + 1 : available;
+
+		memcpy(&buffer[copied], start, toCopy);
+		copied += toCopy;
+		windowPos += toCopy;
+
+		if(newLine)
+			break;
+	}
+
+	buffer[copied] = '\0';
+	return copied? buffer : nullptr;
+}
+
+size_t IndexedGzReader::read(char *buffer, size_t len) {
+	size_t copied = 0;
+
+	while(copied < len) {
+		if(windowPos == windowLen && !fill())
+			break;
+
+		size_t toCopy = std::min(windowLen - windowPos, len - copied);
+		memcpy(&buffer[copied], &window[windowPos], toCopy);
+		copied += toCopy;
+		windowPos += toCopy;
+	}
+
+	return copied;
+}
+
+void IndexedGzReader::seek(uint64_t pos) {
+	// Position is inside the current window, no decompression needed
+	if(pos >= windowStart && pos <= windowStart + windowLen) {
+		windowPos = pos - windowStart;
+		return;
+	}
+
+	// Restart decompression if seeking backwards, or if there is a checkpoint between current position and destination
+	const TraceIndex::checkpointTy *checkpoint = hasIndex? index.findCheckpoint(pos) : nullptr;
+	if(pos < windowStart || (checkpoint && checkpoint->uncompressedOffset > windowStart + windowLen))
+		restart(checkpoint);
+
+	// Decompress forward until destination is reached
+	while(windowStart + windowLen < pos && fill());
+	windowPos = (pos > windowStart + windowLen)? windowLen : pos - windowStart;
+}
+
+void IndexedGzReader::pin(uint64_t pos) {
+	assert(pos >= windowStart && pos <= windowStart + windowLen && "Pinned position must be inside the decompression window");
+
+	pinned = true;
+	pinnedPos = pos;
+}
+
+bool IndexedGzReader::seekNearHeader(std::string bbName, std::string funcName, uint64_t &instCount) {
+	if(!hasIndex)
+		return false;
+
+	const TraceIndex::checkpointTy *checkpoint = index.findCheckpointBeforeHeader(bbName, funcName, tell());
+	if(!checkpoint)
+		return false;
+
+	seek(checkpoint->uncompressedOffset);
+	instCount = checkpoint->instCount;
+
+	return true;
+}
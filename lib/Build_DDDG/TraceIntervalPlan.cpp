@@ -0,0 +1,190 @@
+#include "profile_h/TraceIntervalPlan.h"
+
+#include <unordered_map>
+
+using namespace llvm;
+
+thread_local TraceIntervalPlan traceIntervalPlan;
+
+void TraceIntervalPlan::request(std::string loopName, unsigned loopLevel, uint64_t maxUnrollFactor) {
+	assert(!scanned && "Trace interval plan was already scanned, no more loops can be requested");
+
+	std::string wholeLoopName = appendDepthToLoopName(loopName, loopLevel);
+	std::map<std::string, entryTy>::iterator found = entries.find(wholeLoopName);
+	if(found != entries.end()) {
+		if(maxUnrollFactor > found->second.maxExits)
+			found->second.maxExits = maxUnrollFactor;
+		return;
+	}
+
+	std::string functionName = std::get<0>(parseLoopName(loopName));
+	lpNameLevelStrPairTy lpNameLevelPair = std::make_pair(loopName, std::to_string(loopLevel));
+
+	// Same lookups as DDDGBuilder::getTraceLineFromTo(). Loops without this information are not planned
+	lpNameLevelPair2headBBnameMapTy::iterator found2 = lpNameLevelPair2headBBnameMap.find(lpNameLevelPair);
+	lpNameLevelPair2headBBnameMapTy::iterator found3 = lpNameLevelPair2exitingBBnameMap.find(lpNameLevelPair);
+	if(lpNameLevelPair2headBBnameMap.end() == found2 || lpNameLevelPair2exitingBBnameMap.end() == found3)
+		return;
+
+	headerBBFuncNamePair2lastInstMapTy::iterator found4 = headerBBFuncNamePair2lastInstMap.find(std::make_pair(found2->second, functionName));
+	headerBBFuncNamePair2lastInstMapTy::iterator found5 = exitingBBFuncNamePair2lastInstMap.find(std::make_pair(found3->second, functionName));
+	funcBBNmPair2numInstInBBMapTy::iterator found6 = funcBBNmPair2numInstInBBMap.find(std::make_pair(functionName, found2->second));
+	if(headerBBFuncNamePair2lastInstMap.end() == found4 || exitingBBFuncNamePair2lastInstMap.end() == found5 || funcBBNmPair2numInstInBBMap.end() == found6)
+		return;
+
+	entryTy entry;
+	entry.lastInstHeaderBB = found4->second;
+	entry.lastInstExitingBB = found5->second;
+	entry.numInstInHeaderBB = found6->second;
+	entry.maxExits = maxUnrollFactor;
+	entry.headerFound = false;
+	entry.byteFrom = 0;
+	entry.headerPos = 0;
+	entry.instCount = 0;
+	entry.firstExitPos = 0;
+
+	entries.insert(std::make_pair(wholeLoopName, entry));
+}
+
+void TraceIntervalPlan::clear() {
+	entries.clear();
+	scanned = false;
+	complete = false;
+	scanStart = 0;
+	countsLoopBounds = false;
+	loopBoundCounts.clear();
+}
+
+void TraceIntervalPlan::scan(uint64_t cursor, uint64_t instCount) {
+	VERBOSE_PRINT(errs() << "\t\tScanning trace once for the intervals of " << std::to_string(entries.size()) << " loops\n");
+
+	std::unordered_map<std::string, std::vector<entryTy *>> lastInstHeader2Entries;
+	std::unordered_map<std::string, std::vector<entryTy *>> lastInstExiting2Entries;
+	size_t historySize = 0;
+	for(auto &it : entries) {
+		lastInstHeader2Entries[it.second.lastInstHeaderBB].push_back(&(it.second));
+		lastInstExiting2Entries[it.second.lastInstExitingBB].push_back(&(it.second));
+		if(it.second.numInstInHeaderBB > historySize + 1)
+			historySize = it.second.numInstInHeaderBB - 1;
+
+		wholeloopName2loopBoundMapTy::iterator found = wholeloopName2loopBoundMap.find(it.first);
+		if(found != wholeloopName2loopBoundMap.end() && !(found->second))
+			countsLoopBounds = true;
+	}
+
+	// Create database of headerBBName-lastInst -> loopName-level, exactly as DDDGBuilder::getTraceLineFromTo()
+	std::unordered_map<std::string, std::string> headerBBlastInst2wholeLoopNameMap;
+	if(countsLoopBounds) {
+		for(auto &it : lpNameLevelPair2headBBnameMap) {
+			std::string funcName = std::get<0>(parseLoopName(it.first.first));
+			headerBBFuncNamePair2lastInstMapTy::iterator found = headerBBFuncNamePair2lastInstMap.find(std::make_pair(it.second, funcName));
+			std::string headerBBLastInst = (found != headerBBFuncNamePair2lastInstMap.end())? found->second : "";
+			headerBBlastInst2wholeLoopNameMap.insert(std::make_pair(headerBBLastInst, appendDepthToLoopName(it.first.first, std::stoul(it.first.second))));
+		}
+	}
+
+	TraceReader traceFile;
+	traceFile.seek(cursor);
+	scanStart = cursor;
+
+	// Byte offsets of the last historySize instruction lines
+	traceFile.trackInstructions(historySize);
+#ifdef PIPELINED_TRACE_READ
+	traceFile.startPipeline(false);
+#endif
+	size_t pending = entries.size();
+	traceLineTy line;
+	complete = true;
+	while(traceFile.next(line, false)) {
+		if(traceLineTy::TYPE_INST != line.type)
+			continue;
+
+		const std::string &instName = line.instName;
+		instCount++;
+
+		std::unordered_map<std::string, std::vector<entryTy *>>::iterator found = lastInstHeader2Entries.find(instName);
+		if(found != lastInstHeader2Entries.end()) {
+			for(auto &it : found->second) {
+				if(it->headerFound)
+					continue;
+
+				it->byteFrom = traceFile.getInstructionPos(it->numInstInHeaderBB - 1);
+				it->headerPos = line.pos;
+				it->instCount = instCount - it->numInstInHeaderBB;
+				it->headerFound = true;
+
+				if(it->exits.size() >= it->maxExits)
+					pending--;
+			}
+		}
+
+		found = lastInstExiting2Entries.find(instName);
+		if(found != lastInstExiting2Entries.end()) {
+			for(auto &it : found->second) {
+				if(it->exits.size() >= it->maxExits)
+					continue;
+
+				if(it->exits.empty())
+					it->firstExitPos = line.pos;
+				it->exits.push_back(line.count);
+
+				if(it->headerFound && it->exits.size() >= it->maxExits)
+					pending--;
+			}
+		}
+
+		if(countsLoopBounds) {
+			std::unordered_map<std::string, std::string>::iterator found2 = headerBBlastInst2wholeLoopNameMap.find(instName);
+			if(found2 != headerBBlastInst2wholeLoopNameMap.end())
+				loopBoundCounts[found2->second]++;
+		}
+		else if(!pending) {
+			complete = false;
+			break;
+		}
+	}
+
+	scanned = true;
+}
+
+bool TraceIntervalPlan::get(std::string loopName, unsigned loopLevel, uint64_t unrollFactor, uint64_t cursor, uint64_t instCount, bool runtimeLoopBound, intervalTy &interval) {
+	std::map<std::string, entryTy>::iterator found = entries.find(appendDepthToLoopName(loopName, loopLevel));
+	if(entries.end() == found)
+		return false;
+
+	if(!scanned)
+		scan(cursor, instCount);
+
+	// A search starting before the plan scan might find something else
+	if(cursor < scanStart)
+		return false;
+	// Runtime loop bounds are counted from where the search starts until the end of the trace
+	if(runtimeLoopBound && (cursor != scanStart || !countsLoopBounds || !complete))
+		return false;
+
+	entryTy &entry = found->second;
+	// Header not found, or found before the cursor (a search from the cursor would find a later execution)
+	if(!(entry.headerFound) || entry.byteFrom < cursor)
+		return false;
+	// The exiting BB executions are counted from where the search starts. Only safe if none happened before the header
+	if(!(entry.exits.empty()) && entry.firstExitPos < entry.headerPos)
+		return false;
+
+	uint64_t to;
+	if(!unrollFactor)
+		to = 0;
+	else if(unrollFactor <= entry.exits.size())
+		to = entry.exits[unrollFactor - 1];
+	else if(complete && entry.exits.size() < entry.maxExits)
+		to = 0;
+	else
+		return false;
+
+	if(runtimeLoopBound) {
+		for(auto &it : loopBoundCounts)
+			wholeloopName2loopBoundMap[it.first] += it.second;
+	}
+
+	interval = std::make_tuple(entry.byteFrom, to, entry.instCount);
+	return true;
+}
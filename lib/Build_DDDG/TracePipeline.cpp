@@ -0,0 +1,218 @@
+#include "profile_h/TracePipeline.h"
+
+#include "profile_h/SymbolTable.h"
+
+#include <string.h>
+
+TracePipeline::TracePipeline(IndexedGzReader *reader, bool parseOperands) :
+	reader(reader), parseOperands(parseOperands),
+	chunks(TRACE_PIPELINE_NUM_CHUNKS), freeChunks(TRACE_PIPELINE_NUM_CHUNKS), filledChunks(TRACE_PIPELINE_NUM_CHUNKS),
+	batches(TRACE_PIPELINE_NUM_BATCHES), freeBatches(TRACE_PIPELINE_NUM_BATCHES), filledBatches(TRACE_PIPELINE_NUM_BATCHES),
+	stopping(false), waiters(0), current(nullptr), currentLine(0), ended(false) {
+	// Chunks have one extra byte for a null terminator, so that the last line of the trace is always terminated
+	for(auto &it : chunks) {
+		it.data.resize(TRACE_PIPELINE_CHUNK_SIZE + 1);
+		freeChunks.push(&it);
+	}
+	for(auto &it : batches) {
+		it.lines.resize(TRACE_PIPELINE_BATCH_SIZE);
+		freeBatches.push(&it);
+	}
+
+	inflateThread = std::thread(&TracePipeline::inflateStage, this);
+	tokeniseThread = std::thread(&TracePipeline::tokeniseStage, this);
+}
+
+TracePipeline::~TracePipeline() {
+	stopping.store(true, std::memory_order_relaxed);
+
+	// Wake any stage blocked on a queue, it will see the stopping flag
+	{
+		std::lock_guard<std::mutex> lock(waitMutex);
+		waitCond.notify_all();
+	}
+
+	inflateThread.join();
+	tokeniseThread.join();
+}
+
+template<class F> bool TracePipeline::wait(F ready) {
+	std::unique_lock<std::mutex> lock(waitMutex);
+
+	// The check below must see any push/pop whose signal() did not see this waiter
+	waiters.fetch_add(1);
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+
+	bool isReady = false;
+	waitCond.wait(lock, [&]() { return (isReady = ready()) || stopping.load(std::memory_order_relaxed); });
+	waiters.fetch_sub(1);
+
+	return isReady;
+}
+
+void TracePipeline::signal() {
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if(!(waiters.load(std::memory_order_relaxed)))
+		return;
+
+	std::lock_guard<std::mutex> lock(waitMutex);
+	waitCond.notify_all();
+}
+
+template<class T> bool TracePipeline::push(SPSCQueue<T> &queue, T elem) {
+	for(unsigned i = 0; !(queue.push(elem)); i++) {
+		if(stopping.load(std::memory_order_relaxed))
+			return false;
+
+		if(i < TRACE_PIPELINE_SPIN_COUNT) {
+			std::this_thread::yield();
+		}
+		else {
+			if(!wait([&]() { return queue.push(elem); }))
+				return false;
+			break;
+		}
+	}
+
+	signal();
+	return true;
+}
+
+template<class T> bool TracePipeline::pop(SPSCQueue<T> &queue, T &elem) {
+	for(unsigned i = 0; !(queue.pop(elem)); i++) {
+		if(stopping.load(std::memory_order_relaxed))
+			return false;
+
+		if(i < TRACE_PIPELINE_SPIN_COUNT) {
+			std::this_thread::yield();
+		}
+		else {
+			if(!wait([&]() { return queue.pop(elem); }))
+				return false;
+			break;
+		}
+	}
+
+	signal();
+	return true;
+}
+
+void TracePipeline::inflateStage() {
+	uint64_t pos = reader->tell();
+	chunkTy *chunk;
+
+	while(!(stopping.load(std::memory_order_relaxed)) && pop(freeChunks, chunk)) {
+		chunk->pos = pos;
+		chunk->len = reader->read(chunk->data.data(), TRACE_PIPELINE_CHUNK_SIZE);
+		chunk->data[chunk->len] = '\0';
+		pos += chunk->len;
+
+		// An empty chunk marks the end of the trace
+		if(!push(filledChunks, chunk) || !(chunk->len))
+			break;
+	}
+}
+
+bool TracePipeline::emit(batchTy *&batch, const char *lineStart, uint64_t pos) {
+	traceLineTy &line = batch->lines[batch->numLines];
+	if(!TraceReader::parseText(lineStart, line, parseOperands))
+		return true;
+
+	line.pos = pos;
+	if(parseOperands && line.type != traceLineTy::TYPE_INST)
+		line.labelID = symbolTable.getID(line.label);
+	batch->numLines++;
+
+	if(batch->numLines == batch->lines.size()) {
+		if(!push(filledBatches, batch) || !pop(freeBatches, batch))
+			return false;
+		batch->numLines = 0;
+	}
+
+	return true;
+}
+
+void TracePipeline::tokeniseStage() {
+	// Line crossing the end of a chunk
+	std::vector<char> carry;
+	uint64_t carryPos = 0;
+
+	batchTy *batch;
+	if(!pop(freeBatches, batch))
+		return;
+	batch->numLines = 0;
+
+	chunkTy *chunk;
+	while(!(stopping.load(std::memory_order_relaxed)) && pop(filledChunks, chunk)) {
+		const char *start = chunk->data.data();
+		const char *end = start + chunk->len;
+		const char *cursor = start;
+
+		// End of trace: pass the last (unterminated) line and the last batch, followed by an empty batch
+		if(!(chunk->len)) {
+			if(!(carry.empty())) {
+				carry.push_back('\0');
+				if(!emit(batch, carry.data(), carryPos))
+					return;
+			}
+
+			if(batch->numLines && (!push(filledBatches, batch) || !pop(freeBatches, batch)))
+				return;
+			batch->numLines = 0;
+			push(filledBatches, batch);
+
+			return;
+		}
+
+		if(!(carry.empty())) {
+			const char *newLine = (const char *) memchr(cursor, '\n', end - cursor);
+			if(!newLine) {
+				carry.insert(carry.end(), cursor, end);
+				push(freeChunks, chunk);
+				continue;
+			}
+
+			carry.insert(carry.end(), cursor, newLine + 1);
+			carry.push_back('\0');
+			if(!emit(batch, carry.data(), carryPos))
+				return;
+			carry.clear();
+			cursor = newLine + 1;
+		}
+
+		while(cursor < end) {
+			const char *newLine = (const char *) memchr(cursor, '\n', end - cursor);
+			if(!newLine) {
+				carry.assign(cursor, end);
+				carryPos = chunk->pos + (cursor - start);
+				break;
+			}
+
+			if(!emit(batch, cursor, chunk->pos + (cursor - start)))
+				return;
+			cursor = newLine + 1;
+		}
+
+		if(!push(freeChunks, chunk))
+			return;
+	}
+}
+
+bool TracePipeline::next(traceLineTy &line) {
+	while(!ended) {
+		if(current && currentLine < current->numLines) {
+			std::swap(line, current->lines[currentLine++]);
+			return true;
+		}
+
+		// Queues hold all batches, thus returning one never waits
+		if(current)
+			push(freeBatches, current);
+
+		pop(filledBatches, current);
+		currentLine = 0;
+		ended = !(current->numLines);
+	}
+
+	return false;
+}
@@ -0,0 +1,360 @@
+#include "profile_h/TraceReader.h"
+
+#include "profile_h/SymbolTable.h"
+#include "profile_h/TracePipeline.h"
+
+#include <cmath>
+#include <stdlib.h>
+#include <string.h>
+
+TraceReader::TraceReader() : textFile(nullptr), binFile(nullptr), pipeline(nullptr), marked(false), markPos(0), instHistoryHead(0), instHistoryCount(0) {
+	binary = args.binaryTrace;
+	emptyLabelID = symbolTable.getID("");
+
+	if(binary) {
+		binFile = new BinaryTraceReader(args.workDir + FILE_DYNAMIC_TRACE_BIN);
+		binaryLabelIDs.assign(binFile->getNumStrings(), SymbolTable::NO_SYMBOL);
+	}
+	else {
+		textFile = new IndexedGzReader(args.workDir + FILE_DYNAMIC_TRACE, args.workDir + FILE_DYNAMIC_TRACE_INDEX);
+	}
+}
+
+TraceReader::~TraceReader() {
+	stopPipeline();
+
+	if(textFile)
+		delete textFile;
+	if(binFile)
+		delete binFile;
+}
+
+bool TraceReader::next(traceLineTy &line, bool parseOperands) {
+	bool result;
+	if(pipeline)
+		result = pipeline->next(line);
+	else
+		result = binary? nextBinary(line, parseOperands) : nextText(line, parseOperands);
+
+	if(result && traceLineTy::TYPE_INST == line.type && !marked && !(instHistory.empty())) {
+		instHistory[instHistoryHead] = line.pos;
+		instHistoryHead = (instHistoryHead + 1) % instHistory.size();
+		if(instHistoryCount < instHistory.size())
+			instHistoryCount++;
+	}
+
+	return result;
+}
+
+uint64_t TraceReader::tell() {
+	assert(!pipeline && "Position of a pipelined trace reader is unknown");
+
+	return binary? binFile->tell() : textFile->tell();
+}
+
+void TraceReader::seek(uint64_t pos) {
+	stopPipeline();
+
+	if(binary)
+		binFile->seek(pos);
+	else
+		textFile->seek(pos);
+}
+
+void TraceReader::rewind() {
+	stopPipeline();
+
+	if(binary)
+		binFile->rewind();
+	else
+		textFile->rewind();
+}
+
+bool TraceReader::seekNearHeader(std::string bbName, std::string funcName, uint64_t &instCount) {
+	return binary? false : textFile->seekNearHeader(bbName, funcName, instCount);
+}
+
+void TraceReader::startPipeline(bool parseOperands) {
+	assert(!marked && "Trace reader cannot be pipelined while marked");
+
+	// Binary records are read per block and are already parsed, there is nothing to pipeline
+	if(!binary && !pipeline)
+		pipeline = new TracePipeline(textFile, parseOperands);
+}
+
+void TraceReader::stopPipeline() {
+	if(pipeline) {
+		delete pipeline;
+		pipeline = nullptr;
+	}
+}
+
+void TraceReader::mark() {
+	assert(!marked && "Trace reader is already marked");
+	assert(!pipeline && "Trace reader cannot be marked while pipelined");
+
+	markPos = tell();
+	marked = true;
+
+	// Binary blocks are small and random-access, no need to pin anything
+	if(!binary)
+		textFile->pin(markPos);
+}
+
+void TraceReader::reset() {
+	assert(marked && "Trace reader was not marked");
+
+	seek(markPos);
+	marked = false;
+
+	if(!binary)
+		textFile->unpin();
+}
+
+void TraceReader::trackInstructions(size_t n) {
+	instHistory.assign(n + 1, 0);
+	instHistoryHead = 0;
+	instHistoryCount = 0;
+}
+
+uint64_t TraceReader::getInstructionPos(size_t n) {
+	assert(n < instHistory.size() && "Instruction line is older than the tracked history");
+
+	if(n >= instHistoryCount)
+		return 0;
+
+	return instHistory[(instHistoryHead + instHistory.size() - 1 - n) % instHistory.size()];
+}
+
+// Tokenizer for textual trace lines. Fields are parsed in place from the line buffer, without sscanf() or temporaries
+
+// End of the field starting at cursor (i.e. next comma, newline or end of string)
+static inline const char *fieldEnd(const char *cursor) {
+	while(*cursor && *cursor != ',' && *cursor != '\n')
+		cursor++;
+
+	return cursor;
+}
+
+// Start of the field after the one ending at end
+static inline const char *nextField(const char *end) {
+	return (',' == *end)? end + 1 : end;
+}
+
+// Same as %d/%ld/%lu: optional sign followed by decimal digits
+static inline int64_t parseInt(const char *start, const char *end) {
+	bool negative = (start != end && '-' == *start);
+	if(negative)
+		start++;
+
+	uint64_t value = 0;
+	for(; start != end && *start >= '0' && *start <= '9'; start++)
+		value = value * 10 + (*start - '0');
+
+	return negative? -((int64_t) value) : (int64_t) value;
+}
+
+// Same as %lf. Values printed with %ld are converted exactly, anything else (e.g. %f) goes through strtod()
+static inline double parseValue(const char *start, const char *end) {
+	const char *digits = (start != end && '-' == *start)? start + 1 : start;
+	size_t numDigits = end - digits;
+	bool isInteger = numDigits && numDigits <= 18;
+	for(const char *it = digits; isInteger && it != end; it++)
+		isInteger = (*it >= '0' && *it <= '9');
+
+	return isInteger? (double) parseInt(start, end) : strtod(start, nullptr);
+}
+
+static bool tokenizeText(const char *buffer, traceLineTy &line, bool parseOperands) {
+	const char *tagEnd = fieldEnd(buffer);
+
+	// Empty lines are skipped
+	if(*tagEnd != ',')
+		return false;
+
+	const char *rest = tagEnd + 1;
+	const char *end;
+
+	switch(buffer[0]) {
+		// Instruction line: 0,line,function,bb,instruction,opcode,count
+		// (parameter numbers start at 1, thus no other tag starts with '0')
+		case '0':
+			line.type = traceLineTy::TYPE_INST;
+			end = fieldEnd(rest);
+			line.lineNo = parseInt(rest, end);
+			rest = nextField(end);
+			end = fieldEnd(rest);
+			line.funcName.assign(rest, end - rest);
+			rest = nextField(end);
+			end = fieldEnd(rest);
+			line.bbName.assign(rest, end - rest);
+			rest = nextField(end);
+			end = fieldEnd(rest);
+			line.instName.assign(rest, end - rest);
+			rest = nextField(end);
+			end = fieldEnd(rest);
+			line.opcode = parseInt(rest, end);
+			rest = nextField(end);
+			end = fieldEnd(rest);
+			line.count = parseInt(rest, end);
+
+			return true;
+		case 'r':
+			line.type = traceLineTy::TYPE_RESULT;
+			break;
+		case 'f':
+			line.type = traceLineTy::TYPE_FORWARD;
+			break;
+		default:
+			line.type = traceLineTy::TYPE_PARAM;
+			line.param = parseInt(buffer, tagEnd);
+			break;
+	}
+
+	// Operand line: tag,size,value,is reg[,label]
+	if(parseOperands) {
+		end = fieldEnd(rest);
+		line.size = parseInt(rest, end);
+		rest = nextField(end);
+		end = fieldEnd(rest);
+		line.value = parseValue(rest, end);
+		rest = nextField(end);
+		end = fieldEnd(rest);
+		line.isReg = parseInt(rest, end);
+
+		// The label is the rest of the line (as %[^\n])
+		if(',' == *end && end[1] && end[1] != '\n') {
+			rest = end + 1;
+			end = strchr(rest, '\n');
+			line.label.assign(rest, end? end - rest : strlen(rest));
+		}
+		else {
+			line.label.clear();
+		}
+	}
+
+	return true;
+}
+
+#ifdef CHECK_TRACE_TOKENIZER
+// Parse the line again as it was parsed before the tokenizer (i.e. with sscanf()) and compare the fields. Fields that
+// sscanf() could not match (i.e. malformed lines) are not compared
+static void checkTokenizedText(const char *buffer, const traceLineTy &line, bool parseOperands) {
+	std::vector<char> copy(buffer, buffer + strlen(buffer) + 1);
+	char *tagEnd = strchr(copy.data(), ',');
+	assert(tagEnd && "Trace tokenizer parsed a line that sscanf() would skip");
+	*tagEnd = '\0';
+	char *rest = tagEnd + 1;
+
+	if(!strcmp(copy.data(), "0")) {
+		int lineNo, opcode;
+		unsigned long count;
+		char funcName[BUFF_STR_SZ];
+		char bbName[BUFF_STR_SZ];
+		char instName[BUFF_STR_SZ];
+		int matched = sscanf(rest, "%d,%[^,],%[^,],%[^,],%d,%lu\n", &lineNo, funcName, bbName, instName, &opcode, &count);
+
+		assert(traceLineTy::TYPE_INST == line.type && "Trace tokenizer and sscanf() disagree on the type of an instruction line");
+		assert(
+			(matched < 1 || lineNo == line.lineNo) && (matched < 2 || funcName == line.funcName) &&
+			(matched < 3 || bbName == line.bbName) && (matched < 4 || instName == line.instName) &&
+			(matched < 5 || opcode == line.opcode) && (matched < 6 || count == line.count) &&
+			"Trace tokenizer and sscanf() disagree on an instruction line"
+		);
+		return;
+	}
+
+	if(!strcmp(copy.data(), "r"))
+		assert(traceLineTy::TYPE_RESULT == line.type && "Trace tokenizer and sscanf() disagree on the type of a result line");
+	else if(!strcmp(copy.data(), "f"))
+		assert(traceLineTy::TYPE_FORWARD == line.type && "Trace tokenizer and sscanf() disagree on the type of a forward line");
+	else
+		assert(traceLineTy::TYPE_PARAM == line.type && atoi(copy.data()) == line.param && "Trace tokenizer and sscanf() disagree on a parameter tag");
+
+	if(parseOperands) {
+		int size, isReg;
+		double value;
+		char label[BUFF_STR_SZ];
+		int matched = sscanf(rest, "%d,%lf,%d,%[^\n]\n", &size, &value, &isReg, label);
+
+		// NaN values are compared by class, not by value
+		bool sameValue = (value == line.value) || (std::isnan(value) && std::isnan(line.value));
+		assert(
+			(matched < 1 || size == line.size) && (matched < 2 || sameValue) && (matched < 3 || isReg == line.isReg) &&
+			((4 == matched)? label == line.label : line.label.empty()) &&
+			"Trace tokenizer and sscanf() disagree on an operand line"
+		);
+	}
+}
+#endif
+
+bool TraceReader::parseText(const char *buffer, traceLineTy &line, bool parseOperands) {
+	bool parsed = tokenizeText(buffer, line, parseOperands);
+
+#ifdef CHECK_TRACE_TOKENIZER
+	if(parsed)
+		checkTokenizedText(buffer, line, parseOperands);
+#endif
+
+	return parsed;
+}
+
+bool TraceReader::nextText(traceLineTy &line, bool parseOperands) {
+	while(textFile->gets(buffer, sizeof(buffer))) {
+		if(parseText(buffer, line, parseOperands)) {
+			line.pos = textFile->tell() - strlen(buffer);
+			if(parseOperands && line.type != traceLineTy::TYPE_INST)
+				line.labelID = symbolTable.getID(line.label);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool TraceReader::nextBinary(traceLineTy &line, bool parseOperands) {
+	line.pos = binFile->tell();
+
+	const binaryTraceRecordTy *record = binFile->read();
+	if(!record)
+		return false;
+
+	line.type = record->type;
+
+	if(binaryTraceRecordTy::TYPE_INST == record->type) {
+		line.lineNo = record->lineNo;
+		line.funcName.assign(binFile->getString(record->funcID));
+		line.bbName.assign(binFile->getString(record->bbID));
+		line.instName.assign(binFile->getString(record->instID));
+		line.opcode = record->opcode;
+		line.count = record->value.u;
+
+		return true;
+	}
+
+	line.param = record->lineNo;
+
+	if(parseOperands) {
+		line.size = record->size;
+		line.value = (record->flags & binaryTraceRecordTy::FLAG_DOUBLE)? record->value.d : (double) record->value.i;
+		line.isReg = (record->flags & binaryTraceRecordTy::FLAG_ISREG)? 1 : 0;
+		if(record->flags & binaryTraceRecordTy::FLAG_LABEL) {
+			line.label.assign(binFile->getString(record->funcID));
+			line.labelID = getBinaryLabelID(record->funcID);
+		}
+		else {
+			line.label.clear();
+			line.labelID = emptyLabelID;
+		}
+	}
+
+	return true;
+}
+
+uint32_t TraceReader::getBinaryLabelID(uint32_t stringID) {
+	uint32_t &labelID = binaryLabelIDs.at(stringID);
+	if(SymbolTable::NO_SYMBOL == labelID)
+		labelID = symbolTable.getID(binFile->getString(stringID));
+
+	return labelID;
+}
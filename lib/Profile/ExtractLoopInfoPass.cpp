@@ -34,7 +34,7 @@ LpName2numLevelMapTy LpName2numLevelMap;
 
 lpNameLevelPair2headBBnameMapTy lpNameLevelPair2headBBnameMap;
 lpNameLevelPair2headBBnameMapTy lpNameLevelPair2exitingBBnameMap;
-wholeloopName2loopBoundMapTy wholeloopName2loopBoundMap;
+thread_local wholeloopName2loopBoundMapTy wholeloopName2loopBoundMap;
 wholeloopName2perfectOrNotMapTy wholeloopName2perfectOrNotMap;
 
 using namespace llvm;
@@ -1,4 +1,14 @@
 #include "profile_h/InstrumentForDDDGPass.h"
+#include "profile_h/DesignSpace.h"
+
+#include "profile_h/SymbolTable.h"
+
+#include <atomic>
+#include <chrono>
+#include <errno.h>
+#include <mutex>
+#include <sys/stat.h>
+#include <thread>
 
 #define DEBUG_TYPE "instrument-code-for-building-dddg"
 
@@ -9,7 +19,7 @@ staticInstID2OpcodeMapTy staticInstID2OpcodeMap;
 instName2bbNameMapTy instName2bbNameMap;
 headerBBFuncNamePair2lastInstMapTy headerBBFuncNamePair2lastInstMap;
 headerBBFuncNamePair2lastInstMapTy exitingBBFuncNamePair2lastInstMap;
-loopName2levelUnrollVecMapTy loopName2levelUnrollVecMap;
+thread_local loopName2levelUnrollVecMapTy loopName2levelUnrollVecMap;
 memoryTraceMapTy memoryTraceMap;
 bool memoryTraceGenerated = false;
 
@@ -17,6 +27,24 @@ using namespace llvm;
 
 static ManagedStatic<ProfilingJITContext> gJITContext;
 
+RunContext::RunContext(const ArgPack &args, const wholeloopName2loopBoundMapTy &loopBounds, std::string pointName) :
+	initialArgs(args), initialLoopBoundMap(loopBounds), pointName(pointName), contextFileName(args.outWorkDir + FILE_CONTEXT_MANAGER) { }
+
+void RunContext::install() {
+	args = initialArgs;
+	wholeloopName2loopBoundMap = initialLoopBoundMap;
+	loopName2levelUnrollVecMap.clear();
+	globalDDRMap.clear();
+	globalOutBurstsInfo.clear();
+	globalPackInfo.clear();
+	artificialInstIDCounter = 0;
+#ifdef PROGRESSIVE_TRACE_CURSOR
+	progressiveTraceCursor = 0;
+	progressiveTraceInstCount = 0;
+#endif
+	MemoryModel::reset();
+}
+
 void TraceLogger::initialiseDefaults(Module &M) {
 	LLVMContext &C = M.getContext();
 
@@ -423,8 +451,20 @@ bool InstrumentForDDDG::runOnModule(Module &M) {
 	// Verify the module
 	assert(verifyModuleAndPrintErrors(M) && "Errors found in module\n");
 
-	// Perform the cycle estimation
-	loopBasedTraceAnalysis();
+	// Intern the static names once, before any estimation thread is spawned
+	symbolTable.populate();
+
+	// Perform the cycle estimation, either once or for each design point in the batch file or design space
+	if(!(args.dseFileName.empty())) {
+		dseTraceAnalysis();
+	}
+	else if(args.batchFileName.empty()) {
+		RunContext ctx(args, wholeloopName2loopBoundMap);
+		loopBasedTraceAnalysis(ctx);
+	}
+	else {
+		batchTraceAnalysis();
+	}
 
 	VERBOSE_PRINT(errs() << "[instrumentForDDDG] Finished\n");
 
@@ -723,19 +763,21 @@ void InstrumentForDDDG::updateUnrollingDatabase(const std::vector<ConfigurationM
 	}
 }
 
-void InstrumentForDDDG::loopBasedTraceAnalysis() {
+void InstrumentForDDDG::loopBasedTraceAnalysis(RunContext &ctx) {
 	VERBOSE_PRINT(errs() << "[][loopBasedTraceAnalysis] Loop-based trace analysis started\n");
 
 	std::string traceFileName = args.workDir + FILE_DYNAMIC_TRACE;
 	std::string kernelName = mangleFunctionName(args.kernelNames.at(0));
 
 	VERBOSE_PRINT(errs() << "[][loopBasedTraceAnalysis] Writing header of summary file\n");
-	openSummaryFile(kernelName); 
+	openSummaryFile(ctx, kernelName);
 
 	VERBOSE_PRINT(errs() << "[][loopBasedTraceAnalysis] Parsing configuration file\n");
 	ConfigurationManager CM(kernelName);
-	CM.parseAndPopulate(pipelineLoopLevelVec);
+	CM.parseAndPopulate(ctx.pipelineLoopLevelVec);
 	updateUnrollingDatabase(CM.getUnrollingCfg());
+	ctx.estimatedCycles.clear();
+	ctx.estimatedResources.clear();
 
 #ifdef FUTURE_CACHE
 	if(args.futureCache) {
@@ -748,7 +790,7 @@ void InstrumentForDDDG::loopBasedTraceAnalysis() {
 	}
 #endif
 
-	ContextManager CtxM;
+	ContextManager CtxM(ctx.contextFileName);
 	if(!(args.fNoMMA)) {
 		if(ArgPack::MMA_MODE_GEN == args.mmaMode) {
 			CtxM.openForWrite();
@@ -767,6 +809,20 @@ void InstrumentForDDDG::loopBasedTraceAnalysis() {
 		}
 	}
 
+#ifdef TRACE_INTERVAL_PLAN
+	// Gather all loops that will be analysed, so that their trace intervals are found in a single pass
+	traceIntervalPlan.clear();
+	for(auto &it : loopName2levelUnrollVecMap) {
+		std::string loopIndex = std::to_string(std::get<1>(parseLoopName(it.first)));
+		if(args.targetLoops.end() == std::find(args.targetLoops.begin(), args.targetLoops.end(), loopIndex))
+			continue;
+
+		// Datapaths for recurrence-constrained II calculation with "--f-recii-unroll" use up to twice the unroll factor
+		for(unsigned i = 0; i < it.second.size(); i++)
+			traceIntervalPlan.request(it.first, i + 1, ((uint64_t) std::max(it.second[i], 1u)) << (args.fRecIIUnroll? 1 : 0));
+	}
+#endif
+
 	for(auto &it : loopName2levelUnrollVecMap) {
 		std::string loopName = it.first;
 		std::string loopIndex = std::to_string(std::get<1>(parseLoopName(loopName)));
@@ -805,8 +861,8 @@ void InstrumentForDDDG::loopBasedTraceAnalysis() {
 				targetWholeLoopName = wholeLoopName;
 			}
 
-			std::vector<std::string>::iterator found3 = std::find(pipelineLoopLevelVec.begin(), pipelineLoopLevelVec.end(), wholeLoopName);
-			enablePipelining = found3 != pipelineLoopLevelVec.end();
+			std::vector<std::string>::iterator found3 = std::find(ctx.pipelineLoopLevelVec.begin(), ctx.pipelineLoopLevelVec.end(), wholeLoopName);
+			enablePipelining = found3 != ctx.pipelineLoopLevelVec.end();
 		}
 
 // XXX Different generations of NPLA logic, remove!
@@ -854,25 +910,31 @@ void InstrumentForDDDG::loopBasedTraceAnalysis() {
 			if(enablePipelining) {
 				unsigned actualUnrollFactor = (targetLoopBound < (targetUnrollFactor << 1) && targetLoopBound)? targetLoopBound : (targetUnrollFactor << 1);
 
-				Multipath MD(kernelName, CM, CtxM, &summaryFile, loopName, targetLoopLevel, firstNonPerfectLoopLevel, unrollFactor, levelUnrollVec, actualUnrollFactor);
-				if(args.fNoMMA || ArgPack::MMA_MODE_GEN != args.mmaMode)
+				Multipath MD(kernelName, CM, CtxM, &(ctx.summaryFile), loopName, targetLoopLevel, firstNonPerfectLoopLevel, unrollFactor, levelUnrollVec, actualUnrollFactor);
+				if(args.fNoMMA || ArgPack::MMA_MODE_GEN != args.mmaMode) {
 					errs() << "[][][" << targetWholeLoopName << "] Estimated cycles: " << std::to_string(MD.getCycles()) << "\n";
+					ctx.estimatedCycles.push_back(std::make_pair(targetWholeLoopName, MD.getCycles()));
+					ctx.estimatedResources.push_back(std::make_pair(targetWholeLoopName, MD.getEstimatedResources()));
+				}
 			}
 			else {
-				Multipath MD(kernelName, CM, CtxM, &summaryFile, loopName, targetLoopLevel, firstNonPerfectLoopLevel, unrollFactor, levelUnrollVec);
-				if(args.fNoMMA || ArgPack::MMA_MODE_GEN != args.mmaMode)
+				Multipath MD(kernelName, CM, CtxM, &(ctx.summaryFile), loopName, targetLoopLevel, firstNonPerfectLoopLevel, unrollFactor, levelUnrollVec);
+				if(args.fNoMMA || ArgPack::MMA_MODE_GEN != args.mmaMode) {
 					errs() << "[][][" << targetWholeLoopName << "] Estimated cycles: " << std::to_string(MD.getCycles()) << "\n";
+					ctx.estimatedCycles.push_back(std::make_pair(targetWholeLoopName, MD.getCycles()));
+					ctx.estimatedResources.push_back(std::make_pair(targetWholeLoopName, MD.getEstimatedResources()));
+				}
 			}
 		}
 		else {
 			unsigned recII = 0;
 
-			// Get recurrence-constrained II
-			if(enablePipelining) {
+			// Get recurrence-constrained II (otherwise calculated from the loop-carried dependencies of the datapath)
+			if(enablePipelining && args.fRecIIUnroll) {
 				VERBOSE_PRINT(errs() << "[][][" << targetWholeLoopName << "] Building dynamic datapath for recurrence-constrained II calculation\n");
 
 				unsigned actualUnrollFactor = (targetLoopBound < (targetUnrollFactor << 1) && targetLoopBound)? targetLoopBound : (targetUnrollFactor << 1);
-				DynamicDatapath DD(kernelName, CM, CtxM, &summaryFile, loopName, targetLoopLevel, actualUnrollFactor);
+				DynamicDatapath DD(kernelName, CM, CtxM, &(ctx.summaryFile), loopName, targetLoopLevel, actualUnrollFactor);
 				recII = DD.getASAPII();
 
 				if(args.fNoMMA || ArgPack::MMA_MODE_GEN != args.mmaMode)
@@ -880,10 +942,13 @@ void InstrumentForDDDG::loopBasedTraceAnalysis() {
 			}
 
 			VERBOSE_PRINT(errs() << "[][][" << targetWholeLoopName << "] Building dynamic datapath\n");
-			DynamicDatapath DD(kernelName, CM, CtxM, &summaryFile, loopName, targetLoopLevel, unrollFactor, enablePipelining, recII);
+			DynamicDatapath DD(kernelName, CM, CtxM, &(ctx.summaryFile), loopName, targetLoopLevel, unrollFactor, enablePipelining, recII);
 
-			if(args.fNoMMA || ArgPack::MMA_MODE_GEN != args.mmaMode)
+			if(args.fNoMMA || ArgPack::MMA_MODE_GEN != args.mmaMode) {
 				errs() << "[][][" << targetWholeLoopName << "] Estimated cycles: " << std::to_string(DD.getCycles()) << "\n";
+				ctx.estimatedCycles.push_back(std::make_pair(targetWholeLoopName, DD.getCycles()));
+				ctx.estimatedResources.push_back(std::make_pair(targetWholeLoopName, DD.getEstimatedResources()));
+			}
 		}
 	}
 
@@ -902,40 +967,285 @@ void InstrumentForDDDG::loopBasedTraceAnalysis() {
 
 #ifdef FUTURE_CACHE
 	if(args.futureCache) {
-		futureCache.dumpSummary(&summaryFile);
+		futureCache.dumpSummary(&(ctx.summaryFile));
 
 		VERBOSE_PRINT(errs() << "[][loopBasedTraceAnalysis] Saving future cache\n");
 		futureCache.save();
 	}
 #endif
 
-	closeSummaryFile();
+	closeSummaryFile(ctx);
 	VERBOSE_PRINT(errs() << "[][loopBasedTraceAnalysis] Summary file closed\n");
 
 	VERBOSE_PRINT(errs() << "[][loopBasedTraceAnalysis] Finished\n");
 
 #ifdef DBG_PRINT_ALL
 	CM.parseToFiles();
+
+	errs() << "-- pipelineLoopLevelVec\n";
+	for(auto const &x : ctx.pipelineLoopLevelVec)
+		errs() << "-- " << x << "\n";
+	errs() << "-- --------------------\n";
 #endif
 }
 
-void InstrumentForDDDG::openSummaryFile(std::string kernelName) {
-	std::string fileName(args.outWorkDir + demangleFunctionName(kernelName) + FILE_SUMMARY_SUFFIX);
-	if(summaryFile.is_open())
-		summaryFile.close();
-	summaryFile.open(fileName);
+void InstrumentForDDDG::batchTraceAnalysis() {
+	VERBOSE_PRINT(errs() << "[][batchTraceAnalysis] Batch design-space exploration started\n");
+
+	std::ifstream batchFile(args.batchFileName);
+	assert(batchFile.is_open() && "Error opening batch file");
+
+	// Each design point is either a configuration file ("file,NAME,PATH") or a set of inline
+	// directives enclosed by "begin,NAME" and "end". Inline directives are written to a configuration file
+	std::vector<std::pair<std::string, std::string>> designPoints;
+	std::ofstream inlineCfgFile;
+	std::string line;
+	while(std::getline(batchFile, line)) {
+		if(!line.size() || '#' == line[0])
+			continue;
+
+		if(inlineCfgFile.is_open()) {
+			if(!line.compare("end"))
+				inlineCfgFile.close();
+			else
+				inlineCfgFile << line << "\n";
+
+			continue;
+		}
 
-	assert(summaryFile.is_open() && "Could not open summary output file");
+		size_t tagPos = line.find(",");
+		assert(tagPos != std::string::npos && "Invalid line in batch file");
+		std::string type = line.substr(0, tagPos);
+		std::string rest = line.substr(tagPos + 1);
 
-	summaryFile << "=======================================================================\n";
-	summaryFile << "Lina summary\n";
-	summaryFile << "=======================================================================\n";
-	summaryFile << "Function name: " << demangleFunctionName(kernelName) << "\n";
+		if(!type.compare("file")) {
+			size_t namePos = rest.find(",");
+			assert(namePos != std::string::npos && "Invalid \"file\" line in batch file, expected \"file,NAME,PATH\"");
+			designPoints.push_back(std::make_pair(rest.substr(0, namePos), rest.substr(namePos + 1)));
+		}
+		else if(!type.compare("begin")) {
+			std::string cfgFileName(args.outWorkDir + FILE_BATCH_CFG_PREFIX + rest + ".cfg");
+			inlineCfgFile.open(cfgFileName);
+			assert(inlineCfgFile.is_open() && "Could not open configuration file for inline design point");
+			designPoints.push_back(std::make_pair(rest, cfgFileName));
+		}
+		else {
+			assert(false && "Invalid line in batch file, expected \"file\" or \"begin\"");
+		}
+	}
+	assert(!(inlineCfgFile.is_open()) && "Unterminated \"begin\" block in batch file");
+	batchFile.close();
+
+#ifdef FUTURE_CACHE
+	assert((1 == args.batchThreads || !(args.futureCache)) && "Future cache is not supported with \"--batch-threads\" > 1");
+#endif
+
+	// Each design point has its own output folder (inside the output working directory) and is estimated
+	// from the same state as a fresh execution. The context file (if any) is shared and only read
+	std::vector<RunContext *> contexts;
+	for(auto &it : designPoints) {
+		ArgPack pointArgs = args;
+		pointArgs.configFileName = it.second;
+		pointArgs.outWorkDir = args.outWorkDir + it.first + "/";
+		int mkdirResult = mkdir(pointArgs.outWorkDir.c_str(), 0755);
+		assert((!mkdirResult || EEXIST == errno) && "Could not create output folder for design point");
+
+		RunContext *ctx = new RunContext(pointArgs, wholeloopName2loopBoundMap, it.first);
+		ctx->contextFileName = args.outWorkDir + FILE_CONTEXT_MANAGER;
+		contexts.push_back(ctx);
+	}
+
+	// The memory trace is shared among all design points. Load it now, before any thread is spawned
+	if(!(args.fNoMMA))
+		XilinxZCUMemoryModel::loadMemoryTrace();
+
+	unsigned numThreads = args.batchThreads? args.batchThreads : std::thread::hardware_concurrency();
+	if(!numThreads)
+		numThreads = 1;
+	if(numThreads > designPoints.size())
+		numThreads = designPoints.size();
+
+	// Design points are picked dynamically by idle threads, thus a thread that finishes its (faster) design
+	// points keeps taking new ones while other threads are still busy with slower ones
+	std::atomic<unsigned> nextPoint(0);
+	std::mutex printMutex;
+	auto worker = [&]() {
+		unsigned i;
+		while((i = nextPoint++) < contexts.size()) {
+			RunContext &ctx = *(contexts[i]);
+
+			{
+				std::lock_guard<std::mutex> lock(printMutex);
+				errs() << "[][batchTraceAnalysis] Design point " << std::to_string(i + 1) << "/" << std::to_string(contexts.size()) << ": " << ctx.pointName << "\n";
+			}
+
+			ctx.install();
+			loopBasedTraceAnalysis(ctx);
+		}
+	};
+
+	if(1 == numThreads) {
+		// Estimate in the calling thread, restoring its state afterwards
+		ArgPack originalArgs = args;
+		wholeloopName2loopBoundMapTy originalLoopBoundMap = wholeloopName2loopBoundMap;
+
+		worker();
+
+		args = originalArgs;
+		wholeloopName2loopBoundMap = originalLoopBoundMap;
+	}
+	else {
+		VERBOSE_PRINT(errs() << "[][batchTraceAnalysis] Estimating with " << std::to_string(numThreads) << " threads\n");
+
+		std::vector<std::thread> threads;
+		for(unsigned i = 0; i < numThreads; i++)
+			threads.push_back(std::thread(worker));
+		for(auto &it : threads)
+			it.join();
+	}
+
+	std::string resultsFileName(args.outWorkDir + FILE_BATCH_RESULTS);
+	std::ofstream resultsFile(resultsFileName);
+	assert(resultsFile.is_open() && "Could not open batch results output file");
+	resultsFile << "point,loop,cycles\n";
+	for(auto &ctx : contexts) {
+		for(auto &it : ctx->estimatedCycles)
+			resultsFile << ctx->pointName << "," << it.first << "," << std::to_string(it.second) << "\n";
+		delete ctx;
+	}
+	resultsFile.close();
+
+	VERBOSE_PRINT(errs() << "[][batchTraceAnalysis] Results written to " << resultsFileName << "\n");
+	VERBOSE_PRINT(errs() << "[][batchTraceAnalysis] Finished\n");
 }
 
-void InstrumentForDDDG::closeSummaryFile() {
-	summaryFile << "=======================================================================\n";
-	summaryFile.close();
+void InstrumentForDDDG::dseTraceAnalysis() {
+	VERBOSE_PRINT(errs() << "[][dseTraceAnalysis] Bound-based design-space exploration started\n");
+
+	DesignSpace DS(args.dseFileName);
+	DS.writeConfigurationFiles(args.outWorkDir + FILE_DSE_CFG_PREFIX);
+	errs() << "[][dseTraceAnalysis] Design space with " << std::to_string(DS.size()) << " points\n";
+
+	std::string kernelName = mangleFunctionName(args.kernelNames.at(0));
+	ArgPack originalArgs = args;
+	wholeloopName2loopBoundMapTy originalLoopBoundMap = wholeloopName2loopBoundMap;
+
+	// Memory resources and settings changed by the configuration parser only depend on the configuration file,
+	// thus they are known for all points before any estimation
+	for(unsigned i = 0; i < DS.size(); i++) {
+		args = originalArgs;
+		args.configFileName = DS.getPoint(i).cfgFileName;
+
+		std::vector<std::string> pipelineLoopLevelVec;
+		ConfigurationManager CM(kernelName);
+		CM.parseAndPopulate(pipelineLoopLevelVec);
+
+		HardwareProfile *profile = HardwareProfile::createInstance();
+		profile->setResourceLimits();
+		profile->setMemoryCurrentUsage(CM.getArrayInfoCfgMap(), CM.getPartitionCfgMap(), CM.getCompletePartitionCfgMap());
+		std::tuple<unsigned, unsigned, unsigned> memoryResources = profile->resourcesGetMemory();
+		delete profile;
+
+		// Increased load latency changes the latencies of the DDDG, thus points are only bounded by points with the same setting
+		DS.setPointInfo(i, args.fILL? "ill" : "", std::get<0>(memoryResources), std::get<1>(memoryResources), std::get<2>(memoryResources));
+	}
+	args = originalArgs;
+
+	// The memory trace is shared among all design points
+	if(!(args.fNoMMA))
+		XilinxZCUMemoryModel::loadMemoryTrace();
+
+	// Points are estimated in sequence, so that each estimation tightens the bounds of the following points
+	std::vector<unsigned> order = DS.getEvaluationOrder();
+	unsigned numEvaluated = 0, numPruned = 0;
+	double evaluationTime = 0;
+	for(unsigned i = 0; i < order.size(); i++) {
+		unsigned pointID = order[i];
+		const DesignSpace::pointTy &point = DS.getPoint(pointID);
+
+		DesignSpace::objectivesTy bound = DS.getLowerBound(pointID);
+		if(DS.isDominated(bound)) {
+			VERBOSE_PRINT(errs() << "[][dseTraceAnalysis] Design point " << std::to_string(i + 1) << "/" << std::to_string(order.size()) << ": " << point.name << " pruned\n");
+			DS.setPruned(pointID, bound);
+			numPruned++;
+			continue;
+		}
+
+		errs() << "[][dseTraceAnalysis] Design point " << std::to_string(i + 1) << "/" << std::to_string(order.size()) << ": " << point.name << "\n";
+
+		ArgPack pointArgs = originalArgs;
+		pointArgs.configFileName = point.cfgFileName;
+		pointArgs.outWorkDir = originalArgs.outWorkDir + point.name + "/";
+		int mkdirResult = mkdir(pointArgs.outWorkDir.c_str(), 0755);
+		assert((!mkdirResult || EEXIST == errno) && "Could not create output folder for design point");
+
+		RunContext ctx(pointArgs, originalLoopBoundMap, point.name);
+		ctx.contextFileName = originalArgs.outWorkDir + FILE_CONTEXT_MANAGER;
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		ctx.install();
+		loopBasedTraceAnalysis(ctx);
+		evaluationTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		numEvaluated++;
+
+		// Cycles of all target loops are summed, resources are the largest among them
+		DesignSpace::objectivesTy objectives, floor;
+		for(auto &it : ctx.estimatedCycles)
+			objectives.cycles += it.second;
+		for(auto &it : ctx.estimatedResources) {
+			objectives.dsp = std::max(objectives.dsp, it.second.dsp);
+			objectives.ff = std::max(objectives.ff, it.second.ff);
+			objectives.lut = std::max(objectives.lut, it.second.lut);
+			objectives.bram18k = std::max(objectives.bram18k, it.second.bram18k);
+			floor.dsp = std::max(floor.dsp, it.second.floorDSP);
+			floor.ff = std::max(floor.ff, it.second.floorFF);
+			floor.lut = std::max(floor.lut, it.second.floorLUT);
+		}
+		DS.setEvaluated(pointID, objectives, floor);
+	}
+
+	args = originalArgs;
+	wholeloopName2loopBoundMap = originalLoopBoundMap;
+
+	std::string resultsFileName(args.outWorkDir + FILE_DSE_RESULTS);
+	DS.dumpResults(resultsFileName);
+
+	// Pruned points would have taken about as long as the average estimated point
+	double timeSaved = numEvaluated? numPruned * (evaluationTime / numEvaluated) : 0;
+	errs() << "[][dseTraceAnalysis] Estimated points: " << std::to_string(numEvaluated) << ", pruned points: " << std::to_string(numPruned) << "\n";
+	errs() << "[][dseTraceAnalysis] Estimation time: " << std::to_string(evaluationTime) << " s, estimated time saved by pruning: " << std::to_string(timeSaved) << " s\n";
+	errs() << "[][dseTraceAnalysis] Pareto front (cycles, DSPs, FFs, LUTs, BRAM18k):\n";
+	for(auto &it : DS.getFront()) {
+		const DesignSpace::objectivesTy &objectives = DS.getPoint(it).objectives;
+		errs() << "[][dseTraceAnalysis] \t" << DS.getPoint(it).name << ": " << std::to_string(objectives.cycles) << ", " << std::to_string(objectives.dsp);
+		errs() << ", " << std::to_string(objectives.ff) << ", " << std::to_string(objectives.lut) << ", " << std::to_string(objectives.bram18k) << "\n";
+	}
+
+	VERBOSE_PRINT(errs() << "[][dseTraceAnalysis] Results written to " << resultsFileName << "\n");
+	VERBOSE_PRINT(errs() << "[][dseTraceAnalysis] Finished\n");
+}
+
+void InstrumentForDDDG::openSummaryFile(RunContext &ctx, std::string kernelName) {
+	// In batch mode, each design point has its own summary file
+	std::string pointSuffix = ctx.pointName.empty()? "" : "_" + ctx.pointName;
+	std::string fileName(args.outWorkDir + demangleFunctionName(kernelName) + pointSuffix + FILE_SUMMARY_SUFFIX);
+	if(ctx.summaryFile.is_open())
+		ctx.summaryFile.close();
+	ctx.summaryFile.open(fileName);
+
+	assert(ctx.summaryFile.is_open() && "Could not open summary output file");
+
+	ctx.summaryFile << "=======================================================================\n";
+	ctx.summaryFile << "Lina summary\n";
+	ctx.summaryFile << "=======================================================================\n";
+	ctx.summaryFile << "Function name: " << demangleFunctionName(kernelName) << "\n";
+	if(!(ctx.pointName.empty()))
+		ctx.summaryFile << "Design point: " << ctx.pointName << "\n";
+}
+
+void InstrumentForDDDG::closeSummaryFile(RunContext &ctx) {
+	ctx.summaryFile << "=======================================================================\n";
+	ctx.summaryFile.close();
 }
 
 ProfilingEngine::ProfilingEngine(Module &M, TraceLogger &TL) : M(M), TL(TL) {
@@ -1039,11 +1349,6 @@ void InstrumentForDDDG::printDatabase(void) {
 		errs() << "-- <" << x.first.first << ", " << x.first.second << ">: " << x.second << "\n";
 	errs() << "-- ---------------------------------\n";
 
-	errs() << "-- pipelineLoopLevelVec\n";
-	for(auto const &x : pipelineLoopLevelVec)
-		errs() << "-- " << x << "\n";
-	errs() << "-- --------------------\n";
-
 	errs() << "-- loopName2levelUnrollVecMap\n";
 	for(auto const &x : loopName2levelUnrollVecMap) {
 		errs() << "-- " << x.first << ": (";
@@ -11,6 +11,7 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/ToolOutputFile.h"
 
+#include "profile_h/BinaryTrace.h"
 #include "profile_h/lin-profile.h"
 
 #define DEBUG_TYPE "lina"
@@ -48,7 +49,7 @@ const std::string helpMessage =
 	"                                            ZCU104: Xilinx Zynq UltraScale+ SoC\n"
 	"                                            VC707 : Xilinx Virtex-7 FPGA\n"
 	"        -v       , --verbose          : be verbose, print a lot of information\n"
-	"        -x       , --compressed       : use compressed files to reduce memory footprint\n"
+	"        -x       , --compressed       : compress parsed traces in memory to reduce memory footprint\n"
 #ifdef PROGRESSIVE_TRACE_CURSOR
 	"        -p       , --progressive      : use progressive trace cursor when trace is\n"
 	"                                        analysed, reducing estimation time when several\n"
@@ -61,6 +62,13 @@ const std::string helpMessage =
 	"                                        saving seek time. Only supported when progressive trace\n"
 	"                                        cursor is active with -p | --progressive. Future cache is\n"
 	"                                        disabled when runtime loop bound analysis is required.\n"
+#endif
+#ifdef DDDG_CACHE
+	"                   --dddg-cache       : use DDDG cache. DDDGs are saved in the input working directory\n"
+	"                                        and reused in successive executions of Lina whenever the same\n"
+	"                                        loop, level, unroll factor and trace position are analysed,\n"
+	"                                        skipping trace parsing. Ignored with \"--mma-mode=use\".\n"
+	"                                        Not supported with \"--future-cache\"\n"
 #endif
 	"        -l LOOPS , --loops=LOOPS      : specify loops to be analysed comma-separated (e.g.\n"
 	"                                        --loops=2,3 only analyse loops 2 and 3)\n"
@@ -70,6 +78,34 @@ const std::string helpMessage =
 	"                   --short-mem-trace  : obtain (in trace mode) or use (in estimate mode) short binary\n"
 	"                                        memory trace for access pattern analysis. For large profilings,\n"
 	"                                        this can be generated and processed faster than the full trace\n"
+	"                   --binary-trace=COMP: generate (in trace mode) or use (in estimate mode) the binary\n"
+	"                                        dynamic trace dynamic_trace.bin instead of dynamic_trace.gz.\n"
+	"                                        COMP is optional and selects the block compression:\n"
+	"                                            zlib: compress each block with zlib (DEFAULT)\n"
+	"                                            none: no compression\n"
+	"                   --trace-threads=N  : compress and write the blocks of \"--binary-trace\" in N\n"
+	"                                        background threads while the kernel is traced. If N is 0,\n"
+	"                                        blocks are compressed by the traced kernel itself. DEFAULT: 1\n"
+	"                   --convert-trace    : convert an existing dynamic_trace.gz from the input working\n"
+	"                                        directory to dynamic_trace.bin and exit. Compression can be\n"
+	"                                        selected with \"--binary-trace=COMP\". BYTECODEFILE and\n"
+	"                                        KERNELNAME are not required\n"
+	"                   --batch=FILE       : estimate several design points in one execution. FILE lists\n"
+	"                                        the design points, either as configuration files or as\n"
+	"                                        inline directives (see README.md). The bitcode, trace and\n"
+	"                                        memory trace are loaded once, and estimated cycles for each\n"
+	"                                        point are written to batch_results.csv in the output working\n"
+	"                                        directory. \"-c\" | \"--config-file\" is ignored. Not supported\n"
+	"                                        with \"--mma-mode=gen\" or \"-m trace\"\n"
+	"                   --batch-threads=N  : estimate up to N design points of \"--batch\" in parallel. If\n"
+	"                                        N is 0, the number of hardware threads is used. DEFAULT: 1\n"
+	"                   --dse=FILE         : explore the design space described in FILE (see README.md).\n"
+	"                                        Design points whose lower bounds are already dominated by\n"
+	"                                        the Pareto front of (cycles, DSP, FF, LUT, BRAM18k) are\n"
+	"                                        skipped. The front and all points are written to\n"
+	"                                        dse_results.csv in the output working directory.\n"
+	"                                        \"-c\" | \"--config-file\" is ignored. Not supported with\n"
+	"                                        \"--batch\", \"--mma-mode=gen\" or \"-m trace\"\n"
 	"                   --show-cfg         : dump CFG with basic blocks\n"
 	"                   --show-detail-cfg  : dump detailed CFG with instructions\n"
 	"                   --show-pre-dddg    : dump DDDG before optimisation\n"
@@ -78,8 +114,15 @@ const std::string helpMessage =
 	"\n"
 	"Analysis enable/disable flags:\n"
 	"                   --f-npla           : enable non-perfect loop analysis\n"
+	"                   --f-parnpla        : build the DDDGs of each non-perfect loop level (before,\n"
+	"                                        after and between nested loops) in parallel. Requires\n"
+	"                                        \"--fno-mma\"\n"
 	"                   --fno-tcs          : disable timing-constrained scheduling\n"
 	"                   --fno-mma          : disable memory model analysis\n"
+	"                   --f-recii-unroll   : calculate the recurrence-constrained II of pipelined loops by\n"
+	"                                        building a second DDDG with twice the unroll factor, instead\n"
+	"                                        of the maximum cycle ratio of the loop-carried dependencies\n"
+	"                                        (legacy method, kept for validation)\n"
 	"\n"
 	"Timing-constrained flags (ignored if \"--fno-tcs\" is set):\n"
 	"        -f FREQ  , --frequency=FREQ   : specify the target clock (in MHz)\n"
@@ -139,10 +182,10 @@ const std::string helpMessage =
 	"\n"
 	"For bug reporting, please file a github issue at https://github.com/comododragon/linaii\n";
 
-ArgPack args;
+thread_local ArgPack args;
 #ifdef PROGRESSIVE_TRACE_CURSOR
-long int progressiveTraceCursor = 0;
-uint64_t progressiveTraceInstCount = 0;
+thread_local long int progressiveTraceCursor = 0;
+thread_local uint64_t progressiveTraceInstCount = 0;
 #endif
 
 int main(int argc, char **argv) {
@@ -152,6 +195,13 @@ int main(int argc, char **argv) {
 
 	parseInputArguments(argc, argv);
 
+	if(args.convertTrace) {
+		errs() << "Converting " << args.workDir << FILE_DYNAMIC_TRACE << " to " << args.workDir << FILE_DYNAMIC_TRACE_BIN << "\n";
+		convertTextTraceToBinary(args.workDir + FILE_DYNAMIC_TRACE, args.workDir + FILE_DYNAMIC_TRACE_BIN, args.binaryTraceCompression);
+		errs() << "Done\n";
+		return 0;
+	}
+
 	errs() << "░░░░░░░░░░░░░░░░░░░░░░░░░░░░▒▒\n";
 	errs() << "░░▓▓▓▓▓▓▓▓▓▓▓▓▓▓▓▓▓▓▓▓▓▓▓▓▓▓▒▒\n";
 	errs() << "░░▓░░▓▓▓▓░░▓▓░░▓▓░░▓▓▓░░░░▓▓▒▒\n";
@@ -234,14 +284,24 @@ void parseInputArguments(int argc, char **argv) {
 	args.workDir = temp;
 	args.outWorkDir = temp;
 	args.configFileName = "config.cfg";
+	args.batchFileName = "";
+	args.batchThreads = 1;
+	args.dseFileName = "";
 	args.mode = args.MODE_TRACE_AND_ESTIMATE;
 	args.target = args.TARGET_XILINX_ZC702;
 	args.compressed = false;
+	args.binaryTrace = false;
+	args.binaryTraceCompression = BinaryTraceWriter::COMPRESSION_ZLIB;
+	args.traceThreads = 1;
+	args.convertTrace = false;
 #ifdef PROGRESSIVE_TRACE_CURSOR
 	args.progressive = false;
 #endif
 #ifdef FUTURE_CACHE
 	args.futureCache = false;
+#endif
+#ifdef DDDG_CACHE
+	args.dddgCache = false;
 #endif
 	args.frequency = 100.0;
 	args.uncertainty = 27;
@@ -255,8 +315,10 @@ void parseInputArguments(int argc, char **argv) {
 	args.showPostOptDDDG = false;
 	args.showScheduling = false;
 	args.fNPLA = false;
+	args.fParNPLA = false;
 	args.fNoTCS = false;
 	args.fNoMMA = false;
+	args.fRecIIUnroll = false;
 	args.fBurstAggr = false;
 	args.fBurstMix = false;
 	args.fVec = false;
@@ -322,6 +384,17 @@ void parseInputArguments(int argc, char **argv) {
 			{"f-es", no_argument, 0, 0xF16},
 			{"f-rwrwm", no_argument, 0, 0xF17},
 			{"f-argres", no_argument, 0, 0xF18},
+			{"binary-trace", optional_argument, 0, 0xF19},
+			{"convert-trace", no_argument, 0, 0xF1A},
+			{"batch", required_argument, 0, 0xF1B},
+			{"batch-threads", required_argument, 0, 0xF1C},
+#ifdef DDDG_CACHE
+			{"dddg-cache", no_argument, 0, 0xF1D},
+#endif
+			{"f-parnpla", no_argument, 0, 0xF1E},
+			{"trace-threads", required_argument, 0, 0xF1F},
+			{"f-recii-unroll", no_argument, 0, 0xF20},
+			{"dse", required_argument, 0, 0xF21},
 			{0, 0, 0, 0}
 		};
 		int optionIndex = 0;
@@ -494,6 +567,46 @@ void parseInputArguments(int argc, char **argv) {
 			case 0xF18:
 				args.fArgRes = true;
 				break;
+			case 0xF19:
+				args.binaryTrace = true;
+				if(optarg) {
+					optargStr = optarg;
+					if(!optargStr.compare("none"))
+						args.binaryTraceCompression = BinaryTraceWriter::COMPRESSION_NONE;
+					else if(!optargStr.compare("zlib"))
+						args.binaryTraceCompression = BinaryTraceWriter::COMPRESSION_ZLIB;
+					else {
+						errs() << "Invalid binary trace compression \"" << optargStr << "\", expected \"none\" or \"zlib\"\n";
+						exit(-1);
+					}
+				}
+				break;
+			case 0xF1A:
+				args.convertTrace = true;
+				break;
+			case 0xF1B:
+				args.batchFileName = optarg;
+				break;
+			case 0xF1C:
+				args.batchThreads = std::stoul(optarg);
+				break;
+#ifdef DDDG_CACHE
+			case 0xF1D:
+				args.dddgCache = true;
+				break;
+#endif
+			case 0xF1E:
+				args.fParNPLA = true;
+				break;
+			case 0xF1F:
+				args.traceThreads = std::stoul(optarg);
+				break;
+			case 0xF20:
+				args.fRecIIUnroll = true;
+				break;
+			case 0xF21:
+				args.dseFileName = optarg;
+				break;
 		}
 	}
 
@@ -506,6 +619,10 @@ void parseInputArguments(int argc, char **argv) {
 	args.outWorkDir += "/";
 #endif
 
+	// Trace conversion needs no bitcode or kernel name
+	if(args.convertTrace)
+		return;
+
 	if((argc - optind) != 2) {
 		errs() << "Missing input arguments (run \"" << argv[0] << " --help\" for help)\n";
 		exit(-1);
@@ -564,6 +681,60 @@ void parseInputArguments(int argc, char **argv) {
 		exit(-1);
 	}
 
+	if(!(args.batchFileName.empty())) {
+		if(ArgPack::MODE_TRACE_ONLY == args.mode) {
+			errs() << "\"--batch\" requires a mode that performs cycle estimation\n";
+			exit(-1);
+		}
+		if(ArgPack::MMA_MODE_GEN == args.mmaMode) {
+			errs() << "\"--batch\" is not supported with \"--mma-mode=gen\"\n";
+			exit(-1);
+		}
+#ifdef FUTURE_CACHE
+		if(args.batchThreads != 1 && args.futureCache) {
+			errs() << "\"--batch-threads\" is not supported with \"--future-cache\"\n";
+			exit(-1);
+		}
+#endif
+	}
+
+	if(!(args.dseFileName.empty())) {
+		if(!(args.batchFileName.empty())) {
+			errs() << "\"--dse\" and \"--batch\" cannot be used together\n";
+			exit(-1);
+		}
+		if(ArgPack::MODE_TRACE_ONLY == args.mode) {
+			errs() << "\"--dse\" requires a mode that performs cycle estimation\n";
+			exit(-1);
+		}
+		if(ArgPack::MMA_MODE_GEN == args.mmaMode) {
+			errs() << "\"--dse\" is not supported with \"--mma-mode=gen\"\n";
+			exit(-1);
+		}
+	}
+
+#if defined(DDDG_CACHE) && defined(FUTURE_CACHE)
+	// A DDDG recovered from the DDDG cache skips the trace search, thus its future cache element would never be saved
+	if(args.dddgCache && args.futureCache) {
+		errs() << "\"--dddg-cache\" is not supported with \"--future-cache\"\n";
+		exit(-1);
+	}
+#endif
+
+	if(args.fParNPLA) {
+		// The memory model analysis of a datapath depends on the analyses of the previous datapaths
+		if(!(args.fNoMMA)) {
+			errs() << "\"--f-parnpla\" requires \"--fno-mma\"\n";
+			exit(-1);
+		}
+#ifdef FUTURE_CACHE
+		if(args.futureCache) {
+			errs() << "\"--f-parnpla\" is not supported with \"--future-cache\"\n";
+			exit(-1);
+		}
+#endif
+	}
+
 	if(args.fVec && args.mmaMode != ArgPack::MMA_MODE_OFF && !(args.fBurstAggr)) {
 		errs() << "\"--f-burstaggr\" is required for \"--f-vec\" to work\n";
 		exit(-1);
@@ -574,7 +745,12 @@ void parseInputArguments(int argc, char **argv) {
 		errs() << "Kernel name: " << args.kernelNames[0] << "\n";
 		errs() << "Input working directory: " << args.workDir << "\n";
 		errs() << "Output working directory: " << args.outWorkDir << "\n";
-		errs() << "Configuration file: " << args.configFileName << "\n";
+		if(!(args.dseFileName.empty()))
+			errs() << "Design space file: " << args.dseFileName << "\n";
+		else if(args.batchFileName.empty())
+			errs() << "Configuration file: " << args.configFileName << "\n";
+		else
+			errs() << "Batch file: " << args.batchFileName << "\n";
 		errs() << "Mode: ";
 		switch(args.mode) {
 			case ArgPack::MODE_TRACE_ONLY:
@@ -603,6 +779,15 @@ void parseInputArguments(int argc, char **argv) {
 				errs() << "Xilinx Zynq-7000 SoC\n";
 				break;
 		}
+		errs() << "Dynamic trace format: " << (args.binaryTrace? "binary" : "textual (gzip)");
+		if(args.binaryTrace) {
+			errs() << ((BinaryTraceWriter::COMPRESSION_NONE == args.binaryTraceCompression)? ", uncompressed blocks" : ", zlib-compressed blocks");
+			if(args.mode != ArgPack::MODE_ESTIMATE_ONLY)
+				errs() << ", " << std::to_string(args.traceThreads) << " background thread(s)";
+			errs() << "\n";
+		}
+		else
+			errs() << "\n";
 		errs() << "Target clock: " << std::to_string(args.frequency) << ((args.fNoTCS)? " MHz (disabled)\n" : " MHz\n");
 		errs() << "Clock uncertainty: " << std::to_string(args.uncertainty) << ((args.fNoTCS)? " % (disabled)\n" : " %\n");
 		errs() << "Target clock period: " << std::to_string(1000 / args.frequency) << ((args.fNoTCS)? " ns (disabled)\n" : " ns\n");